@@ -42,6 +42,26 @@ static float truncateFloatFraction(float x, uint32_t mask = 0xFFFFFF00)
   return myu.y;
 }
 
+static void truncateFloatFraction(float* x, uint32_t n, uint32_t mask = 0xFFFFFF00)
+{
+  // Same as above, applied in place to an array of n floats. The loop has no
+  // branches and no dependencies between iterations, so it can be vectorized
+  constexpr uint32_t ProtMask = ((0x1u << 9) - 1u) << 23;
+  const uint32_t fullMask = ProtMask | mask;
+  if (fullMask == 0xFFFFFFFF) {
+    return;
+  }
+  for (uint32_t i = 0; i < n; i++) {
+    union {
+      float y;
+      uint32_t iy;
+    } myu;
+    myu.y = x[i];
+    myu.iy &= fullMask;
+    x[i] = myu.y;
+  }
+}
+
 } // namespace detail
 } // namespace math_utils
 } // namespace o2
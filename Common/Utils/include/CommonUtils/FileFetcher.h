@@ -21,7 +21,9 @@
 #include <thread>
 #include <Rtypes.h>
 #include <mutex>
+#include <atomic>
 #include <regex>
+#include <chrono>
 
 namespace o2
 {
@@ -36,6 +38,8 @@ class FileFetcher
     std::string localName{}; // local alias for for remote files
     bool remote = false;
     bool copied = false;
+    size_t size = 0;       // size of the local file when it was queued
+    float fetchTime = 0.f; // time in ms between the fetching start and the file being queued
 
     const auto& getLocalName() const { return remote ? localName : origName; }
     const auto& getOrigName() const { return origName; }
@@ -60,6 +64,12 @@ class FileFetcher
   const auto& getFileRef(size_t i) const { return mInputFiles[i]; }
 
   void setMaxFilesInQueue(size_t s) { mMaxInQueue = s > 0 ? s : 1; }
+  // max total size of the queued files, the files being copied are accounted with the average size. 0 for no limit
+  void setMaxBytesInQueue(size_t s) { mMaxBytesInQueue = s; }
+  // number of remote files copied concurrently, files are still queued in the input order
+  void setMaxConcurrentCopies(size_t n) { mMaxCopies = n > 0 ? n : 1; }
+  // ask the OS to read ahead the local files once they are queued
+  void setReadAhead(bool v) { mReadAhead = v; }
   void setMaxLoops(size_t v) { mMaxLoops = v; }
   bool isRunning() const { return mRunning; }
   void start();
@@ -69,15 +79,18 @@ class FileFetcher
   size_t getNFilesProc() const { return mNFilesProc; }
   size_t getNFilesProcOK() const { return mNFilesProcOK; }
   size_t getMaxFilesInQueue() const { return mMaxInQueue; }
+  size_t getMaxBytesInQueue() const { return mMaxBytesInQueue; }
+  size_t getMaxConcurrentCopies() const { return mMaxCopies; }
+  size_t getBytesInQueue() const { return mBytesInQueue; }
   size_t getNRemoteFiles() const { return mNRemote; }
   size_t getNFiles() const { return mInputFiles.size(); }
   size_t popFromQueue(bool discard = false);
   size_t getQueueSize() const { return mQueue.size(); }
   std::string getNextFileInQueue() const;
+  size_t nextInQueue() const;
   void discardFile(const std::string& fname);
 
  private:
-  size_t nextInQueue() const;
   void processInput(const std::string& input);
   void processInput(const std::vector<std::string>& input);
   void processDirectory(const std::string& name);
@@ -86,6 +99,8 @@ class FileFetcher
   bool copyFile(size_t id);
   bool isRemote(const std::string& fname) const;
   void fetcher();
+  void queueFile(size_t id, std::chrono::steady_clock::time_point start);
+  void readAhead(const std::string& fname) const;
 
  private:
   FIFO<size_t> mQueue{};
@@ -98,7 +113,12 @@ class FileFetcher
   std::vector<FileRef> mInputFiles{};
   size_t mNRemote{0};
   size_t mMaxInQueue{5};
-  bool mRunning = false;
+  size_t mMaxBytesInQueue{0};
+  size_t mMaxCopies{1};
+  std::atomic<size_t> mBytesInQueue{0}; //! total size of the queued files
+  size_t mBytesQueuedTotal{0};          // total size of all files queued so far, for the average
+  bool mReadAhead = false;
+  std::atomic<bool> mRunning{false}; //! set by the fetcher thread, polled by the reader
   bool mNoRemoteCopy = false;
   size_t mMaxLoops = 0;
   size_t mNLoops = 0;
@@ -19,8 +19,16 @@
 #include <TString.h>
 #include <TTree.h>
 #include <vector>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 class TBranch;
+class TBufferFile;
 class TClass;
 class TDataType;
 
@@ -28,6 +36,31 @@ namespace o2
 {
 namespace utils
 {
+/// Serial background executor filling the trees of batched TreeStreams.
+/// All streams writing to the same file must share the same flusher, since
+/// the ROOT I/O of one file can not be done from several threads.
+class TreeStreamFlusher
+{
+ public:
+  TreeStreamFlusher(size_t maxPending = 4);
+  ~TreeStreamFlusher();
+  /// queue a task, blocks if more than maxPending tasks are waiting
+  void submit(std::function<void()>&& task);
+  /// wait until all queued tasks are done
+  void wait();
+
+ private:
+  void run();
+
+  size_t mMaxPending = 4;
+  bool mStop = false;
+  bool mBusy = false;
+  std::mutex mMutex;
+  std::condition_variable mCondition;
+  std::deque<std::function<void()>> mTasks;
+  std::thread mThread;
+};
+
 /// The TreeStream class allows creating a root tree of any objects having root
 /// dictionary, using operator<< interface, and w/o prior tree declaration.
 /// The format is:
@@ -38,6 +71,10 @@ namespace utils
 ///
 /// See testTreeStream.cxx for functional example
 ///
+/// With setBatching, the rows are recorded into a buffer and filled into the tree
+/// in batches, optionally on a background thread, see TreeStreamFlusher. The
+/// resulting tree is identical.
+///
 class TreeStream
 {
  public:
@@ -50,15 +87,34 @@ class TreeStream
 
   TreeStream(const char* treename);
   TreeStream() = default;
-  virtual ~TreeStream() = default;
-  void Close() { mTree.Write(); }
+  virtual ~TreeStream();
+  void Close()
+  {
+    sync();
+    mTree.Write();
+  }
   Int_t CheckIn(Char_t type, void* pointer);
-  void BuildTree();
+  void BuildTree() { buildTree(mElements); }
   void Fill();
-  Double_t getSize() { return mTree.GetZipBytes(); }
+  Double_t getSize()
+  {
+    sync();
+    return mTree.GetZipBytes();
+  }
   TreeStream& Endl();
 
-  TTree& getTree() { return mTree; }
+  /// Record the rows into a buffer and fill the tree in batches of @a rowsPerBatch rows,
+  /// on the thread of the @a flusher if provided. 0 fills the tree row by row.
+  /// Fundamental types are copied, objects are streamed into the buffer.
+  void setBatching(size_t rowsPerBatch, TreeStreamFlusher* flusher = nullptr);
+  /// fill the tree with the buffered rows and wait until done
+  void sync();
+
+  TTree& getTree()
+  {
+    sync();
+    return mTree;
+  }
   const char* getName() const { return mTree.GetName(); }
   void setID(int id) { mID = id; }
   int getID() const { return mID; }
@@ -160,6 +216,27 @@ class TreeStream
   Int_t CheckIn(T* obj);
 
  private:
+  /// rows recorded in batched mode
+  struct Batch {
+    struct Row {
+      int status = 0;       ///< status of the layout when the row was recorded
+      size_t nElements = 0; ///< number of elements of the layout
+      size_t first = 0;     ///< index of the first element of the row in offsets and sizes
+    };
+    static constexpr uint32_t NullObject = 0xffffffff;
+    std::vector<TreeDataElement> layout; ///< elements as of the last recorded row
+    std::vector<Row> rows;
+    std::vector<uint32_t> offsets; ///< per row and element: offset in data
+    std::vector<uint32_t> sizes;   ///< per row and element: size in data, NullObject for null pointers
+    std::vector<char> data;        ///< values of the fundamental types and streamed objects
+  };
+
+  void buildTree(std::vector<TreeDataElement>& elements);
+  void fillRow(std::vector<TreeDataElement>& elements, int status);
+  void recordRow();
+  void flushBatch();
+  void fillBatch(Batch const& batch);
+
   //
   std::vector<TreeDataElement> mElements;
   std::vector<TBranch*> mBranches; ///< pointers to branches
@@ -169,6 +246,13 @@ class TreeStream
   int mNextNameCounter = 0;        ///< next name counter
   int mStatus = 0;                 ///< status of the layout
   TString mNextName;               ///< name for next entry
+  size_t mRowsPerBatch = 0;                   //! number of rows per batch, 0 if not batched
+  TreeStreamFlusher* mFlusher = nullptr;      //! executor of the batch filling, not owned
+  std::unique_ptr<Batch> mBatch;              //! rows being recorded
+  std::vector<TreeDataElement> mFillElements; //! elements as seen by the tree in batched mode
+  std::vector<void*> mFillObjects;            //! objects the streamed rows are read into
+  std::unique_ptr<TBufferFile> mStreamBuffer; //! buffer to stream the objects of a row
+  Long64_t mRecordedRows = 0;                 //! number of rows recorded in batched mode
 
   ClassDefNV(TreeStream, 0);
 };
@@ -36,6 +36,10 @@ namespace utils
 /// The flushing of trees to the file happens on TreeStreamRedirector::Close() call
 /// or at its desctruction.
 ///
+/// With setBatching, the rows of all streams are buffered and the trees are filled
+/// in batches on a background thread, so that the streaming costs only a copy of
+/// the values on the calling thread.
+///
 /// See testTreeStream.cxx for functional example
 ///
 class TreeStreamRedirector
@@ -50,6 +54,9 @@ class TreeStreamRedirector
   virtual TreeStream& operator<<(const char* name);
   void SetDirectory(TDirectory* sfile);
   void SetFile(TFile* sfile);
+  /// Fill the trees in batches of @a rowsPerBatch rows, on a background thread if @a async,
+  /// with at most @a maxPendingBatches batches waiting. 0 rows fills row by row.
+  void setBatching(size_t rowsPerBatch, bool async = true, size_t maxPendingBatches = 4);
   static void FixLeafNameBug(TTree* tree);
 
  private:
@@ -58,6 +65,8 @@ class TreeStreamRedirector
 
   std::unique_ptr<TDirectory> mOwnDirectory;             // own directory of the redirector
   TDirectory* mDirectory = nullptr;                      // output directory
+  size_t mRowsPerBatch = 0;                              //! rows per batch, 0 if not batched
+  std::unique_ptr<TreeStreamFlusher> mFlusher;           //! background filling of the batches, must outlive the layouts
   std::vector<std::unique_ptr<TreeStream>> mDataLayouts; // array of data layouts
 
   ClassDefNV(TreeStreamRedirector, 0);
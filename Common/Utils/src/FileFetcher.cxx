@@ -17,6 +17,9 @@
 #include "Framework/Logger.h"
 #include <filesystem>
 #include <fstream>
+#include <future>
+#include <deque>
+#include <unordered_set>
 #include <memory>
 #include <thread>
 #include <chrono>
@@ -24,6 +27,8 @@
 #include <locale>
 #include <boost/process.hpp>
 #include <TGrid.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 using namespace o2::utils;
 using namespace std::chrono_literals;
@@ -176,6 +181,7 @@ size_t FileFetcher::popFromQueue(bool discard)
   }
   auto id = mQueue.front();
   mQueue.pop();
+  mBytesInQueue -= std::min(mBytesInQueue.load(), mInputFiles[id].size);
   if (discard) {
     discardFile(mInputFiles[id].getLocalName());
   }
@@ -185,6 +191,7 @@ size_t FileFetcher::popFromQueue(bool discard)
 //____________________________________________________________
 size_t FileFetcher::nextInQueue() const
 {
+  std::lock_guard<std::mutex> lock(mMtx);
   return mQueue.empty() ? -1ul : mQueue.front();
 }
 
@@ -257,34 +264,128 @@ void FileFetcher::fetcher()
     }
   }
 
+  // TGrid is not thread safe, connect before the copies are started on their own threads
+  if (mNRemote && !mNoRemoteCopy && mCopyCmd.find("alien") != std::string::npos) {
+    if (!gGrid && !TGrid::Connect("alien://")) {
+      LOG(error) << "Copy command refers to alien but connection to Grid failed";
+    }
+  }
+
+  // files being fetched, in the order they have to be queued
+  struct Pending {
+    size_t id;
+    std::chrono::steady_clock::time_point start;
+    std::future<bool> copied; // invalid if no copy is needed
+  };
+  std::deque<Pending> pending;
+  std::unordered_set<size_t> copying; // ids of the files being copied
+  // queue the fetched files at the head of the pending list
+  auto queueFetched = [this, &pending, &copying]() {
+    while (!pending.empty()) {
+      auto& head = pending.front();
+      if (head.copied.valid()) {
+        if (head.copied.wait_for(0s) != std::future_status::ready) {
+          break;
+        }
+        copying.erase(head.id);
+        if (head.copied.get()) {
+          {
+            std::lock_guard<std::mutex> lock(mMtx); // the reader may be discarding another copy
+            mInputFiles[head.id].copied = true;
+          }
+          queueFile(head.id, head.start);
+        }
+      } else {
+        queueFile(head.id, head.start);
+      }
+      pending.pop_front();
+    }
+  };
+
   while (mRunning) {
+    queueFetched();
     mNLoops = mNFilesProc / getNFiles();
     if (mNLoops > mMaxLoops) {
+      if (!pending.empty()) { // complete the files being fetched
+        std::this_thread::sleep_for(5ms);
+        continue;
+      }
       LOGP(info, "Finished file fetching: {} of {} files fetched successfully in {} iterations", mNFilesProcOK, mNFilesProc, mMaxLoops);
       mRunning = false;
       break;
     }
-    if (getQueueSize() >= mMaxInQueue) {
+    bool full = getQueueSize() + pending.size() >= mMaxInQueue;
+    if (!full && mMaxBytesInQueue && (getQueueSize() || !pending.empty())) {
+      // the files being fetched are accounted with the average size of the files seen so far
+      size_t average = mNFilesProcOK ? mBytesQueuedTotal / mNFilesProcOK : 0;
+      full = mBytesInQueue + pending.size() * average >= mMaxBytesInQueue;
+    }
+    if (full) {
+      std::this_thread::sleep_for(5ms);
+      continue;
+    }
+    auto nextEntry = (fileEntry + 1) % getNFiles();
+    if (copying.count(nextEntry)) { // the file is still being copied in the previous iteration
       std::this_thread::sleep_for(5ms);
       continue;
     }
-    fileEntry = (fileEntry + 1) % getNFiles();
+    bool needsCopy = false;
+    {
+      std::lock_guard<std::mutex> lock(mMtx);
+      const auto& fileRef = mInputFiles[nextEntry];
+      needsCopy = !(fileRef.copied || !fileRef.remote || mNoRemoteCopy);
+    }
+    if (needsCopy && copying.size() >= mMaxCopies) {
+      std::this_thread::sleep_for(5ms);
+      continue;
+    }
+    fileEntry = nextEntry;
     if (fileEntry == 0 && mNLoops > 0) {
       LOG(info) << "Fetcher starts new iteration " << mNLoops;
     }
     mNFilesProc++;
-    auto& fileRef = mInputFiles[fileEntry];
-    if (fileRef.copied || !fileRef.remote || mNoRemoteCopy) {
-      mQueue.push(fileEntry);
-      mNFilesProcOK++;
-    } else { // need to copy
-      if (copyFile(fileEntry)) {
-        fileRef.copied = true;
-        mQueue.push(fileEntry);
-        mNFilesProcOK++;
-      }
+    auto& entry = pending.emplace_back(Pending{fileEntry, std::chrono::steady_clock::now(), {}});
+    if (needsCopy) {
+      entry.copied = std::async(std::launch::async, [this, fileEntry]() { return copyFile(fileEntry); });
+      copying.insert(fileEntry);
     }
   }
+  // the copies can not be interrupted, wait for them before returning
+  for (auto& entry : pending) {
+    if (entry.copied.valid()) {
+      entry.copied.wait();
+    }
+  }
+}
+
+//____________________________________________________________
+void FileFetcher::queueFile(size_t id, std::chrono::steady_clock::time_point start)
+{
+  auto& fileRef = mInputFiles[id];
+  const auto& fname = fileRef.getLocalName();
+  std::error_code ec;
+  auto size = fs::file_size(fname, ec); // remote files which are not copied have no local size
+  fileRef.size = ec ? 0 : size;
+  if (mReadAhead && !ec) {
+    readAhead(fname);
+  }
+  fileRef.fetchTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+  mBytesInQueue += fileRef.size;
+  mBytesQueuedTotal += fileRef.size;
+  mQueue.push(id);
+  mNFilesProcOK++;
+}
+
+//____________________________________________________________
+void FileFetcher::readAhead(const std::string& fname) const
+{
+  // ask the kernel to start reading the file into the page cache, so that the reader does not wait for the disk
+  int fd = open(fname.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+  posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+  close(fd);
 }
 
 //____________________________________________________________
@@ -303,11 +404,7 @@ void FileFetcher::discardFile(const std::string& fname)
 bool FileFetcher::copyFile(size_t id)
 {
   // copy remote file to local setCopyDirName. Adaptation for Gvozden's code from SubTimeFrameFileSource::DataFetcherThread()
-  if (mCopyCmd.find("alien") != std::string::npos) {
-    if (!gGrid && !TGrid::Connect("alien://")) {
-      LOG(error) << "Copy command refers to alien but connection to Grid failed";
-    }
-  }
+  // runs on its own thread, the Grid connection is done by the fetcher thread
   auto realCmd = std::regex_replace(std::regex_replace(mCopyCmd, std::regex("\\?src"), mInputFiles[id].getOrigName()), std::regex("\\?dst"), mInputFiles[id].getLocalName());
   std::vector<std::string> copyParams{"-c", realCmd};
   bp::child copyChild(bp::search_path("sh"), copyParams, bp::std_err > mCopyCmdLogFile, bp::std_out > mCopyCmdLogFile);
@@ -322,6 +419,7 @@ bool FileFetcher::copyFile(size_t id)
     LOGP(error, "FileFetcher: failed for copy command {}", realCmd);
     return false;
   }
+  std::lock_guard<std::mutex> lock(mMtx); // several copies may run concurrently
   mCopied[mInputFiles[id].getLocalName()] = id + 1;
   return true;
 }
@@ -13,9 +13,90 @@
 
 #include "CommonUtils/TreeStream.h"
 #include <TBranch.h>
+#include <TBufferFile.h>
+#include <cstring>
 
 using namespace o2::utils;
 
+namespace
+{
+size_t typeSize(char type)
+{
+  switch (type) {
+    case 'B':
+    case 'b':
+      return 1;
+    case 'S':
+    case 's':
+      return 2;
+    case 'I':
+    case 'i':
+    case 'F':
+      return 4;
+    default: // 'L', 'l', 'D'
+      return 8;
+  }
+}
+} // namespace
+
+//_________________________________________________
+TreeStreamFlusher::TreeStreamFlusher(size_t maxPending) : mMaxPending(maxPending > 0 ? maxPending : 1), mThread([this]() { run(); })
+{
+}
+
+//_________________________________________________
+TreeStreamFlusher::~TreeStreamFlusher()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStop = true;
+  }
+  mCondition.notify_all();
+  mThread.join();
+}
+
+//_________________________________________________
+void TreeStreamFlusher::submit(std::function<void()>&& task)
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  mCondition.wait(lock, [this]() { return mTasks.size() < mMaxPending; });
+  mTasks.emplace_back(std::move(task));
+  lock.unlock();
+  mCondition.notify_all();
+}
+
+//_________________________________________________
+void TreeStreamFlusher::wait()
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  mCondition.wait(lock, [this]() { return mTasks.empty() && !mBusy; });
+}
+
+//_________________________________________________
+void TreeStreamFlusher::run()
+{
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mCondition.wait(lock, [this]() { return mStop || !mTasks.empty(); });
+      if (mTasks.empty()) {
+        return;
+      }
+      task = std::move(mTasks.front());
+      mTasks.pop_front();
+      mBusy = true;
+    }
+    mCondition.notify_all();
+    task();
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mBusy = false;
+    }
+    mCondition.notify_all();
+  }
+}
+
 //_________________________________________________
 TreeStream::TreeStream(const char* treename) : mTree(treename, treename)
 {
@@ -23,6 +104,144 @@ TreeStream::TreeStream(const char* treename) : mTree(treename, treename)
   // Standard ctor
 }
 
+//_________________________________________________
+TreeStream::~TreeStream()
+{
+  // pending batches refer to this stream
+  if (mFlusher) {
+    mFlusher->wait();
+  }
+  for (size_t i = 0; i < mFillObjects.size(); i++) {
+    if (mFillObjects[i]) {
+      const_cast<TClass*>(mFillElements[i].cls)->Destructor(mFillObjects[i]);
+    }
+  }
+}
+
+//_________________________________________________
+void TreeStream::setBatching(size_t rowsPerBatch, TreeStreamFlusher* flusher)
+{
+  // Configure the batched filling, the rows recorded so far are filled first
+  sync();
+  if (!rowsPerBatch && !mFillElements.empty()) {
+    // object branches hold the address of the element pointer
+    for (size_t i = 0; i < mBranches.size() && i < mElements.size(); i++) {
+      if (mBranches[i] && mElements[i].cls) {
+        mBranches[i]->SetAddress(&(mElements[i].ptr));
+      }
+    }
+    mFillElements.clear();
+  }
+  mRowsPerBatch = rowsPerBatch;
+  mFlusher = rowsPerBatch ? flusher : nullptr;
+  mRecordedRows = mTree.GetEntries();
+}
+
+//_________________________________________________
+void TreeStream::sync()
+{
+  // Fill the tree with the recorded rows and wait until done
+  flushBatch();
+  if (mFlusher) {
+    mFlusher->wait();
+  }
+}
+
+//_________________________________________________
+void TreeStream::recordRow()
+{
+  // Record the current values of all elements
+  if (!mBatch) {
+    mBatch = std::make_unique<Batch>();
+  }
+  if (!mStreamBuffer) {
+    mStreamBuffer = std::make_unique<TBufferFile>(TBuffer::kWrite);
+  }
+  auto& batch = *mBatch;
+  batch.rows.push_back({mStatus, mElements.size(), batch.offsets.size()});
+  for (auto& element : mElements) {
+    auto offset = batch.data.size();
+    uint32_t size = Batch::NullObject;
+    if (element.type > 0) {
+      size = typeSize(element.type);
+      batch.data.resize(offset + size);
+      std::memcpy(batch.data.data() + offset, element.ptr, size);
+    } else if (element.cls && element.ptr && !mStatus) {
+      // on mismatch the pointer was not updated, the row is not filled anyhow
+      mStreamBuffer->Reset();
+      element.cls->Streamer(element.ptr, *mStreamBuffer);
+      size = mStreamBuffer->Length();
+      batch.data.insert(batch.data.end(), mStreamBuffer->Buffer(), mStreamBuffer->Buffer() + size);
+    }
+    batch.offsets.push_back(offset);
+    batch.sizes.push_back(size);
+  }
+  if (!mStatus) {
+    mRecordedRows++;
+  }
+}
+
+//_________________________________________________
+void TreeStream::flushBatch()
+{
+  // Hand the recorded rows over to the filling
+  if (!mBatch || mBatch->rows.empty()) {
+    return;
+  }
+  mBatch->layout = mElements;
+  std::shared_ptr<Batch> batch(std::move(mBatch));
+  if (mFlusher) {
+    mFlusher->submit([this, batch]() { fillBatch(*batch); });
+  } else {
+    fillBatch(*batch);
+  }
+}
+
+//_________________________________________________
+void TreeStream::fillBatch(Batch const& batch)
+{
+  // Fill the tree with the recorded rows, the elements point to the recorded values
+  for (auto& row : batch.rows) {
+    if (mFillElements.size() < row.nElements) {
+      bool moved = mFillElements.capacity() < row.nElements;
+      mFillElements.insert(mFillElements.end(), batch.layout.begin() + mFillElements.size(), batch.layout.begin() + row.nElements);
+      mFillObjects.resize(row.nElements, nullptr);
+      if (moved) {
+        // object branches hold the address of the element pointer
+        for (size_t i = 0; i < mBranches.size() && i < mFillElements.size(); i++) {
+          if (mBranches[i] && mFillElements[i].cls) {
+            mBranches[i]->SetAddress(&(mFillElements[i].ptr));
+          }
+        }
+      }
+    }
+    for (size_t i = 0; i < row.nElements; i++) {
+      auto& element = mFillElements[i];
+      auto offset = batch.offsets[row.first + i];
+      auto size = batch.sizes[row.first + i];
+      if (!element.cls) {
+        element.cls = batch.layout[i].cls;
+      }
+      if (element.type > 0) {
+        element.ptr = const_cast<char*>(batch.data.data() + offset);
+      } else if (size == Batch::NullObject || !element.cls) {
+        element.ptr = nullptr;
+      } else {
+        if (!mFillObjects[i]) {
+          mFillObjects[i] = element.cls->New();
+        }
+        TBufferFile buffer(TBuffer::kRead, size, const_cast<char*>(batch.data.data() + offset), kFALSE);
+        element.cls->Streamer(mFillObjects[i], buffer);
+        element.ptr = mFillObjects[i];
+      }
+    }
+    if (mTree.GetNbranches() == 0) {
+      buildTree(mFillElements);
+    }
+    fillRow(mFillElements, row.status);
+  }
+}
+
 //_________________________________________________
 int TreeStream::CheckIn(Char_t type, void* pointer)
 {
@@ -55,20 +274,20 @@ int TreeStream::CheckIn(Char_t type, void* pointer)
 }
 
 //_________________________________________________
-void TreeStream::BuildTree()
+void TreeStream::buildTree(std::vector<TreeDataElement>& elements)
 {
   // Build the Tree
 
   int entriesFilled = mTree.GetEntries();
-  if (mBranches.size() < mElements.size()) {
-    mBranches.resize(mElements.size());
+  if (mBranches.size() < elements.size()) {
+    mBranches.resize(elements.size());
   }
 
   TString name;
   TBranch* br = nullptr;
-  for (int i = 0; i < static_cast<int>(mElements.size()); i++) {
+  for (int i = 0; i < static_cast<int>(elements.size()); i++) {
     //
-    auto& element = mElements[i];
+    auto& element = elements[i];
     if (mBranches[i]) {
       continue;
     }
@@ -107,13 +326,21 @@ void TreeStream::BuildTree()
 void TreeStream::Fill()
 {
   // Fill the tree
+  fillRow(mElements, mStatus);
+  mStatus = 0;
+}
+
+//_________________________________________________
+void TreeStream::fillRow(std::vector<TreeDataElement>& elements, int status)
+{
+  // Fill the tree with the values the elements point to
 
-  int entries = mElements.size();
+  int entries = elements.size();
   if (entries > mTree.GetNbranches()) {
-    BuildTree();
+    buildTree(elements);
   }
   for (int i = 0; i < entries; i++) {
-    auto& element = mElements[i];
+    auto& element = elements[i];
     if (!element.type) {
       continue;
     }
@@ -124,10 +351,9 @@ void TreeStream::Fill()
       }
     }
   }
-  if (!mStatus) {
+  if (!status) {
     mTree.Fill(); // fill only in case of non conflicts
   }
-  mStatus = 0;
 }
 
 //_________________________________________________
@@ -135,6 +361,15 @@ TreeStream& TreeStream::Endl()
 {
   // Perform pseudo endl operation
 
+  if (mRowsPerBatch) {
+    recordRow();
+    if (mBatch->rows.size() >= mRowsPerBatch) {
+      flushBatch();
+    }
+    mStatus = 0;
+    mCurrentIndex = 0;
+    return *this;
+  }
   if (mTree.GetNbranches() == 0) {
     BuildTree();
   }
@@ -154,7 +389,7 @@ TreeStream& TreeStream::operator<<(const Char_t* name)
   }
   //
   // if tree was already defined ignore
-  if (mTree.GetEntries() > 0) {
+  if ((mRowsPerBatch ? mRecordedRows : mTree.GetEntries()) > 0) {
     return *this;
   }
   // check branch name if tree was not
@@ -14,6 +14,7 @@
 #include "CommonUtils/TreeStreamRedirector.h"
 #include <TFile.h>
 #include <TLeaf.h>
+#include <TROOT.h>
 #include <cstring>
 
 using namespace o2::utils;
@@ -60,6 +61,24 @@ void TreeStreamRedirector::SetDirectory(TDirectory* sfile)
   mDirectory = sfile;
 }
 
+//_________________________________________________
+void TreeStreamRedirector::setBatching(size_t rowsPerBatch, bool async, size_t maxPendingBatches)
+{
+  // Configure the batched filling of all the streams
+
+  std::unique_ptr<TreeStreamFlusher> flusher;
+  if (rowsPerBatch && async) {
+    ROOT::EnableThreadSafety();
+    flusher = std::make_unique<TreeStreamFlusher>(maxPendingBatches);
+  }
+  for (auto& layout : mDataLayouts) {
+    layout->setBatching(rowsPerBatch, flusher.get());
+  }
+  // the previous flusher is idle now
+  mFlusher = std::move(flusher);
+  mRowsPerBatch = rowsPerBatch;
+}
+
 //_____________________________________________________
 TreeStream& TreeStreamRedirector::operator<<(Int_t id)
 {
@@ -77,6 +96,7 @@ TreeStream& TreeStreamRedirector::operator<<(Int_t id)
   mDataLayouts.emplace_back(std::unique_ptr<TreeStream>(new TreeStream(Form("Tree%d", id))));
   auto layout = mDataLayouts.back().get();
   layout->setID(id);
+  layout->setBatching(mRowsPerBatch, mFlusher.get());
   if (backup) {
     backup->cd();
   }
@@ -101,6 +121,7 @@ TreeStream& TreeStreamRedirector::operator<<(const char* name)
   mDataLayouts.emplace_back(std::unique_ptr<TreeStream>(new TreeStream(name)));
   auto layout = mDataLayouts.back().get();
   layout->setID(-1);
+  layout->setBatching(mRowsPerBatch, mFlusher.get());
   if (backup) {
     backup->cd();
   }
@@ -112,6 +133,10 @@ void TreeStreamRedirector::Close()
 {
   // flush and close
 
+  // fill the rows still buffered by batched streams
+  for (auto& layout : mDataLayouts) {
+    layout->sync();
+  }
   TDirectory* backup = gDirectory;
   mDirectory->cd();
   for (auto& layout : mDataLayouts) {
@@ -0,0 +1,93 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file   testFileFetcher.cxx
+/// @brief  unit tests for the concurrent copies of the FileFetcher
+
+#define BOOST_TEST_MODULE FileFetcher unit test
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fmt/format.h>
+#include "CommonUtils/FileFetcher.h"
+#include "CommonUtils/StringUtils.h"
+
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+namespace
+{
+std::string readFile(const std::string& fname)
+{
+  std::ifstream in(fname, std::ios::binary);
+  return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_concurrent_copies)
+{
+  auto dir = o2::utils::Str::create_unique_path(fs::temp_directory_path().native() + "/test_FileFetcher", 8);
+  fs::create_directories(dir);
+  const size_t nFiles = 2, nLoops = 2;
+  std::vector<std::string> inputs, contents;
+  for (size_t i = 0; i < nFiles; i++) {
+    inputs.push_back(fmt::format("{}/remote_{}.dat", dir, i));
+    contents.push_back(std::string(1000 * (i + 1), 'a' + i));
+    std::ofstream(inputs.back(), std::ios::binary) << contents.back();
+  }
+  auto copyLog = fmt::format("{}/copies.txt", dir);
+
+  {
+    // the copies are slow, so that the next iteration asks for files which are still being copied
+    o2::utils::FileFetcher fetcher(fmt::format("{},{}", inputs[0], inputs[1]), "", ".*remote_.*",
+                                   fmt::format("sleep 0.2 && echo ?src >> {} && cp ?src ?dst", copyLog), dir);
+    BOOST_REQUIRE_EQUAL(fetcher.getNRemoteFiles(), nFiles);
+    fetcher.setMaxConcurrentCopies(4);
+    fetcher.setMaxFilesInQueue(4);
+    fetcher.setMaxLoops(nLoops - 1);
+    fetcher.start();
+
+    // files are queued in the input order, each with its complete copy
+    size_t nRead = 0;
+    auto deadline = std::chrono::steady_clock::now() + 30s;
+    while ((fetcher.isRunning() || fetcher.getQueueSize()) && std::chrono::steady_clock::now() < deadline) {
+      auto id = fetcher.nextInQueue();
+      if (id == -1ul) {
+        std::this_thread::sleep_for(5ms);
+        continue;
+      }
+      BOOST_CHECK_EQUAL(id, nRead % nFiles);
+      const auto& fileRef = fetcher.getFileRef(id);
+      BOOST_CHECK(fileRef.copied);
+      BOOST_CHECK_EQUAL(fileRef.size, contents[id].size());
+      BOOST_CHECK(readFile(fileRef.getLocalName()) == contents[id]);
+      BOOST_CHECK_EQUAL(fetcher.popFromQueue(), id);
+      nRead++;
+    }
+    fetcher.stop();
+    BOOST_CHECK_EQUAL(nRead, nFiles * nLoops);
+    BOOST_CHECK_EQUAL(fetcher.getNFilesProcOK(), nFiles * nLoops);
+  }
+
+  // a file still being copied is not copied a second time, the copy is reused
+  std::ifstream log(copyLog);
+  std::vector<std::string> copied{std::istream_iterator<std::string>(log), std::istream_iterator<std::string>()};
+  BOOST_CHECK_EQUAL(copied.size(), nFiles);
+
+  fs::remove_all(dir);
+}
@@ -27,7 +27,7 @@
 
 using namespace o2::utils;
 
-bool UnitTestSparse(Double_t scale, Int_t testEntries);
+bool UnitTestSparse(Double_t scale, Int_t testEntries, size_t rowsPerBatch = 0);
 
 BOOST_AUTO_TEST_CASE(TreeStream_test)
 {
@@ -109,8 +109,48 @@ BOOST_AUTO_TEST_CASE(TreeStream_test)
   //
 }
 
+BOOST_AUTO_TEST_CASE(TreeStreamBatched_test)
+{
+  // the same as above, filling the trees in batches on a background thread
+  std::string outFName("testTreeStreamBatched.root");
+  int nit = 1000;
+  {
+    TreeStreamRedirector tstStream(outFName.data(), "recreate");
+    tstStream.setBatching(64);
+    std::array<float, o2::track::kNParams> par{};
+    for (int i = 0; i < nit; i++) {
+      par[o2::track::kQ2Pt] = 0.5 + float(i) / nit;
+      float x = 10. + float(i) / nit * 200.;
+      o2::track::TrackPar trc(0., 0., par);
+      trc.propagateParamTo(x, 0.5);
+      tstStream << "TrackTree"
+                << "id=" << i << "x=" << x << "track=" << &trc << "\n";
+    }
+    tstStream.Close();
+  }
+  {
+    TFile inpf(outFName.data());
+    BOOST_CHECK(!inpf.IsZombie());
+    auto tree = (TTree*)inpf.GetObjectChecked("TrackTree", "TTree");
+    BOOST_REQUIRE(tree);
+    BOOST_CHECK(tree->GetEntries() == nit);
+    int id;
+    float x;
+    o2::track::TrackPar* trc = nullptr;
+    BOOST_CHECK(!tree->SetBranchAddress("id", &id));
+    BOOST_CHECK(!tree->SetBranchAddress("x", &x));
+    BOOST_CHECK(!tree->SetBranchAddress("track", &trc));
+    for (int i = 0; i < tree->GetEntries(); i++) {
+      tree->GetEntry(i);
+      BOOST_CHECK(id == i);
+      BOOST_CHECK(std::abs(x - trc->getX()) < 1e-4);
+    }
+  }
+  BOOST_CHECK(UnitTestSparse(0.5, nit, 64));
+}
+
 //_________________________________________________
-bool UnitTestSparse(Double_t scale, Int_t testEntries)
+bool UnitTestSparse(Double_t scale, Int_t testEntries, size_t rowsPerBatch)
 {
   // Unit test for the TreeStreamRedirector
   // 1.) Test TTreeRedirector
@@ -132,6 +172,7 @@ bool UnitTestSparse(Double_t scale, Int_t testEntries)
     scale = 1;
   }
   TreeStreamRedirector* pcstream = new TreeStreamRedirector(outFName.data(), "recreate");
+  pcstream->setBatching(rowsPerBatch);
   for (Int_t ientry = 0; ientry < testEntries; ientry++) {
     TVectorD vecRandom(200);
     TVectorD vecZerro(200); // zerro vector
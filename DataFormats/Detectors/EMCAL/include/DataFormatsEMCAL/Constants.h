@@ -104,7 +104,8 @@ enum FitAlgorithm {
   Standard = 0,  ///< Standard raw fitter
   Gamma2 = 1,    ///< Gamma2 raw fitter
   NeuralNet = 2, ///< Neural net raw fitter
-  NONE = 3
+  NONE = 3,
+  LookupTable = 4 ///< Lookup-table raw fitter
 };
 
 } // namespace emcal
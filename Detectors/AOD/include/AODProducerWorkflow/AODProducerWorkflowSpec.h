@@ -29,6 +29,7 @@
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/AnalysisHelpers.h"
 #include "Framework/DataProcessorSpec.h"
+#include "Framework/TableBuilder.h"
 #include "Framework/Task.h"
 #include "ReconstructionDataFormats/GlobalTrackID.h"
 #include "ReconstructionDataFormats/PrimaryVertex.h"
@@ -220,6 +221,7 @@ class AODProducerWorkflowDPL : public Task
   int64_t mTFNumber{-1};
   int mRunNumber{-1};
   int mTruncate{1};
+  int mNThreads{1};
   int mRecoOnly{0};
   o2::InteractionRecord mStartIR{}; // TF 1st IR
   TString mResFile{"AO2D"};
@@ -304,6 +306,30 @@ class AODProducerWorkflowDPL : public Task
     float trackTimeRes = -999.f;
   };
 
+  // columnar staging area for barrel tracks: filled collision by collision
+  // and written in bulk to the TRACK, TRACKCOV and TRACKEXTRA tables once
+  // all collisions of the TF are processed, row i being table entry i
+  struct BarrelTracksBatch {
+    std::vector<int> collisionIDs;
+    std::vector<o2::track::TrackParCov> tracks;
+    std::vector<TrackExtraInfo> extras;
+
+    size_t size() const { return tracks.size(); }
+    void reserve(size_t n)
+    {
+      collisionIDs.reserve(n);
+      tracks.reserve(n);
+      extras.reserve(n);
+    }
+    void clear()
+    {
+      collisionIDs.clear();
+      tracks.clear();
+      extras.clear();
+    }
+  };
+  BarrelTracksBatch mBarrelTracks;
+
   // helper struct for mc track labels
   // using -1 as dummies for AOD
   struct MCLabels {
@@ -320,12 +346,14 @@ class AODProducerWorkflowDPL : public Task
 
   uint64_t getTFNumber(const o2::InteractionRecord& tfStartIR, int runNumber);
 
-  template <typename TracksCursorType, typename TracksCovCursorType>
-  void addToTracksTable(TracksCursorType& tracksCursor, TracksCovCursorType& tracksCovCursor,
-                        const o2::track::TrackParCov& track, int collisionID);
+  void addToBarrelTracksBatch(const o2::track::TrackParCov& track, int collisionID, const TrackExtraInfo& extraInfoHolder);
 
-  template <typename TracksExtraCursorType>
-  void addToTracksExtraTable(TracksExtraCursorType& tracksExtraCursor, TrackExtraInfo& extraInfoHolder);
+  // bulk writers of the staged barrel tracks, one per table; the tables are
+  // independent and are filled in parallel if more than one thread is configured
+  void fillBarrelTracksTables(TableBuilder& tracksBuilder, TableBuilder& tracksCovBuilder, TableBuilder& tracksExtraBuilder);
+  void fillTracksTable(TableBuilder& tracksBuilder);
+  void fillTracksCovTable(TableBuilder& tracksCovBuilder);
+  void fillTracksExtraTable(TableBuilder& tracksExtraBuilder);
 
   template <typename mftTracksCursorType>
   void addToMFTTracksTable(mftTracksCursorType& mftTracksCursor, const o2::mft::TrackMFT& track, int collisionID);
@@ -337,15 +365,13 @@ class AODProducerWorkflowDPL : public Task
   // helper for track tables
   // * fills tables collision by collision
   // * interaction time is for TOF information
-  template <typename TracksCursorType, typename TracksCovCursorType, typename TracksExtraCursorType, typename mftTracksCursorType, typename fwdTracksCursorType, typename fwdTracksCovCursorType>
+  // * barrel tracks are only staged, see BarrelTracksBatch
+  template <typename mftTracksCursorType, typename fwdTracksCursorType, typename fwdTracksCovCursorType>
   void fillTrackTablesPerCollision(int collisionID,
                                    double interactionTime,
                                    const o2::dataformats::VtxTrackRef& trackRef,
                                    gsl::span<const GIndex>& GIndices,
                                    o2::globaltracking::RecoContainer& data,
-                                   TracksCursorType& tracksCursor,
-                                   TracksCovCursorType& tracksCovCursor,
-                                   TracksExtraCursorType& tracksExtraCursor,
                                    mftTracksCursorType& mftTracksCursor,
                                    fwdTracksCursorType& fwdTracksCursor,
                                    fwdTracksCovCursorType& fwdTracksCovCursor,
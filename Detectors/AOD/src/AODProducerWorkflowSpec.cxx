@@ -66,6 +66,8 @@
 #include "TMatrixD.h"
 #include "TString.h"
 #include "TObjString.h"
+#include <algorithm>
+#include <cmath>
 #include <map>
 #include <unordered_map>
 #include <string>
@@ -175,66 +177,159 @@ uint64_t AODProducerWorkflowDPL::getTFNumber(const o2::InteractionRecord& tfStar
   return ts;
 };
 
-template <typename TracksCursorType, typename TracksCovCursorType>
-void AODProducerWorkflowDPL::addToTracksTable(TracksCursorType& tracksCursor, TracksCovCursorType& tracksCovCursor,
-                                              const o2::track::TrackParCov& track, int collisionID)
+void AODProducerWorkflowDPL::addToBarrelTracksBatch(const o2::track::TrackParCov& track, int collisionID, const TrackExtraInfo& extraInfoHolder)
 {
-  tracksCursor(0,
-               collisionID,
-               o2::aod::track::Track,
-               truncateFloatFraction(track.getX(), mTrackX),
-               truncateFloatFraction(track.getAlpha(), mTrackAlpha),
-               track.getY(),
-               track.getZ(),
-               truncateFloatFraction(track.getSnp(), mTrackSnp),
-               truncateFloatFraction(track.getTgl(), mTrackTgl),
-               truncateFloatFraction(track.getQ2Pt(), mTrack1Pt));
-  // trackscov
-  float sY = TMath::Sqrt(track.getSigmaY2()), sZ = TMath::Sqrt(track.getSigmaZ2()), sSnp = TMath::Sqrt(track.getSigmaSnp2()),
-        sTgl = TMath::Sqrt(track.getSigmaTgl2()), sQ2Pt = TMath::Sqrt(track.getSigma1Pt2());
-  tracksCovCursor(0,
-                  truncateFloatFraction(sY, mTrackCovDiag),
-                  truncateFloatFraction(sZ, mTrackCovDiag),
-                  truncateFloatFraction(sSnp, mTrackCovDiag),
-                  truncateFloatFraction(sTgl, mTrackCovDiag),
-                  truncateFloatFraction(sQ2Pt, mTrackCovDiag),
-                  (Char_t)(128. * track.getSigmaZY() / (sZ * sY)),
-                  (Char_t)(128. * track.getSigmaSnpY() / (sSnp * sY)),
-                  (Char_t)(128. * track.getSigmaSnpZ() / (sSnp * sZ)),
-                  (Char_t)(128. * track.getSigmaTglY() / (sTgl * sY)),
-                  (Char_t)(128. * track.getSigmaTglZ() / (sTgl * sZ)),
-                  (Char_t)(128. * track.getSigmaTglSnp() / (sTgl * sSnp)),
-                  (Char_t)(128. * track.getSigma1PtY() / (sQ2Pt * sY)),
-                  (Char_t)(128. * track.getSigma1PtZ() / (sQ2Pt * sZ)),
-                  (Char_t)(128. * track.getSigma1PtSnp() / (sQ2Pt * sSnp)),
-                  (Char_t)(128. * track.getSigma1PtTgl() / (sQ2Pt * sTgl)));
+  mBarrelTracks.collisionIDs.push_back(collisionID);
+  mBarrelTracks.tracks.push_back(track);
+  mBarrelTracks.extras.push_back(extraInfoHolder);
 }
 
-template <typename TracksExtraCursorType>
-void AODProducerWorkflowDPL::addToTracksExtraTable(TracksExtraCursorType& tracksExtraCursor, TrackExtraInfo& extraInfoHolder)
+void AODProducerWorkflowDPL::fillBarrelTracksTables(TableBuilder& tracksBuilder, TableBuilder& tracksCovBuilder, TableBuilder& tracksExtraBuilder)
 {
-  // extra
-  tracksExtraCursor(0,
-                    truncateFloatFraction(extraInfoHolder.tpcInnerParam, mTrack1Pt),
-                    extraInfoHolder.flags,
-                    extraInfoHolder.itsClusterMap,
-                    extraInfoHolder.tpcNClsFindable,
-                    extraInfoHolder.tpcNClsFindableMinusFound,
-                    extraInfoHolder.tpcNClsFindableMinusCrossedRows,
-                    extraInfoHolder.tpcNClsShared,
-                    extraInfoHolder.trdPattern,
-                    truncateFloatFraction(extraInfoHolder.itsChi2NCl, mTrackCovOffDiag),
-                    truncateFloatFraction(extraInfoHolder.tpcChi2NCl, mTrackCovOffDiag),
-                    truncateFloatFraction(extraInfoHolder.trdChi2, mTrackCovOffDiag),
-                    truncateFloatFraction(extraInfoHolder.tofChi2, mTrackCovOffDiag),
-                    truncateFloatFraction(extraInfoHolder.tpcSignal, mTrackSignal),
-                    truncateFloatFraction(extraInfoHolder.trdSignal, mTrackSignal),
-                    truncateFloatFraction(extraInfoHolder.length, mTrackSignal),
-                    truncateFloatFraction(extraInfoHolder.tofExpMom, mTrack1Pt),
-                    truncateFloatFraction(extraInfoHolder.trackEtaEMCAL, mTrackPosEMCAL),
-                    truncateFloatFraction(extraInfoHolder.trackPhiEMCAL, mTrackPosEMCAL),
-                    truncateFloatFraction(extraInfoHolder.trackTime, mTrackSignal),
-                    truncateFloatFraction(extraInfoHolder.trackTimeRes, mTrackSignal));
+#ifdef WITH_OPENMP
+#pragma omp parallel for num_threads(mNThreads) schedule(static, 1) if (mNThreads > 1)
+#endif
+  for (int table = 0; table < 3; table++) {
+    switch (table) {
+      case 0:
+        fillTracksTable(tracksBuilder);
+        break;
+      case 1:
+        fillTracksCovTable(tracksCovBuilder);
+        break;
+      case 2:
+        fillTracksExtraTable(tracksExtraBuilder);
+        break;
+    }
+  }
+  mBarrelTracks.clear();
+}
+
+void AODProducerWorkflowDPL::fillTracksTable(TableBuilder& tracksBuilder)
+{
+  const auto& tracks = mBarrelTracks.tracks;
+  const uint32_t nTracks = tracks.size();
+  std::vector<uint8_t> trackType(nTracks, o2::aod::track::Track);
+  std::vector<float> x(nTracks), alpha(nTracks), y(nTracks), z(nTracks), snp(nTracks), tgl(nTracks), q2Pt(nTracks);
+  for (uint32_t i = 0; i < nTracks; i++) {
+    x[i] = tracks[i].getX();
+    alpha[i] = tracks[i].getAlpha();
+    y[i] = tracks[i].getY();
+    z[i] = tracks[i].getZ();
+    snp[i] = tracks[i].getSnp();
+    tgl[i] = tracks[i].getTgl();
+    q2Pt[i] = tracks[i].getQ2Pt();
+  }
+  truncateFloatFraction(x.data(), nTracks, mTrackX);
+  truncateFloatFraction(alpha.data(), nTracks, mTrackAlpha);
+  truncateFloatFraction(snp.data(), nTracks, mTrackSnp);
+  truncateFloatFraction(tgl.data(), nTracks, mTrackTgl);
+  truncateFloatFraction(q2Pt.data(), nTracks, mTrack1Pt);
+
+  auto tracksWriter = tracksBuilder.bulkCursor<o2::aodproducer::TracksTable>(nTracks);
+  tracksWriter(0, nTracks, mBarrelTracks.collisionIDs.data(), trackType.data(),
+               x.data(), alpha.data(), y.data(), z.data(), snp.data(), tgl.data(), q2Pt.data());
+}
+
+void AODProducerWorkflowDPL::fillTracksCovTable(TableBuilder& tracksCovBuilder)
+{
+  const auto& tracks = mBarrelTracks.tracks;
+  const uint32_t nTracks = tracks.size();
+  std::vector<float> sY(nTracks), sZ(nTracks), sSnp(nTracks), sTgl(nTracks), sQ2Pt(nTracks);
+  for (uint32_t i = 0; i < nTracks; i++) {
+    sY[i] = tracks[i].getSigmaY2();
+    sZ[i] = tracks[i].getSigmaZ2();
+    sSnp[i] = tracks[i].getSigmaSnp2();
+    sTgl[i] = tracks[i].getSigmaTgl2();
+    sQ2Pt[i] = tracks[i].getSigma1Pt2();
+  }
+  for (uint32_t i = 0; i < nTracks; i++) {
+    sY[i] = std::sqrt(sY[i]);
+    sZ[i] = std::sqrt(sZ[i]);
+    sSnp[i] = std::sqrt(sSnp[i]);
+    sTgl[i] = std::sqrt(sTgl[i]);
+    sQ2Pt[i] = std::sqrt(sQ2Pt[i]);
+  }
+  // the correlations are computed from the non-truncated sigmas
+  std::vector<int8_t> rhoZY(nTracks), rhoSnpY(nTracks), rhoSnpZ(nTracks), rhoTglY(nTracks), rhoTglZ(nTracks),
+    rhoTglSnp(nTracks), rho1PtY(nTracks), rho1PtZ(nTracks), rho1PtSnp(nTracks), rho1PtTgl(nTracks);
+  for (uint32_t i = 0; i < nTracks; i++) {
+    const auto& track = tracks[i];
+    rhoZY[i] = (Char_t)(128. * track.getSigmaZY() / (sZ[i] * sY[i]));
+    rhoSnpY[i] = (Char_t)(128. * track.getSigmaSnpY() / (sSnp[i] * sY[i]));
+    rhoSnpZ[i] = (Char_t)(128. * track.getSigmaSnpZ() / (sSnp[i] * sZ[i]));
+    rhoTglY[i] = (Char_t)(128. * track.getSigmaTglY() / (sTgl[i] * sY[i]));
+    rhoTglZ[i] = (Char_t)(128. * track.getSigmaTglZ() / (sTgl[i] * sZ[i]));
+    rhoTglSnp[i] = (Char_t)(128. * track.getSigmaTglSnp() / (sTgl[i] * sSnp[i]));
+    rho1PtY[i] = (Char_t)(128. * track.getSigma1PtY() / (sQ2Pt[i] * sY[i]));
+    rho1PtZ[i] = (Char_t)(128. * track.getSigma1PtZ() / (sQ2Pt[i] * sZ[i]));
+    rho1PtSnp[i] = (Char_t)(128. * track.getSigma1PtSnp() / (sQ2Pt[i] * sSnp[i]));
+    rho1PtTgl[i] = (Char_t)(128. * track.getSigma1PtTgl() / (sQ2Pt[i] * sTgl[i]));
+  }
+  truncateFloatFraction(sY.data(), nTracks, mTrackCovDiag);
+  truncateFloatFraction(sZ.data(), nTracks, mTrackCovDiag);
+  truncateFloatFraction(sSnp.data(), nTracks, mTrackCovDiag);
+  truncateFloatFraction(sTgl.data(), nTracks, mTrackCovDiag);
+  truncateFloatFraction(sQ2Pt.data(), nTracks, mTrackCovDiag);
+
+  auto tracksCovWriter = tracksCovBuilder.bulkCursor<o2::aodproducer::TracksCovTable>(nTracks);
+  tracksCovWriter(0, nTracks, sY.data(), sZ.data(), sSnp.data(), sTgl.data(), sQ2Pt.data(),
+                  rhoZY.data(), rhoSnpY.data(), rhoSnpZ.data(), rhoTglY.data(), rhoTglZ.data(),
+                  rhoTglSnp.data(), rho1PtY.data(), rho1PtZ.data(), rho1PtSnp.data(), rho1PtTgl.data());
+}
+
+void AODProducerWorkflowDPL::fillTracksExtraTable(TableBuilder& tracksExtraBuilder)
+{
+  const auto& extras = mBarrelTracks.extras;
+  const uint32_t nTracks = extras.size();
+  std::vector<uint32_t> flags(nTracks);
+  std::vector<uint8_t> itsClusterMap(nTracks), tpcNClsFindable(nTracks), tpcNClsShared(nTracks), trdPattern(nTracks);
+  std::vector<int8_t> tpcNClsFindableMinusFound(nTracks), tpcNClsFindableMinusCrossedRows(nTracks);
+  std::vector<float> tpcInnerParam(nTracks), itsChi2NCl(nTracks), tpcChi2NCl(nTracks), trdChi2(nTracks), tofChi2(nTracks),
+    tpcSignal(nTracks), trdSignal(nTracks), length(nTracks), tofExpMom(nTracks), trackEtaEMCAL(nTracks), trackPhiEMCAL(nTracks),
+    trackTime(nTracks), trackTimeRes(nTracks);
+  for (uint32_t i = 0; i < nTracks; i++) {
+    const auto& extra = extras[i];
+    tpcInnerParam[i] = extra.tpcInnerParam;
+    flags[i] = extra.flags;
+    itsClusterMap[i] = extra.itsClusterMap;
+    tpcNClsFindable[i] = extra.tpcNClsFindable;
+    tpcNClsFindableMinusFound[i] = extra.tpcNClsFindableMinusFound;
+    tpcNClsFindableMinusCrossedRows[i] = extra.tpcNClsFindableMinusCrossedRows;
+    tpcNClsShared[i] = extra.tpcNClsShared;
+    trdPattern[i] = extra.trdPattern;
+    itsChi2NCl[i] = extra.itsChi2NCl;
+    tpcChi2NCl[i] = extra.tpcChi2NCl;
+    trdChi2[i] = extra.trdChi2;
+    tofChi2[i] = extra.tofChi2;
+    tpcSignal[i] = extra.tpcSignal;
+    trdSignal[i] = extra.trdSignal;
+    length[i] = extra.length;
+    tofExpMom[i] = extra.tofExpMom;
+    trackEtaEMCAL[i] = extra.trackEtaEMCAL;
+    trackPhiEMCAL[i] = extra.trackPhiEMCAL;
+    trackTime[i] = extra.trackTime;
+    trackTimeRes[i] = extra.trackTimeRes;
+  }
+  truncateFloatFraction(tpcInnerParam.data(), nTracks, mTrack1Pt);
+  truncateFloatFraction(itsChi2NCl.data(), nTracks, mTrackCovOffDiag);
+  truncateFloatFraction(tpcChi2NCl.data(), nTracks, mTrackCovOffDiag);
+  truncateFloatFraction(trdChi2.data(), nTracks, mTrackCovOffDiag);
+  truncateFloatFraction(tofChi2.data(), nTracks, mTrackCovOffDiag);
+  truncateFloatFraction(tpcSignal.data(), nTracks, mTrackSignal);
+  truncateFloatFraction(trdSignal.data(), nTracks, mTrackSignal);
+  truncateFloatFraction(length.data(), nTracks, mTrackSignal);
+  truncateFloatFraction(tofExpMom.data(), nTracks, mTrack1Pt);
+  truncateFloatFraction(trackEtaEMCAL.data(), nTracks, mTrackPosEMCAL);
+  truncateFloatFraction(trackPhiEMCAL.data(), nTracks, mTrackPosEMCAL);
+  truncateFloatFraction(trackTime.data(), nTracks, mTrackSignal);
+  truncateFloatFraction(trackTimeRes.data(), nTracks, mTrackSignal);
+
+  auto tracksExtraWriter = tracksExtraBuilder.bulkCursor<o2::aodproducer::TracksExtraTable>(nTracks);
+  tracksExtraWriter(0, nTracks, tpcInnerParam.data(), flags.data(), itsClusterMap.data(), tpcNClsFindable.data(),
+                    tpcNClsFindableMinusFound.data(), tpcNClsFindableMinusCrossedRows.data(), tpcNClsShared.data(), trdPattern.data(),
+                    itsChi2NCl.data(), tpcChi2NCl.data(), trdChi2.data(), tofChi2.data(), tpcSignal.data(), trdSignal.data(),
+                    length.data(), tofExpMom.data(), trackEtaEMCAL.data(), trackPhiEMCAL.data(), trackTime.data(), trackTimeRes.data());
 }
 
 template <typename mftTracksCursorType>
@@ -254,15 +349,12 @@ void AODProducerWorkflowDPL::addToMFTTracksTable(mftTracksCursorType& mftTracksC
                   track.getTrackChi2());
 }
 
-template <typename TracksCursorType, typename TracksCovCursorType, typename TracksExtraCursorType, typename MftTracksCursorType, typename FwdTracksCursorType, typename FwdTracksCovCursorType>
+template <typename MftTracksCursorType, typename FwdTracksCursorType, typename FwdTracksCovCursorType>
 void AODProducerWorkflowDPL::fillTrackTablesPerCollision(int collisionID,
                                                          double interactionTime,
                                                          const o2::dataformats::VtxTrackRef& trackRef,
                                                          gsl::span<const GIndex>& GIndices,
                                                          o2::globaltracking::RecoContainer& data,
-                                                         TracksCursorType& tracksCursor,
-                                                         TracksCovCursorType& tracksCovCursor,
-                                                         TracksExtraCursorType& tracksExtraCursor,
                                                          MftTracksCursorType& mftTracksCursor,
                                                          FwdTracksCursorType& fwdTracksCursor,
                                                          FwdTracksCovCursorType& fwdTracksCovCursor,
@@ -365,8 +457,7 @@ void AODProducerWorkflowDPL::fillTrackTablesPerCollision(int collisionID,
             extraInfoHolder.flags |= o2::aod::track::PVContributor;
           }
 
-          addToTracksTable(tracksCursor, tracksCovCursor, trackPar, collisionID);
-          addToTracksExtraTable(tracksExtraCursor, extraInfoHolder);
+          addToBarrelTracksBatch(trackPar, collisionID, extraInfoHolder);
           // collecting table indices of barrel tracks for V0s table
           mGIDToTableID.emplace(trackIndex, mTableTrID);
           mTableTrID++;
@@ -960,6 +1051,7 @@ void AODProducerWorkflowDPL::init(InitContext& ic)
   mRecoOnly = ic.options().get<int>("reco-mctracks-only");
   mTruncate = ic.options().get<int>("enable-truncation");
   mRunNumber = ic.options().get<int>("run-number");
+  mNThreads = std::max(1, ic.options().get<int>("nthreads"));
 
   if (mTFNumber == -1L) {
     LOG(info) << "TFNumber will be obtained from CCDB";
@@ -1126,9 +1218,6 @@ void AODProducerWorkflowDPL::run(ProcessingContext& pc)
   auto mcParticlesCursor = mcParticlesBuilder.cursor<o2::aodproducer::MCParticlesTable>();
   auto mcTrackLabelCursor = mcTrackLabelBuilder.cursor<o2::aod::McTrackLabels>();
   auto mftTracksCursor = mftTracksBuilder.cursor<o2::aodproducer::MFTTracksTable>();
-  auto tracksCovCursor = tracksCovBuilder.cursor<o2::aodproducer::TracksCovTable>();
-  auto tracksCursor = tracksBuilder.cursor<o2::aodproducer::TracksTable>();
-  auto tracksExtraCursor = tracksExtraBuilder.cursor<o2::aodproducer::TracksExtraTable>();
   auto v0sCursor = v0sBuilder.cursor<o2::aod::StoredV0s>();
   auto zdcCursor = zdcBuilder.cursor<o2::aod::Zdcs>();
   auto caloCellsCursor = caloCellsBuilder.cursor<o2::aod::Calos>();
@@ -1386,11 +1475,13 @@ void AODProducerWorkflowDPL::run(ProcessingContext& pc)
     }
   }
 
+  mBarrelTracks.reserve(primVerGIs.size());
+
   // filling unassigned tracks first
   // so that all unassigned tracks are stored in the beginning of the table together
   auto& trackRef = primVer2TRefs.back(); // references to unassigned tracks are at the end
   // fixme: interaction time is undefined for unassigned tracks (?)
-  fillTrackTablesPerCollision(-1, -1, trackRef, primVerGIs, recoData, tracksCursor, tracksCovCursor, tracksExtraCursor, mftTracksCursor, fwdTracksCursor, fwdTracksCovCursor, dataformats::PrimaryVertex{});
+  fillTrackTablesPerCollision(-1, -1, trackRef, primVerGIs, recoData, mftTracksCursor, fwdTracksCursor, fwdTracksCovCursor, dataformats::PrimaryVertex{});
 
   // filling collisions and tracks into tables
   int collisionID = 0;
@@ -1428,10 +1519,13 @@ void AODProducerWorkflowDPL::run(ProcessingContext& pc)
                      truncateFloatFraction(timeStamp.getTimeStampError() * 1E3, mCollisionPositionCov));
     auto& trackRef = primVer2TRefs[collisionID];
     // passing interaction time in [ps]
-    fillTrackTablesPerCollision(collisionID, interactionTime, trackRef, primVerGIs, recoData, tracksCursor, tracksCovCursor, tracksExtraCursor, mftTracksCursor, fwdTracksCursor, fwdTracksCovCursor, vertex);
+    fillTrackTablesPerCollision(collisionID, interactionTime, trackRef, primVerGIs, recoData, mftTracksCursor, fwdTracksCursor, fwdTracksCovCursor, vertex);
     collisionID++;
   }
 
+  // all barrel tracks are staged now, write them in bulk
+  fillBarrelTracksTables(tracksBuilder, tracksCovBuilder, tracksExtraBuilder);
+
   // filling v0s table
   for (auto& svertex : secVertices) {
     auto trPosID = svertex.getProngID(0);
@@ -1598,6 +1692,7 @@ DataProcessorSpec getAODProducerWorkflowSpec(GID::mask_t src, bool enableSV, boo
       ConfigParamSpec{"aod-timeframe-id", VariantType::Int64, -1L, {"Set timeframe number"}},
       ConfigParamSpec{"fill-calo-cells", VariantType::Int, 1, {"Fill calo cells into cell table"}},
       ConfigParamSpec{"enable-truncation", VariantType::Int, 1, {"Truncation parameter: 1 -- on, != 1 -- off"}},
+      ConfigParamSpec{"nthreads", VariantType::Int, 1, {"Number of threads used to fill the barrel track tables"}},
       ConfigParamSpec{"lpmp-prod-tag", VariantType::String, "", {"LPMProductionTag"}},
       ConfigParamSpec{"anchor-pass", VariantType::String, "", {"AnchorPassName"}},
       ConfigParamSpec{"anchor-prod", VariantType::String, "", {"AnchorProduction"}},
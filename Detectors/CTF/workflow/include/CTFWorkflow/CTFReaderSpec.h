@@ -32,6 +32,9 @@ struct CTFReaderInp {
   std::vector<int> ctfIDs{};
   bool allowMissingDetectors = false;
   int maxFileCache = 1;
+  int maxFileCacheMB = 0;
+  int fetchCopies = 1;
+  bool fetchReadAhead = false;
   int64_t delay_us = 0;
   int maxLoops = 0;
   int maxTFs = -1;
@@ -21,6 +21,7 @@
 #include "Framework/InputSpec.h"
 #include "CommonUtils/StringUtils.h"
 #include "CommonUtils/FileFetcher.h"
+#include "Framework/Monitoring.h"
 #include "CTFWorkflow/CTFReaderSpec.h"
 #include "DetectorsCommonDataFormats/EncodedBlocks.h"
 #include "CommonUtils/NameConf.h"
@@ -94,6 +95,7 @@ class CTFReaderSpec : public o2::framework::Task
   int mFilesRead = 0;
   long mLastSendTime = 0L;
   long mCurrTreeEntry = 0;
+  float mFileWaitTime = 0.f; // time in ms spent waiting for the next file to be fetched
   size_t mSelIDEntry = 0; // next CTFID to select from the mInput.ctfIDs (if non-empty)
   TStopwatch mTimer;
 };
@@ -137,6 +139,9 @@ void CTFReaderSpec::init(InitContext& ic)
   mRunning = true;
   mFileFetcher = std::make_unique<o2::utils::FileFetcher>(mInput.inpdata, mInput.tffileRegex, mInput.remoteRegex, mInput.copyCmd);
   mFileFetcher->setMaxFilesInQueue(mInput.maxFileCache);
+  mFileFetcher->setMaxBytesInQueue(size_t(mInput.maxFileCacheMB) << 20);
+  mFileFetcher->setMaxConcurrentCopies(mInput.fetchCopies);
+  mFileFetcher->setReadAhead(mInput.fetchReadAhead);
   mFileFetcher->setMaxLoops(mInput.maxLoops);
   mFileFetcher->start();
 }
@@ -203,9 +208,19 @@ void CTFReaderSpec::run(ProcessingContext& pc)
         break;
       }
       usleep(5000); // wait 5ms for the files cache to be filled
+      mFileWaitTime += 5.f;
       continue;
     }
     LOG(info) << "Reading CTF input " << ' ' << tfFileName;
+    {
+      using namespace o2::monitoring;
+      auto& fileRef = mFileFetcher->getFileRef(mFileFetcher->nextInQueue());
+      auto& monitoring = pc.services().get<Monitoring>();
+      monitoring.send(Metric{double(fileRef.fetchTime), "ctf-reader/file-fetch-time-ms"}.addTag(tags::Key::Subsystem, tags::Value::DPL));
+      monitoring.send(Metric{double(mFileWaitTime), "ctf-reader/file-wait-time-ms"}.addTag(tags::Key::Subsystem, tags::Value::DPL));
+      monitoring.send(Metric{uint64_t(mFileFetcher->getBytesInQueue()), "ctf-reader/cached-bytes"}.addTag(tags::Key::Subsystem, tags::Value::DPL));
+    }
+    mFileWaitTime = 0.f;
     openCTFFile(tfFileName);
   }
 
@@ -57,6 +57,9 @@ void customize(std::vector<o2::framework::ConfigParamSpec>& workflowOptions)
   options.push_back(ConfigParamSpec{"ctf-file-regex", VariantType::String, ".*o2_ctf_run.+\\.root$", {"regex string to identify CTF files"}});
   options.push_back(ConfigParamSpec{"remote-regex", VariantType::String, "^(alien://|)/alice/data/.+", {"regex string to identify remote files"}}); // Use "^/eos/aliceo2/.+" for direct EOS access
   options.push_back(ConfigParamSpec{"max-cached-files", VariantType::Int, 3, {"max CTF files queued (copied for remote source)"}});
+  options.push_back(ConfigParamSpec{"max-cached-mb", VariantType::Int, 0, {"max size in MB of the CTF files queued, 0: no limit"}});
+  options.push_back(ConfigParamSpec{"fetch-copies", VariantType::Int, 1, {"number of remote CTF files copied concurrently"}});
+  options.push_back(ConfigParamSpec{"fetch-read-ahead", VariantType::Bool, false, {"let the OS read ahead the queued CTF files"}});
   options.push_back(ConfigParamSpec{"allow-missing-detectors", VariantType::Bool, false, {"send empty message if detector is missing in the CTF (otherwise throw)"}});
   options.push_back(ConfigParamSpec{"ctf-reader-verbosity", VariantType::Int, 0, {"verbosity level (0: summary per detector, 1: summary per block"}});
   options.push_back(ConfigParamSpec{"configKeyValues", VariantType::String, "", {"Semicolon separated key=value strings"}});
@@ -105,6 +108,9 @@ WorkflowSpec defineDataProcessing(ConfigContext const& configcontext)
   ctfInput.maxTFs = n > 0 ? n : 0x7fffffff;
 
   ctfInput.maxFileCache = std::max(1, configcontext.options().get<int>("max-cached-files"));
+  ctfInput.maxFileCacheMB = std::max(0, configcontext.options().get<int>("max-cached-mb"));
+  ctfInput.fetchCopies = std::max(1, configcontext.options().get<int>("fetch-copies"));
+  ctfInput.fetchReadAhead = configcontext.options().get<bool>("fetch-read-ahead");
 
   ctfInput.copyCmd = configcontext.options().get<std::string>("copy-cmd");
   ctfInput.tffileRegex = configcontext.options().get<std::string>("ctf-file-regex");
@@ -31,16 +31,28 @@ class TimeSlot
  public:
   TimeSlot() = default;
   TimeSlot(TFType tfS, TFType tfE) : mTFStart(tfS), mTFEnd(tfE) {}
-  TimeSlot(const TimeSlot& src) : mTFStart(src.mTFStart), mTFEnd(src.mTFEnd), mContainer(std::make_unique<Container>(*src.getContainer())) {}
+  TimeSlot(const TimeSlot& src) : mTFStart(src.mTFStart), mTFEnd(src.mTFEnd), mEntries(src.mEntries), mContainer(std::make_unique<Container>(*src.getContainer())) {}
+  TimeSlot(TimeSlot&& src) noexcept : mTFStart(src.mTFStart), mTFEnd(src.mTFEnd), mEntries(src.mEntries), mContainer(std::move(src.mContainer)) {}
   TimeSlot& operator=(const TimeSlot& src)
   {
     if (&src != this) {
       mTFStart = src.mTFStart;
       mTFEnd = src.mTFEnd;
+      mEntries = src.mEntries;
       mContainer = std::make_unique<Container>(*src.getContainer());
     }
     return *this;
   }
+  TimeSlot& operator=(TimeSlot&& src) noexcept
+  {
+    if (&src != this) {
+      mTFStart = src.mTFStart;
+      mTFEnd = src.mTFEnd;
+      mEntries = src.mEntries;
+      mContainer = std::move(src.mContainer);
+    }
+    return *this;
+  }
 
   ~TimeSlot() = default;
 
@@ -53,6 +65,10 @@ class TimeSlot
   void setTFStart(TFType v) { mTFStart = v; }
   void setTFEnd(TFType v) { mTFEnd = v; }
 
+  // number of TFs filled into this slot
+  size_t getEntries() const { return mEntries; }
+  void addEntry() { mEntries++; }
+
   // compare the TF with this slot boundaties
   int relateToTF(TFType tf) { return tf < mTFStart ? -1 : (tf > mTFEnd ? 1 : 0); }
 
@@ -61,6 +77,7 @@ class TimeSlot
   {
     mContainer->merge(prev.mContainer.get());
     mTFStart = prev.mTFStart;
+    mEntries += prev.mEntries;
   }
 
   void print() const
@@ -15,9 +15,15 @@
 /// @brief Processor for the multiple time slots calibration
 
 #include "DetectorsCalibration/TimeSlot.h"
+#include <chrono>
+#include <condition_variable>
 #include <deque>
 #include <gsl/gsl>
 #include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 namespace o2
 {
@@ -30,8 +36,19 @@ class TimeSlotCalibration
   using Slot = TimeSlot<Container>;
 
  public:
+  /// Occupancy of the slots and latency of their finalization
+  struct SlotMetrics {
+    size_t nSlots = 0;                  // number of open slots
+    size_t nEntries = 0;                // number of TFs accumulated in the open slots
+    size_t nPendingFinalization = 0;    // number of closed slots waiting for the asynchronous finalization
+    size_t nFinalized = 0;              // number of finalized slots
+    double lastFinalizationLatency = 0; // time in ms between closing of the slot and end of its finalization
+    double meanFinalizationLatency = 0;
+    double maxFinalizationLatency = 0;
+  };
+
   TimeSlotCalibration() = default;
-  virtual ~TimeSlotCalibration() = default;
+  virtual ~TimeSlotCalibration();
   uint64_t getMaxSlotsDelay() const { return mMaxSlotsDelay; }
   void setMaxSlotsDelay(uint64_t v) { mMaxSlotsDelay = v; }
 
@@ -49,6 +66,19 @@ class TimeSlotCalibration
 
   void setUpdateAtTheEndOfRunOnly() { mUpdateAtTheEndOfRunOnly = kTRUE; }
 
+  /// Finalize closed slots on a background thread, so that process() does not wait for finalizeSlot.
+  /// The output filled by finalizeSlot must then be accessed only while holding lockOutput().
+  /// At the end of run (checkSlotsToFinalize with INFINITE_TF) the pending finalizations are always waited for.
+  /// Since the thread calls finalizeSlot, it must be stopped with setAsyncFinalization(false) before the
+  /// derived class is destroyed, e.g. in its destructor or at the end of stream of the device.
+  void setAsyncFinalization(bool v = true);
+  bool isAsyncFinalization() const { return mAsyncFinalization; }
+  std::unique_lock<std::mutex> lockOutput() { return std::unique_lock<std::mutex>(mOutputMutex); }
+  /// block until all slots handed to the background thread are finalized
+  void waitForFinalization();
+
+  SlotMetrics getSlotMetrics() const;
+
   int getNSlots() const { return mSlots.size(); }
   Slot& getSlotForTF(TFType tf);
   Slot& getSlot(int i) { return (Slot&)mSlots.at(i); }
@@ -56,6 +86,8 @@ class TimeSlotCalibration
   const Slot& getLastSlot() const { return (Slot&)mSlots.back(); }
   const Slot& getFirstSlot() const { return (Slot&)mSlots.front(); }
 
+  // process() may be called concurrently for different TFs: the slot bookkeeping is serialized,
+  // while the containers of different slots are filled in parallel
   template <typename DATA>
   bool process(TFType tf, const DATA& data);
   virtual bool process(TFType tf, const gsl::span<const Input> data);
@@ -79,9 +111,46 @@ class TimeSlotCalibration
   auto& getSlots() { return mSlots; }
 
  private:
+  using Clock = std::chrono::steady_clock;
+
   TFType tf2SlotMin(TFType tf) const;
 
+  template <typename DATA>
+  bool processImpl(TFType tf, const DATA& data);
+
+  // finalize the slot right away or hand it over to the finalization thread, the slot is left empty
+  void closeSlot(Slot& slot);
+  void finalizeAndMeasure(Slot& slot, Clock::time_point closedAt);
+  void asyncFinalizationLoop();
+  void stopAsyncFinalization();
+
+  // fills in flight for a slot; such slots must not be finalized or merged
+  struct FillState {
+    std::mutex mutex; // serializes the fills of the slot container from different threads
+    int pending = 0;
+  };
+  // book a fill of the slot, must be called holding mSlotsMutex
+  FillState& bookFill(const Slot& slot);
+  void releaseFill(const Slot& slot);
+  bool hasPendingFills(const Slot& slot) const { return mFills.find(&slot) != mFills.end(); }
+
   std::deque<Slot> mSlots;
+  mutable std::recursive_mutex mSlotsMutex;                          //! protects the slot bookkeeping
+  // slots exist in mFills only while they have fills in flight, and they are not removed in the meanwhile
+  std::unordered_map<const Slot*, std::unique_ptr<FillState>> mFills; //! protected by mSlotsMutex
+
+  bool mAsyncFinalization = false;                                   //!
+  std::thread mFinalizationThread;                                   //!
+  mutable std::mutex mFinalizeMutex;                                 //! protects the queue of slots to finalize and the metrics
+  std::condition_variable mFinalizeCondition;                        //!
+  std::deque<std::pair<Slot, Clock::time_point>> mSlotsToFinalize;   //! closed slots waiting for finalization
+  bool mFinalizationInProgress = false;                              //!
+  bool mStopFinalization = false;                                    //!
+  std::mutex mOutputMutex;                                           //! held while finalizeSlot fills the output
+  size_t mNFinalized = 0;                                            //!
+  double mLastFinalizationLatency = 0.;                              //!
+  double mSumFinalizationLatency = 0.;                               //!
+  double mMaxFinalizationLatency = 0.;                               //!
 
   TFType mLastClosedTF = 0;
   TFType mFirstTF = 0;
@@ -108,56 +177,53 @@ template <typename Input, typename Container>
 template <typename DATA>
 bool TimeSlotCalibration<Input, Container>::process(TFType tf, const DATA& data)
 {
-
-  // process current TF
-
-  int maxDelay = mMaxSlotsDelay * mSlotLength;
-  if (!mUpdateAtTheEndOfRunOnly) {                                                               // if you update at the end of run only, then you accept everything
-    if (tf < mLastClosedTF || (!mSlots.empty() && getLastSlot().getTFStart() > tf + maxDelay)) { // ignore TF; note that if you have only 1 timeslot
-                                                                                                 // which is INFINITE_TF wide, then maxDelay
-                                                                                                 // does not matter: you won't accept TFs from the past,
-                                                                                                 // so the first condition will be used
-      LOG(info) << "Ignoring TF " << tf << ", mLastClosedTF = " << mLastClosedTF;
-      return false;
-    }
-  }
-
-  auto& slotTF = getSlotForTF(tf);
-  slotTF.getContainer()->fill(data);
-  if (tf > mMaxSeenTF) {
-    mMaxSeenTF = tf; // keep track of the most recent TF processed
-  }
-  if (!mUpdateAtTheEndOfRunOnly) { // if you update at the end of run only, you don't check at every TF which slots can be closed
-    // check if some slots are done
-    checkSlotsToFinalize(tf, maxDelay);
-  }
-
-  return true;
+  return processImpl(tf, data);
 }
 
 //_________________________________________________
 template <typename Input, typename Container>
 bool TimeSlotCalibration<Input, Container>::process(TFType tf, const gsl::span<const Input> data)
+{
+  return processImpl(tf, data);
+}
+
+//_________________________________________________
+template <typename Input, typename Container>
+template <typename DATA>
+bool TimeSlotCalibration<Input, Container>::processImpl(TFType tf, const DATA& data)
 {
 
   // process current TF
 
   int maxDelay = mMaxSlotsDelay * mSlotLength;
-  if (!mUpdateAtTheEndOfRunOnly) {                                                               // if you update at the end of run only, then you accept everything
-    if (tf < mLastClosedTF || (!mSlots.empty() && getLastSlot().getTFStart() > tf + maxDelay)) { // ignore TF; note that if you have only 1 timeslot
-                                                                                                 // which is INFINITE_TF wide, then maxDelay
-                                                                                                 // does not matter: you won't accept TFs from the past,
-                                                                                                 // so the first condition will be used
-      LOG(info) << "Ignoring TF " << tf << ", mLastClosedTF = " << mLastClosedTF;
-      return false;
+  Slot* slotTF = nullptr;
+  FillState* fill = nullptr;
+  {
+    std::lock_guard<std::recursive_mutex> lock(mSlotsMutex);
+    if (!mUpdateAtTheEndOfRunOnly) {                                                               // if you update at the end of run only, then you accept everything
+      if (tf < mLastClosedTF || (!mSlots.empty() && getLastSlot().getTFStart() > tf + maxDelay)) { // ignore TF; note that if you have only 1 timeslot
+                                                                                                   // which is INFINITE_TF wide, then maxDelay
+                                                                                                   // does not matter: you won't accept TFs from the past,
+                                                                                                   // so the first condition will be used
+        LOG(info) << "Ignoring TF " << tf << ", mLastClosedTF = " << mLastClosedTF;
+        return false;
+      }
+    }
+    slotTF = &getSlotForTF(tf);
+    fill = &bookFill(*slotTF); // the slot will not be merged or finalized until the fill is done
+    if (tf > mMaxSeenTF) {
+      mMaxSeenTF = tf; // keep track of the most recent TF processed
     }
   }
 
-  auto& slotTF = getSlotForTF(tf);
-  slotTF.getContainer()->fill(data);
-  if (tf > mMaxSeenTF) {
-    mMaxSeenTF = tf; // keep track of the most recent TF processed
+  {
+    // references to the slots are stable, since slots are only added and removed at the ends of the deque
+    std::lock_guard<std::mutex> lock(fill->mutex);
+    slotTF->getContainer()->fill(data);
+    slotTF->addEntry();
   }
+  releaseFill(*slotTF);
+
   if (!mUpdateAtTheEndOfRunOnly) { // if you update at the end of run only, you don't check at every TF which slots can be closed
     // check if some slots are done
     checkSlotsToFinalize(tf, maxDelay);
@@ -172,6 +238,7 @@ void TimeSlotCalibration<Input, Container>::checkSlotsToFinalize(TFType tf, int
 {
   // Check which slots can be finalized, provided the newly arrived TF is tf
 
+  std::lock_guard<std::recursive_mutex> lock(mSlotsMutex);
   constexpr uint64_t INFINITE_TF = 0xffffffffffffffff;
   constexpr int64_t INFINITE_TF_int64 = std::numeric_limits<long>::max() - 1; // this is used to define the end
                                                                               // of the slot in case it is "std::numeric_limits<long>::max()"
@@ -180,6 +247,9 @@ void TimeSlotCalibration<Input, Container>::checkSlotsToFinalize(TFType tf, int
   // if we have one slot only which is INFINITE_TF_int64 long, and we are not at the end of run (tf != INFINITE_TF),
   // we need to check if we got enough statistics, and if so, redefine the slot
   if (mSlots.size() == 1 && mSlots[0].getTFEnd() == INFINITE_TF_int64) {
+    if (hasPendingFills(mSlots[0])) {
+      return; // will be checked with the next TF
+    }
     uint64_t checkInterval = mCheckIntervalInfiniteSlot + mLastCheckedTFInfiniteSlot;
     if (mWasCheckedInfiniteSlot) {
       checkInterval = mCheckDeltaIntervalInfiniteSlot + mLastCheckedTFInfiniteSlot;
@@ -198,7 +268,7 @@ void TimeSlotCalibration<Input, Container>::checkSlotsToFinalize(TFType tf, int
         mSlots[0].setTFStart(mLastClosedTF);
         mSlots[0].setTFEnd(mMaxSeenTF);
         LOG(info) << "Finalizing slot for " << mSlots[0].getTFStart() << " <= TF <= " << mSlots[0].getTFEnd();
-        finalizeSlot(mSlots[0]);                  // will be removed after finalization
+        closeSlot(mSlots[0]);                     // will be removed after finalization
         mLastClosedTF = mSlots[0].getTFEnd() + 1; // will not accept any TF below this
         mSlots.erase(mSlots.begin());
         // creating a new slot if we are not at the end of run
@@ -218,10 +288,16 @@ void TimeSlotCalibration<Input, Container>::checkSlotsToFinalize(TFType tf, int
     for (auto slot = mSlots.begin(); slot != mSlots.end();) {
       //if (maxDelay == 0 || (slot->getTFEnd() + maxDelay) < tf) {
       if ((slot->getTFEnd() + maxDelay) < tf) {
+        if (hasPendingFills(*slot)) {
+          break; // still being filled, will be checked with the next TF
+        }
         if (hasEnoughData(*slot)) {
           LOG(debug) << "Finalizing slot for " << slot->getTFStart() << " <= TF <= " << slot->getTFEnd();
-          finalizeSlot(*slot); // will be removed after finalization
+          closeSlot(*slot); // will be removed after finalization
         } else if ((slot + 1) != mSlots.end()) {
+          if (hasPendingFills(*(slot + 1))) {
+            break;
+          }
           LOG(info) << "Merging underpopulated slot " << slot->getTFStart() << " <= TF <= " << slot->getTFEnd()
                     << " to slot " << (slot + 1)->getTFStart() << " <= TF <= " << (slot + 1)->getTFEnd();
           (slot + 1)->mergeToPrevious(*slot);
@@ -237,6 +313,9 @@ void TimeSlotCalibration<Input, Container>::checkSlotsToFinalize(TFType tf, int
       }
     }
   }
+  if (tf == INFINITE_TF) {
+    waitForFinalization();
+  }
 }
 
 //_________________________________________________
@@ -244,11 +323,12 @@ template <typename Input, typename Container>
 void TimeSlotCalibration<Input, Container>::finalizeOldestSlot()
 {
   // Enforce finalization and removal of the oldest slot
+  std::lock_guard<std::recursive_mutex> lock(mSlotsMutex);
   if (mSlots.empty()) {
     LOG(warning) << "There are no slots defined";
     return;
   }
-  finalizeSlot(mSlots.front());
+  closeSlot(mSlots.front());
   mLastClosedTF = mSlots.front().getTFEnd() + 1; // do not accept any TF below this
   mSlots.erase(mSlots.begin());
 }
@@ -298,10 +378,27 @@ TimeSlot<Container>& TimeSlotCalibration<Input, Container>::getSlotForTF(TFType
     }
     return mSlots[0];
   }
-  for (auto it = mSlots.begin(); it != mSlots.end(); it++) {
-    auto rel = (*it).relateToTF(tf);
-    if (rel == 0) {
-      return (*it);
+  if (!mSlots.empty() && tf <= mSlots.back().getTFEnd()) {
+    // all slots but the first one (which may have absorbed underpopulated slots) are contiguous and mSlotLength wide,
+    // so the slot is found from its distance to the last one; derived classes may create other layouts, hence the scan as fallback
+    if (mSlots.front().relateToTF(tf) == 0) {
+      return mSlots.front();
+    }
+    auto tfmn = tf2SlotMin(tf);
+    if (tfmn <= mSlots.back().getTFStart()) {
+      auto distance = (mSlots.back().getTFStart() - tfmn) / mSlotLength;
+      if (distance < mSlots.size()) {
+        auto& slot = mSlots[mSlots.size() - 1 - distance];
+        if (slot.relateToTF(tf) == 0) {
+          return slot;
+        }
+      }
+    }
+    for (auto it = mSlots.begin(); it != mSlots.end(); it++) {
+      auto rel = (*it).relateToTF(tf);
+      if (rel == 0) {
+        return (*it);
+      }
     }
   }
   // need to add in the end
@@ -315,6 +412,157 @@ TimeSlot<Container>& TimeSlotCalibration<Input, Container>::getSlotForTF(TFType
   return mSlots.back();
 }
 
+//_________________________________________________
+template <typename Input, typename Container>
+TimeSlotCalibration<Input, Container>::~TimeSlotCalibration()
+{
+  if (mFinalizationThread.joinable()) {
+    // the derived class is already destroyed at this point, finalizeSlot must not be called anymore
+    LOG(error) << "Asynchronous finalization was not stopped with setAsyncFinalization(false) before destroying the calibrator";
+    stopAsyncFinalization();
+  }
+}
+
+//_________________________________________________
+template <typename Input, typename Container>
+typename TimeSlotCalibration<Input, Container>::FillState& TimeSlotCalibration<Input, Container>::bookFill(const Slot& slot)
+{
+  auto& fill = mFills[&slot];
+  if (!fill) {
+    fill = std::make_unique<FillState>();
+  }
+  fill->pending++;
+  return *fill;
+}
+
+//_________________________________________________
+template <typename Input, typename Container>
+void TimeSlotCalibration<Input, Container>::releaseFill(const Slot& slot)
+{
+  std::lock_guard<std::recursive_mutex> lock(mSlotsMutex);
+  auto fill = mFills.find(&slot);
+  if (--fill->second->pending == 0) {
+    mFills.erase(fill);
+  }
+}
+
+//_________________________________________________
+template <typename Input, typename Container>
+void TimeSlotCalibration<Input, Container>::closeSlot(Slot& slot)
+{
+  auto closedAt = Clock::now();
+  if (!mAsyncFinalization) {
+    finalizeAndMeasure(slot, closedAt);
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mFinalizeMutex);
+  mSlotsToFinalize.emplace_back(std::move(slot), closedAt);
+  mFinalizeCondition.notify_all();
+}
+
+//_________________________________________________
+template <typename Input, typename Container>
+void TimeSlotCalibration<Input, Container>::finalizeAndMeasure(Slot& slot, Clock::time_point closedAt)
+{
+  {
+    std::lock_guard<std::mutex> lock(mOutputMutex);
+    finalizeSlot(slot);
+  }
+  double latency = std::chrono::duration<double, std::milli>(Clock::now() - closedAt).count();
+  std::lock_guard<std::mutex> lock(mFinalizeMutex);
+  mNFinalized++;
+  mLastFinalizationLatency = latency;
+  mSumFinalizationLatency += latency;
+  mMaxFinalizationLatency = std::max(mMaxFinalizationLatency, latency);
+}
+
+//_________________________________________________
+template <typename Input, typename Container>
+void TimeSlotCalibration<Input, Container>::setAsyncFinalization(bool v)
+{
+  if (v == mAsyncFinalization) {
+    return;
+  }
+  if (v) {
+    mStopFinalization = false;
+    mFinalizationThread = std::thread(&TimeSlotCalibration<Input, Container>::asyncFinalizationLoop, this);
+  } else {
+    waitForFinalization();
+    stopAsyncFinalization();
+  }
+  mAsyncFinalization = v;
+}
+
+//_________________________________________________
+template <typename Input, typename Container>
+void TimeSlotCalibration<Input, Container>::asyncFinalizationLoop()
+{
+  std::unique_lock<std::mutex> lock(mFinalizeMutex);
+  while (true) {
+    mFinalizeCondition.wait(lock, [this] { return mStopFinalization || !mSlotsToFinalize.empty(); });
+    if (mStopFinalization) {
+      return;
+    }
+    auto [slot, closedAt] = std::move(mSlotsToFinalize.front());
+    mSlotsToFinalize.pop_front();
+    mFinalizationInProgress = true;
+    lock.unlock();
+    finalizeAndMeasure(slot, closedAt);
+    lock.lock();
+    mFinalizationInProgress = false;
+    mFinalizeCondition.notify_all();
+  }
+}
+
+//_________________________________________________
+template <typename Input, typename Container>
+void TimeSlotCalibration<Input, Container>::waitForFinalization()
+{
+  std::unique_lock<std::mutex> lock(mFinalizeMutex);
+  mFinalizeCondition.wait(lock, [this] { return !mFinalizationThread.joinable() || (mSlotsToFinalize.empty() && !mFinalizationInProgress); });
+}
+
+//_________________________________________________
+template <typename Input, typename Container>
+void TimeSlotCalibration<Input, Container>::stopAsyncFinalization()
+{
+  if (!mFinalizationThread.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mFinalizeMutex);
+    if (!mSlotsToFinalize.empty()) {
+      // the derived class may be already gone, so the remaining slots cannot be finalized anymore
+      LOG(warning) << "Discarding " << mSlotsToFinalize.size() << " slots which were not finalized yet";
+      mSlotsToFinalize.clear();
+    }
+    mStopFinalization = true;
+    mFinalizeCondition.notify_all();
+  }
+  mFinalizationThread.join();
+}
+
+//_________________________________________________
+template <typename Input, typename Container>
+typename TimeSlotCalibration<Input, Container>::SlotMetrics TimeSlotCalibration<Input, Container>::getSlotMetrics() const
+{
+  SlotMetrics metrics;
+  {
+    std::lock_guard<std::recursive_mutex> lock(mSlotsMutex);
+    metrics.nSlots = mSlots.size();
+    for (const auto& slot : mSlots) {
+      metrics.nEntries += slot.getEntries();
+    }
+  }
+  std::lock_guard<std::mutex> lock(mFinalizeMutex);
+  metrics.nPendingFinalization = mSlotsToFinalize.size() + (mFinalizationInProgress ? 1 : 0);
+  metrics.nFinalized = mNFinalized;
+  metrics.lastFinalizationLatency = mLastFinalizationLatency;
+  metrics.meanFinalizationLatency = mNFinalized ? mSumFinalizationLatency / mNFinalized : 0.;
+  metrics.maxFinalizationLatency = mMaxFinalizationLatency;
+  return metrics;
+}
+
 //_________________________________________________
 template <typename Input, typename Container>
 void TimeSlotCalibration<Input, Container>::print() const
@@ -0,0 +1,172 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test TimeSlotCalibration
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "DetectorsCalibration/TimeSlotCalibration.h"
+#include <future>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace o2
+{
+namespace calibration
+{
+
+// counts the data filled into a slot
+struct TFCounter {
+  size_t entries = 0;
+  void fill(const gsl::span<const int> data) { entries += data.size(); }
+  void merge(const TFCounter* prev) { entries += prev->entries; }
+  void print() const {}
+};
+
+class CountingCalibrator final : public TimeSlotCalibration<int, TFCounter>
+{
+ public:
+  using Slot = TimeSlot<TFCounter>;
+  using Result = std::tuple<TFType, TFType, size_t>;
+
+  ~CountingCalibrator() final { setAsyncFinalization(false); }
+
+  void initOutput() final { mFinalized.clear(); }
+
+  void finalizeSlot(Slot& slot) final
+  {
+    if (mRelease.valid()) {
+      mRelease.wait();
+    }
+    mFinalized.emplace_back(slot.getTFStart(), slot.getTFEnd(), slot.getContainer()->entries);
+  }
+
+  Slot& emplaceNewSlot(bool front, TFType tstart, TFType tend) final
+  {
+    auto& slots = getSlots();
+    auto& slot = front ? slots.emplace_front(tstart, tend) : slots.emplace_back(tstart, tend);
+    slot.setContainer(std::make_unique<TFCounter>());
+    return slot;
+  }
+
+  bool hasEnoughData(const Slot& slot) const final { return true; }
+
+  // finalizeSlot blocks until the value is set
+  void setRelease(std::shared_future<void> release) { mRelease = release; }
+  const std::vector<Result>& getFinalized() const { return mFinalized; }
+
+ private:
+  std::shared_future<void> mRelease;
+  std::vector<Result> mFinalized;
+};
+
+void processTF(CountingCalibrator& calib, TFType tf)
+{
+  std::vector<int> data{static_cast<int>(tf)};
+  calib.process(tf, gsl::span<const int>(data));
+}
+
+BOOST_AUTO_TEST_CASE(AsyncFinalization)
+{
+  CountingCalibrator calib;
+  calib.setSlotLength(10);
+  calib.setMaxSlotsDelay(0);
+  calib.setAsyncFinalization();
+  BOOST_CHECK(calib.isAsyncFinalization());
+  for (TFType tf = 0; tf < 50; tf++) {
+    processTF(calib, tf);
+  }
+  // end of run: all slots are closed, and their finalization is waited for
+  calib.checkSlotsToFinalize(0xffffffffffffffff);
+  BOOST_CHECK_EQUAL(calib.getNSlots(), 0);
+
+  auto metrics = calib.getSlotMetrics();
+  BOOST_CHECK_EQUAL(metrics.nPendingFinalization, 0);
+  BOOST_CHECK_EQUAL(metrics.nFinalized, 5);
+
+  auto lock = calib.lockOutput();
+  const auto& finalized = calib.getFinalized();
+  BOOST_REQUIRE_EQUAL(finalized.size(), 5);
+  for (size_t i = 0; i < finalized.size(); i++) {
+    BOOST_CHECK_EQUAL(std::get<0>(finalized[i]), i * 10);
+    BOOST_CHECK_EQUAL(std::get<1>(finalized[i]), i * 10 + 9);
+    BOOST_CHECK_EQUAL(std::get<2>(finalized[i]), 10);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ProcessWhileFinalizing)
+{
+  CountingCalibrator calib;
+  std::promise<void> release;
+  calib.setRelease(release.get_future().share());
+  calib.setSlotLength(10);
+  calib.setMaxSlotsDelay(0);
+  calib.setAsyncFinalization();
+  // the finalization of the first slot blocks, but TFs keep being accepted
+  for (TFType tf = 0; tf < 30; tf++) {
+    processTF(calib, tf);
+  }
+  auto metrics = calib.getSlotMetrics();
+  BOOST_CHECK_EQUAL(metrics.nSlots, 1);
+  BOOST_CHECK_EQUAL(metrics.nEntries, 10);
+  BOOST_CHECK_EQUAL(metrics.nPendingFinalization, 2);
+  BOOST_CHECK_EQUAL(metrics.nFinalized, 0);
+
+  release.set_value();
+  calib.waitForFinalization();
+  metrics = calib.getSlotMetrics();
+  BOOST_CHECK_EQUAL(metrics.nPendingFinalization, 0);
+  BOOST_CHECK_EQUAL(metrics.nFinalized, 2);
+  {
+    auto lock = calib.lockOutput();
+    BOOST_CHECK_EQUAL(calib.getFinalized().size(), 2);
+  }
+  // switching back to synchronous finalization stops the thread
+  calib.setAsyncFinalization(false);
+  BOOST_CHECK(!calib.isAsyncFinalization());
+  calib.checkSlotsToFinalize(0xffffffffffffffff);
+  BOOST_CHECK_EQUAL(calib.getFinalized().size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentFill)
+{
+  CountingCalibrator calib;
+  calib.setSlotLength(10);
+  calib.setMaxSlotsDelay(100); // nothing is closed before the end of run
+  calib.setAsyncFinalization();
+  const int nThreads = 4;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < nThreads; t++) {
+    threads.emplace_back([&calib, t]() {
+      for (TFType tf = t; tf < 100; tf += nThreads) {
+        processTF(calib, tf);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  BOOST_CHECK_EQUAL(calib.getSlotMetrics().nEntries, 100);
+  calib.checkSlotsToFinalize(0xffffffffffffffff);
+
+  auto lock = calib.lockOutput();
+  const auto& finalized = calib.getFinalized();
+  BOOST_REQUIRE_EQUAL(finalized.size(), 10);
+  for (size_t i = 0; i < finalized.size(); i++) {
+    BOOST_CHECK_EQUAL(std::get<0>(finalized[i]), i * 10);
+    BOOST_CHECK_EQUAL(std::get<2>(finalized[i]), 10);
+  }
+}
+
+} // namespace calibration
+} // namespace o2
@@ -15,6 +15,8 @@
 #include <array>
 #include <optional>
 #include <string_view>
+#include <variant>
+#include <vector>
 #include <Rtypes.h>
 #include <gsl/span>
 #include "EMCALReconstruction/CaloFitResults.h"
@@ -75,6 +77,18 @@ class CaloRawFitter
 
   virtual CaloFitResults evaluate(const gsl::span<const Bunch> bunchvector) = 0;
 
+  /// \brief Result of the raw fit of a channel within a batch: fit results or error code
+  using ChannelFitResult = std::variant<CaloFitResults, RawFitterError_t>;
+
+  /// \brief Evaluate amplitude and time of several channels
+  /// \param channels ALTRO bunches of each channel
+  /// \param[out] results Fit results or error code for each channel, in the same order as the channels
+  ///
+  /// Channels without bunches are not fitted and get RawFitterError_t::BUNCH_NOT_OK.
+  /// The default implementation calls evaluate for each other channel. Fitters able
+  /// to process several channels at once can override it.
+  virtual void evaluateBatch(const gsl::span<const gsl::span<const Bunch>> channels, std::vector<ChannelFitResult>& results);
+
   /// \brief Method to do the selection of what should possibly be fitted.
   /// \param bunchvector ALTRO bunches for the current channel
   /// \param adcThreshold ADC threshold applied in peak finding
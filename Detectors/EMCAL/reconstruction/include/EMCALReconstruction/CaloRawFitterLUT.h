@@ -0,0 +1,126 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef __CALORAWFITTERLUT_H__
+#define __CALORAWFITTERLUT_H__
+
+#include <array>
+#include <vector>
+#include <Rtypes.h>
+#include "EMCALReconstruction/CaloFitResults.h"
+#include "DataFormatsEMCAL/Constants.h"
+#include "EMCALReconstruction/Bunch.h"
+#include "EMCALReconstruction/CaloRawFitter.h"
+
+namespace o2
+{
+
+namespace emcal
+{
+
+/// \class CaloRawFitterLUT
+/// \brief  Raw data fitting: Gamma-2 pulse shape from lookup tables
+/// \ingroup EMCALreconstruction
+///
+/// Evaluation of amplitude and peak position assuming the same gamma-2
+/// pulse shape as CaloRawFitterGamma2, without iterative fit:
+/// - the peak time is obtained from the ratio (A[max+1] - A[max-1]) / A[max]
+///   of the samples around the maximum, through a precomputed table,
+/// - the amplitude is the least square estimate for this peak time,
+/// - both are refined with a single Newton (Gauss-Newton) step over the samples
+///   of the peak region.
+/// The pulse shape and its derivative are tabulated as well, so that no exponential
+/// is evaluated during the fit. In evaluateBatch the samples of up to BATCHSIZE
+/// channels are stored aligned on their maximum, and the fit is done with loops
+/// over the channels which the compiler can vectorize.
+class CaloRawFitterLUT final : public CaloRawFitter
+{
+
+ public:
+  static constexpr int BATCHSIZE = 64;                                ///< max. number of channels fitted together
+  static constexpr int NROWS = 2 * constants::EMCAL_MAXTIMEBINS - 1;  ///< number of sample rows, maximum in the central one
+  static constexpr int CENTRALROW = constants::EMCAL_MAXTIMEBINS - 1; ///< row of the maximum sample
+  static constexpr int NRATIOBINS = 1024;                             ///< number of bins of the peak time table
+  static constexpr int NSHAPEBINSPERSAMPLE = 128;                     ///< number of bins of the shape table per time sample
+  static constexpr double MAXPEAKSHIFT = 1.;                          ///< max. distance (samples) between peak time and max. sample
+  static constexpr double SHAPEMIN = -constants::TAU;                 ///< start of the shape table (samples after peak time)
+  static constexpr double SHAPEMAX = CENTRALROW + MAXPEAKSHIFT;       ///< end of the shape table (samples after peak time)
+
+  /// \brief Constructor, building the lookup tables
+  CaloRawFitterLUT();
+
+  /// \brief Destructor
+  ~CaloRawFitterLUT() final = default;
+
+  /// \brief Evaluation Amplitude and TOF
+  /// \param bunchvector ALTRO bunches for the current channel
+  /// \return Container with the fit results (amp, time, chi2, ...)
+  /// \throw RawFitterError_t in case the fit failed (including all possible errors from upstream)
+  CaloFitResults evaluate(const gsl::span<const Bunch> bunchvector) final;
+
+  /// \brief Evaluation Amplitude and TOF of several channels, fitted in batches of BATCHSIZE channels
+  /// \param channels ALTRO bunches of each channel
+  /// \param[out] results Fit results or error code for each channel
+  void evaluateBatch(const gsl::span<const gsl::span<const Bunch>> channels, std::vector<ChannelFitResult>& results) final;
+
+  /// \brief Gamma-2 pulse shape normalized to 1 at the peak
+  /// \param dt Time after the peak time, in samples
+  static double pulseShape(double dt);
+
+  /// \brief Derivative of the gamma-2 pulse shape
+  /// \param dt Time after the peak time, in samples
+  static double pulseShapeDerivative(double dt);
+
+  /// \brief Ratio (A[max+1] - A[max-1]) / A[max] for a pulse peaking at max + shift
+  /// \param shift Peak time minus time of the max. sample, in samples
+  static double peakRatio(double shift);
+
+ private:
+  /// \brief Select the peak region of the channel and store it in a batch slot
+  /// \param bunchvector ALTRO bunches of the channel
+  /// \param slot Slot in the batch
+  /// \throw RawFitterError_t in case no peak can be selected
+  void loadChannel(const gsl::span<const Bunch> bunchvector, int slot);
+
+  /// \brief Fit the channels stored in the first nchannels slots of the batch
+  void fitBatch(int nchannels);
+
+  /// \brief Build the fit results of the channel in a batch slot
+  /// \return Fit results, or RawFitterError_t::FIT_ERROR if the amplitude is below the threshold
+  ChannelFitResult getResults(int slot) const;
+
+  std::array<float, NRATIOBINS + 1> mPeakShiftTable;                                   ///< peak time - time of max. sample vs. ratio
+  float mRatioMin = 0.;                                                                ///< ratio at the start of mPeakShiftTable
+  float mRatioBinsPerUnit = 0.;                                                        ///< number of bins of mPeakShiftTable per unit of ratio
+  std::array<float, int((SHAPEMAX - SHAPEMIN) * NSHAPEBINSPERSAMPLE) + 2> mShapeTable; ///< pulse shape vs. time after peak
+  std::array<float, int((SHAPEMAX - SHAPEMIN) * NSHAPEBINSPERSAMPLE) + 2> mDerivTable; ///< derivative of the pulse shape vs. time after peak
+
+  // batch storage, one entry per slot
+  std::array<std::array<float, BATCHSIZE>, NROWS> mSamples; //! samples aligned on the max. sample
+  std::array<std::array<float, BATCHSIZE>, NROWS> mWeights; //! 1 for samples in the peak region, 0 otherwise
+  std::array<float, BATCHSIZE> mPeakADC;                    //! max. pedestal subtracted ADC value
+  std::array<float, BATCHSIZE> mAmplitude;                  //! fitted amplitude
+  std::array<float, BATCHSIZE> mPeakShift;                  //! fitted peak time - time of max. sample
+  std::array<float, BATCHSIZE> mChi2;                       //! chi2 of the fit
+  std::array<float, BATCHSIZE> mPedestal;                   //! pedestal
+  std::array<short, BATCHSIZE> mMaxADC;                     //! max. raw ADC value
+  std::array<short, BATCHSIZE> mMaxTimeBin;                 //! time bin of the max. sample
+  std::array<short, BATCHSIZE> mNSamples;                   //! number of samples in the peak region
+  int mRowMin = CENTRALROW;                                 //! first row used in the batch
+  int mRowMax = CENTRALROW;                                 //! last row used in the batch
+
+  ClassDefNV(CaloRawFitterLUT, 1);
+}; // End of CaloRawFitterLUT
+
+} // namespace emcal
+
+} // namespace o2
+#endif
@@ -77,6 +77,23 @@ CaloRawFitter::CaloRawFitter(const char* name, const char* nameshort) : mMinTime
 {
 }
 
+void CaloRawFitter::evaluateBatch(const gsl::span<const gsl::span<const Bunch>> channels, std::vector<ChannelFitResult>& results)
+{
+  results.clear();
+  results.reserve(channels.size());
+  for (const auto& bunches : channels) {
+    if (bunches.empty()) {
+      results.emplace_back(RawFitterError_t::BUNCH_NOT_OK);
+      continue;
+    }
+    try {
+      results.emplace_back(evaluate(bunches));
+    } catch (RawFitterError_t& fiterror) {
+      results.emplace_back(fiterror);
+    }
+  }
+}
+
 void CaloRawFitter::setTimeConstraint(int min, int max)
 {
 
@@ -0,0 +1,253 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file CaloRawFitterLUT.cxx
+/// \brief Raw fitter using tabulated gamma-2 pulse shape
+
+#include <algorithm>
+#include <cmath>
+
+#include "EMCALReconstruction/Bunch.h"
+#include "EMCALReconstruction/CaloFitResults.h"
+#include "DataFormatsEMCAL/Constants.h"
+
+#include "EMCALReconstruction/CaloRawFitterLUT.h"
+
+using namespace o2::emcal;
+
+namespace
+{
+/// Linear interpolation in a table, x being the position in bins, clamped to the table range
+/// (the bin is clamped as an integer, which keeps the loops calling it free of branches)
+template <size_t N>
+inline float interpolate(const std::array<float, N>& table, float x)
+{
+  int ibin = std::min(std::max(static_cast<int>(x), 0), static_cast<int>(N) - 2);
+  float frac = std::min(std::max(x - ibin, 0.f), 1.f);
+  return table[ibin] + frac * (table[ibin + 1] - table[ibin]);
+}
+
+/// Position in bins of the shape table of the time dt after the peak
+inline float shapeBin(float dt)
+{
+  return (dt - static_cast<float>(CaloRawFitterLUT::SHAPEMIN)) * CaloRawFitterLUT::NSHAPEBINSPERSAMPLE;
+}
+} // namespace
+
+CaloRawFitterLUT::CaloRawFitterLUT() : CaloRawFitter("Lookup table ( Gamma2 )", "LUT")
+{
+  mAlgo = FitAlgorithm::LookupTable;
+
+  // the ratio increases monotonically with the peak shift: invert it by bisection
+  mRatioMin = peakRatio(-MAXPEAKSHIFT);
+  mRatioBinsPerUnit = NRATIOBINS / (peakRatio(MAXPEAKSHIFT) - mRatioMin);
+  for (int ibin = 0; ibin <= NRATIOBINS; ibin++) {
+    double ratio = mRatioMin + ibin / mRatioBinsPerUnit;
+    double low = -MAXPEAKSHIFT, high = MAXPEAKSHIFT;
+    for (int iter = 0; iter < 40; iter++) {
+      double mid = 0.5 * (low + high);
+      if (peakRatio(mid) < ratio) {
+        low = mid;
+      } else {
+        high = mid;
+      }
+    }
+    mPeakShiftTable[ibin] = 0.5 * (low + high);
+  }
+
+  for (size_t ibin = 0; ibin < mShapeTable.size(); ibin++) {
+    double dt = SHAPEMIN + static_cast<double>(ibin) / NSHAPEBINSPERSAMPLE;
+    mShapeTable[ibin] = pulseShape(dt);
+    mDerivTable[ibin] = pulseShapeDerivative(dt);
+  }
+}
+
+double CaloRawFitterLUT::pulseShape(double dt)
+{
+  double ti = dt / constants::TAU;
+  if (ti <= -1.) {
+    return 0.;
+  }
+  return (ti + 1.) * (ti + 1.) * std::exp(-2. * ti);
+}
+
+double CaloRawFitterLUT::pulseShapeDerivative(double dt)
+{
+  double ti = dt / constants::TAU;
+  if (ti <= -1.) {
+    return 0.;
+  }
+  return -2. * ti * (ti + 1.) * std::exp(-2. * ti) / constants::TAU;
+}
+
+double CaloRawFitterLUT::peakRatio(double shift)
+{
+  return (pulseShape(1. - shift) - pulseShape(-1. - shift)) / pulseShape(-shift);
+}
+
+CaloFitResults CaloRawFitterLUT::evaluate(const gsl::span<const Bunch> bunchlist)
+{
+  mRowMin = mRowMax = CENTRALROW;
+  loadChannel(bunchlist, 0);
+  fitBatch(1);
+  auto result = getResults(0);
+  if (auto fiterror = std::get_if<RawFitterError_t>(&result)) {
+    throw *fiterror;
+  }
+  return std::get<CaloFitResults>(result);
+}
+
+void CaloRawFitterLUT::evaluateBatch(const gsl::span<const gsl::span<const Bunch>> channels, std::vector<ChannelFitResult>& results)
+{
+  results.clear();
+  results.reserve(channels.size());
+  std::array<size_t, BATCHSIZE> slotChannel;
+  for (size_t firstChannel = 0; firstChannel < channels.size(); firstChannel += BATCHSIZE) {
+    size_t lastChannel = std::min(firstChannel + BATCHSIZE, channels.size());
+    mRowMin = mRowMax = CENTRALROW;
+    int nslots = 0;
+    for (size_t ichannel = firstChannel; ichannel < lastChannel; ichannel++) {
+      if (channels[ichannel].empty()) {
+        results.emplace_back(RawFitterError_t::BUNCH_NOT_OK);
+        continue;
+      }
+      try {
+        loadChannel(channels[ichannel], nslots);
+        slotChannel[nslots++] = ichannel;
+        results.emplace_back(RawFitterError_t::FIT_ERROR); // replaced by the fit results below
+      } catch (RawFitterError_t& fiterror) {
+        results.emplace_back(fiterror);
+      }
+    }
+    fitBatch(nslots);
+    for (int islot = 0; islot < nslots; islot++) {
+      results[slotChannel[islot]] = getResults(islot);
+    }
+  }
+}
+
+void CaloRawFitterLUT::loadChannel(const gsl::span<const Bunch> bunchlist, int slot)
+{
+  auto [nsamples, bunchIndex, ampEstimate,
+        maxADC, timeEstimate, pedEstimate, first, last] = preFitEvaluateSamples(bunchlist, mAmpCut);
+
+  if (ampEstimate < mAmpCut) {
+    throw RawFitterError_t::FIT_ERROR;
+  }
+
+  const auto& bunch = bunchlist[bunchIndex];
+  int timebinOffset = bunch.getStartTime() - (bunch.getBunchLength() - 1);
+  mPeakADC[slot] = ampEstimate;
+  mMaxADC[slot] = maxADC;
+  mMaxTimeBin[slot] = timeEstimate + timebinOffset;
+  mPedestal[slot] = pedEstimate;
+
+  // samples of the peak region, fitted only if the maximum is not at its edge and is below the overflow
+  bool doFit = nsamples > 2 && maxADC < constants::OVERFLOWCUT;
+  mNSamples[slot] = doFit ? nsamples : 0;
+  int firstRow = CENTRALROW, lastRow = CENTRALROW;
+  if (doFit) {
+    firstRow += first - timeEstimate;
+    lastRow += last - timeEstimate;
+    mRowMin = std::min(mRowMin, firstRow);
+    mRowMax = std::max(mRowMax, lastRow);
+  }
+  for (int row = 0; row < NROWS; row++) {
+    bool inPeak = doFit && row >= firstRow && row <= lastRow;
+    mSamples[row][slot] = inPeak ? getReversed(timeEstimate + row - CENTRALROW) : 0.f;
+    mWeights[row][slot] = inPeak ? 1.f : 0.f;
+  }
+}
+
+void CaloRawFitterLUT::fitBatch(int nchannels)
+{
+  // initial peak time from the samples around the maximum
+  const auto& before = mSamples[CENTRALROW - 1];
+  const auto& peak = mSamples[CENTRALROW];
+  const auto& after = mSamples[CENTRALROW + 1];
+  const float ratioMin = mRatioMin, ratioBinsPerUnit = mRatioBinsPerUnit;
+  for (int ich = 0; ich < nchannels; ich++) {
+    float ratio = (after[ich] - before[ich]) / std::max(peak[ich], 1.e-3f); // slots not fitted have no peak
+    mPeakShift[ich] = interpolate(mPeakShiftTable, (ratio - ratioMin) * ratioBinsPerUnit);
+  }
+
+  // sums over the samples of the pulse shape g, its derivative d and the ADC values y
+  std::array<float, BATCHSIZE> sgg{}, sgd{}, sdd{}, sgy{}, sdy{};
+  for (int row = mRowMin; row <= mRowMax; row++) {
+    const auto& samples = mSamples[row];
+    const auto& weights = mWeights[row];
+    for (int ich = 0; ich < nchannels; ich++) {
+      float x = shapeBin(row - CENTRALROW - mPeakShift[ich]);
+      float g = weights[ich] * interpolate(mShapeTable, x);
+      float d = weights[ich] * interpolate(mDerivTable, x);
+      sgg[ich] += g * g;
+      sgd[ich] += g * d;
+      sdd[ich] += d * d;
+      sgy[ich] += g * samples[ich];
+      sdy[ich] += d * samples[ich];
+    }
+  }
+
+  // least square amplitude for the initial peak time, then one Gauss-Newton step
+  // for the model amp * g(t - peak time), whose derivative in the peak time is -amp * d
+  // (the divisions are done unconditionally with safe denominators so that the loop has no branch)
+  constexpr float maxShift = MAXPEAKSHIFT;
+  for (int ich = 0; ich < nchannels; ich++) {
+    float norm = std::max(sgg[ich], 1.e-6f);
+    float amp = sgy[ich] / norm;
+    float sdr = sdy[ich] - amp * sgd[ich]; // sum of d * residual, the one of g * residual being 0
+    float det = sgg[ich] * sdd[ich] - sgd[ich] * sgd[ich];
+    bool valid = (amp > 0.f) & (det > 1.e-6f * sgg[ich] * sdd[ich]);
+    float dt = -sdr * norm / std::max(amp * det, 1.e-20f);
+    dt = valid ? std::min(std::max(dt, -maxShift), maxShift) : 0.f;
+    mAmplitude[ich] = amp + amp * sgd[ich] / norm * dt;
+    mPeakShift[ich] += dt;
+  }
+
+  // chi2 with the refined parameters
+  std::array<float, BATCHSIZE> chi2{};
+  for (int row = mRowMin; row <= mRowMax; row++) {
+    const auto& samples = mSamples[row];
+    const auto& weights = mWeights[row];
+    for (int ich = 0; ich < nchannels; ich++) {
+      float x = shapeBin(row - CENTRALROW - mPeakShift[ich]);
+      float residual = samples[ich] - weights[ich] * mAmplitude[ich] * interpolate(mShapeTable, x);
+      chi2[ich] += residual * residual;
+    }
+  }
+  std::copy(chi2.begin(), chi2.begin() + nchannels, mChi2.begin());
+}
+
+CaloRawFitter::ChannelFitResult CaloRawFitterLUT::getResults(int slot) const
+{
+  float amp = mPeakADC[slot];
+  float time = mMaxTimeBin[slot];
+  float chi2 = 0.;
+  int ndf = 0;
+
+  if (mNSamples[slot] > 0) {
+    // same sanity check of the fit results as in CaloRawFitterGamma2
+    float ampAsymm = (mAmplitude[slot] - amp) / (mAmplitude[slot] + amp);
+    if (std::abs(ampAsymm) <= 0.1) {
+      amp = mAmplitude[slot];
+      time += mPeakShift[slot];
+    }
+    chi2 = mChi2[slot];
+    ndf = mNSamples[slot] - 2;
+  }
+
+  if (amp < mAmpCut) {
+    return RawFitterError_t::FIT_ERROR;
+  }
+  time = time * constants::EMCAL_TIMESAMPLE;
+  time -= mL1Phase;
+  return CaloFitResults(mMaxADC[slot], mPedestal[slot], mAlgo, amp, time, (int)time, chi2, ndf);
+}
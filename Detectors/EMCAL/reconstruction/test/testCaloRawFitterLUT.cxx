@@ -0,0 +1,198 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#define BOOST_TEST_MODULE Test EMCAL Reconstruction
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <variant>
+#include <vector>
+#include <gsl/span>
+#include "DataFormatsEMCAL/Constants.h"
+#include "EMCALReconstruction/Bunch.h"
+#include "EMCALReconstruction/CaloFitResults.h"
+#include "EMCALReconstruction/CaloRawFitterGamma2.h"
+#include "EMCALReconstruction/CaloRawFitterLUT.h"
+
+using namespace o2::emcal;
+
+namespace
+{
+struct Pulse {
+  double amplitude; ///< true amplitude (ADC counts)
+  double time;      ///< true peak time (samples)
+};
+
+/// Single bunch of 15 samples following the gamma-2 shape, with Gaussian noise
+std::vector<Bunch> makeChannel(const Pulse& pulse, double noise, std::mt19937& generator)
+{
+  const int nSamples = 15;
+  std::normal_distribution<double> gaus(0., noise);
+  std::vector<Bunch> bunches;
+  auto& bunch = bunches.emplace_back(nSamples, nSamples - 1);
+  // ADC values are stored in reversed time order
+  for (int isample = nSamples - 1; isample >= 0; isample--) {
+    double adc = pulse.amplitude * CaloRawFitterLUT::pulseShape(isample - pulse.time) + (noise > 0 ? gaus(generator) : 0.);
+    bunch.addADC(std::clamp(static_cast<int>(std::lround(adc)), 0, 1023));
+  }
+  return bunches;
+}
+
+std::vector<Pulse> makePulses()
+{
+  std::vector<Pulse> pulses;
+  for (double amplitude : {20., 50., 100., 300., 600., 900.}) {
+    for (double time = 4.; time <= 9.; time += 0.25) {
+      pulses.push_back({amplitude, time});
+    }
+  }
+  return pulses;
+}
+
+void configure(CaloRawFitter& fitter)
+{
+  fitter.setAmpCut(3);
+  fitter.setL1Phase(0.);
+  fitter.setIsZeroSuppressed(true);
+}
+
+std::vector<CaloRawFitter::ChannelFitResult> fitSingle(CaloRawFitter& fitter, const std::vector<std::vector<Bunch>>& channels)
+{
+  std::vector<CaloRawFitter::ChannelFitResult> results;
+  for (const auto& channel : channels) {
+    try {
+      results.emplace_back(fitter.evaluate(channel));
+    } catch (CaloRawFitter::RawFitterError_t& fiterror) {
+      results.emplace_back(fiterror);
+    }
+  }
+  return results;
+}
+} // namespace
+
+/// \brief Lookup table fitter on pulses of known amplitude and time without noise
+BOOST_AUTO_TEST_CASE(CaloRawFitterLUT_truth)
+{
+  std::mt19937 generator(1);
+  CaloRawFitterLUT fitter;
+  configure(fitter);
+  for (const auto& pulse : makePulses()) {
+    BOOST_TEST_CONTEXT("amplitude " << pulse.amplitude << ", time " << pulse.time)
+    {
+      auto fit = fitter.evaluate(makeChannel(pulse, 0., generator));
+      // the samples are rounded to integer ADC counts
+      BOOST_CHECK_SMALL(fit.getAmp() - pulse.amplitude, 0.01 * pulse.amplitude + 1.);
+      BOOST_CHECK_SMALL(fit.getTime() - pulse.time * constants::EMCAL_TIMESAMPLE, 2. + 100. / pulse.amplitude);
+    }
+  }
+}
+
+/// \brief Lookup table fitter against the reference gamma2 fitter, with noise
+BOOST_AUTO_TEST_CASE(CaloRawFitterLUT_gamma2)
+{
+  std::mt19937 generator(12345);
+  std::vector<std::vector<Bunch>> channels;
+  std::vector<Pulse> pulses;
+  for (int iteration = 0; iteration < 10; iteration++) {
+    for (const auto& pulse : makePulses()) {
+      channels.emplace_back(makeChannel(pulse, 1., generator));
+      pulses.push_back(pulse);
+    }
+  }
+  CaloRawFitterGamma2 reference;
+  CaloRawFitterLUT fitter;
+  configure(reference);
+  configure(fitter);
+  auto resultsReference = fitSingle(reference, channels);
+  auto results = fitSingle(fitter, channels);
+
+  // per amplitude: sum of the differences between the fitters, and of the squared residuals of each fitter
+  struct Sums {
+    int n = 0;
+    double ampDiff = 0., timeDiff = 0.;
+    double ampRes2 = 0., ampRes2Reference = 0., timeRes2 = 0., timeRes2Reference = 0.;
+  };
+  std::map<double, Sums> sums;
+  for (size_t ich = 0; ich < channels.size(); ich++) {
+    const auto& pulse = pulses[ich];
+    BOOST_TEST_CONTEXT("amplitude " << pulse.amplitude << ", time " << pulse.time)
+    {
+      auto fitReference = std::get_if<CaloFitResults>(&resultsReference[ich]);
+      auto fit = std::get_if<CaloFitResults>(&results[ich]);
+      BOOST_REQUIRE(fitReference != nullptr);
+      BOOST_REQUIRE(fit != nullptr);
+      double ampDiff = (fit->getAmp() - fitReference->getAmp()) / pulse.amplitude;
+      double timeDiff = fit->getTime() - fitReference->getTime();
+      // the gamma2 fit has a worse time resolution at low amplitude
+      BOOST_CHECK_SMALL(ampDiff, 0.02 + 5. / pulse.amplitude);
+      BOOST_CHECK_SMALL(timeDiff, 2. + 6000. / pulse.amplitude);
+      auto& sum = sums[pulse.amplitude];
+      double trueTime = pulse.time * constants::EMCAL_TIMESAMPLE;
+      sum.n++;
+      sum.ampDiff += ampDiff;
+      sum.timeDiff += timeDiff;
+      sum.ampRes2 += std::pow((fit->getAmp() - pulse.amplitude) / pulse.amplitude, 2);
+      sum.ampRes2Reference += std::pow((fitReference->getAmp() - pulse.amplitude) / pulse.amplitude, 2);
+      sum.timeRes2 += std::pow(fit->getTime() - trueTime, 2);
+      sum.timeRes2Reference += std::pow(fitReference->getTime() - trueTime, 2);
+    }
+  }
+  for (const auto& [amplitude, sum] : sums) {
+    BOOST_TEST_CONTEXT("amplitude " << amplitude)
+    {
+      // no bias between the two fitters
+      BOOST_CHECK_SMALL(sum.ampDiff / sum.n, 0.01);
+      BOOST_CHECK_SMALL(sum.timeDiff / sum.n, 5.);
+      // the lookup table fitter resolves the known pulses at least as well as the reference
+      BOOST_CHECK_LE(std::sqrt(sum.ampRes2 / sum.n), 1.1 * std::sqrt(sum.ampRes2Reference / sum.n));
+      BOOST_CHECK_LE(std::sqrt(sum.timeRes2 / sum.n), 1.1 * std::sqrt(sum.timeRes2Reference / sum.n));
+    }
+  }
+}
+
+/// \brief Batch fit of the lookup table fitter gives the results of the single channel fit
+BOOST_AUTO_TEST_CASE(CaloRawFitterLUT_batch)
+{
+  std::mt19937 generator(42);
+  std::vector<std::vector<Bunch>> channels;
+  for (int iteration = 0; iteration < 3; iteration++) {
+    for (const auto& pulse : makePulses()) {
+      channels.emplace_back(makeChannel(pulse, 1., generator));
+    }
+    // channels which cannot be fitted: no bunch and below the amplitude cut
+    channels.emplace_back();
+    channels.emplace_back(makeChannel({1., 6.}, 0., generator));
+  }
+  CaloRawFitterLUT fitter;
+  configure(fitter);
+  auto results = fitSingle(fitter, channels);
+  std::vector<gsl::span<const Bunch>> spans(channels.begin(), channels.end());
+  std::vector<CaloRawFitter::ChannelFitResult> resultsBatch;
+  fitter.evaluateBatch(spans, resultsBatch);
+  BOOST_REQUIRE_EQUAL(resultsBatch.size(), results.size());
+  for (size_t ich = 0; ich < channels.size(); ich++) {
+    BOOST_TEST_CONTEXT("channel " << ich)
+    {
+      BOOST_REQUIRE_EQUAL(resultsBatch[ich].index(), results[ich].index());
+      if (auto error = std::get_if<CaloRawFitter::RawFitterError_t>(&results[ich])) {
+        BOOST_CHECK(std::get<CaloRawFitter::RawFitterError_t>(resultsBatch[ich]) == *error);
+        continue;
+      }
+      auto& fit = std::get<CaloFitResults>(results[ich]);
+      auto& fitBatch = std::get<CaloFitResults>(resultsBatch[ich]);
+      BOOST_CHECK_CLOSE(fitBatch.getAmp(), fit.getAmp(), 1.e-2);
+      BOOST_CHECK_SMALL(fitBatch.getTime() - fit.getTime(), 1.e-3);
+    }
+  }
+}
@@ -11,6 +11,7 @@
 
 #include <chrono>
 #include <vector>
+#include <gsl/span>
 
 #include "Framework/DataProcessorSpec.h"
 #include "Framework/Task.h"
@@ -126,6 +127,8 @@ class RawToCellConverterSpec : public framework::Task
   Geometry* mGeometry = nullptr;                                     ///!<! Geometry pointer
   std::unique_ptr<MappingHandler> mMapper = nullptr;                 ///!<! Mapper
   std::unique_ptr<CaloRawFitter> mRawFitter;                         ///!<! Raw fitter
+  std::vector<gsl::span<const Bunch>> mChannelBunches;               ///< Bunches of the channels of the current DDL
+  std::vector<CaloRawFitter::ChannelFitResult> mChannelFitResults;   ///< Raw fit results of the channels of the current DDL
   std::vector<Cell> mOutputCells;                                    ///< Container with output cells
   std::vector<TriggerRecord> mOutputTriggerRecords;                  ///< Container with output cells
   std::vector<ErrorTypeFEE> mOutputDecoderErrors;                    ///< Container with decoder errors
@@ -20,6 +20,7 @@
 #include "SimulationDataFormat/MCTruthContainer.h"
 #include "EMCALReconstruction/CaloRawFitterStandard.h"
 #include "EMCALReconstruction/CaloRawFitterGamma2.h"
+#include "EMCALReconstruction/CaloRawFitterLUT.h"
 
 using namespace o2::emcal::reco_workflow;
 
@@ -41,6 +42,9 @@ void CellConverterSpec::init(framework::InitContext& ctx)
   } else if (fitmethod == "gamma2") {
     LOG(info) << "Using gamma2 raw fitter";
     mRawFitter = std::unique_ptr<o2::emcal::CaloRawFitter>(new o2::emcal::CaloRawFitterGamma2);
+  } else if (fitmethod == "lut") {
+    LOG(info) << "Using lookup table raw fitter";
+    mRawFitter = std::unique_ptr<o2::emcal::CaloRawFitter>(new o2::emcal::CaloRawFitterLUT);
   }
   mRawFitter->setAmpCut(0.);
   mRawFitter->setL1Phase(0.);
@@ -251,5 +255,5 @@ o2::framework::DataProcessorSpec o2::emcal::reco_workflow::getCellConverterSpec(
                                           outputs,
                                           o2::framework::adaptFromTask<o2::emcal::reco_workflow::CellConverterSpec>(propagateMC),
                                           o2::framework::Options{
-                                            {"fitmethod", o2::framework::VariantType::String, "gamma2", {"Fit method (standard or gamma2)"}}}};
+                                            {"fitmethod", o2::framework::VariantType::String, "gamma2", {"Fit method (standard, gamma2 or lut)"}}}};
 }
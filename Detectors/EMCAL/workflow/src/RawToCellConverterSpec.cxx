@@ -31,6 +31,7 @@
 #include "EMCALReconstruction/Bunch.h"
 #include "EMCALReconstruction/CaloRawFitterStandard.h"
 #include "EMCALReconstruction/CaloRawFitterGamma2.h"
+#include "EMCALReconstruction/CaloRawFitterLUT.h"
 #include "EMCALReconstruction/AltroDecoder.h"
 #include "EMCALReconstruction/RawDecodingError.h"
 #include "EMCALWorkflow/RawToCellConverterSpec.h"
@@ -74,6 +75,9 @@ void RawToCellConverterSpec::init(framework::InitContext& ctx)
   } else if (fitmethod == "gamma2") {
     LOG(info) << "Using gamma2 raw fitter";
     mRawFitter = std::unique_ptr<CaloRawFitter>(new o2::emcal::CaloRawFitterGamma2);
+  } else if (fitmethod == "lut") {
+    LOG(info) << "Using lookup table raw fitter";
+    mRawFitter = std::unique_ptr<CaloRawFitter>(new o2::emcal::CaloRawFitterLUT);
   } else {
     LOG(fatal) << "Unknown fit method" << fitmethod;
   }
@@ -264,9 +268,26 @@ void RawToCellConverterSpec::run(framework::ProcessingContext& ctx)
       const auto& map = mMapper->getMappingForDDL(feeID);
       int iSM = feeID / 2;
 
+      // Fit all the high and low gain channels of the DDL at once, other
+      // channels are left without bunches and are skipped by the raw fitter
+      const auto& channels = decoder.getChannels();
+      mChannelBunches.assign(channels.size(), {});
+      for (size_t ichan = 0; ichan < channels.size(); ichan++) {
+        try {
+          auto chantype = map.getChannelType(channels[ichan].getHardwareAddress());
+          if (chantype == o2::emcal::ChannelType_t::HIGH_GAIN || chantype == o2::emcal::ChannelType_t::LOW_GAIN) {
+            mChannelBunches[ichan] = channels[ichan].getBunches();
+          }
+        } catch (Mapper::AddressNotFoundException&) {
+          // reported in the loop over the channels
+        }
+      }
+      mRawFitter->evaluateBatch(mChannelBunches, mChannelFitResults);
+
       // Loop over all the channels
       int nBunchesNotOK = 0;
-      for (auto& chan : decoder.getChannels()) {
+      for (size_t ichan = 0; ichan < channels.size(); ichan++) {
+        const auto& chan = channels[ichan];
 
         int iRow, iCol;
         ChannelType_t chantype;
@@ -353,7 +374,10 @@ void RawToCellConverterSpec::run(framework::ProcessingContext& ctx)
         // define the conatiner for the fit results, and perform the raw fitting using the stadnard raw fitter
         CaloFitResults fitResults;
         try {
-          fitResults = mRawFitter->evaluate(chan.getBunches());
+          if (auto fiterror = std::get_if<CaloRawFitter::RawFitterError_t>(&mChannelFitResults[ichan])) {
+            throw *fiterror;
+          }
+          fitResults = std::get<CaloFitResults>(mChannelFitResults[ichan]);
           // Prevent negative entries - we should no longer get here as the raw fit usually will end in an error state
           if (fitResults.getAmp() < 0) {
             fitResults.setAmp(0.);
@@ -558,7 +582,7 @@ o2::framework::DataProcessorSpec o2::emcal::reco_workflow::getRawToCellConverter
                                           outputs,
                                           o2::framework::adaptFromTask<o2::emcal::reco_workflow::RawToCellConverterSpec>(subspecification),
                                           o2::framework::Options{
-                                            {"fitmethod", o2::framework::VariantType::String, "gamma2", {"Fit method (standard or gamma2)"}},
+                                            {"fitmethod", o2::framework::VariantType::String, "gamma2", {"Fit method (standard, gamma2 or lut)"}},
                                             {"maxmessage", o2::framework::VariantType::Int, 100, {"Max. amout of error messages to be displayed"}},
                                             {"printtrailer", o2::framework::VariantType::Bool, false, {"Print RCU trailer (for debugging)"}},
                                             {"no-mergeHGLG", o2::framework::VariantType::Bool, false, {"Do not merge HG and LG channels for same tower"}},
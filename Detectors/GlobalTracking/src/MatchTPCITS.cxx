@@ -202,6 +202,8 @@ void MatchTPCITS::init()
   // debug streamer
   if (mDBGFlags) {
     mDBGOut = std::make_unique<o2::utils::TreeStreamRedirector>(mDebugTreeFileName.data(), "recreate");
+    // keep the tree filling and compression off the matching thread
+    mDBGOut->setBatching(1024);
   }
 #endif
 
@@ -0,0 +1,25 @@
+#!/bin/bash
+# Standalone benchmark of the ITS raw data decoding (GBT demultiplexing + ALPIDE decoding w/o clusterization)
+# on the raw data produced by o2-its-digi2raw. The digits are produced if missing.
+# Usage: run_rawdecoding_benchmark.sh [nEvents] [nLoops] [nThreads]
+
+nEvents=${1:-10}
+nLoops=${2:-10}
+nThreads=${3:-1}
+rawDir=raw/ITS
+
+if [[ ! -f itsdigits.root ]]; then
+  o2-sim -n $nEvents -e TGeant3 -g pythia8pp -m PIPE ITS >& sim.log
+  o2-sim-digitizer-workflow -b --onlyDet ITS >& digi.log
+fi
+
+if [[ ! -f $rawDir/ITSraw.cfg ]]; then
+  mkdir -p $rawDir
+  o2-its-digi2raw --file-for link -o $rawDir >& digi2raw.log
+fi
+
+# the raw files are read in loop, the decoding timing (w/o disk IO) is reported by the decoder at the end of the run
+o2-raw-file-reader-workflow -b --input-conf $rawDir/ITSraw.cfg --loop $nLoops | \
+o2-itsmft-stf-decoder-workflow -b --no-clusters --nthreads $nThreads >& rawdecoding.log
+
+grep "Total STF decoding" rawdecoding.log
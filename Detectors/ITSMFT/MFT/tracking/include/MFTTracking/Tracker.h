@@ -16,6 +16,8 @@
 #ifndef O2_MFT_TRACKER_H_
 #define O2_MFT_TRACKER_H_
 
+#include <memory>
+
 #include "MFTTracking/ROframe.h"
 #include "MFTTracking/TrackFitter.h"
 #include "MFTTracking/Cluster.h"
@@ -61,6 +63,7 @@ class Tracker : public TrackerConfig
   std::uint32_t getROFrame() const { return mROFrame; }
 
   void initialize(bool fullClusterScan = false);
+  void initialize(const Tracker<T>& tracker);
   void initConfig(const MFTTrackingParam& trkParam, bool printConfig = false);
 
  private:
@@ -96,8 +99,10 @@ class Tracker : public TrackerConfig
 
   bool mUseMC = false;
 
-  std::array<std::array<std::array<std::vector<Int_t>, constants::index_table::MaxRPhiBins>, (constants::mft::LayersNumber - 1)>, (constants::mft::LayersNumber - 1)> mBinsS;
-  std::array<std::array<std::array<std::vector<Int_t>, constants::index_table::MaxRPhiBins>, (constants::mft::LayersNumber - 1)>, (constants::mft::LayersNumber - 1)> mBins;
+  using BinsTable = std::array<std::array<std::array<std::vector<Int_t>, constants::index_table::MaxRPhiBins>, (constants::mft::LayersNumber - 1)>, (constants::mft::LayersNumber - 1)>;
+  /// look-up tables of the R-Phi bins projections, read-only once initialized and shared by the trackers of all threads
+  std::shared_ptr<BinsTable> mBinsS;
+  std::shared_ptr<BinsTable> mBins;
 
   /// helper to store points of a track candidate
   struct TrackElement {
@@ -109,6 +109,9 @@ void Tracker<T>::initialize(bool fullClusterScan)
   /// calculate Look-Up-Table of the R-Phi bins projection from one layer to another
   /// layer1 + global R-Phi bin index ---> layer2 + R bin index + Phi bin index
 
+  mBinsS = std::make_shared<BinsTable>();
+  mBins = std::make_shared<BinsTable>();
+
   Float_t dz, x, y, r, phi, x_proj, y_proj, r_proj, phi_proj;
   Int_t binIndex1, binIndex2, binIndex2S, binR_proj, binPhi_proj;
 
@@ -161,7 +164,7 @@ void Tracker<T>::initialize(bool fullClusterScan)
               }
 
               binIndex2S = getBinIndex(binRS, binPhiS);
-              mBinsS[layer1][layer2 - 1][binIndex1].emplace_back(binIndex2S);
+              (*mBinsS)[layer1][layer2 - 1][binIndex1].emplace_back(binIndex2S);
             }
           }
 
@@ -186,7 +189,7 @@ void Tracker<T>::initialize(bool fullClusterScan)
               }
 
               binIndex2 = getBinIndex(binR, binPhi);
-              mBins[layer1][layer2 - 1][binIndex1].emplace_back(binIndex2);
+              (*mBins)[layer1][layer2 - 1][binIndex1].emplace_back(binIndex2);
             }
           }
 
@@ -196,6 +199,18 @@ void Tracker<T>::initialize(bool fullClusterScan)
   }       // end loop layer1
 }
 
+//_________________________________________________________________________________________________
+template <typename T>
+void Tracker<T>::initialize(const Tracker<T>& tracker)
+{
+  /// initialize by sharing the look-up tables of an already initialized tracker with the same
+  /// configuration, so that several trackers can process different ROFs concurrently
+  mRoad.initialize();
+  mFullClusterScan = tracker.mFullClusterScan;
+  mBinsS = tracker.mBinsS;
+  mBins = tracker.mBins;
+}
+
 //_________________________________________________________________________________________________
 template <typename T>
 void Tracker<T>::clustersToTracks(ROframe<T>& event, std::ostream& timeBenchmarkOutputStream)
@@ -264,7 +279,7 @@ void Tracker<T>::findTracksLTF(ROframe<T>& event)
       clsInLayer1 = it1 - event.getClustersInLayer(layer1).begin();
 
       // loop over the bins in the search window
-      for (auto& binS : mBinsS[layer1][layer2 - 1][cluster1.indexTableBin]) {
+      for (auto& binS : (*mBinsS)[layer1][layer2 - 1][cluster1.indexTableBin]) {
 
         getBinClusterRange(event, layer2, binS, clsMinIndexS, clsMaxIndexS);
 
@@ -294,7 +309,7 @@ void Tracker<T>::findTracksLTF(ROframe<T>& event)
 
             // loop over the bins in the search window
             dR2min = mLTFConeRadius ? dR2cut * dRCone * dRCone : dR2cut;
-            for (auto& bin : mBins[layer1][layer - 1][cluster1.indexTableBin]) {
+            for (auto& bin : (*mBins)[layer1][layer - 1][cluster1.indexTableBin]) {
 
               getBinClusterRange(event, layer, bin, clsMinIndex, clsMaxIndex);
 
@@ -543,7 +558,7 @@ void Tracker<T>::findTracksCA(ROframe<T>& event)
         clsInLayer1 = it1 - event.getClustersInLayer(layer1).begin();
 
         // loop over the bins in the search window
-        for (auto& binS : mBinsS[layer1][layer2 - 1][cluster1.indexTableBin]) {
+        for (auto& binS : (*mBinsS)[layer1][layer2 - 1][cluster1.indexTableBin]) {
 
           getBinClusterRange(event, layer2, binS, clsMinIndexS, clsMaxIndexS);
 
@@ -569,7 +584,7 @@ void Tracker<T>::findTracksCA(ROframe<T>& event)
               dR2min = mLTFConeRadius ? dR2cut * dRCone * dRCone : dR2cut;
 
               // loop over the bins in the search window
-              for (auto& bin : mBins[layer1][layer - 1][cluster1.indexTableBin]) {
+              for (auto& bin : (*mBins)[layer1][layer - 1][cluster1.indexTableBin]) {
 
                 getBinClusterRange(event, layer, bin, clsMinIndex, clsMaxIndex);
 
@@ -21,8 +21,15 @@
 #include "Framework/Task.h"
 #include "DataFormatsParameters/GRPObject.h"
 #include "DataFormatsITSMFT/TopologyDictionary.h"
+#include "DataFormatsITSMFT/CompCluster.h"
+#include "DataFormatsITSMFT/ROFRecord.h"
+#include "MemoryResources/MemoryResources.h"
 #include "TStopwatch.h"
 
+#include <memory>
+#include <vector>
+#include <gsl/span>
+
 namespace o2
 {
 namespace mft
@@ -40,12 +47,26 @@ class TrackerDPL : public o2::framework::Task
   void endOfStream(framework::EndOfStreamContext& ec) final;
 
  private:
+  template <typename T>
+  void createTrackers(std::vector<std::unique_ptr<o2::mft::Tracker<T>>>& trackers, float bz);
+  template <typename T>
+  void runTracking(std::vector<std::unique_ptr<o2::mft::Tracker<T>>>& trackers, o2::pmr::vector<o2::itsmft::ROFRecord>& rofs,
+                   gsl::span<const o2::itsmft::CompClusterExt> compClusters, gsl::span<const unsigned char> patterns,
+                   const o2::dataformats::MCTruthContainer<o2::MCCompLabel>* labels, o2::pmr::vector<o2::mft::TrackMFT>& allTracksMFT,
+                   o2::pmr::vector<int>& allClusIdx, std::vector<o2::MCCompLabel>& allTrackLabels);
+
+  static constexpr int ROFsPerThreadInBatch = 4; ///< number of ROFs loaded per thread before tracking them concurrently
+
   bool mUseMC = false;
   bool mFieldOn = true;
+  int mNThreads = 1;
   o2::itsmft::TopologyDictionary mDict;
   std::unique_ptr<o2::parameters::GRPObject> mGRP = nullptr;
-  std::unique_ptr<o2::mft::Tracker<TrackLTF>> mTracker = nullptr;
-  std::unique_ptr<o2::mft::Tracker<TrackLTFL>> mTrackerL = nullptr;
+  std::vector<std::unique_ptr<o2::mft::Tracker<TrackLTF>>> mTrackers;   ///< one tracker per thread, sharing the look-up tables
+  std::vector<std::unique_ptr<o2::mft::Tracker<TrackLTFL>>> mTrackersL; ///< one linear tracker per thread
+  size_t mNROFsTracked = 0;                                             ///< number of ROFs with clusters tracked
+  double mROFTimeTotal = 0.;                                            ///< sum of the tracking times of the ROFs (ms)
+  double mROFTimeMax = 0.;                                              ///< longest tracking time of a ROF (ms)
   TStopwatch mTimer;
 };
 
@@ -19,6 +19,8 @@
 #include "MFTTracking/TrackCA.h"
 #include "MFTBase/GeometryTGeo.h"
 
+#include <algorithm>
+#include <chrono>
 #include <vector>
 
 #include "TGeoGlobalMagField.h"
@@ -36,6 +38,10 @@
 #include "DetectorsCommonDataFormats/DetectorNameConf.h"
 #include "ITSMFTReconstruction/ClustererParam.h"
 
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
 using namespace o2::framework;
 
 namespace o2
@@ -47,6 +53,13 @@ void TrackerDPL::init(InitContext& ic)
 {
   mTimer.Stop();
   mTimer.Reset();
+  mNThreads = std::max(1, ic.options().get<int>("nthreads"));
+#ifndef WITH_OPENMP
+  if (mNThreads > 1) {
+    LOG(warning) << "MFT tracker was compiled without OpenMP, using 1 thread instead of " << mNThreads;
+    mNThreads = 1;
+  }
+#endif
   auto filename = ic.options().get<std::string>("grp-file");
   const auto grp = o2::parameters::GRPObject::loadFrom(filename.c_str());
   if (grp) {
@@ -64,23 +77,18 @@ void TrackerDPL::init(InitContext& ic)
 
     // tracking configuration parameters
     auto& trackingParam = MFTTrackingParam::Instance();
-    // create the tracker: set the B-field, the configuration and initialize
+    // create the trackers: set the B-field, the configuration and initialize
 
     double centerMFT[3] = {0, 0, -61.4}; // Field at center of MFT
     auto Bz = field->getBz(centerMFT);
     if (Bz == 0 || trackingParam.forceZeroField) {
       LOG(info) << "Starting MFT Linear tracker: Field is off!";
       mFieldOn = false;
-      mTrackerL = std::make_unique<o2::mft::Tracker<TrackLTFL>>(mUseMC);
-      mTrackerL->initConfig(trackingParam, true);
-      mTrackerL->initialize(trackingParam.FullClusterScan);
+      createTrackers(mTrackersL, Bz);
     } else {
       LOG(info) << "Starting MFT tracker: Field is on!";
       mFieldOn = true;
-      mTracker = std::make_unique<o2::mft::Tracker<TrackLTF>>(mUseMC);
-      mTracker->setBz(Bz);
-      mTracker->initConfig(trackingParam, true);
-      mTracker->initialize(trackingParam.FullClusterScan);
+      createTrackers(mTrackers, Bz);
     }
   } else {
     throw std::runtime_error(o2::utils::Str::concat_string("Cannot retrieve GRP from the ", filename));
@@ -101,7 +109,6 @@ void TrackerDPL::run(ProcessingContext& pc)
   mTimer.Start(false);
   gsl::span<const unsigned char> patterns = pc.inputs().get<gsl::span<unsigned char>>("patterns");
   auto compClusters = pc.inputs().get<const std::vector<o2::itsmft::CompClusterExt>>("compClusters");
-  auto ntracks = 0;
 
   // code further down does assignment to the rofs and the altered object is used for output
   // we therefore need a copy of the vector rather than an object created directly on the input data,
@@ -123,122 +130,160 @@ void TrackerDPL::run(ProcessingContext& pc)
   }
 
   auto& allClusIdx = pc.outputs().make<std::vector<int>>(Output{"MFT", "TRACKCLSID", 0, Lifetime::Timeframe});
-  std::vector<o2::MCCompLabel> trackLabels;
   std::vector<o2::MCCompLabel> allTrackLabels;
-  std::vector<o2::mft::TrackLTF> tracks;
-  std::vector<o2::mft::TrackLTFL> tracksL;
   auto& allTracksMFT = pc.outputs().make<std::vector<o2::mft::TrackMFT>>(Output{"MFT", "TRACKS", 0, Lifetime::Timeframe});
 
-  std::uint32_t roFrame = 0;
-
   if (mFieldOn) {
-    o2::mft::ROframe<TrackLTF> event(0);
+    runTracking(mTrackers, rofs, compClusters, patterns, labels, allTracksMFT, allClusIdx, allTrackLabels);
+  } else { // Use Linear Tracker for Field off
+    runTracking(mTrackersL, rofs, compClusters, patterns, labels, allTracksMFT, allClusIdx, allTrackLabels);
+  }
+  LOG(info) << "MFTTracker pushed " << allTracksMFT.size() << " tracks";
 
-    // tracking configuration parameters
-    auto& trackingParam = MFTTrackingParam::Instance();
+  if (mUseMC) {
+    pc.outputs().snapshot(Output{"MFT", "TRACKSMCTR", 0, Lifetime::Timeframe}, allTrackLabels);
+    pc.outputs().snapshot(Output{"MFT", "TRACKSMC2ROF", 0, Lifetime::Timeframe}, mc2rofs);
+  }
+  mTimer.Stop();
+}
 
-    // snippet to convert found tracks to final output tracks with separate cluster indices
-    auto copyTracks = [&event](auto& tracks, auto& allTracks, auto& allClusIdx) {
-      for (auto& trc : tracks) {
-        trc.setExternalClusterIndexOffset(allClusIdx.size());
-        int ncl = trc.getNumberOfPoints();
-        for (int ic = 0; ic < ncl; ic++) {
-          auto externalClusterID = trc.getExternalClusterIndex(ic);
-          allClusIdx.push_back(externalClusterID);
-        }
-        allTracks.emplace_back(trc);
-      }
-    };
+///_______________________________________
+template <typename T>
+void TrackerDPL::createTrackers(std::vector<std::unique_ptr<o2::mft::Tracker<T>>>& trackers, float bz)
+{
+  // one tracker per thread: the first one computes the look-up tables, the others share them
+  auto& trackingParam = MFTTrackingParam::Instance();
+  trackers.clear();
+  for (int ith = 0; ith < mNThreads; ith++) {
+    auto& tracker = trackers.emplace_back(std::make_unique<o2::mft::Tracker<T>>(mUseMC));
+    if (mFieldOn) {
+      tracker->setBz(bz);
+    }
+    tracker->initConfig(trackingParam, ith == 0);
+    if (ith == 0) {
+      tracker->initialize(trackingParam.FullClusterScan);
+    } else {
+      tracker->initialize(*trackers.front());
+    }
+  }
+  LOG(info) << "MFT tracking ROFs with " << mNThreads << " thread(s)";
+}
 
-    gsl::span<const unsigned char>::iterator pattIt = patterns.begin();
-    for (auto& rof : rofs) {
-      int nclUsed = ioutils::loadROFrameData(rof, event, compClusters, pattIt, mDict, labels, mTracker.get());
-      if (nclUsed) {
-        event.setROFrameId(roFrame);
-        event.initialize(trackingParam.FullClusterScan);
-        LOG(debug) << "ROframe: " << roFrame << ", clusters loaded : " << nclUsed;
-        mTracker->setROFrame(roFrame);
-        mTracker->clustersToTracks(event);
-        tracks.swap(event.getTracks());
-        ntracks += tracks.size();
-
-        if (mUseMC) {
-          mTracker->computeTracksMClabels(tracks);
-          trackLabels.swap(mTracker->getTrackLabels());
-          std::copy(trackLabels.begin(), trackLabels.end(), std::back_inserter(allTrackLabels));
-          trackLabels.clear();
-        }
-
-        LOG(debug) << "Found MFT tracks: " << tracks.size();
-        int first = allTracksMFT.size();
-        int number = tracks.size();
-        rof.setFirstEntry(first);
-        rof.setNEntries(number);
-        copyTracks(tracks, allTracksMFT, allClusIdx);
+///_______________________________________
+template <typename T>
+void TrackerDPL::runTracking(std::vector<std::unique_ptr<o2::mft::Tracker<T>>>& trackers, o2::pmr::vector<o2::itsmft::ROFRecord>& rofs,
+                             gsl::span<const o2::itsmft::CompClusterExt> compClusters, gsl::span<const unsigned char> patterns,
+                             const dataformats::MCTruthContainer<MCCompLabel>* labels, o2::pmr::vector<o2::mft::TrackMFT>& allTracksMFT,
+                             o2::pmr::vector<int>& allClusIdx, std::vector<o2::MCCompLabel>& allTrackLabels)
+{
+  // The ROFs are loaded in batches, sequentially since the cluster patterns are read in order,
+  // the ROFs of a batch are tracked concurrently, each thread using its own tracker, and their
+  // tracks are finally copied to the output in the ROF order, so that the output does not depend
+  // on the number of threads.
+
+  // tracking configuration parameters
+  auto& trackingParam = MFTTrackingParam::Instance();
+
+  // snippet to convert found tracks to final output tracks with separate cluster indices
+  auto copyTracks = [](auto& tracks, auto& allTracks, auto& allClusIdx) {
+    for (auto& trc : tracks) {
+      trc.setExternalClusterIndexOffset(allClusIdx.size());
+      int ncl = trc.getNumberOfPoints();
+      for (int ic = 0; ic < ncl; ic++) {
+        auto externalClusterID = trc.getExternalClusterIndex(ic);
+        allClusIdx.push_back(externalClusterID);
       }
-      roFrame++;
+      allTracks.emplace_back(trc);
     }
-  } else { // Use Linear Tracker for Field off
-    o2::mft::ROframe<TrackLTFL> event(0);
-
-    // tracking configuration parameters
-    auto& trackingParam = MFTTrackingParam::Instance();
+  };
+
+  int nThreads = trackers.size();
+  int batchSize = nThreads > 1 ? nThreads * ROFsPerThreadInBatch : 1;
+  std::vector<o2::mft::ROframe<T>> events(batchSize, o2::mft::ROframe<T>(0));
+  std::vector<std::vector<o2::MCCompLabel>> eventLabels(batchSize);
+  std::vector<std::uint32_t> eventROF(batchSize);
+  std::vector<double> eventTime(batchSize);
+
+  auto trackEvent = [&](int iEvent, int ith) {
+    auto tStart = std::chrono::high_resolution_clock::now();
+    auto& tracker = *trackers[ith];
+    auto& event = events[iEvent];
+    tracker.setROFrame(eventROF[iEvent]);
+    tracker.clustersToTracks(event);
+    if (mUseMC) {
+      tracker.computeTracksMClabels(event.getTracks());
+      eventLabels[iEvent].swap(tracker.getTrackLabels());
+      tracker.getTrackLabels().clear();
+    }
+    eventTime[iEvent] = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - tStart).count();
+  };
 
-    // snippet to convert found tracks to final output tracks with separate cluster indices
-    auto copyTracks = [&event](auto& tracks, auto& allTracks, auto& allClusIdx) {
-      for (auto& trc : tracks) {
-        trc.setExternalClusterIndexOffset(allClusIdx.size());
-        int ncl = trc.getNumberOfPoints();
-        for (int ic = 0; ic < ncl; ic++) {
-          auto externalClusterID = trc.getExternalClusterIndex(ic);
-          allClusIdx.push_back(externalClusterID);
-        }
-        allTracks.emplace_back(trc);
-      }
-    };
+  gsl::span<const unsigned char>::iterator pattIt = patterns.begin();
+  size_t nROFsTracked = 0;
+  double rofTimeTotal = 0., rofTimeMax = 0.;
+  std::uint32_t roFrame = 0;
+  while (roFrame < rofs.size()) {
 
-    gsl::span<const unsigned char>::iterator pattIt = patterns.begin();
-    for (auto& rof : rofs) {
-      int nclUsed = ioutils::loadROFrameData(rof, event, compClusters, pattIt, mDict, labels, mTrackerL.get());
+    // load the next batch of ROFs with clusters
+    int nEvents = 0;
+    for (; roFrame < rofs.size() && nEvents < batchSize; roFrame++) {
+      auto& event = events[nEvents];
+      int nclUsed = ioutils::loadROFrameData(rofs[roFrame], event, compClusters, pattIt, mDict, labels, trackers.front().get());
       if (nclUsed) {
         event.setROFrameId(roFrame);
         event.initialize(trackingParam.FullClusterScan);
         LOG(debug) << "ROframe: " << roFrame << ", clusters loaded : " << nclUsed;
-        mTrackerL->setROFrame(roFrame);
-        mTrackerL->clustersToTracks(event);
-        tracksL.swap(event.getTracks());
-        ntracks += tracksL.size();
-
-        if (mUseMC) {
-          mTrackerL->computeTracksMClabels(tracksL);
-          trackLabels.swap(mTrackerL->getTrackLabels());
-          std::copy(trackLabels.begin(), trackLabels.end(), std::back_inserter(allTrackLabels));
-          trackLabels.clear();
-        }
-
-        LOG(debug) << "Found MFT tracks: " << tracks.size();
-        int first = allTracksMFT.size();
-        int number = tracksL.size();
-        rof.setFirstEntry(first);
-        rof.setNEntries(number);
-        copyTracks(tracksL, allTracksMFT, allClusIdx);
+        eventROF[nEvents++] = roFrame;
       }
-      roFrame++;
     }
+
+    // track them
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(nThreads)
+    for (int iEvent = 0; iEvent < nEvents; iEvent++) {
+      trackEvent(iEvent, omp_get_thread_num());
+    }
+#else
+    for (int iEvent = 0; iEvent < nEvents; iEvent++) {
+      trackEvent(iEvent, 0);
+    }
+#endif
+
+    // store their tracks
+    for (int iEvent = 0; iEvent < nEvents; iEvent++) {
+      auto& tracks = events[iEvent].getTracks();
+      LOG(debug) << "ROframe: " << eventROF[iEvent] << ", found MFT tracks: " << tracks.size() << " in " << eventTime[iEvent] << " ms";
+      auto& rof = rofs[eventROF[iEvent]];
+      rof.setFirstEntry(allTracksMFT.size());
+      rof.setNEntries(tracks.size());
+      copyTracks(tracks, allTracksMFT, allClusIdx);
+      if (mUseMC) {
+        std::copy(eventLabels[iEvent].begin(), eventLabels[iEvent].end(), std::back_inserter(allTrackLabels));
+        eventLabels[iEvent].clear();
+      }
+      rofTimeTotal += eventTime[iEvent];
+      rofTimeMax = std::max(rofTimeMax, eventTime[iEvent]);
+    }
+    nROFsTracked += nEvents;
   }
-  LOG(info) << "MFTTracker pushed " << allTracksMFT.size() << " tracks";
 
-  if (mUseMC) {
-    pc.outputs().snapshot(Output{"MFT", "TRACKSMCTR", 0, Lifetime::Timeframe}, allTrackLabels);
-    pc.outputs().snapshot(Output{"MFT", "TRACKSMC2ROF", 0, Lifetime::Timeframe}, mc2rofs);
+  if (nROFsTracked) {
+    LOGF(info, "MFTTracker tracked %zu ROFs with clusters, tracking time per ROF: mean %.3f ms, max %.3f ms",
+         nROFsTracked, rofTimeTotal / nROFsTracked, rofTimeMax);
   }
-  mTimer.Stop();
+  mNROFsTracked += nROFsTracked;
+  mROFTimeTotal += rofTimeTotal;
+  mROFTimeMax = std::max(mROFTimeMax, rofTimeMax);
 }
 
 void TrackerDPL::endOfStream(EndOfStreamContext& ec)
 {
   LOGF(info, "MFT Tracker total timing: Cpu: %.3e Real: %.3e s in %d slots",
        mTimer.CpuTime(), mTimer.RealTime(), mTimer.Counter() - 1);
+  if (mNROFsTracked) {
+    LOGF(info, "MFT Tracker tracked %zu ROFs with clusters with %d thread(s), tracking time per ROF: mean %.3f ms, max %.3f ms",
+         mNROFsTracked, mNThreads, mROFTimeTotal / mNROFsTracked, mROFTimeMax);
+  }
 }
 
 DataProcessorSpec getTrackerSpec(bool useMC)
@@ -266,7 +311,8 @@ DataProcessorSpec getTrackerSpec(bool useMC)
     outputs,
     AlgorithmSpec{adaptFromTask<TrackerDPL>(useMC)},
     Options{
-      {"grp-file", VariantType::String, "o2sim_grp.root", {"Name of the output file"}}}};
+      {"grp-file", VariantType::String, "o2sim_grp.root", {"Name of the output file"}},
+      {"nthreads", VariantType::Int, 1, {"Number of tracking threads, each tracking different ROFs"}}}};
 }
 
 } // namespace mft
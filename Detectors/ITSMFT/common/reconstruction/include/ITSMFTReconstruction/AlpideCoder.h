@@ -37,6 +37,28 @@ namespace o2
 namespace itsmft
 {
 
+/// Offsets (w.r.t. the DATA LONG address) of the extra hits encoded in each of the possible DATA LONG hit maps,
+/// allowing to expand the hit map w/o testing its bits one by one
+struct AlpideHitMapLUT {
+  static constexpr int NPatterns = 0x1 << 7;
+  struct Entry {
+    uint8_t nHits = 0;
+    uint8_t offsets[7] = {};
+  };
+  constexpr AlpideHitMapLUT()
+  {
+    for (int pattern = 0; pattern < NPatterns; pattern++) {
+      auto& entry = entries[pattern];
+      for (int ip = 0; ip < 7; ip++) {
+        if (pattern & (0x1 << ip)) {
+          entry.offsets[entry.nHits++] = ip + 1;
+        }
+      }
+    }
+  }
+  Entry entries[NPatterns] = {};
+};
+
 /// Decoder / Encoder of ALPIDE payload stream.
 /// All decoding methods are static. Only a few encoding methods are non-static but can be made so
 /// if needed (will require to make the encoding buffers external to this class)
@@ -78,6 +100,7 @@ class AlpideCoder
   static constexpr int NRegions = 32;
   static constexpr int NDColInReg = NCols / NRegions / 2;
   static constexpr int HitMapSize = 7;
+  static constexpr AlpideHitMapLUT HitMapLUT{}; // expanded DATA LONG hit maps
 
   // masks for records components
   static constexpr uint32_t MaskEncoder = 0x3c00;                 // encoder (double column) ID takes 4 bit max (0:15)
@@ -232,7 +255,7 @@ class AlpideCoder
           uint16_t row = pixID >> 1;
           // abs id of left column in double column
           uint16_t colD = (region * NDColInReg + dColID) << 1; // TODO consider <<4 instead of *NDColInReg?
-          bool rightC = (row & 0x1) ? !(pixID & 0x1) : (pixID & 0x1); // true for right column / lalse for left
+          bool rightC = (row ^ pixID) & 0x1; // true for right column / lalse for left
           // if we start new double column, transfer the hits accumulated in the right column buffer of prev. double column
           if (colD != colDPrev) {
             colDPrev++;
@@ -288,22 +311,21 @@ class AlpideCoder
 #endif
               return unexpectedEOF("CHIP_DATA_LONG:Pattern");
             }
-            for (int ip = 0; ip < HitMapSize; ip++) {
-              if (hitsPattern & (0x1 << ip)) {
-                uint16_t addr = pixID + ip + 1, rowE = addr >> 1;
-                if (addr & ~MaskPixID) {
+            const auto& extraHits = HitMapLUT.entries[hitsPattern]; // set bits of the hit map, in increasing order
+            for (int ih = 0; ih < extraHits.nHits; ih++) {
+              uint16_t addr = pixID + extraHits.offsets[ih], rowE = addr >> 1;
+              if (addr & ~MaskPixID) {
 #ifdef ALPIDE_DECODING_STAT
-                  chipData.setError(ChipStat::WrongRow);
+                chipData.setError(ChipStat::WrongRow);
 #endif
-                  return unexpectedEOF(fmt::format("Non-existing encoder {} decoded, DataLong was {:x}", pixID, dataS));
-                }
-                rightC = ((rowE & 0x1) ? !(addr & 0x1) : (addr & 0x1)); // true for right column / lalse for left
-                // the real columnt is int colE = colD + rightC;
-                if (rightC) { // same as above
-                  rightColHits[nRightCHits++] = rowE;
-                } else {
-                  addHit(chipData, rowE, colD + rightC); // left column hits are added directly to the container
-                }
+                return unexpectedEOF(fmt::format("Non-existing encoder {} decoded, DataLong was {:x}", pixID, dataS));
+              }
+              rightC = (rowE ^ addr) & 0x1; // true for right column / lalse for left
+              // the real columnt is int colE = colD + rightC;
+              if (rightC) { // same as above
+                rightColHits[nRightCHits++] = rowE;
+              } else {
+                addHit(chipData, rowE, colD + rightC); // left column hits are added directly to the container
               }
             }
           }
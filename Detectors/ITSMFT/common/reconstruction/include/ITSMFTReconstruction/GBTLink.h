@@ -277,6 +277,10 @@ GBTLink::CollectedDataStatus GBTLink::collectROFCableData(const Mapping& chmap)
     }
     auto gbtD = reinterpret_cast<const o2::itsmft::GBTData*>(&currRawPiece->data[dataOffset]);
     expectPacketDone = true;
+    // The cable buffers are reserved once per page for the worst case of all the remaining words going to
+    // the same cable, so that the words can be demultiplexed w/o capacity checks, by fixed size copies of padded words
+    uint32_t cablesReserved = 0;
+    size_t maxPayloadInPage = (currRawPiece->size - dataOffset) / GBTPaddedWordLength * 9 + GBTPaddedWordLength;
     while (!gbtD->isDataTrailer()) { // start reading real payload
       nw++;
       if (verbosity >= VerboseData) {
@@ -288,10 +292,15 @@ GBTLink::CollectedDataStatus GBTLink::collectROFCableData(const Mapping& chmap)
         GBTLINK_DECODE_ERRORCHECK(errRes, checkErrorsCableID(gbtD, cableSW));
         if (errRes != GBTLink::Skip) {
           GBTLINK_DECODE_ERRORCHECK(errRes, checkErrorsGBTData(chmap.cableHW2Pos(ruPtr->ruInfo->ruType, cableHW)));
-          ruPtr->cableData[cableSW].add(gbtD->getW8(), 9);
-          ruPtr->cableHWID[cableSW] = cableHW;
-          ruPtr->cableLinkID[cableSW] = idInRU;
-          ruPtr->cableLinkPtr[cableSW] = this;
+          auto& cableData = ruPtr->cableData[cableSW];
+          if (!(cablesReserved & (0x1 << cableSW))) { // 1st word of this cable in the page
+            cablesReserved |= 0x1 << cableSW;
+            cableData.ensureFreeCapacity(maxPayloadInPage);
+            ruPtr->cableHWID[cableSW] = cableHW;
+            ruPtr->cableLinkID[cableSW] = idInRU;
+            ruPtr->cableLinkPtr[cableSW] = this;
+          }
+          cableData.addFastBlock<GBTPaddedWordLength>(gbtD->getW8(), 9);
         }
       }
       dataOffset += GBTPaddedWordLength;
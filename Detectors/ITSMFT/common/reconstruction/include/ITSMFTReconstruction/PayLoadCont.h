@@ -94,6 +94,16 @@ class PayLoadCont
     mEnd += n;
   }
 
+  ///< add n bytes to the buffer copying a fixed size block of N >= n bytes w/o checking for the size:
+  ///< the fixed size copy is done with few wide moves instead of a variable size memcpy.
+  ///< N bytes must be readable at ptr and N bytes must be free in the buffer, bytes beyond n are not used.
+  template <size_t N>
+  void addFastBlock(const uint8_t* ptr, size_t n)
+  {
+    std::memcpy(mEnd, ptr, N);
+    mEnd += n;
+  }
+
   ///< add new byte to the buffer w/o checking for the size
   void addFast(uint8_t val) { *mEnd++ = val; }
 
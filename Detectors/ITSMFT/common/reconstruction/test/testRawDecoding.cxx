@@ -0,0 +1,443 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file   testRawDecoding.cxx
+/// @brief  encoding -> decoding round trips of the ALPIDE data and of the GBT links pages
+
+#define BOOST_TEST_MODULE Test ITSMFT RawDecoding
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "CommonConstants/Triggers.h"
+#include "CommonDataFormat/InteractionRecord.h"
+#include "DetectorsRaw/RDHUtils.h"
+#include "Headers/RAWDataHeader.h"
+#include "ITSMFTReconstruction/AlpideCoder.h"
+#include "ITSMFTReconstruction/ChipMappingITS.h"
+#include "ITSMFTReconstruction/GBTLink.h"
+#include "ITSMFTReconstruction/GBTWord.h"
+#include "ITSMFTReconstruction/PayLoadCont.h"
+#include "ITSMFTReconstruction/PixelData.h"
+#include "ITSMFTReconstruction/RUDecodeData.h"
+
+using namespace o2::itsmft;
+using RDHUtils = o2::raw::RDHUtils;
+using GBTWordBytes = std::array<uint8_t, GBTPaddedWordLength>;
+
+namespace
+{
+/// pixel encoded at the given address of the double column of the region
+PixelData pixelAt(int region, int dcol, int address)
+{
+  int row = address >> 1, rightC = (row ^ address) & 0x1;
+  return PixelData(row, ((region * AlpideCoder::NDColInReg + dcol) << 1) + rightC);
+}
+
+/// pixels in the column/row order of the decoder output, w/o duplicates
+std::vector<PixelData> sorted(std::vector<PixelData> pixels)
+{
+  std::sort(pixels.begin(), pixels.end());
+  pixels.erase(std::unique(pixels.begin(), pixels.end()), pixels.end());
+  return pixels;
+}
+
+/// encode single chip as the raw data encoders do, i.e. with the pixels sorted in row/col
+void encodeChip(AlpideCoder& coder, PayLoadCont& buffer, std::vector<PixelData> pixels, uint16_t chipInModule, uint16_t bc)
+{
+  std::sort(pixels.begin(), pixels.end(), [](const auto& lhs, const auto& rhs) {
+    return (lhs.getRow() < rhs.getRow()) || (lhs.getRow() == rhs.getRow() && lhs.getCol() < rhs.getCol());
+  });
+  ChipPixelData chipData;
+  chipData.getData() = pixels;
+  buffer.ensureFreeCapacity(40 * (2 + pixels.size()));
+  coder.encodeChip(buffer, chipData, chipInModule, bc);
+}
+
+/// encode and decode back single chip, checking the size of its ALPIDE stream if expectedSize > 0
+void checkChipRoundTrip(const std::vector<PixelData>& pixels, uint16_t chipInModule, size_t expectedSize = 0)
+{
+  AlpideCoder coder;
+  PayLoadCont buffer;
+  encodeChip(coder, buffer, pixels, chipInModule, 0x123);
+  if (expectedSize) {
+    BOOST_CHECK_EQUAL(buffer.getSize(), expectedSize);
+  }
+  ChipPixelData decoded;
+  int ret = AlpideCoder::decodeChip(decoded, buffer, [](int cid) { return cid; });
+  BOOST_CHECK_EQUAL(ret, int(sorted(pixels).size()));
+  BOOST_CHECK_EQUAL(decoded.getChipID(), chipInModule);
+  BOOST_CHECK(!decoded.isErrorSet());
+  BOOST_CHECK(buffer.isEmpty());
+  auto decodedPixels = sorted(decoded.getData());
+  BOOST_CHECK(decodedPixels == sorted(pixels));
+}
+
+/// random clusters, some of them on the matrix edges
+std::vector<PixelData> makeClusters(std::mt19937& generator, int nClusters, int maxSize)
+{
+  std::uniform_int_distribution<int> row(0, AlpideCoder::NRows - 1), col(0, AlpideCoder::NCols - 1), size(1, maxSize);
+  std::bernoulli_distribution fired(0.6);
+  std::vector<PixelData> pixels;
+  for (int i = 0; i < nClusters; i++) {
+    int r0 = row(generator), c0 = col(generator), dr = size(generator), dc = size(generator);
+    for (int r = std::max(0, r0 - dr / 2); r <= std::min(AlpideCoder::NRows - 1, r0 + dr / 2); r++) {
+      for (int c = std::max(0, c0 - dc / 2); c <= std::min(AlpideCoder::NCols - 1, c0 + dc / 2); c++) {
+        if (r == r0 || fired(generator)) {
+          pixels.emplace_back(r, c);
+        }
+      }
+    }
+  }
+  return sorted(pixels);
+}
+
+/// CRU pages of single GBT link in the format produced by the MC2RawEncoder with the RawFileWriter: every page starts with
+/// the RDH and the GBT header, a ROF not fitting in the page is continued on the next page after the repeated GBT trigger,
+/// the trailer of the page with the continued ROF having no packetDone flag. The HBF is closed by the stop page.
+class LinkPages
+{
+ public:
+  LinkPages(uint16_t feeID, uint8_t linkID, uint32_t lanes, const o2::InteractionRecord& hbIR, size_t pageSize)
+    : mFEEID(feeID), mLinkID(linkID), mHeader(lanes), mHBIR(hbIR), mPageSize(pageSize) {}
+
+  void addROF(const GBTTrigger& trigger, const std::vector<GBTWordBytes>& words)
+  {
+    size_t next = 0;
+    do {
+      if (mPages.empty() || freeWords() < 3) { // need space for the trigger, 1 data word and the trailer
+        openPage(false);
+        add(mHeader.getW8());
+      }
+      add(trigger.getW8());
+      size_t nw = std::min(freeWords() - 1, words.size() - next);
+      for (size_t i = 0; i < nw; i++) {
+        add(words[next++].data());
+      }
+      GBTDataTrailer trailer;
+      trailer.packetDone = next == words.size();
+      add(trailer.getW8());
+    } while (next < words.size());
+  }
+
+  const std::vector<std::vector<uint8_t>>& close()
+  {
+    openPage(true);
+    add(GBTDiagnostic().getW8());
+    for (auto& page : mPages) {
+      auto& rdh = *reinterpret_cast<o2::header::RAWDataHeader*>(page.data());
+      RDHUtils::setMemorySize(rdh, page.size());
+      RDHUtils::setOffsetToNext(rdh, page.size());
+    }
+    return mPages;
+  }
+
+ private:
+  size_t freeWords() const { return (mPageSize - mPages.back().size()) / GBTPaddedWordLength; }
+
+  void add(const uint8_t* word)
+  {
+    auto& page = mPages.back();
+    page.insert(page.end(), word, word + GBTPaddedWordLength);
+  }
+
+  void openPage(bool stop)
+  {
+    o2::header::RAWDataHeader rdh;
+    RDHUtils::setFEEID(rdh, mFEEID);
+    RDHUtils::setLinkID(rdh, mLinkID);
+    RDHUtils::setPacketCounter(rdh, mPages.size());
+    RDHUtils::setPageCounter(rdh, mPages.size());
+    RDHUtils::setStop(rdh, stop);
+    RDHUtils::setHeartBeatOrbit(rdh, mHBIR.orbit);
+    RDHUtils::setHeartBeatBC(rdh, mHBIR.bc);
+    RDHUtils::setTriggerOrbit(rdh, mHBIR.orbit);
+    RDHUtils::setTriggerBC(rdh, mHBIR.bc);
+    RDHUtils::setTriggerType(rdh, o2::trigger::HB);
+    auto& page = mPages.emplace_back(sizeof(rdh));
+    std::memcpy(page.data(), &rdh, sizeof(rdh));
+  }
+
+  uint16_t mFEEID = 0;
+  uint8_t mLinkID = 0;
+  GBTDataHeader mHeader;
+  o2::InteractionRecord mHBIR;
+  size_t mPageSize = 0;
+  std::vector<std::vector<uint8_t>> mPages;
+};
+
+using ChipsPixels = std::map<int, std::vector<PixelData>>; // pixels of the fired chips of single ROF, per global chip ID
+
+/// GBT links of single RU, cabled as in the ITS digi2raw
+struct RUSetup {
+  int ruSW = 0;
+  const RUInfo* ruInfo = nullptr;
+  std::vector<uint32_t> linksLanes;
+};
+
+RUSetup makeRU(ChipMappingITS& mp, int ruSW)
+{
+  constexpr int lanesPerLink[ChipMappingITS::NSubB][RUDecodeData::MaxLinksPerRU] = {{3, 3, 3}, {14, 14, 0}, {14, 14, 0}};
+  RUSetup ru{ruSW, mp.getRUInfoSW(ruSW), {}};
+  uint32_t lanes = mp.getCablesOnRUType(ru.ruInfo->ruType);
+  int firstLane = 0;
+  for (int nLanes : lanesPerLink[ru.ruInfo->ruType]) {
+    if (nLanes) {
+      ru.linksLanes.push_back(lanes & (((0x1 << nLanes) - 1) << firstLane));
+      firstLane += nLanes;
+    }
+  }
+  return ru;
+}
+
+/// encode single ROF of the RU and append it to the pages of its links, as the MC2RawEncoder does
+void encodeROF(ChipMappingITS& mp, const RUSetup& ru, const ChipsPixels& chips, const o2::InteractionRecord& ir, std::vector<LinkPages>& links)
+{
+  AlpideCoder coder;
+  std::array<PayLoadCont, RUDecodeData::MaxCablesPerRU> cableData;
+  std::array<uint8_t, RUDecodeData::MaxCablesPerRU> cableHW{};
+  int ruType = ru.ruInfo->ruType;
+  for (int ich = 0; ich < mp.getNChipsOnRUType(ruType); ich++) {
+    const auto& chip = *mp.getChipOnRUInfo(ruType, ich);
+    cableHW[chip.cableHWPos] = chip.cableHW;
+    auto fired = chips.find(ru.ruInfo->firstChipIDSW + ich);
+    if (fired != chips.end()) {
+      encodeChip(coder, cableData[chip.cableHWPos], fired->second, chip.chipOnModuleHW, ir.bc);
+    } else {
+      cableData[chip.cableHWPos].ensureFreeCapacity(100);
+      coder.addEmptyChip(cableData[chip.cableHWPos], chip.chipOnModuleHW, ir.bc);
+    }
+  }
+  GBTTrigger trigger;
+  trigger.bc = ir.bc;
+  trigger.orbit = ir.orbit;
+  trigger.triggerType = o2::trigger::PhT;
+  for (size_t il = 0; il < ru.linksLanes.size(); il++) {
+    std::vector<GBTWordBytes> words; // words of the cables of the link, interleaved
+    bool hasData = true;
+    while (hasData) {
+      hasData = false;
+      for (int icab = 0; icab < ru.ruInfo->nCables; icab++) {
+        int pos = mp.cablePos(ruType, icab);
+        auto& cable = cableData[pos];
+        if (!(ru.linksLanes[il] & (0x1 << pos)) || cable.isEmpty()) {
+          continue;
+        }
+        int nb = std::min(size_t(9), cable.getUnusedSize());
+        auto& word = words.emplace_back();
+        word.fill(0);
+        std::memcpy(word.data(), cable.getPtr(), nb);
+        word[9] = mp.getGBTHeaderRUType(ruType, cableHW[pos]);
+        cable.setPtr(cable.getPtr() + nb);
+        hasData = true;
+      }
+    }
+    links[il].addROF(trigger, words);
+  }
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(DataShort)
+{
+  // pixels more than 7 addresses apart in their double column are encoded as DATA SHORT
+  std::vector<PixelData> pixels;
+  int nDCols = 0;
+  for (int region = 0; region < AlpideCoder::NRegions; region++) {
+    for (int address : {0, 8, 511, 1015, 1023}) {
+      pixels.push_back(pixelAt(region, region % AlpideCoder::NDColInReg, address));
+    }
+    nDCols++;
+    if (region % 3 == 0) {
+      for (int address : {1, 600}) {
+        pixels.push_back(pixelAt(region, (region + 7) % AlpideCoder::NDColInReg, address));
+      }
+      nDCols++;
+    }
+  }
+  // chip header + chip trailer + region header for every double column + DATA SHORT for every pixel
+  checkChipRoundTrip(pixels, 5, 2 + 1 + nDCols + 2 * pixels.size());
+}
+
+BOOST_AUTO_TEST_CASE(DataLongHitMaps)
+{
+  // every hit map value, in increasing address order, 0 being a DATA SHORT
+  std::vector<PixelData> pixels;
+  const int nGroupsPerDCol = 64, groupAddresses = 1024 / nGroupsPerDCol;
+  static_assert(groupAddresses > AlpideCoder::HitMapSize + 1, "hits of neighbour groups must not be in the same hit map");
+  for (int hitMap = 0; hitMap <= int(AlpideCoder::MaskHitMap); hitMap++) {
+    int region = hitMap < nGroupsPerDCol ? 3 : 17, dcol = hitMap < nGroupsPerDCol ? 5 : 15;
+    int address = (hitMap % nGroupsPerDCol) * groupAddresses;
+    pixels.push_back(pixelAt(region, dcol, address));
+    for (int ib = 0; ib < AlpideCoder::HitMapSize; ib++) {
+      if (hitMap & (0x1 << ib)) {
+        pixels.push_back(pixelAt(region, dcol, address + ib + 1));
+      }
+    }
+  }
+  // chip header + chip trailer + 2 region headers + 1 DATA SHORT + 127 DATA LONG with their hit map
+  checkChipRoundTrip(pixels, 11, 2 + 1 + 2 + 2 + 3 * AlpideCoder::MaskHitMap);
+
+  // the hit map expansion gives the set bits in increasing order
+  for (int hitMap = 0; hitMap <= int(AlpideCoder::MaskHitMap); hitMap++) {
+    const auto& entry = AlpideCoder::HitMapLUT.entries[hitMap];
+    int nHits = 0;
+    for (int ib = 0; ib < AlpideCoder::HitMapSize; ib++) {
+      if (hitMap & (0x1 << ib)) {
+        BOOST_CHECK_EQUAL(int(entry.offsets[nHits++]), ib + 1);
+      }
+    }
+    BOOST_CHECK_EQUAL(int(entry.nHits), nHits);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(RandomChips)
+{
+  std::mt19937 generator(1);
+  std::uniform_int_distribution<int> nClusters(1, 50);
+  for (int i = 0; i < 500; i++) {
+    BOOST_TEST_CONTEXT("chip " << i)
+    {
+      checkChipRoundTrip(makeClusters(generator, nClusters(generator), 6), i % 15);
+    }
+  }
+  // fully fired double columns and a fully fired chip
+  std::vector<PixelData> pixels;
+  for (int address = 0; address < 1024; address++) {
+    pixels.push_back(pixelAt(0, 0, address));
+    pixels.push_back(pixelAt(31, 15, address));
+  }
+  checkChipRoundTrip(pixels, 0);
+  pixels.clear();
+  for (int row = 0; row < AlpideCoder::NRows; row++) {
+    for (int col = 0; col < AlpideCoder::NCols; col++) {
+      pixels.emplace_back(row, col);
+    }
+  }
+  checkChipRoundTrip(pixels, 14);
+}
+
+BOOST_AUTO_TEST_CASE(GBTLinks)
+{
+  // ROFs of IB, MB and OB RUs read out by several links, each link interleaving the words of its cables,
+  // with ROFs sharing CRU pages and ROFs continued over several pages
+  ChipMappingITS mp;
+  const o2::InteractionRecord hbIR(0, 1000);
+  std::vector<RUSetup> rus;
+  for (int ruSW : {5, 60, 130}) {
+    rus.push_back(makeRU(mp, ruSW));
+  }
+  std::mt19937 generator(2);
+  std::uniform_int_distribution<int> nClusters(1, 30);
+  std::bernoulli_distribution fired(0.3);
+  std::vector<o2::InteractionRecord> rofIRs;
+  std::vector<ChipsPixels> rofChips;
+  for (int irof = 0; irof < 6; irof++) {
+    rofIRs.push_back(hbIR + 100 * (irof + 1));
+    auto& chips = rofChips.emplace_back();
+    for (const auto& ru : rus) {
+      for (int ich = 0; ich < mp.getNChipsOnRUType(ru.ruInfo->ruType); ich++) {
+        if (irof == 2 || fired(generator)) { // all chips fired, leaving several pages per ROF
+          chips[ru.ruInfo->firstChipIDSW + ich] = makeClusters(generator, nClusters(generator), irof == 2 ? 10 : 4);
+        }
+      }
+    }
+  }
+  rofChips.emplace_back(); // ROF w/o fired chips
+  rofIRs.push_back(hbIR + 1000);
+
+  for (size_t pageSize : {size_t(RDHUtils::MAXCRUPage), size_t(512)}) {
+    BOOST_TEST_CONTEXT("CRU page size " << pageSize)
+    {
+      // encode
+      std::vector<std::vector<LinkPages>> ruLinksPages;
+      for (const auto& ru : rus) {
+        auto& linksPages = ruLinksPages.emplace_back();
+        for (size_t il = 0; il < ru.linksLanes.size(); il++) {
+          linksPages.emplace_back(mp.RUSW2FEEId(ru.ruSW, il), il, ru.linksLanes[il], hbIR, pageSize);
+        }
+        for (size_t irof = 0; irof < rofChips.size(); irof++) {
+          encodeROF(mp, ru, rofChips[irof], rofIRs[irof], linksPages);
+        }
+      }
+
+      // decode, as the RawPixelDecoder does
+      std::vector<RUDecodeData> ruDecode(rus.size());
+      std::vector<GBTLink> links;
+      links.reserve(rus.size() * RUDecodeData::MaxLinksPerRU); // links are referred to by their pointers
+      size_t nPagesMin = -1, nPagesMax = 0;
+      for (size_t iru = 0; iru < rus.size(); iru++) {
+        auto& ru = ruDecode[iru];
+        ru.ruSWID = rus[iru].ruSW;
+        ru.ruInfo = rus[iru].ruInfo;
+        ru.chipsData.resize(mp.getNChipsOnRUType(ru.ruInfo->ruType));
+        for (size_t il = 0; il < rus[iru].linksLanes.size(); il++) {
+          const auto& linkPages = ruLinksPages[iru][il].close();
+          nPagesMin = std::min(nPagesMin, linkPages.size());
+          nPagesMax = std::max(nPagesMax, linkPages.size());
+          auto& link = links.emplace_back(iru, mp.RUSW2FEEId(ru.ruSWID, il), 0, il);
+          link.idInRU = il;
+          link.ruPtr = &ru;
+          ru.links[il] = links.size() - 1;
+          for (const auto& page : linkPages) {
+            link.cacheData(page.data(), page.size());
+          }
+        }
+      }
+      BOOST_CHECK_LT(nPagesMin, rofChips.size()); // some links have several ROFs per page
+      BOOST_CHECK_GT(nPagesMax, rofChips.size()); // some links have ROFs continued over several pages
+      for (size_t irof = 0; irof < rofChips.size(); irof++) {
+        BOOST_TEST_CONTEXT("ROF " << irof)
+        {
+          ChipsPixels decoded;
+          for (auto& ru : ruDecode) {
+            ru.clear();
+            for (int il = 0; il < RUDecodeData::MaxLinksPerRU; il++) {
+              if (ru.links[il] >= 0) {
+                auto& link = links[ru.links[il]];
+                BOOST_REQUIRE(link.collectROFCableData(mp) == GBTLink::DataSeen);
+                BOOST_CHECK(link.ir == rofIRs[irof]);
+                BOOST_CHECK_EQUAL(link.trigger, o2::trigger::PhT);
+              }
+            }
+            ru.decodeROF(mp);
+            for (int ich = 0; ich < ru.nChipsFired; ich++) {
+              const auto& chipData = ru.chipsData[ich];
+              BOOST_CHECK(!chipData.isErrorSet());
+              BOOST_CHECK(chipData.getInteractionRecord() == rofIRs[irof]);
+              BOOST_CHECK(decoded.find(chipData.getChipID()) == decoded.end());
+              decoded[chipData.getChipID()] = sorted(chipData.getData());
+            }
+          }
+          BOOST_REQUIRE_EQUAL(decoded.size(), rofChips[irof].size());
+          for (const auto& [chipID, pixels] : rofChips[irof]) {
+            BOOST_TEST_CONTEXT("chip " << chipID)
+            {
+              BOOST_REQUIRE(decoded.find(chipID) != decoded.end());
+              BOOST_CHECK(decoded[chipID] == pixels);
+            }
+          }
+        }
+      }
+      for (auto& link : links) { // only the stop page is left
+        BOOST_CHECK(link.collectROFCableData(mp) == GBTLink::StoppedOnEndOfData);
+        BOOST_CHECK_EQUAL(link.errorBits, 0u);
+      }
+    }
+  }
+}
@@ -120,6 +120,10 @@ class AlpideSimResponse
   bool getResponse(float vRow, float vCol, float cDepth, AlpideRespSimMat& dest) const;
   const AlpideRespSimMat* getResponse(float vRow, float vCol, float vDepth, bool& flipRow, bool& flipCol) const;
   const AlpideRespSimMat* getResponse(float vRow, float vCol, float vDepth, bool& flipRow, bool& flipCol, float rowMax, float colMax) const;
+  int getResponseBin(float vRow, float vCol, float vDepth, bool& flipRow, bool& flipCol) const { return getResponseBin(vRow, vCol, vDepth, flipRow, flipCol, mRowMax, mColMax); }
+  int getResponseBin(float vRow, float vCol, float vDepth, bool& flipRow, bool& flipCol, float rowMax, float colMax) const;
+  size_t getNBins() const { return mData.size(); }
+  const AlpideRespSimMat& getBinResponse(size_t bin) const { return mData[bin]; }
   static int constexpr getNPix() { return AlpideRespSimMat::getNPix(); }
   int getNBinCol() const { return mNBinCol; }
   int getNBinRow() const { return mNBinRow; }
@@ -41,6 +41,8 @@ struct DPLDigitizerParam : public o2::conf::ConfigurableParamHelper<DPLDigitizer
   int minChargeToAccount = 15;            ///< minimum charge contribution to account
   int nSimSteps = 7;                      ///< number of steps in response simulation
   float energyToNElectrons = 1. / 3.6e-9; // conversion of eloss to Nelectrons
+  int shapeCacheNQuant = 0;               ///< approximate hit shapes by cached ones for positions quantized in pitch/N, 0: exact
+  int nThreads = 1;                       ///< number of threads digitizing the hits of different chips, the digits do not depend on it
 
   // boilerplate stuff + make principal key
   O2ParamDef(DPLDigitizerParam, getParamName().data());
@@ -70,12 +70,14 @@ class DigiParams
   void setChargeThreshold(int v, float frac2Account = 0.1);
   void setNSimSteps(int v);
   void setEnergyToNElectrons(float v) { mEnergyToNElectrons = v; }
+  void setShapeCacheNQuant(int v) { mShapeCacheNQuant = v < 0 ? 0 : (v > 64 ? 64 : v); }
 
   int getChargeThreshold() const { return mChargeThreshold; }
   int getMinChargeToAccount() const { return mMinChargeToAccount; }
   int getNSimSteps() const { return mNSimSteps; }
   float getNSimStepsInv() const { return mNSimStepsInv; }
   float getEnergyToNElectrons() const { return mEnergyToNElectrons; }
+  int getShapeCacheNQuant() const { return mShapeCacheNQuant; }
 
   bool isTimeOffsetSet() const { return mTimeOffset > -infTime; }
 
@@ -101,6 +103,7 @@ class DigiParams
   int mMinChargeToAccount = 15;            ///< minimum charge contribution to account
   int mNSimSteps = 7;                      ///< number of steps in response simulation
   float mEnergyToNElectrons = 1. / 3.6e-9; // conversion of eloss to Nelectrons
+  int mShapeCacheNQuant = 0;               ///< hit shapes are cached for positions quantized in pitch/N, 0: not cached
 
   o2::itsmft::AlpideSignalTrapezoid mSignalShape; ///< signal timeshape parameterization
 
@@ -110,7 +113,7 @@ class DigiParams
   float mROFrameLengthInv = 0; ///< inverse length of RO frame in ns
   float mNSimStepsInv = 0;     ///< its inverse
 
-  ClassDefNV(DigiParams, 2);
+  ClassDefNV(DigiParams, 3);
 };
 } // namespace itsmft
 } // namespace o2
@@ -17,9 +17,11 @@
 #include <vector>
 #include <deque>
 #include <memory>
+#include <unordered_map>
 
 #include "Rtypes.h" // for Digitizer::Class
 #include "TObject.h" // for TObject
+#include "TRandom.h"
 
 #include "ITSMFTSimulation/ChipDigitsContainer.h"
 #include "ITSMFTSimulation/AlpideSimResponse.h"
@@ -80,6 +82,10 @@ class Digitizer : public TObject
   // provide the common itsmft::GeometryTGeo to access matrices and segmentation
   void setGeometry(const o2::itsmft::GeometryTGeo* gm) { mGeometry = gm; }
 
+  /// number of threads digitizing the hits of different chips in parallel, to be set before init
+  void setNThreads(int n) { mNThreads = n > 0 ? n : 1; }
+  int getNThreads() const { return mNThreads; }
+
   uint32_t getEventROFrameMin() const { return mEventROFrameMin; }
   uint32_t getEventROFrameMax() const { return mEventROFrameMax; }
   void resetEventROFrames()
@@ -89,23 +95,56 @@ class Digitizer : public TObject
   }
 
  private:
-  void processHit(const o2::itsmft::Hit& hit, uint32_t& maxFr, int evID, int srcID);
-  void registerDigits(ChipDigitsContainer& chip, uint32_t roFrame, float tInROF, int nROF,
+  /// response matrix of a single step of a hit, centered at the pixel of the step
+  struct StepResponse {
+    int row, col;
+    const AlpideRespSimMat* mat;
+  };
+
+  /// response of a hit per electron injected at every step, in the plaquet of pixels it can reach
+  struct HitShape {
+    int rowMin = 0, colMin = 0;   ///< 1st row and column of the plaquet
+    int rowSpan = 0, colSpan = 0; ///< size of the plaquet, 0 if the hit has no shape
+    std::vector<float> resp;      ///< response for every pixel of the plaquet, row-wise
+  };
+
+  /// digitization state for the hits of the chips with (chip index % number of threads) == worker index
+  struct Worker {
+    std::unique_ptr<TRandom> rnd;                       ///< generator of the collected charge
+    int rndChip = -1;                                   ///< chip for which the generator was seeded
+    std::vector<StepResponse> stepResp;                 ///< responses of the steps of the current hit
+    HitShape shape;                                     ///< shape of the current hit, when not cached
+    std::unordered_map<uint64_t, HitShape> shapeCache;  ///< shapes of the hits for quantized entry point, depth and direction
+    std::deque<std::unique_ptr<ExtraDig>> extraBuff;    ///< buffer (per roFrame) for extra digits
+    uint32_t roFrameMax = 0;                            ///< highest RO frame reached by the hits
+    uint32_t eventROFrameMin = 0xffffffff;              ///< lowest RO frame of the registered digits
+    uint32_t eventROFrameMax = 0;                       ///< highest RO frame of the registered digits
+  };
+
+  void processHit(const o2::itsmft::Hit& hit, Worker& worker, int evID, int srcID);
+  void registerDigits(Worker& worker, ChipDigitsContainer& chip, uint32_t roFrame, float tInROF, int nROF,
                       uint16_t row, uint16_t col, int nEle, o2::MCCompLabel& lbl);
-
-  ExtraDig* getExtraDigBuffer(uint32_t roFrame)
+  void buildResponseCache(const o2::itsmft::AlpideSimResponse* resp);
+  uint32_t getChipSeed(int chipID) const;
+  bool computeHitShape(Worker& worker, const o2::itsmft::AlpideSimResponse* resp, math_utils::Vector3D<float> xyzS,
+                       const math_utils::Vector3D<float>& xyzE, const math_utils::Vector3D<float>& step, int nSteps, HitShape& shape);
+  const HitShape* getCachedHitShape(Worker& worker, const o2::itsmft::AlpideSimResponse* resp, const math_utils::Vector3D<float>& xyzS,
+                                    const math_utils::Vector3D<float>& step, int nSteps, int& row, int& col);
+
+  ExtraDig* getExtraDigBuffer(Worker& worker, uint32_t roFrame)
   {
     if (mROFrameMin > roFrame) {
       return nullptr; // nothing to do
     }
     int ind = roFrame - mROFrameMin;
-    while (ind >= int(mExtraBuff.size())) {
-      mExtraBuff.emplace_back(std::make_unique<ExtraDig>());
+    while (ind >= int(worker.extraBuff.size())) {
+      worker.extraBuff.emplace_back(std::make_unique<ExtraDig>());
     }
-    return mExtraBuff[ind].get();
+    return worker.extraBuff[ind].get();
   }
 
   static constexpr float sec2ns = 1e9;
+  static constexpr size_t MaxCachedShapes = 100000; ///< max number of cached hit shapes per worker
 
   o2::itsmft::DigiParams mParams; ///< digitization parameters
   o2::InteractionTimeRecord mEventTime; ///< global event time and interaction record
@@ -119,17 +158,21 @@ class Digitizer : public TObject
   uint32_t mEventROFrameMax = 0;          ///< highest RO frame forfor processed events (w/o automatic noise ROFs)
 
   std::unique_ptr<o2::itsmft::AlpideSimResponse> mAlpSimResp; // simulated response
+  const o2::itsmft::AlpideSimResponse* mRespCacheSource = nullptr; //! response from which mRespFlipped was built
+  std::vector<o2::itsmft::AlpideRespSimMat> mRespFlipped;          //! response matrices for every bin and row/col flips (4 per bin)
 
   const o2::itsmft::GeometryTGeo* mGeometry = nullptr; ///< ITS OR MFT upgrade geometry
 
   std::vector<o2::itsmft::ChipDigitsContainer> mChips; ///< Array of chips digits containers
-  std::deque<std::unique_ptr<ExtraDig>> mExtraBuff;    ///< burrer (per roFrame) for extra digits
+  int mNThreads = 1;                                   ///< number of threads digitizing the hits
+  uint32_t mChipSeedBase = 0;                          ///< seed of the event, from which the seeds of the chips are derived
+  std::vector<std::unique_ptr<Worker>> mWorkers;       //! digitization state of every thread
 
   std::vector<o2::itsmft::Digit>* mDigits = nullptr;                       //! output digits
   std::vector<o2::itsmft::ROFRecord>* mROFRecords = nullptr;               //! output ROF records
   o2::dataformats::MCTruthContainer<o2::MCCompLabel>* mMCLabels = nullptr; //! output labels
 
-  ClassDefOverride(Digitizer, 2);
+  ClassDefOverride(Digitizer, 3);
 };
 } // namespace itsmft
 } // namespace o2
@@ -250,17 +250,17 @@ const AlpideRespSimMat* AlpideSimResponse::getResponse(float vRow, float vCol, f
 }
 
 //____________________________________________________________
-const AlpideRespSimMat* AlpideSimResponse::getResponse(float vRow, float vCol, float vDepth, bool& flipRow, bool& flipCol, float rowMax, float colMax) const
+int AlpideSimResponse::getResponseBin(float vRow, float vCol, float vDepth, bool& flipRow, bool& flipCol, float rowMax, float colMax) const
 {
   /*
-   * get linearized NPix*NPix matrix for response at point vRow(sensor local X, along row)
-   * vCol(sensor local Z, along columns) and vDepth (sensor local Y, i.e. depth)
+   * get the bin of linearized NPix*NPix matrix for response at point vRow(sensor local X, along row)
+   * vCol(sensor local Z, along columns) and vDepth (sensor local Y, i.e. depth), -1 if there is no response
    */
   if (!mNBinDpt) {
     LOG(fatal) << "response object is not initialized";
   }
   if (vDepth < mDptMin || vDepth > mDptMax) {
-    return nullptr;
+    return -1;
   }
   if (vCol < 0) {
     vCol = -vCol;
@@ -269,7 +269,7 @@ const AlpideRespSimMat* AlpideSimResponse::getResponse(float vRow, float vCol, f
     flipCol = false;
   }
   if (vCol > colMax) {
-    return nullptr;
+    return -1;
   }
   if (vRow < 0) {
     vRow = -vRow;
@@ -278,7 +278,7 @@ const AlpideRespSimMat* AlpideSimResponse::getResponse(float vRow, float vCol, f
     flipRow = true;
   }
   if (vRow > rowMax) {
-    return nullptr;
+    return -1;
   }
 
   size_t bin = getDepthBin(vDepth) + mNBinDpt * (getRowBin(vRow) + mNBinRow * getColBin(vCol));
@@ -289,7 +289,14 @@ const AlpideRespSimMat* AlpideSimResponse::getResponse(float vRow, float vCol, f
                << ">= maxBin " << mData.size()
                << " for X(row)=" << vRow << " Z(col)=" << vCol << " Y(depth)=" << vDepth;
   }
-  return &mData[bin];
+  return bin;
+}
+
+//____________________________________________________________
+const AlpideRespSimMat* AlpideSimResponse::getResponse(float vRow, float vCol, float vDepth, bool& flipRow, bool& flipCol, float rowMax, float colMax) const
+{
+  int bin = getResponseBin(vRow, vCol, vDepth, flipRow, flipCol, rowMax, colMax);
+  return bin < 0 ? nullptr : &mData[bin];
 }
 
 //__________________________________________________
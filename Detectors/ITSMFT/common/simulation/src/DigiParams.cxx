@@ -67,6 +67,7 @@ void DigiParams::print() const
   printf("Threshold (N electrons)        : %d\n", mChargeThreshold);
   printf("Min N electrons to accoint     : %d\n", mMinChargeToAccount);
   printf("Number of charge sharing steps : %d\n", mNSimSteps);
+  printf("Hit shape cache quantization   : %d\n", mShapeCacheNQuant);
   printf("ELoss to N electrons factor    : %e\n", mEnergyToNElectrons);
   printf("Noise level per pixel          : %e\n", mNoisePerPixel);
   printf("Charge time-response:\n");
@@ -20,7 +20,11 @@
 #include "DetectorsRaw/HBFUtils.h"
 
 #include <TRandom.h>
+#include <TRandom3.h>
+#include <algorithm>
+#include <atomic>
 #include <climits>
+#include <cmath>
 #include <vector>
 #include <numeric>
 #include "FairLogger.h" // for LOG
@@ -45,6 +49,18 @@ void Digitizer::init()
     mAlpSimResp->initData();
     mParams.setAlpSimResponse(mAlpSimResp.get());
   }
+#ifndef WITH_OPENMP
+  if (mNThreads > 1) {
+    LOG(warning) << "No OpenMP support, digitizing with 1 thread instead of " << mNThreads;
+    mNThreads = 1;
+  }
+#endif
+  mWorkers.clear();
+  for (int i = 0; i < mNThreads; i++) {
+    mWorkers.emplace_back(std::make_unique<Worker>());
+    mWorkers.back()->rnd = std::make_unique<TRandom3>();
+  }
+  mRespCacheSource = nullptr;
   mParams.print();
   mIRFirstSampledTF = o2::raw::HBFUtils::Instance().getFirstSampledTFIR();
 }
@@ -64,6 +80,11 @@ void Digitizer::process(const std::vector<Hit>* hits, int evID, int srcID)
     fillOutputContainer(mNewROFrame - 1); // flush out all frame preceding the new one
   }
 
+  const o2::itsmft::AlpideSimResponse* resp = mParams.getAlpSimResponse();
+  if (resp != mRespCacheSource) {
+    buildResponseCache(resp);
+  }
+
   int nHits = hits->size();
   std::vector<int> hitIdx(nHits);
   std::iota(std::begin(hitIdx), std::end(hitIdx), 0);
@@ -72,8 +93,38 @@ void Digitizer::process(const std::vector<Hit>* hits, int evID, int srcID)
             [hits](auto lhs, auto rhs) {
               return (*hits)[lhs].GetDetectorID() < (*hits)[rhs].GetDetectorID();
             });
-  for (int i : hitIdx) {
-    processHit((*hits)[i], mROFrameMax, evID, srcID);
+  // the charge collected from the hits of a chip is generated with a generator seeded from the chip index and
+  // a single number drawn from the global generator per event, so that the digits do not depend on the number
+  // of threads and on which thread processes the chip
+  mChipSeedBase = gRandom->Integer(0xffffffff);
+  for (auto& worker : mWorkers) {
+    worker->rndChip = -1;
+    worker->roFrameMax = mROFrameMax;
+    worker->eventROFrameMin = mEventROFrameMin;
+    worker->eventROFrameMax = mEventROFrameMax;
+  }
+  int nWorkers = mWorkers.size();
+  if (nWorkers == 1) {
+    for (int i : hitIdx) {
+      processHit((*hits)[i], *mWorkers[0], evID, srcID);
+    }
+  } else {
+    // every thread digitizes the hits of its own chips
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(static, 1) num_threads(nWorkers)
+#endif
+    for (int iw = 0; iw < nWorkers; iw++) {
+      for (int i : hitIdx) {
+        if ((*hits)[i].GetDetectorID() % nWorkers == iw) {
+          processHit((*hits)[i], *mWorkers[iw], evID, srcID);
+        }
+      }
+    }
+  }
+  for (auto& worker : mWorkers) {
+    mROFrameMax = std::max(mROFrameMax, worker->roFrameMax);
+    mEventROFrameMin = std::min(mEventROFrameMin, worker->eventROFrameMin);
+    mEventROFrameMax = std::max(mEventROFrameMax, worker->eventROFrameMax);
   }
   // in the triggered mode store digits after every MC event
   // TODO: in the real triggered mode this will not be needed, this is actually for the
@@ -124,7 +175,9 @@ void Digitizer::fillOutputContainer(uint32_t frameLast)
     frameLast = mROFrameMax;
   }
   // make sure all buffers for extra digits are created up to the maxFrame
-  getExtraDigBuffer(mROFrameMax);
+  for (auto& worker : mWorkers) {
+    getExtraDigBuffer(*worker, mROFrameMax);
+  }
 
   LOG(info) << "Filling " << mGeometry->getName() << " digits output for RO frames " << mROFrameMin << ":"
             << frameLast;
@@ -136,8 +189,8 @@ void Digitizer::fillOutputContainer(uint32_t frameLast)
     rcROF.setROFrame(mROFrameMin);
     rcROF.setFirstEntry(mDigits->size()); // start of current ROF in digits
 
-    auto& extra = *(mExtraBuff.front().get());
     for (auto& chip : mChips) {
+      auto& extra = *(mWorkers[chip.getChipIndex() % mWorkers.size()]->extraBuff.front().get());
       chip.addNoise(mROFrameMin, mROFrameMin, &mParams);
       auto& buffer = chip.getPreDigits();
       if (buffer.empty()) {
@@ -174,21 +227,24 @@ void Digitizer::fillOutputContainer(uint32_t frameLast)
     if (mROFRecords) {
       mROFRecords->push_back(rcROF);
     }
-    extra.clear(); // clear container for extra digits of the mROFrameMin ROFrame
-    // and move it as a new slot in the end
-    mExtraBuff.emplace_back(mExtraBuff.front().release());
-    mExtraBuff.pop_front();
+    for (auto& worker : mWorkers) {
+      auto& extraBuff = worker->extraBuff;
+      extraBuff.front()->clear(); // clear container for extra digits of the mROFrameMin ROFrame
+      // and move it as a new slot in the end
+      extraBuff.emplace_back(extraBuff.front().release());
+      extraBuff.pop_front();
+    }
   }
 }
 
 //_______________________________________________________________________
-void Digitizer::processHit(const o2::itsmft::Hit& hit, uint32_t& maxFr, int evID, int srcID)
+void Digitizer::processHit(const o2::itsmft::Hit& hit, Worker& worker, int evID, int srcID)
 {
   // convert single hit to digits
   float timeInROF = hit.GetTime() * sec2ns;
   if (timeInROF > 20e3) {
     const int maxWarn = 10;
-    static int warnNo = 0;
+    static std::atomic<int> warnNo{0};
     if (warnNo < maxWarn) {
       LOG(warning) << "Ignoring hit with time_in_event = " << timeInROF << " ns"
                    << ((++warnNo < maxWarn) ? "" : " (suppressing further warnings)");
@@ -209,8 +265,8 @@ void Digitizer::processHit(const o2::itsmft::Hit& hit, uint32_t& maxFr, int evID
   uint32_t roFrameRelMax = mParams.isContinuous() ? (timeInROF + tTot) * mParams.getROFrameLengthInv() : roFrameRel;
   int nFrames = roFrameRelMax + 1 - roFrameRel;
   uint32_t roFrameMax = mNewROFrame + roFrameRelMax;
-  if (roFrameMax > maxFr) {
-    maxFr = roFrameMax; // if signal extends beyond current maxFrame, increase the latter
+  if (roFrameMax > worker.roFrameMax) {
+    worker.roFrameMax = roFrameMax; // if signal extends beyond current maxFrame, increase the latter
   }
 
   // here we start stepping in the depth of the sensor to generate charge diffision
@@ -243,6 +299,78 @@ void Digitizer::processHit(const o2::itsmft::Hit& hit, uint32_t& maxFr, int evID
     }
     xyzLocE -= step;
   }
+
+  float nElectrons = hit.GetEnergyLoss() * mParams.getEnergyToNElectrons(); // total number of deposited electrons
+  nElectrons *= nStepsInv;                                                  // N electrons injected per step
+  if (nSkip) {
+    nSteps -= nSkip;
+  }
+
+  const o2::itsmft::AlpideSimResponse* resp = mParams.getAlpSimResponse();
+
+  // take into account that the AlpideSimResponse depth defintion has different min/max boundaries
+  // although the max should coincide with the surface of the epitaxial layer, which in the chip
+  // local coordinates has Y = +SensorLayerThickness/2
+
+  xyzLocS.SetY(xyzLocS.Y() + resp->getDepthMax() - Segmentation::SensorLayerThickness / 2.);
+
+  // the response of a hit fully inside the sensitive matrix may be approximated by the one of the hit with the
+  // same quantized entry point in the pixel, depth and direction, otherwise it is accumulated over its steps
+  const HitShape* shape = nullptr;
+  int rowShift = 0, colShift = 0; // position of the shape plaquet in the chip
+  if (mParams.getShapeCacheNQuant() && !nSkip) {
+    shape = getCachedHitShape(worker, resp, xyzLocS, step, nSteps, rowShift, colShift);
+  }
+  if (!shape) {
+    if (!computeHitShape(worker, resp, xyzLocS, xyzLocE, step, nSteps, worker.shape)) {
+      return; // should not happen
+    }
+    shape = &worker.shape;
+    rowShift = colShift = 0;
+  }
+
+  // fire the pixels assuming Poisson(n_response_electrons), a cached shape may extend beyond the chip
+  if (worker.rndChip != hit.GetDetectorID()) { // the hits are sorted in chips, this is done once per chip
+    worker.rnd->SetSeed(getChipSeed(hit.GetDetectorID()));
+    worker.rndChip = hit.GetDetectorID();
+  }
+  o2::MCCompLabel lbl(hit.GetTrackID(), evID, srcID, false);
+  auto& chip = mChips[hit.GetDetectorID()];
+  auto roFrameAbs = mNewROFrame + roFrameRel;
+  rowShift += shape->rowMin;
+  colShift += shape->colMin;
+  int irowMin = std::max(0, -rowShift), irowMax = std::min(shape->rowSpan, Segmentation::NRows - rowShift);
+  int icolMin = std::max(0, -colShift), icolMax = std::min(shape->colSpan, Segmentation::NCols - colShift);
+  for (int irow = irowMax; irow-- > irowMin;) {
+    uint16_t rowIS = irow + rowShift;
+    const float* respRow = &shape->resp[irow * shape->colSpan];
+    for (int icol = icolMax; icol-- > icolMin;) {
+      float nEleResp = respRow[icol];
+      if (!nEleResp) {
+        continue;
+      }
+      int nEle = worker.rnd->Poisson(nElectrons * nEleResp); // total charge in given pixel
+      // ignore charge which have no chance to fire the pixel
+      if (nEle < mParams.getMinChargeToAccount()) {
+        continue;
+      }
+      uint16_t colIS = icol + colShift;
+      //
+      registerDigits(worker, chip, roFrameAbs, timeInROF, nFrames, rowIS, colIS, nEle, lbl);
+    }
+  }
+}
+
+//________________________________________________________________________________
+bool Digitizer::computeHitShape(Worker& worker, const o2::itsmft::AlpideSimResponse* resp, math_utils::Vector3D<float> xyzS,
+                                const math_utils::Vector3D<float>& xyzE, const math_utils::Vector3D<float>& step, int nSteps, HitShape& shape)
+{
+  // accumulate the response of nSteps steps, the 1st (last) one being centered at xyzS (xyzE)
+  int rowS = -1, colS = -1, rowE = -1, colE = -1;
+  if (!Segmentation::localToDetector(xyzS.X(), xyzS.Z(), rowS, colS) ||
+      !Segmentation::localToDetector(xyzE.X(), xyzE.Z(), rowE, colE)) {
+    return false;
+  }
   // estimate the limiting min/max row and col where the non-0 response is possible
   if (rowS > rowE) {
     std::swap(rowS, rowE);
@@ -267,31 +395,22 @@ void Digitizer::processHit(const o2::itsmft::Hit& hit, uint32_t& maxFr, int evID
     colE = Segmentation::NCols - 1;
   }
   int rowSpan = rowE - rowS + 1, colSpan = colE - colS + 1; // size of plaquet where some response is expected
+  shape.rowMin = rowS;
+  shape.colMin = colS;
+  shape.rowSpan = rowSpan;
+  shape.colSpan = colSpan;
+  shape.resp.assign(rowSpan * colSpan, 0.f); // response accumulated here
 
-  float respMatrix[rowSpan][colSpan]; // response accumulated here
-  std::fill(&respMatrix[0][0], &respMatrix[0][0] + rowSpan * colSpan, 0.f);
-
-  float nElectrons = hit.GetEnergyLoss() * mParams.getEnergyToNElectrons(); // total number of deposited electrons
-  nElectrons *= nStepsInv;                                                  // N electrons injected per step
-  if (nSkip) {
-    nSteps -= nSkip;
-  }
-  //
   int rowPrev = -1, colPrev = -1, row, col;
   float cRowPix = 0.f, cColPix = 0.f; // local coordinated of the current pixel center
 
-  const o2::itsmft::AlpideSimResponse* resp = mParams.getAlpSimResponse();
-
-  // take into account that the AlpideSimResponse depth defintion has different min/max boundaries
-  // although the max should coincide with the surface of the epitaxial layer, which in the chip
-  // local coordinates has Y = +SensorLayerThickness/2
-
-  xyzLocS.SetY(xyzLocS.Y() + resp->getDepthMax() - Segmentation::SensorLayerThickness / 2.);
-
-  // collect charge in evey pixel which might be affected by the hit
+  // collect charge in evey pixel which might be affected by the hit: first look up the responses of all steps,
+  // then accumulate the flip-resolved response matrices, clipped to the plaquet, w/o per-element checks
+  auto& stepResp = worker.stepResp;
+  stepResp.clear();
   for (int iStep = nSteps; iStep--;) {
     // Get the pixel ID
-    Segmentation::localToDetector(xyzLocS.X(), xyzLocS.Z(), row, col);
+    Segmentation::localToDetector(xyzS.X(), xyzS.Z(), row, col);
     if (row != rowPrev || col != colPrev) { // update pixel and coordinates of its center
       if (!Segmentation::detectorToLocal(row, col, cRowPix, cColPix)) {
         continue; // should not happen
@@ -301,53 +420,117 @@ void Digitizer::processHit(const o2::itsmft::Hit& hit, uint32_t& maxFr, int evID
     }
     bool flipCol, flipRow;
     // note that response needs coordinates along column row (locX) (locZ) then depth (locY)
-    auto rspmat = resp->getResponse(xyzLocS.X() - cRowPix, xyzLocS.Z() - cColPix, xyzLocS.Y(), flipRow, flipCol);
+    int bin = resp->getResponseBin(xyzS.X() - cRowPix, xyzS.Z() - cColPix, xyzS.Y(), flipRow, flipCol);
 
-    xyzLocS += step;
-    if (!rspmat) {
+    xyzS += step;
+    if (bin < 0) {
       continue;
     }
+    stepResp.push_back({row, col, &mRespFlipped[(bin << 2) + (flipRow << 1) + flipCol]});
+  }
 
-    for (int irow = AlpideRespSimMat::NPix; irow--;) {
-      int rowDest = row + irow - AlpideRespSimMat::NPix / 2 - rowS; // destination row in the respMatrix
-      if (rowDest < 0 || rowDest >= rowSpan) {
-        continue;
-      }
-      for (int icol = AlpideRespSimMat::NPix; icol--;) {
-        int colDest = col + icol - AlpideRespSimMat::NPix / 2 - colS; // destination column in the respMatrix
-        if (colDest < 0 || colDest >= colSpan) {
-          continue;
-        }
-        respMatrix[rowDest][colDest] += rspmat->getValue(irow, icol, flipRow, flipCol);
+  for (const auto& sr : stepResp) {
+    int rowOffs = sr.row - AlpideRespSimMat::NPix / 2 - rowS; // destination row in the plaquet of the 1st response row
+    int colOffs = sr.col - AlpideRespSimMat::NPix / 2 - colS; // destination column in the plaquet of the 1st response column
+    int irowMin = std::max(0, -rowOffs), irowMax = std::min(AlpideRespSimMat::NPix, rowSpan - rowOffs);
+    int icolMin = std::max(0, -colOffs), icolMax = std::min(AlpideRespSimMat::NPix, colSpan - colOffs);
+    for (int irow = irowMin; irow < irowMax; irow++) {
+      float* respRow = &shape.resp[(rowOffs + irow) * colSpan + colOffs];
+      for (int icol = icolMin; icol < icolMax; icol++) {
+        respRow[icol] += sr.mat->getValue(irow, icol);
       }
     }
   }
+  return true;
+}
 
-  // fire the pixels assuming Poisson(n_response_electrons)
-  o2::MCCompLabel lbl(hit.GetTrackID(), evID, srcID, false);
-  auto& chip = mChips[hit.GetDetectorID()];
-  auto roFrameAbs = mNewROFrame + roFrameRel;
-  for (int irow = rowSpan; irow--;) {
-    uint16_t rowIS = irow + rowS;
-    for (int icol = colSpan; icol--;) {
-      float nEleResp = respMatrix[irow][icol];
-      if (!nEleResp) {
-        continue;
-      }
-      int nEle = gRandom->Poisson(nElectrons * nEleResp); // total charge in given pixel
-      // ignore charge which have no chance to fire the pixel
-      if (nEle < mParams.getMinChargeToAccount()) {
-        continue;
-      }
-      uint16_t colIS = icol + colS;
-      //
-      registerDigits(chip, roFrameAbs, timeInROF, nFrames, rowIS, colIS, nEle, lbl);
+//________________________________________________________________________________
+const Digitizer::HitShape* Digitizer::getCachedHitShape(Worker& worker, const o2::itsmft::AlpideSimResponse* resp, const math_utils::Vector3D<float>& xyzS,
+                                                        const math_utils::Vector3D<float>& step, int nSteps, int& row, int& col)
+{
+  // get the shape of the hit with the entry point in its pixel, the depth and the displacement quantized in units
+  // of pitch / NQuant, the plaquet being relative to the entry pixel row and col. The shape is built once, for the
+  // hit entering the pixel in the middle of the chip. nullptr is returned if the hit cannot be cached.
+  constexpr int RowRef = Segmentation::NRows / 2, ColRef = Segmentation::NCols / 2;
+  constexpr int MaxDisp = 1 << 11; // the displacements are stored in 12 bits, the depth in 8 bits
+  const int nq = mParams.getShapeCacheNQuant();
+  const float unitRow = Segmentation::PitchRow / nq, unitCol = Segmentation::PitchCol / nq;
+  const float depthMin = resp->getDepthMax() - Segmentation::SensorLayerThickness;
+
+  float cRowPix, cColPix;
+  if (!Segmentation::localToDetector(xyzS.X(), xyzS.Z(), row, col) || !Segmentation::detectorToLocal(row, col, cRowPix, cColPix)) {
+    return nullptr;
+  }
+  int qRow = std::clamp(int((xyzS.X() - cRowPix) / unitRow + 0.5f * nq), 0, nq - 1);
+  int qCol = std::clamp(int((xyzS.Z() - cColPix) / unitCol + 0.5f * nq), 0, nq - 1);
+  int qDpt = int(std::floor((xyzS.Y() - depthMin) / unitRow));
+  int qDispRow = std::lround(step.X() * nSteps / unitRow);
+  int qDispCol = std::lround(step.Z() * nSteps / unitCol);
+  int qDispDpt = std::lround(step.Y() * nSteps / unitRow);
+  if (qDpt < 0 || qDpt > 0xff || std::abs(qDispRow) >= MaxDisp || std::abs(qDispCol) >= MaxDisp || std::abs(qDispDpt) >= MaxDisp) {
+    return nullptr;
+  }
+  uint64_t key = uint64_t(qRow) | (uint64_t(qCol) << 6) | (uint64_t(qDpt) << 12) |
+                 (uint64_t(qDispRow + MaxDisp) << 20) | (uint64_t(qDispCol + MaxDisp) << 32) | (uint64_t(qDispDpt + MaxDisp) << 44);
+
+  auto entry = worker.shapeCache.find(key);
+  if (entry == worker.shapeCache.end()) {
+    if (worker.shapeCache.size() >= MaxCachedShapes) {
+      return nullptr;
     }
+    float cRowRef, cColRef;
+    Segmentation::detectorToLocal(RowRef, ColRef, cRowRef, cColRef);
+    math_utils::Vector3D<float> xyzRefS(cRowRef + (qRow + 0.5f - 0.5f * nq) * unitRow,
+                                        depthMin + (qDpt + 0.5f) * unitRow,
+                                        cColRef + (qCol + 0.5f - 0.5f * nq) * unitCol);
+    math_utils::Vector3D<float> stepRef(qDispRow * unitRow / nSteps, qDispDpt * unitRow / nSteps, qDispCol * unitCol / nSteps);
+    math_utils::Vector3D<float> xyzRefE(xyzRefS + stepRef * float(nSteps - 1));
+    HitShape shape;
+    if (computeHitShape(worker, resp, xyzRefS, xyzRefE, stepRef, nSteps, shape)) {
+      shape.rowMin -= RowRef;
+      shape.colMin -= ColRef;
+    } else {
+      shape.rowSpan = shape.colSpan = 0; // the hit leaves the chip, it is never approximated
+    }
+    entry = worker.shapeCache.emplace(key, std::move(shape)).first;
+  }
+  return entry->second.rowSpan ? &entry->second : nullptr;
+}
+
+//________________________________________________________________________________
+void Digitizer::buildResponseCache(const o2::itsmft::AlpideSimResponse* resp)
+{
+  // precompute every response matrix with all combinations of row/column flips, so that the
+  // response returned for a given position can be accumulated w/o flipping its elements
+  size_t nBins = resp->getNBins();
+  mRespFlipped.resize(nBins << 2);
+  for (size_t bin = 0; bin < nBins; bin++) {
+    for (int flip = 0; flip < 4; flip++) {
+      mRespFlipped[(bin << 2) + flip].adopt(resp->getBinResponse(bin), (flip & 0x2) != 0, (flip & 0x1) != 0);
+    }
+  }
+  mRespCacheSource = resp;
+  for (auto& worker : mWorkers) {
+    worker->shapeCache.clear(); // the hit shapes depend on the response
   }
+  LOG(info) << "Cached " << mRespFlipped.size() << " flip-resolved Alpide response matrices";
+}
+
+//________________________________________________________________________________
+uint32_t Digitizer::getChipSeed(int chipID) const
+{
+  // seed of the generator of the chip in the current event: mix the event seed with the chip index (splitmix64
+  // finalizer) so that the chips get uncorrelated sequences, 0 is avoided as it means a time-based seed for TRandom3
+  uint64_t z = ((uint64_t(mChipSeedBase) << 32) | uint32_t(chipID)) + 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  z ^= z >> 31;
+  uint32_t seed = uint32_t(z >> 32);
+  return seed ? seed : 1;
 }
 
 //________________________________________________________________________________
-void Digitizer::registerDigits(ChipDigitsContainer& chip, uint32_t roFrame, float tInROF, int nROF,
+void Digitizer::registerDigits(Worker& worker, ChipDigitsContainer& chip, uint32_t roFrame, float tInROF, int nROF,
                                uint16_t row, uint16_t col, int nEle, o2::MCCompLabel& lbl)
 {
   // Register digits for given pixel, accounting for the possible signal contribution to
@@ -364,11 +547,11 @@ void Digitizer::registerDigits(ChipDigitsContainer& chip, uint32_t roFrame, floa
     if (nEleROF < mParams.getMinChargeToAccount()) {
       continue;
     }
-    if (roFr > mEventROFrameMax) {
-      mEventROFrameMax = roFr;
+    if (roFr > worker.eventROFrameMax) {
+      worker.eventROFrameMax = roFr;
     }
-    if (roFr < mEventROFrameMin) {
-      mEventROFrameMin = roFr;
+    if (roFr < worker.eventROFrameMin) {
+      worker.eventROFrameMin = roFr;
     }
     auto key = chip.getOrderingKey(roFr, row, col);
     PreDigit* pd = chip.findDigit(key);
@@ -379,7 +562,7 @@ void Digitizer::registerDigits(ChipDigitsContainer& chip, uint32_t roFrame, floa
       if (pd->labelRef.label == lbl) { // don't store the same label twice
         continue;
       }
-      ExtraDig* extra = getExtraDigBuffer(roFr);
+      ExtraDig* extra = getExtraDigBuffer(worker, roFr);
       int& nxt = pd->labelRef.next;
       bool skip = false;
       while (nxt >= 0) {
@@ -47,3 +47,34 @@ BOOST_AUTO_TEST_CASE(AlpideSimResponse_test)
   LOG(info) << "Total response to 1 electron: " << norm;
   BOOST_CHECK(norm > 0.1);
 }
+
+BOOST_AUTO_TEST_CASE(AlpideSimResponseBins_test)
+{
+  // check that the bin lookup and the flip-resolved matrices used by the digitizer agree with getResponse
+  AlpideSimResponse resp;
+  resp.initData();
+  const float vRows[] = {-2.e-3, -1.e-4, 1.e-4, 1.e-3};
+  const float vCols[] = {-1.e-3, -1.e-4, 1.e-4, 2.e-3};
+  for (auto vRow : vRows) {
+    for (auto vCol : vCols) {
+      bool flipCol, flipRow, flipColB, flipRowB;
+      float vDepth = resp.getDepthMax() - 10.e-4;
+      auto respMat = resp.getResponse(vRow, vCol, vDepth, flipRow, flipCol);
+      int bin = resp.getResponseBin(vRow, vCol, vDepth, flipRowB, flipColB);
+      BOOST_CHECK_EQUAL(respMat == nullptr, bin < 0);
+      if (!respMat) {
+        continue;
+      }
+      BOOST_CHECK(bin < int(resp.getNBins()));
+      BOOST_CHECK(&resp.getBinResponse(bin) == respMat);
+      BOOST_CHECK(flipRow == flipRowB && flipCol == flipColB);
+      AlpideRespSimMat flipped;
+      flipped.adopt(*respMat, flipRow, flipCol);
+      for (int ir = respMat->getNPix(); ir--;) {
+        for (int ic = respMat->getNPix(); ic--;) {
+          BOOST_CHECK_EQUAL(flipped.getValue(ir, ic), respMat->getValue(ir, ic, flipRow, flipCol));
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,197 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test ITSMFT Digitizer
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <vector>
+#include <TRandom.h>
+#include <TRandom3.h>
+#include <TVector3.h>
+#include "ITSMFTSimulation/Digitizer.h"
+#include "ITSMFTSimulation/DPLDigitizerParam.h"
+#include "ITSMFTBase/DPLAlpideParam.h"
+#include "ITSMFTBase/GeometryTGeo.h"
+#include "ITSMFTBase/SegmentationAlpide.h"
+#include "SimulationDataFormat/MCTruthContainer.h"
+#include "FairLogger.h"
+
+using namespace o2::itsmft;
+using Segmentation = o2::itsmft::SegmentationAlpide;
+using o2::detectors::DetID;
+
+namespace
+{
+/// chips with their local frame being the global one
+class ToyGeometry : public GeometryTGeo
+{
+ public:
+  ToyGeometry(int nChips) : GeometryTGeo(DetID::ITS)
+  {
+    setSize(nChips);
+    getCacheL2G().setSize(nChips);
+    for (int i = 0; i < nChips; i++) {
+      getCacheL2G().setMatrix(Mat3D(), i);
+    }
+  }
+  void Build(int) final {}
+  void fillMatrixCache(int) final {}
+};
+
+struct DigitizerOutput {
+  std::vector<Digit> digits;
+  std::vector<ROFRecord> rofs;
+  o2::dataformats::MCTruthContainer<o2::MCCompLabel> labels;
+};
+
+/// hit crossing the sensor, entering in the pixel (row, col) and leaving (dRow, dCol) pixels away
+Hit makeHit(int trackID, int chip, float row, float col, float dRow, float dCol, float eLoss)
+{
+  float xS, zS, xE, zE;
+  Segmentation::detectorToLocalUnchecked(row, col, xS, zS);
+  Segmentation::detectorToLocalUnchecked(row + dRow, col + dCol, xE, zE);
+  const float y = Segmentation::SensorLayerThickness / 2;
+  return Hit(trackID, chip, TVector3(xS, y, zS), TVector3(xE, -y, zE), TVector3(0., 0., 1.), 1., 0., eLoss, 0, 0);
+}
+
+/// events of hits in random chips, some of them sharing pixels with another track
+std::vector<std::vector<Hit>> makeEvents(int nEvents, int nHits, int nChips, bool oneHitPerChip)
+{
+  TRandom3 rnd(1234);
+  std::vector<std::vector<Hit>> events(nEvents);
+  for (auto& hits : events) {
+    for (int i = 0; i < nHits; i++) {
+      int chip = oneHitPerChip ? i : rnd.Integer(nChips);
+      float row = rnd.Uniform(10., Segmentation::NRows - 10.), col = rnd.Uniform(10., Segmentation::NCols - 10.);
+      float dRow = rnd.Uniform(-3., 3.), dCol = rnd.Uniform(-3., 3.), eLoss = rnd.Uniform(5.e-6, 2.e-5);
+      hits.push_back(makeHit(i, chip, row, col, dRow, dCol, eLoss));
+      if (!oneHitPerChip && rnd.Rndm() < 0.2) {
+        hits.push_back(makeHit(nHits + i, chip, row + rnd.Uniform(-1., 1.), col + rnd.Uniform(-1., 1.), -dRow, dCol, eLoss));
+      }
+    }
+  }
+  return events;
+}
+
+DigitizerOutput digitize(const GeometryTGeo& geom, const std::vector<std::vector<Hit>>& events, int nThreads, int shapeCacheNQuant, float noisePerPixel)
+{
+  const auto& dopt = DPLDigitizerParam<DetID::ITS>::Instance();
+  const auto& aopt = DPLAlpideParam<DetID::ITS>::Instance();
+  DigitizerOutput out;
+  Digitizer digitizer;
+  auto& params = digitizer.getParams();
+  params.setContinuous(false);
+  params.setROFrameLength(aopt.roFrameLengthTrig);
+  params.setStrobeDelay(aopt.strobeDelay);
+  params.setStrobeLength(aopt.strobeLengthTrig);
+  params.getSignalShape().setParameters(dopt.strobeFlatTop, dopt.strobeMaxRiseTime, dopt.strobeQRiseTime0);
+  params.setChargeThreshold(dopt.chargeThreshold);
+  params.setNoisePerPixel(noisePerPixel);
+  params.setNSimSteps(dopt.nSimSteps);
+  params.setShapeCacheNQuant(shapeCacheNQuant);
+  digitizer.setNThreads(nThreads);
+  digitizer.setGeometry(&geom);
+  digitizer.setDigits(&out.digits);
+  digitizer.setROFRecords(&out.rofs);
+  digitizer.setMCLabels(&out.labels);
+  digitizer.init();
+  gRandom->SetSeed(4321);
+  for (size_t iev = 0; iev < events.size(); iev++) {
+    digitizer.setEventTime(o2::InteractionTimeRecord(o2::InteractionRecord(100 * (iev + 1), 0), 0.));
+    digitizer.process(&events[iev], iev, 0);
+  }
+  return out;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(DigitizerThreads_test)
+{
+  // the digits and their labels must not depend on the number of threads, with and without the shape cache
+  const int nChips = 48;
+  ToyGeometry geom(nChips);
+  auto events = makeEvents(3, 1000, nChips, false);
+  for (int nQuant : {0, 8}) {
+    auto ref = digitize(geom, events, 1, nQuant, 1.e-6);
+    BOOST_REQUIRE(!ref.digits.empty());
+    BOOST_REQUIRE_EQUAL(ref.rofs.size(), events.size());
+    for (int nThreads : {2, 3, 4}) {
+      BOOST_TEST_CONTEXT("shape cache " << nQuant << ", " << nThreads << " threads")
+      {
+        auto out = digitize(geom, events, nThreads, nQuant, 1.e-6);
+        BOOST_REQUIRE_EQUAL(out.digits.size(), ref.digits.size());
+        BOOST_REQUIRE_EQUAL(out.labels.getIndexedSize(), ref.labels.getIndexedSize());
+        for (size_t i = 0; i < ref.digits.size(); i++) {
+          const auto &d = out.digits[i], &r = ref.digits[i];
+          BOOST_REQUIRE(d.getChipIndex() == r.getChipIndex() && d.getRow() == r.getRow() && d.getColumn() == r.getColumn());
+          BOOST_CHECK_EQUAL(d.getCharge(), r.getCharge());
+          auto lbl = out.labels.getLabels(i), lblRef = ref.labels.getLabels(i);
+          BOOST_CHECK_EQUAL_COLLECTIONS(lbl.begin(), lbl.end(), lblRef.begin(), lblRef.end());
+        }
+        for (size_t i = 0; i < ref.rofs.size(); i++) {
+          BOOST_CHECK_EQUAL(out.rofs[i].getFirstEntry(), ref.rofs[i].getFirstEntry());
+          BOOST_CHECK_EQUAL(out.rofs[i].getNEntries(), ref.rofs[i].getNEntries());
+        }
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(DigitizerShapeCache_test)
+{
+  // the hits approximated by the cached shapes give the same clusters as the exact ones, up to the quantization
+  // of the entry point and displacement (pitch / 8) and to the Poisson fluctuations of the collected charge
+  const int nChips = 2000;
+  ToyGeometry geom(nChips);
+  auto events = makeEvents(1, nChips, nChips, true); // one hit per chip, w/o noise
+  auto exact = digitize(geom, events, 1, 0, 0.);
+  auto cached = digitize(geom, events, 1, 8, 0.);
+
+  struct Cluster {
+    int nDigits = 0;
+    double charge = 0., row = 0., col = 0.;
+  };
+  auto clusters = [nChips](const DigitizerOutput& out) {
+    std::vector<Cluster> cls(nChips);
+    for (const auto& d : out.digits) {
+      auto& cl = cls[d.getChipIndex()];
+      cl.nDigits++;
+      cl.charge += d.getCharge();
+      cl.row += d.getCharge() * d.getRow();
+      cl.col += d.getCharge() * d.getColumn();
+    }
+    return cls;
+  };
+  auto clsExact = clusters(exact), clsCached = clusters(cached);
+  double chargeExact = 0., chargeCached = 0., sumDev = 0., maxDev = 0.;
+  int nCompared = 0;
+  for (int i = 0; i < nChips; i++) {
+    const auto &e = clsExact[i], &c = clsCached[i];
+    chargeExact += e.charge;
+    chargeCached += c.charge;
+    if (!e.nDigits || !c.nDigits) {
+      continue;
+    }
+    double dev = std::hypot(c.row / c.charge - e.row / e.charge, c.col / c.charge - e.col / e.charge);
+    sumDev += dev;
+    maxDev = std::max(maxDev, dev);
+    nCompared++;
+  }
+  LOG(info) << "Shape cache vs exact: digits " << cached.digits.size() << " / " << exact.digits.size() << ", charge "
+            << chargeCached << " / " << chargeExact << ", centroid deviation mean " << sumDev / nCompared << " max " << maxDev << " pixels";
+  BOOST_REQUIRE(exact.digits.size() > size_t(nChips));
+  BOOST_CHECK_GT(nCompared, 0.95 * nChips);
+  BOOST_CHECK_SMALL(double(cached.digits.size()) / exact.digits.size() - 1., 0.03);
+  BOOST_CHECK_SMALL(chargeCached / chargeExact - 1., 0.02);
+  BOOST_CHECK_LT(sumDev / nCompared, 0.1);
+  BOOST_CHECK_LT(maxDev, 0.5);
+}
@@ -0,0 +1,105 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file AbsorberMaterialMap.h
+/// \brief Definition of a precomputed map of the material crossed in the front absorber
+
+#ifndef ALICEO2_MCH_ABSORBERMATERIALMAP_H_
+#define ALICEO2_MCH_ABSORBERMATERIALMAP_H_
+
+#include <string>
+#include <vector>
+
+#include <Rtypes.h>
+
+class TGeoMaterial;
+
+namespace o2
+{
+namespace mch
+{
+
+/// Map of the material budget of the front absorber, binned in the direction (tan(theta), phi) of
+/// a straight line going from the interaction point towards the muon spectrometer (z < 0).
+/// For each direction, the material crossed between zBeg and zEnd is stored as a list of slices,
+/// each with its extent in z and the properties of its material. The path length in each slice
+/// of any other straight line with a close direction is then given by its extent in z divided by
+/// the z-component of the direction, without navigating in the geometry.
+/// The map is a plain ROOT object that can be stored in a file or in the CCDB.
+class AbsorberMaterialMap
+{
+ public:
+  /// Properties of a material crossed in the absorber
+  struct Material {
+    double rho = 0.;          ///< density (g/cm3)
+    double x0 = 0.;           ///< radiation length (cm)
+    double atomicZ = 0.;      ///< Z of the material
+    double atomicZoverA = 0.; ///< Z/A of the material
+    ClassDefNV(Material, 1);
+  };
+
+  /// Part of a straight line crossing a given material
+  struct Slice {
+    double dZ = 0.;    ///< extent in z (cm), always > 0
+    int material = -1; ///< index of the material
+    ClassDefNV(Slice, 1);
+  };
+
+  AbsorberMaterialMap() = default;
+  ~AbsorberMaterialMap() = default;
+
+  static Material getMaterialProperties(const TGeoMaterial& material);
+
+  bool build(double zBeg, double zEnd, int nTanTheta, double tanThetaMax, int nPhi);
+
+  /// Return true if the map contains any direction
+  bool isValid() const { return !mFirstSlice.empty(); }
+
+  double getZBeg() const { return mZBeg; }
+  double getZEnd() const { return mZEnd; }
+
+  int findBin(double dirX, double dirY, double dirZ) const;
+
+  /// Return the index of the first slice of the direction bin iBin
+  int getFirstSlice(int iBin) const { return mFirstSlice[iBin]; }
+  /// Return the index following the last slice of the direction bin iBin
+  int getLastSlice(int iBin) const { return mFirstSlice[iBin + 1]; }
+  /// Return the slice iSlice, ordered from zBeg to zEnd within each direction bin
+  const Slice& getSlice(int iSlice) const { return mSlices[iSlice]; }
+  /// Return the material iMaterial
+  const Material& getMaterial(int iMaterial) const { return mMaterials[iMaterial]; }
+
+  int getNBins() const { return mNTanTheta * mNPhi; }
+  size_t getNSlices() const { return mSlices.size(); }
+  size_t getNMaterials() const { return mMaterials.size(); }
+
+  bool writeTo(const std::string& fileName) const;
+  static AbsorberMaterialMap* loadFrom(const std::string& fileName);
+
+ private:
+  int addMaterial(const Material& material);
+
+  double mZBeg = 0.;                  ///< z position of the beginning of the absorber (cm)
+  double mZEnd = 0.;                  ///< z position of the end of the absorber (cm)
+  int mNTanTheta = 0;                 ///< number of bins in tan(theta)
+  double mTanThetaMax = 0.;           ///< upper edge of the last bin in tan(theta)
+  int mNPhi = 0;                      ///< number of bins in phi, over 2 pi
+  std::vector<int> mFirstSlice{};     ///< index of the first slice of each direction bin (+ total number of slices)
+  std::vector<Slice> mSlices{};       ///< slices of all the direction bins
+  std::vector<Material> mMaterials{}; ///< list of the different materials
+
+  ClassDefNV(AbsorberMaterialMap, 1);
+};
+
+} // namespace mch
+} // namespace o2
+
+#endif // ALICEO2_MCH_ABSORBERMATERIALMAP_H_
@@ -0,0 +1,61 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file MagFieldGrid.h
+/// \brief Definition of a cache of the magnetic field on a regular grid in the muon spectrometer
+
+#ifndef ALICEO2_MCH_MAGFIELDGRID_H_
+#define ALICEO2_MCH_MAGFIELDGRID_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace o2
+{
+namespace mch
+{
+
+/// Values of the magnetic field tabulated on a regular (x, y, z) grid covering the muon spectrometer,
+/// from which the field at any point inside the grid is obtained by trilinear interpolation.
+/// The grid is filled once from the field map registered in TGeoGlobalMagField, which must not change
+/// afterward. It is never modified after being built, so that it can be read by several threads.
+class MagFieldGrid
+{
+ public:
+  MagFieldGrid() = default;
+  ~MagFieldGrid() = default;
+
+  bool build(double xMax, double yMax, double zBeg, double zEnd, double stepXY, double stepZ);
+
+  /// Return true if the grid has been built
+  bool isValid() const { return !mField.empty(); }
+
+  double getZBeg() const { return mMin[2] + (mN[2] - 1) * mStep[2]; }
+  double getZEnd() const { return mMin[2]; }
+
+  int findCell(const double* x) const;
+
+  bool field(const double* x, double* b) const;
+
+  std::size_t getNPoints() const { return mField.size() / 3; }
+
+ private:
+  int mN[3] = {0, 0, 0};             ///< number of grid points in x, y and z
+  double mMin[3] = {0., 0., 0.};     ///< position of the first grid point in x, y and z (cm)
+  double mStep[3] = {0., 0., 0.};    ///< distance between grid points in x, y and z (cm)
+  double mInvStep[3] = {0., 0., 0.}; ///< inverse of the distance between grid points (1/cm)
+  std::vector<float> mField{};       ///< field components (kG) at each grid point, x running fastest
+};
+
+} // namespace mch
+} // namespace o2
+
+#endif // ALICEO2_MCH_MAGFIELDGRID_H_
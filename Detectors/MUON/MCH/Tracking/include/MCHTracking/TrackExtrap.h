@@ -18,9 +18,14 @@
 #define ALICEO2_MCH_TRACKEXTRAP_H_
 
 #include <cstddef>
+#include <memory>
+#include <vector>
 
 #include <TMatrixD.h>
 
+#include "MCHTracking/AbsorberMaterialMap.h"
+#include "MCHTracking/MagFieldGrid.h"
+
 namespace o2
 {
 namespace mch
@@ -49,6 +54,14 @@ class TrackExtrap
   /// Switch to Runge-Kutta extrapolation v2
   static void useExtrapV2(bool extrapV2 = true) { sExtrapV2 = extrapV2; }
 
+  static bool setFieldGrid(std::shared_ptr<const MagFieldGrid> grid);
+  /// Return the grid used to get the magnetic field (nullptr if the field map is always used)
+  static const MagFieldGrid* getFieldGrid() { return sFieldGrid.get(); }
+
+  static bool setAbsorberMaterialMap(const AbsorberMaterialMap* map);
+  /// Return the material map used for the corrections in the absorber (nullptr if the geometry is navigated)
+  static const AbsorberMaterialMap* getAbsorberMaterialMap() { return sAbsorberMaterialMap; }
+
   static double getImpactParamFromBendingMomentum(double bendingMomentum);
   static double getBendingMomentumFromImpactParam(double impactParam);
 
@@ -57,6 +70,8 @@ class TrackExtrap
 
   static bool extrapToZ(TrackParam& trackParam, double zEnd);
   static bool extrapToZCov(TrackParam& trackParam, double zEnd, bool updatePropagator = false);
+  static std::size_t extrapToZCov(const std::vector<TrackParam*>& trackParams, double zEnd, bool updatePropagator,
+                                  std::vector<bool>& extrapOK);
 
   static bool extrapToVertex(TrackParam& trackParam, double xVtx, double yVtx, double zVtx, double errXVtx, double errYVtx)
   {
@@ -98,6 +113,16 @@ class TrackExtrap
                                          double& pathLength, double& f0, double& f1, double& f2,
                                          double& meanRho, double& totalELoss, double& sigmaELoss2);
 
+  static bool getAbsorberCorrectionParamFromMap(double trackXYZIn[3], double b[3], double pathLength, double pTotal,
+                                                double& f0, double& f1, double& f2, double& meanRho,
+                                                double& totalELoss, double& sigmaELoss);
+  static bool getAbsorberCorrectionParamFromGeometry(double trackXYZIn[3], double b[3], double pathLength, double pTotal,
+                                                     double& f0, double& f1, double& f2, double& meanRho,
+                                                     double& totalELoss, double& sigmaELoss);
+  static void addAbsorberSlice(const AbsorberMaterialMap::Material& material, double dzB, double dzE, double bz,
+                               double localPathLength, double pTotal, double& f0, double& f1, double& f2,
+                               double& meanRho, double& totalELoss, double& sigmaELoss);
+
   static void addMCSEffectInAbsorber(TrackParam& param, double signedPathLength, double f0, double f1, double f2);
 
   static double betheBloch(double pTotal, double pathLength, double rho, double atomicZ, double atomicZoverA);
@@ -116,6 +141,7 @@ class TrackExtrap
   static bool extrapToZRungekutta(TrackParam& trackParam, double zEnd);
   static bool extrapToZRungekuttaV2(TrackParam& trackParam, double zEnd);
   static bool extrapOneStepRungekutta(double charge, double step, const double* vect, double* vout);
+  static void getField(const double* x, double* b);
 
   static constexpr double SMuMass = 0.105658;                         ///< Muon mass (GeV/c2)
   static constexpr double SAbsZBeg = -90.;                            ///< Position of the begining of the absorber (cm)
@@ -137,11 +163,16 @@ class TrackExtrap
 
   static bool sExtrapV2; ///< switch to Runge-Kutta extrapolation v2
 
+  static std::shared_ptr<const MagFieldGrid> sFieldGrid; ///< grid of the magnetic field (use the field map if null)
+
+  static const AbsorberMaterialMap* sAbsorberMaterialMap; ///< material map of the absorber (navigate in TGeo if null)
+
   static double sSimpleBValue; ///< Magnetic field value at the centre
   static bool sFieldON;        ///< true if the field is switched ON
 
   static std::size_t sNCallExtrapToZCov; ///< number of times the method extrapToZCov(...) is called
   static std::size_t sNCallField;        ///< number of times the method Field(...) is called
+  static std::size_t sNCallFieldGrid;    ///< number of times the field is interpolated from the grid
 };
 
 } // namespace mch
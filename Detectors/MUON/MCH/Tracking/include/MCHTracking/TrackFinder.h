@@ -86,6 +86,7 @@ class TrackFinder
 
   bool isAcceptable(const TrackParam& param) const;
 
+  void extrapCandidatesToChamber(int chamber);
   void prepareForwardTracking(std::list<Track>::iterator& itTrack, bool runSmoother);
   void prepareBackwardTracking(std::list<Track>::iterator& itTrack, bool refit);
   void setCurrentParam(Track& track, const TrackParam& param, int chamber, bool smoothed = false);
@@ -126,6 +127,12 @@ class TrackFinder
                                                        0.035, 0.035, 0.035, 0.035, 0.035};
   static constexpr int SNDE[10] = {4, 4, 4, 4, 18, 18, 26, 26, 26, 26}; ///< number of DE per chamber
 
+  static constexpr double SFieldGridXYMax = 350.;  ///< half size (cm) in x and y of the magnetic field grid
+  static constexpr double SFieldGridZBeg = -480.;  ///< upstream edge (cm) of the magnetic field grid
+  static constexpr double SFieldGridZEnd = -1620.; ///< downstream edge (cm) of the magnetic field grid
+  static constexpr double SFieldGridStepXY = 10.;  ///< distance (cm) between grid points in x and y
+  static constexpr double SFieldGridStepZ = 5.;    ///< distance (cm) between grid points in z
+
   TrackFitter mTrackFitter{}; /// track fitter
 
   /// array of pointers to the lists of clusters per DE
@@ -133,6 +140,10 @@ class TrackFinder
 
   std::list<Track> mTracks{}; ///< list of reconstructed tracks
 
+  /// current parameters of some candidates already extrapolated to the chamber mChamberOfParams
+  std::unordered_map<const Track*, TrackParam> mParamsAtChamber{};
+  int mChamberOfParams = -1; ///< chamber to which the parameters in mParamsAtChamber are extrapolated
+
   double mChamberResolutionX2 = 0.;      ///< chamber resolution square (cm^2) in x direction
   double mChamberResolutionY2 = 0.;      ///< chamber resolution square (cm^2) in y direction
   double mBendingVertexDispersion2 = 0.; ///< vertex dispersion square (cm^2) in y direction
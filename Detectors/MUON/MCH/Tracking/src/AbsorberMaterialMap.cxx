@@ -0,0 +1,219 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file AbsorberMaterialMap.cxx
+/// \brief Implementation of a precomputed map of the material crossed in the front absorber
+
+#include "MCHTracking/AbsorberMaterialMap.h"
+
+#include <algorithm>
+#include <memory>
+
+#include <TFile.h>
+#include <TGeoManager.h>
+#include <TGeoMaterial.h>
+#include <TGeoNode.h>
+#include <TGeoShape.h>
+#include <TMath.h>
+
+#include "Framework/Logger.h"
+
+namespace o2
+{
+namespace mch
+{
+
+//__________________________________________________________________________
+AbsorberMaterialMap::Material AbsorberMaterialMap::getMaterialProperties(const TGeoMaterial& material)
+{
+  /// Return the properties of the material relevant for the absorber corrections
+  Material properties{};
+  properties.rho = material.GetDensity();
+  properties.x0 = material.GetRadLen();
+  properties.atomicZ = material.GetZ();
+  if (material.IsMixture()) {
+    const auto& mixture = static_cast<const TGeoMixture&>(material);
+    double sum(0.);
+    for (int iel = 0; iel < mixture.GetNelements(); ++iel) {
+      sum += mixture.GetWmixt()[iel];
+      properties.atomicZoverA += mixture.GetWmixt()[iel] * mixture.GetZmixt()[iel] / mixture.GetAmixt()[iel];
+    }
+    properties.atomicZoverA /= sum;
+  } else {
+    properties.atomicZoverA = properties.atomicZ / material.GetA();
+  }
+  return properties;
+}
+
+//__________________________________________________________________________
+bool AbsorberMaterialMap::build(double zBeg, double zEnd, int nTanTheta, double tanThetaMax, int nPhi)
+{
+  /// Build the map by navigating in the current geometry, from zBeg to zEnd (zEnd < zBeg < 0),
+  /// along the straight line going from (0,0,0) in the direction of the center of each bin
+  /// Return false in case of failure, leaving the map invalid
+
+  *this = AbsorberMaterialMap();
+
+  if (!gGeoManager) {
+    LOG(error) << "geometry is missing";
+    return false;
+  }
+  if (zEnd >= zBeg || zBeg >= 0. || nTanTheta <= 0 || tanThetaMax <= 0. || nPhi <= 0) {
+    LOG(error) << "invalid absorber range or binning";
+    return false;
+  }
+
+  std::vector<int> firstSlice{};
+  firstSlice.reserve(nTanTheta * nPhi + 1);
+  for (int iTanTheta = 0; iTanTheta < nTanTheta; ++iTanTheta) {
+    double tanTheta = (iTanTheta + 0.5) * tanThetaMax / nTanTheta;
+    double norm = TMath::Sqrt(1. + tanTheta * tanTheta);
+    for (int iPhi = 0; iPhi < nPhi; ++iPhi) {
+
+      firstSlice.push_back(mSlices.size());
+
+      // Initialize starting point and direction
+      double phi = (iPhi + 0.5) * TMath::TwoPi() / nPhi;
+      double b[3] = {tanTheta * TMath::Cos(phi) / norm, tanTheta * TMath::Sin(phi) / norm, -1. / norm};
+      double xyzBeg[3] = {zBeg * b[0] / b[2], zBeg * b[1] / b[2], zBeg};
+      TGeoNode* currentnode = gGeoManager->InitTrack(xyzBeg, b);
+      if (!currentnode) {
+        LOG(error) << "starting point out of geometry";
+        mSlices.clear();
+        mMaterials.clear();
+        return false;
+      }
+
+      // loop over absorber slices, following the same navigation as TrackExtrap::getAbsorberCorrectionParam
+      double zB = zBeg;
+      double remainingPathLength = (zEnd - zBeg) / b[2];
+      do {
+        int material = addMaterial(getMaterialProperties(*currentnode->GetVolume()->GetMedium()->GetMaterial()));
+
+        gGeoManager->FindNextBoundary(remainingPathLength);
+        double localPathLength = gGeoManager->GetStep() + 1.e-6;
+        if (localPathLength >= remainingPathLength) {
+          localPathLength = remainingPathLength;
+        } else {
+          currentnode = gGeoManager->Step();
+          if (currentnode && !gGeoManager->IsEntering()) {
+            // make another small step to try to enter in new absorber slice
+            gGeoManager->SetStep(0.001);
+            currentnode = gGeoManager->Step();
+            if (!gGeoManager->IsEntering()) {
+              currentnode = nullptr;
+            }
+            localPathLength += 0.001;
+          }
+          if (!currentnode) {
+            LOG(error) << "navigation failed at tan(theta) = " << tanTheta << ", phi = " << phi;
+            mSlices.clear();
+            mMaterials.clear();
+            return false;
+          }
+        }
+
+        // merge consecutive slices of the same material
+        double zE = b[2] * localPathLength + zB;
+        if (mSlices.size() > static_cast<size_t>(firstSlice.back()) && mSlices.back().material == material) {
+          mSlices.back().dZ += zB - zE;
+        } else {
+          mSlices.emplace_back();
+          mSlices.back().dZ = zB - zE;
+          mSlices.back().material = material;
+        }
+
+        // prepare next step
+        zB = zE;
+        remainingPathLength -= localPathLength;
+      } while (remainingPathLength > TGeoShape::Tolerance());
+    }
+  }
+  firstSlice.push_back(mSlices.size());
+
+  mZBeg = zBeg;
+  mZEnd = zEnd;
+  mNTanTheta = nTanTheta;
+  mTanThetaMax = tanThetaMax;
+  mNPhi = nPhi;
+  mFirstSlice = std::move(firstSlice);
+
+  LOG(info) << "absorber material map built with " << getNBins() << " directions, " << mSlices.size()
+            << " slices and " << mMaterials.size() << " materials";
+
+  return true;
+}
+
+//__________________________________________________________________________
+int AbsorberMaterialMap::findBin(double dirX, double dirY, double dirZ) const
+{
+  /// Return the bin of the direction (dirX, dirY, dirZ) or -1 if it is outside of the map
+  if (!isValid() || dirZ >= 0.) {
+    return -1;
+  }
+  double tanTheta = TMath::Sqrt(dirX * dirX + dirY * dirY) / -dirZ;
+  if (tanTheta >= mTanThetaMax) {
+    return -1;
+  }
+  double phi = TMath::ATan2(dirY, dirX);
+  if (phi < 0.) {
+    phi += TMath::TwoPi();
+  }
+  int iTanTheta = static_cast<int>(tanTheta / mTanThetaMax * mNTanTheta);
+  int iPhi = std::min(static_cast<int>(phi / TMath::TwoPi() * mNPhi), mNPhi - 1);
+  return iTanTheta * mNPhi + iPhi;
+}
+
+//__________________________________________________________________________
+int AbsorberMaterialMap::addMaterial(const Material& material)
+{
+  /// Return the index of the material, adding it to the list if not already there
+  for (size_t i = 0; i < mMaterials.size(); ++i) {
+    const auto& m = mMaterials[i];
+    if (m.rho == material.rho && m.x0 == material.x0 && m.atomicZ == material.atomicZ && m.atomicZoverA == material.atomicZoverA) {
+      return i;
+    }
+  }
+  mMaterials.push_back(material);
+  return mMaterials.size() - 1;
+}
+
+//__________________________________________________________________________
+bool AbsorberMaterialMap::writeTo(const std::string& fileName) const
+{
+  /// Write the map in a ROOT file, under the same key as used for CCDB objects
+  std::unique_ptr<TFile> file(TFile::Open(fileName.c_str(), "RECREATE"));
+  if (!file || file->IsZombie()) {
+    LOG(error) << "cannot open file " << fileName;
+    return false;
+  }
+  return file->WriteObjectAny(this, "o2::mch::AbsorberMaterialMap", "ccdb_object") > 0;
+}
+
+//__________________________________________________________________________
+AbsorberMaterialMap* AbsorberMaterialMap::loadFrom(const std::string& fileName)
+{
+  /// Read the map from a ROOT file written with writeTo or downloaded from the CCDB
+  /// Return nullptr in case of failure. The ownership is transferred to the caller
+  std::unique_ptr<TFile> file(TFile::Open(fileName.c_str(), "READ"));
+  if (!file || file->IsZombie()) {
+    LOG(error) << "cannot open file " << fileName;
+    return nullptr;
+  }
+  auto map = file->Get<AbsorberMaterialMap>("ccdb_object");
+  if (!map) {
+    LOG(error) << "no absorber material map in file " << fileName;
+  }
+  return map;
+}
+
+} // namespace mch
+} // namespace o2
@@ -17,5 +17,10 @@
 
 #pragma link C++ class o2::mch::TrackerParam + ;
 #pragma link C++ class o2::conf::ConfigurableParamHelper < o2::mch::TrackerParam> + ;
+#pragma link C++ class o2::mch::AbsorberMaterialMap + ;
+#pragma link C++ class o2::mch::AbsorberMaterialMap::Material + ;
+#pragma link C++ class o2::mch::AbsorberMaterialMap::Slice + ;
+#pragma link C++ class std::vector < o2::mch::AbsorberMaterialMap::Material> + ;
+#pragma link C++ class std::vector < o2::mch::AbsorberMaterialMap::Slice> + ;
 
 #endif
@@ -0,0 +1,135 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file MagFieldGrid.cxx
+/// \brief Implementation of a cache of the magnetic field on a regular grid in the muon spectrometer
+
+#include "MCHTracking/MagFieldGrid.h"
+
+#include <cmath>
+#include <utility>
+
+#include <TGeoGlobalMagField.h>
+
+#include "Framework/Logger.h"
+
+namespace o2
+{
+namespace mch
+{
+
+//__________________________________________________________________________
+bool MagFieldGrid::build(double xMax, double yMax, double zBeg, double zEnd, double stepXY, double stepZ)
+{
+  /// Fill the grid with the current field in the volume |x| < xMax, |y| < yMax, zEnd < z < zBeg (zEnd < zBeg),
+  /// the grid being extended if needed to have an integer number of steps in each direction
+  /// Return false in case of failure, leaving the grid invalid
+
+  *this = MagFieldGrid();
+
+  if (!TGeoGlobalMagField::Instance()->GetField()) {
+    LOG(error) << "magnetic field is missing";
+    return false;
+  }
+  if (xMax <= 0. || yMax <= 0. || zEnd >= zBeg || stepXY <= 0. || stepZ <= 0.) {
+    LOG(error) << "invalid grid range or binning";
+    return false;
+  }
+
+  int n[3] = {static_cast<int>(std::ceil(2. * xMax / stepXY)) + 1,
+              static_cast<int>(std::ceil(2. * yMax / stepXY)) + 1,
+              static_cast<int>(std::ceil((zBeg - zEnd) / stepZ)) + 1};
+  double step[3] = {stepXY, stepXY, stepZ};
+  double min[3] = {-0.5 * (n[0] - 1) * stepXY, -0.5 * (n[1] - 1) * stepXY, zEnd};
+
+  std::vector<float> field(3 * static_cast<std::size_t>(n[0]) * n[1] * n[2]);
+  auto itField = field.begin();
+  double x[3] = {0., 0., 0.};
+  double b[3] = {0., 0., 0.};
+  for (int iz = 0; iz < n[2]; ++iz) {
+    x[2] = min[2] + iz * step[2];
+    for (int iy = 0; iy < n[1]; ++iy) {
+      x[1] = min[1] + iy * step[1];
+      for (int ix = 0; ix < n[0]; ++ix) {
+        x[0] = min[0] + ix * step[0];
+        TGeoGlobalMagField::Instance()->Field(x, b);
+        *itField++ = b[0];
+        *itField++ = b[1];
+        *itField++ = b[2];
+      }
+    }
+  }
+
+  for (int i = 0; i < 3; ++i) {
+    mN[i] = n[i];
+    mMin[i] = min[i];
+    mStep[i] = step[i];
+    mInvStep[i] = 1. / step[i];
+  }
+  mField = std::move(field);
+
+  LOG(info) << "magnetic field grid built with " << n[0] << " x " << n[1] << " x " << n[2] << " points in |x| < "
+            << -mMin[0] << ", |y| < " << -mMin[1] << ", " << getZEnd() << " < z < " << getZBeg();
+
+  return true;
+}
+
+//__________________________________________________________________________
+int MagFieldGrid::findCell(const double* x) const
+{
+  /// Return the index of the grid point at the lower corner of the cell containing the position x
+  /// or -1 if this position is outside of the grid
+  int index[3] = {0, 0, 0};
+  for (int i = 0; i < 3; ++i) {
+    double pos = (x[i] - mMin[i]) * mInvStep[i];
+    if (!(pos >= 0. && pos < mN[i] - 1)) {
+      return -1;
+    }
+    index[i] = static_cast<int>(pos);
+  }
+  return (index[2] * mN[1] + index[1]) * mN[0] + index[0];
+}
+
+//__________________________________________________________________________
+bool MagFieldGrid::field(const double* x, double* b) const
+{
+  /// Return in b the field (kG) at the position x (cm), interpolated between the 8 corners of its cell
+  /// Return false, leaving b unchanged, if this position is outside of the grid
+  int index[3] = {0, 0, 0};
+  double u[3] = {0., 0., 0.};
+  for (int i = 0; i < 3; ++i) {
+    double pos = (x[i] - mMin[i]) * mInvStep[i];
+    if (!(pos >= 0. && pos < mN[i] - 1)) {
+      return false;
+    }
+    index[i] = static_cast<int>(pos);
+    u[i] = pos - index[i];
+  }
+
+  const std::size_t dx = 3;
+  const std::size_t dy = 3 * static_cast<std::size_t>(mN[0]);
+  const std::size_t dz = dy * mN[1];
+  const float* b000 = &mField[index[2] * dz + index[1] * dy + index[0] * dx];
+  for (int i = 0; i < 3; ++i) {
+    double b00 = b000[i] + u[0] * (b000[dx + i] - b000[i]);
+    double b10 = b000[dy + i] + u[0] * (b000[dy + dx + i] - b000[dy + i]);
+    double b01 = b000[dz + i] + u[0] * (b000[dz + dx + i] - b000[dz + i]);
+    double b11 = b000[dz + dy + i] + u[0] * (b000[dz + dy + dx + i] - b000[dz + dy + i]);
+    double b0 = b00 + u[1] * (b10 - b00);
+    double b1 = b01 + u[1] * (b11 - b01);
+    b[i] = b0 + u[2] * (b1 - b0);
+  }
+
+  return true;
+}
+
+} // namespace mch
+} // namespace o2
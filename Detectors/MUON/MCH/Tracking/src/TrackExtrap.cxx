@@ -16,6 +16,10 @@
 
 #include "MCHTracking/TrackExtrap.h"
 
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
 #include <TGeoGlobalMagField.h>
 #include <TGeoManager.h>
 #include <TGeoMaterial.h>
@@ -33,10 +37,13 @@ namespace mch
 {
 
 bool TrackExtrap::sExtrapV2 = false;
+std::shared_ptr<const MagFieldGrid> TrackExtrap::sFieldGrid{};
+const AbsorberMaterialMap* TrackExtrap::sAbsorberMaterialMap = nullptr;
 double TrackExtrap::sSimpleBValue = 0.;
 bool TrackExtrap::sFieldON = false;
 std::size_t TrackExtrap::sNCallExtrapToZCov = 0;
 std::size_t TrackExtrap::sNCallField = 0;
+std::size_t TrackExtrap::sNCallFieldGrid = 0;
 
 //__________________________________________________________________________
 void TrackExtrap::setField()
@@ -49,6 +56,43 @@ void TrackExtrap::setField()
   sSimpleBValue = b[0];
   sFieldON = (TMath::Abs(sSimpleBValue) > 1.e-10) ? true : false;
   LOG(info) << "Track extrapolation with magnetic field " << (sFieldON ? "ON" : "OFF");
+  // stop using the magnetic field grid, built from the previous field map
+  if (sFieldGrid) {
+    setFieldGrid(nullptr);
+  }
+}
+
+//__________________________________________________________________________
+bool TrackExtrap::setFieldGrid(std::shared_ptr<const MagFieldGrid> grid)
+{
+  /// Interpolate the magnetic field from the grid, where it is defined, instead of calling the field map.
+  /// The grid must have been built from the current field map. The field map is still used outside of it.
+  /// Passing a null pointer restores the use of the field map everywhere. The ownership of the grid is shared,
+  /// so that it is kept as long as it is used, whoever built it, and released when replaced or when the field changes.
+  /// Return false, and keep the current settings, if the grid is not valid
+  if (grid && !grid->isValid()) {
+    LOG(error) << "the magnetic field grid is not valid";
+    return false;
+  }
+  sFieldGrid = std::move(grid);
+  LOG(info) << "Magnetic field taken " << (sFieldGrid ? "from the grid when possible" : "from the field map");
+  return true;
+}
+
+//__________________________________________________________________________
+bool TrackExtrap::setAbsorberMaterialMap(const AbsorberMaterialMap* map)
+{
+  /// Use the material map to compute the corrections in the absorber instead of navigating in the geometry.
+  /// The geometry is still used, if available, for the directions not covered by the map.
+  /// Passing a null pointer restores the navigation in the geometry. The map is not owned.
+  /// Return false, and keep the current settings, if the map does not cover the whole absorber
+  if (map && (!map->isValid() || map->getZBeg() < SAbsZBeg || map->getZEnd() > SAbsZEnd)) {
+    LOG(error) << "the absorber material map does not cover the absorber (" << SAbsZBeg << ", " << SAbsZEnd << ")";
+    return false;
+  }
+  sAbsorberMaterialMap = map;
+  LOG(info) << "Absorber corrections computed " << (map ? "from the material map" : "by navigating in the geometry");
+  return true;
 }
 
 //__________________________________________________________________________
@@ -248,6 +292,40 @@ bool TrackExtrap::extrapToZCov(TrackParam& trackParam, double zEnd, bool updateP
   return true;
 }
 
+//__________________________________________________________________________
+std::size_t TrackExtrap::extrapToZCov(const std::vector<TrackParam*>& trackParams, double zEnd, bool updatePropagator,
+                                      std::vector<bool>& extrapOK)
+{
+  /// Track parameters and their covariances of several tracks extrapolated to the same plane at "zEnd".
+  /// On return, extrapOK tells for each track whether the extrapolation succeeded, in which case
+  /// the results are updated in its trackParam, and the number of successful extrapolations is returned.
+  /// When the field is taken from the grid, the tracks are processed in the order of the grid cell
+  /// they start from, so that the tracks crossing the same region of the grid follow each other.
+
+  extrapOK.assign(trackParams.size(), false);
+
+  std::vector<std::size_t> order(trackParams.size());
+  std::iota(order.begin(), order.end(), 0);
+  if (sFieldON && sFieldGrid) {
+    std::vector<int> cells(trackParams.size());
+    for (std::size_t i = 0; i < trackParams.size(); ++i) {
+      const double x[3] = {trackParams[i]->getNonBendingCoor(), trackParams[i]->getBendingCoor(), trackParams[i]->getZ()};
+      cells[i] = sFieldGrid->findCell(x);
+    }
+    std::stable_sort(order.begin(), order.end(), [&cells](std::size_t i, std::size_t j) { return cells[i] < cells[j]; });
+  }
+
+  std::size_t nOK(0);
+  for (auto i : order) {
+    if (extrapToZCov(*trackParams[i], zEnd, updatePropagator)) {
+      extrapOK[i] = true;
+      ++nOK;
+    }
+  }
+
+  return nOK;
+}
+
 //__________________________________________________________________________
 bool TrackExtrap::extrapToMID(TrackParam& trackParam)
 {
@@ -397,12 +475,6 @@ bool TrackExtrap::getAbsorberCorrectionParam(double trackXYZIn[3], double trackX
   /// totalELoss:  total energy loss in absorber
   /// sigmaELoss2: square of energy loss fluctuation in absorber
 
-  // Check whether the geometry is available
-  if (!gGeoManager) {
-    LOG(warning) << "geometry is missing";
-    return false;
-  }
-
   // Initialize starting point and direction
   pathLength = TMath::Sqrt((trackXYZOut[0] - trackXYZIn[0]) * (trackXYZOut[0] - trackXYZIn[0]) +
                            (trackXYZOut[1] - trackXYZIn[1]) * (trackXYZOut[1] - trackXYZIn[1]) +
@@ -412,6 +484,71 @@ bool TrackExtrap::getAbsorberCorrectionParam(double trackXYZIn[3], double trackX
     return false;
   }
   double b[3] = {(trackXYZOut[0] - trackXYZIn[0]) / pathLength, (trackXYZOut[1] - trackXYZIn[1]) / pathLength, (trackXYZOut[2] - trackXYZIn[2]) / pathLength};
+
+  // use the material map if any and if it covers this direction, or navigate in the geometry
+  f0 = f1 = f2 = meanRho = totalELoss = 0.;
+  double sigmaELoss(0.);
+  if (!getAbsorberCorrectionParamFromMap(trackXYZIn, b, pathLength, pTotal, f0, f1, f2, meanRho, totalELoss, sigmaELoss) &&
+      !getAbsorberCorrectionParamFromGeometry(trackXYZIn, b, pathLength, pTotal, f0, f1, f2, meanRho, totalELoss, sigmaELoss)) {
+    return false;
+  }
+
+  meanRho /= pathLength;
+  sigmaELoss2 = sigmaELoss * sigmaELoss;
+
+  return true;
+}
+
+//__________________________________________________________________________
+bool TrackExtrap::getAbsorberCorrectionParamFromMap(double trackXYZIn[3], double b[3], double pathLength, double pTotal,
+                                                    double& f0, double& f1, double& f2, double& meanRho,
+                                                    double& totalELoss, double& sigmaELoss)
+{
+  /// Accumulate the absorber parameters along the straight line starting at trackXYZIn in the direction b,
+  /// using the material crossed in the same direction according to the material map
+  /// Return false, without accumulating anything, if there is no map or if it does not cover this direction
+
+  if (!sAbsorberMaterialMap) {
+    return false;
+  }
+  int iBin = sAbsorberMaterialMap->findBin(b[0], b[1], b[2]);
+  if (iBin < 0) {
+    return false;
+  }
+
+  // loop over the slices of the map, restricted to the z range of the track
+  double zIn = trackXYZIn[2];
+  double zOut = zIn + b[2] * pathLength;
+  double zB = sAbsorberMaterialMap->getZBeg();
+  for (int iSlice = sAbsorberMaterialMap->getFirstSlice(iBin); iSlice < sAbsorberMaterialMap->getLastSlice(iBin); ++iSlice) {
+    const auto& slice = sAbsorberMaterialMap->getSlice(iSlice);
+    double zE = zB - slice.dZ;
+    double zBInTrack = (zB < zIn) ? zB : zIn;
+    double zEInTrack = (zE > zOut) ? zE : zOut;
+    if (zBInTrack > zEInTrack) {
+      addAbsorberSlice(sAbsorberMaterialMap->getMaterial(slice.material), zBInTrack - zIn, zEInTrack - zIn, b[2],
+                       (zEInTrack - zBInTrack) / b[2], pTotal, f0, f1, f2, meanRho, totalELoss, sigmaELoss);
+    }
+    zB = zE;
+  }
+
+  return true;
+}
+
+//__________________________________________________________________________
+bool TrackExtrap::getAbsorberCorrectionParamFromGeometry(double trackXYZIn[3], double b[3], double pathLength, double pTotal,
+                                                         double& f0, double& f1, double& f2, double& meanRho,
+                                                         double& totalELoss, double& sigmaELoss)
+{
+  /// Accumulate the absorber parameters along the straight line starting at trackXYZIn in the direction b,
+  /// over pathLength, by navigating in the geometry
+
+  // Check whether the geometry is available
+  if (!gGeoManager) {
+    LOG(warning) << "geometry is missing";
+    return false;
+  }
+
   TGeoNode* currentnode = gGeoManager->InitTrack(trackXYZIn, b);
   if (!currentnode) {
     LOG(warning) << "starting point out of geometry";
@@ -419,29 +556,12 @@ bool TrackExtrap::getAbsorberCorrectionParam(double trackXYZIn[3], double trackX
   }
 
   // loop over absorber slices and calculate absorber's parameters
-  f0 = f1 = f2 = meanRho = totalELoss = 0.;
-  double sigmaELoss(0.);
   double zB = trackXYZIn[2];
   double remainingPathLength = pathLength;
   do {
 
     // Get material properties
-    TGeoMaterial* material = currentnode->GetVolume()->GetMedium()->GetMaterial();
-    double rho = material->GetDensity(); // material density (g/cm3)
-    double x0 = material->GetRadLen();   // radiation-length (cm-1)
-    double atomicZ = material->GetZ();   // Z of material
-    double atomicZoverA(0.);             // Z/A of material
-    if (material->IsMixture()) {
-      TGeoMixture* mixture = static_cast<TGeoMixture*>(material);
-      double sum(0.);
-      for (int iel = 0; iel < mixture->GetNelements(); ++iel) {
-        sum += mixture->GetWmixt()[iel];
-        atomicZoverA += mixture->GetWmixt()[iel] * mixture->GetZmixt()[iel] / mixture->GetAmixt()[iel];
-      }
-      atomicZoverA /= sum;
-    } else {
-      atomicZoverA = atomicZ / material->GetA();
-    }
+    auto material = AbsorberMaterialMap::getMaterialProperties(*currentnode->GetVolume()->GetMedium()->GetMaterial());
 
     // Get path length within this material
     gGeoManager->FindNextBoundary(remainingPathLength);
@@ -469,26 +589,32 @@ bool TrackExtrap::getAbsorberCorrectionParam(double trackXYZIn[3], double trackX
 
     // calculate absorber's parameters
     double zE = b[2] * localPathLength + zB;
-    double dzB = zB - trackXYZIn[2];
-    double dzE = zE - trackXYZIn[2];
-    f0 += localPathLength / x0;
-    f1 += (dzE * dzE - dzB * dzB) / b[2] / b[2] / x0 / 2.;
-    f2 += (dzE * dzE * dzE - dzB * dzB * dzB) / b[2] / b[2] / b[2] / x0 / 3.;
-    meanRho += localPathLength * rho;
-    totalELoss += betheBloch(pTotal, localPathLength, rho, atomicZ, atomicZoverA);
-    sigmaELoss += energyLossFluctuation(pTotal, localPathLength, rho, atomicZoverA);
+    addAbsorberSlice(material, zB - trackXYZIn[2], zE - trackXYZIn[2], b[2], localPathLength, pTotal,
+                     f0, f1, f2, meanRho, totalELoss, sigmaELoss);
 
     // prepare next step
     zB = zE;
     remainingPathLength -= localPathLength;
   } while (remainingPathLength > TGeoShape::Tolerance());
 
-  meanRho /= pathLength;
-  sigmaELoss2 = sigmaELoss * sigmaELoss;
-
   return true;
 }
 
+//__________________________________________________________________________
+void TrackExtrap::addAbsorberSlice(const AbsorberMaterialMap::Material& material, double dzB, double dzE, double bz,
+                                   double localPathLength, double pTotal, double& f0, double& f1, double& f2,
+                                   double& meanRho, double& totalELoss, double& sigmaELoss)
+{
+  /// Add the contribution of a slice of material crossed over localPathLength, from dzB to dzE
+  /// with respect to the starting point of the track, in the direction of z-component bz
+  f0 += localPathLength / material.x0;
+  f1 += (dzE * dzE - dzB * dzB) / bz / bz / material.x0 / 2.;
+  f2 += (dzE * dzE * dzE - dzB * dzB * dzB) / bz / bz / bz / material.x0 / 3.;
+  meanRho += localPathLength * material.rho;
+  totalELoss += betheBloch(pTotal, localPathLength, material.rho, material.atomicZ, material.atomicZoverA);
+  sigmaELoss += energyLossFluctuation(pTotal, localPathLength, material.rho, material.atomicZoverA);
+}
+
 //__________________________________________________________________________
 double TrackExtrap::getMCSAngle2(const TrackParam& param, double dZ, double x0)
 {
@@ -1066,8 +1192,7 @@ bool TrackExtrap::extrapOneStepRungekutta(double charge, double step, const doub
       h = rest;
     }
     // cmodif: call gufld(vout,f) changed into:
-    TGeoGlobalMagField::Instance()->Field(vout, f);
-    ++sNCallField;
+    getField(vout, f);
 
     // *
     // *             start of integration
@@ -1115,8 +1240,7 @@ bool TrackExtrap::extrapOneStepRungekutta(double charge, double step, const doub
     xyzt[2] = zt;
 
     // cmodif: call gufld(xyzt,f) changed into:
-    TGeoGlobalMagField::Instance()->Field(xyzt, f);
-    ++sNCallField;
+    getField(xyzt, f);
 
     at = a + secxs[0];
     bt = b + secys[0];
@@ -1155,8 +1279,7 @@ bool TrackExtrap::extrapOneStepRungekutta(double charge, double step, const doub
     xyzt[2] = zt;
 
     // cmodif: call gufld(xyzt,f) changed into:
-    TGeoGlobalMagField::Instance()->Field(xyzt, f);
-    ++sNCallField;
+    getField(xyzt, f);
 
     z = z + (c + (seczs[0] + seczs[1] + seczs[2]) * kthird) * h;
     y = y + (b + (secys[0] + secys[1] + secys[2]) * kthird) * h;
@@ -1255,12 +1378,26 @@ bool TrackExtrap::extrapOneStepRungekutta(double charge, double step, const doub
   return true;
 }
 
+//__________________________________________________________________________
+void TrackExtrap::getField(const double* x, double* b)
+{
+  /// Get the magnetic field at the position x, from the grid if it is set and covers this position
+  /// or from the field map otherwise
+  if (sFieldGrid && sFieldGrid->field(x, b)) {
+    ++sNCallFieldGrid;
+    return;
+  }
+  TGeoGlobalMagField::Instance()->Field(x, b);
+  ++sNCallField;
+}
+
 //__________________________________________________________________________
 void TrackExtrap::printNCalls()
 {
   /// Print the number of times some methods are called
   LOG(info) << "number of times extrapToZCov() is called = " << sNCallExtrapToZCov;
   LOG(info) << "number of times Field() is called = " << sNCallField;
+  LOG(info) << "number of times the field is interpolated from the grid = " << sNCallFieldGrid;
 }
 
 } // namespace mch
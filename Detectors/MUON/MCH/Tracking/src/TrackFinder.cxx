@@ -18,6 +18,7 @@
 
 #include <cassert>
 #include <iostream>
+#include <memory>
 #include <stdexcept>
 
 #include <TGeoGlobalMagField.h>
@@ -47,8 +48,16 @@ void TrackFinder::init(float l3Current, float dipoleCurrent)
   // create the magnetic field map if not already done
   mTrackFitter.initField(l3Current, dipoleCurrent);
 
-  // Set the parameters used for fitting the tracks during the tracking
+  // interpolate the magnetic field from a grid covering the tracking chambers if requested and not already done
   const auto& trackerParam = TrackerParam::Instance();
+  if (trackerParam.useFieldGrid && TrackExtrap::isFieldON() && !TrackExtrap::getFieldGrid()) {
+    auto fieldGrid = std::make_shared<MagFieldGrid>();
+    if (fieldGrid->build(SFieldGridXYMax, SFieldGridXYMax, SFieldGridZBeg, SFieldGridZEnd, SFieldGridStepXY, SFieldGridStepZ)) {
+      TrackExtrap::setFieldGrid(std::move(fieldGrid));
+    }
+  }
+
+  // Set the parameters used for fitting the tracks during the tracking
   mTrackFitter.setBendingVertexDispersion(trackerParam.bendingVertexDispersion);
   mTrackFitter.setChamberResolution(trackerParam.chamberResolutionX, trackerParam.chamberResolutionY);
   mTrackFitter.smoothTracks(true);
@@ -176,14 +185,17 @@ const std::list<Track>& TrackFinder::findTracks(const std::unordered_map<int, st
   print("------ list of track candidates ------");
   printTracks();
 
-  // track each candidate down to chamber 1 and remove it
+  // track each candidate down to chamber 1 and remove it,
+  // after extrapolating all of them at once through the dipole to chamber 6
   tStart = std::chrono::high_resolution_clock::now();
+  extrapCandidatesToChamber(5);
   for (auto itTrack = mTracks.begin(); itTrack != mTracks.end();) {
     std::unordered_map<int, std::unordered_set<uint32_t>> excludedClusters{};
     followTrackInChamber(itTrack, 5, 0, false, excludedClusters);
     print("findTracks: removing candidate at position #", getTrackIndex(itTrack));
     itTrack = mTracks.erase(itTrack);
   }
+  mParamsAtChamber.clear();
   tEnd = std::chrono::high_resolution_clock::now();
   mTimeFollowTracks += tEnd - tStart;
   print("------ list of tracks before improvement and cleaning ------");
@@ -890,9 +902,12 @@ std::list<Track>::iterator TrackFinder::followTrackInChamber(std::list<Track>::i
     return mTracks.end();
   }
 
-  // extrapolate the candidate to the chamber if not already there
-  TrackParam paramAtChamber = itTrack->getCurrentParam();
-  if (itTrack->getCurrentChamber() != chamber && !TrackExtrap::extrapToZCov(paramAtChamber, SDefaultChamberZ[chamber], true)) {
+  // extrapolate the candidate to the chamber if not already there or already done together with the other candidates
+  auto itParamAtChamber = (chamber == mChamberOfParams && itTrack->getCurrentChamber() != chamber) ? mParamsAtChamber.find(&*itTrack) : mParamsAtChamber.end();
+  TrackParam paramAtChamber = (itParamAtChamber != mParamsAtChamber.end()) ? itParamAtChamber->second : itTrack->getCurrentParam();
+  if (itParamAtChamber != mParamsAtChamber.end()) {
+    mParamsAtChamber.erase(itParamAtChamber);
+  } else if (itTrack->getCurrentChamber() != chamber && !TrackExtrap::extrapToZCov(paramAtChamber, SDefaultChamberZ[chamber], true)) {
     itTrack->invalidateCurrentParam();
     return mTracks.end();
   }
@@ -1420,6 +1435,36 @@ void TrackFinder::setCurrentParam(Track& track, const TrackParam& param, int cha
   }
 }
 
+//_________________________________________________________________________________________________
+void TrackFinder::extrapCandidatesToChamber(int chamber)
+{
+  /// Extrapolate at once to the chamber the current parameters of every candidates on an adjacent chamber
+  /// The results are stored to be used when following these candidates in that chamber
+  /// The current parameters of the candidates that cannot be extrapolated are invalidated
+
+  mParamsAtChamber.clear();
+  mChamberOfParams = chamber;
+
+  std::vector<Track*> tracks{};
+  std::vector<TrackParam*> params{};
+  for (auto& track : mTracks) {
+    if (track.areCurrentParamValid() && (track.getCurrentChamber() == chamber - 1 || track.getCurrentChamber() == chamber + 1)) {
+      tracks.push_back(&track);
+      params.push_back(&(mParamsAtChamber.emplace(&track, track.getCurrentParam()).first->second));
+    }
+  }
+
+  std::vector<bool> extrapOK{};
+  TrackExtrap::extrapToZCov(params, SDefaultChamberZ[chamber], true, extrapOK);
+
+  for (std::size_t i = 0; i < tracks.size(); ++i) {
+    if (!extrapOK[i]) {
+      tracks[i]->invalidateCurrentParam();
+      mParamsAtChamber.erase(tracks[i]);
+    }
+  }
+}
+
 //_________________________________________________________________________________________________
 bool TrackFinder::propagateCurrentParam(Track& track, int chamber)
 {
@@ -0,0 +1,249 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file   testMagFieldGrid.cxx
+/// @brief  unit tests of the magnetic field grid and of its use in the track extrapolation
+
+#define BOOST_TEST_MODULE Test MCHTracking MagFieldGrid
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <TGeoGlobalMagField.h>
+#include <TMatrixD.h>
+#include <TVirtualMagField.h>
+
+#include "CommonUtils/ConfigurableParam.h"
+#include "MCHTracking/MagFieldGrid.h"
+#include "MCHTracking/TrackExtrap.h"
+#include "MCHTracking/TrackFinder.h"
+#include "MCHTracking/TrackParam.h"
+
+using namespace o2::mch;
+
+namespace
+{
+/// Field (kG) linear in each coordinate (cm) separately, hence exactly reproduced by the trilinear interpolation
+class MultilinearField : public TVirtualMagField
+{
+ public:
+  MultilinearField() : TVirtualMagField("MultilinearField") {}
+  void Field(const Double_t* x, Double_t* b) override
+  {
+    b[0] = -5. + 2.e-3 * x[1] + 1.e-6 * x[0] * x[2];
+    b[1] = 1.e-3 * x[0] + 1.e-8 * x[0] * x[1] * x[2];
+    b[2] = 1.e-3 * x[1];
+  }
+};
+
+/// Register the field once for all the tests
+void initField()
+{
+  if (!TGeoGlobalMagField::Instance()->GetField()) {
+    TGeoGlobalMagField::Instance()->SetField(new MultilinearField());
+    TGeoGlobalMagField::Instance()->Lock();
+  }
+  TrackExtrap::setField();
+  TrackExtrap::useExtrapV2();
+}
+
+std::shared_ptr<MagFieldGrid> makeGrid()
+{
+  auto grid = std::make_shared<MagFieldGrid>();
+  BOOST_REQUIRE(grid->build(350., 350., -480., -1620., 10., 5.));
+  return grid;
+}
+
+/// Muons on chamber 8, coming from the vertex, in the acceptance
+std::vector<TrackParam> makeTracks(int nTracks)
+{
+  std::mt19937 generator(1);
+  std::uniform_real_distribution<double> uniform(0., 1.);
+  std::vector<TrackParam> tracks(nTracks);
+  TMatrixD cov(5, 5);
+  cov(0, 0) = cov(2, 2) = 0.2 * 0.2;
+  cov(1, 1) = cov(3, 3) = 1.e-3 * 1.e-3;
+  for (auto& track : tracks) {
+    double tanTheta = std::tan((2. + 7. * uniform(generator)) * M_PI / 180.);
+    double phi = 2. * M_PI * uniform(generator);
+    double nonBendingSlope = -tanTheta * std::cos(phi);
+    double bendingSlope = -tanTheta * std::sin(phi);
+    double p = 4. + 96. * uniform(generator);
+    double pYZ = p / std::sqrt(1. + nonBendingSlope * nonBendingSlope / (1. + bendingSlope * bendingSlope));
+    track.setZ(-1307.5);
+    track.setNonBendingCoor(nonBendingSlope * -1307.5);
+    track.setBendingCoor(bendingSlope * -1307.5);
+    track.setNonBendingSlope(nonBendingSlope);
+    track.setBendingSlope(bendingSlope);
+    track.setInverseBendingMomentum((uniform(generator) < 0.5 ? -1. : 1.) / pYZ);
+    cov(4, 4) = 0.01 / pYZ / pYZ;
+    track.setCovariances(cov);
+  }
+  return tracks;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(Interpolation)
+{
+  initField();
+
+  MagFieldGrid grid{};
+  BOOST_CHECK(!grid.isValid());
+  BOOST_CHECK(!grid.build(350., 350., -480., -1620., 10., 0.));
+  BOOST_CHECK(!grid.isValid());
+
+  BOOST_REQUIRE(grid.build(350., 350., -480., -1620., 10., 5.));
+  BOOST_CHECK(grid.isValid());
+  BOOST_CHECK_EQUAL(grid.getNPoints(), 71u * 71u * 229u);
+  BOOST_CHECK_CLOSE(grid.getZBeg(), -480., 1.e-9);
+  BOOST_CHECK_CLOSE(grid.getZEnd(), -1620., 1.e-9);
+
+  // the field is stored in single precision
+  std::mt19937 generator(2);
+  std::uniform_real_distribution<double> xy(-349., 349.);
+  std::uniform_real_distribution<double> z(-1619., -481.);
+  for (int i = 0; i < 10000; ++i) {
+    double x[3] = {xy(generator), xy(generator), z(generator)};
+    double bMap[3] = {0., 0., 0.};
+    double bGrid[3] = {0., 0., 0.};
+    TGeoGlobalMagField::Instance()->Field(x, bMap);
+    BOOST_REQUIRE(grid.field(x, bGrid));
+    BOOST_REQUIRE_GE(grid.findCell(x), 0);
+    for (int j = 0; j < 3; ++j) {
+      BOOST_CHECK_SMALL(bGrid[j] - bMap[j], 1.e-5);
+    }
+  }
+
+  // the field is not interpolated outside of the grid
+  const std::vector<std::array<double, 3>> outside{{400., 0., -1000.}, {0., -400., -1000.}, {0., 0., -400.}, {0., 0., -1700.}};
+  for (const auto& pos : outside) {
+    double b[3] = {1., 2., 3.};
+    BOOST_CHECK(!grid.field(pos.data(), b));
+    BOOST_CHECK_EQUAL(grid.findCell(pos.data()), -1);
+    BOOST_CHECK_EQUAL(b[0], 1.);
+    BOOST_CHECK_EQUAL(b[1], 2.);
+    BOOST_CHECK_EQUAL(b[2], 3.);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Extrapolation)
+{
+  initField();
+  BOOST_REQUIRE(TrackExtrap::isFieldON());
+  const int nTracks = 1000;
+  const double zEnd = -967.5;
+  auto tracksMap = makeTracks(nTracks);
+  auto tracksGrid = tracksMap;
+  auto tracksGridBatch = tracksMap;
+
+  // extrapolate the tracks one by one with the field map, then with the grid, then all at once with the grid
+  BOOST_REQUIRE(TrackExtrap::getFieldGrid() == nullptr);
+  std::vector<bool> extrapOKMap{};
+  for (auto& track : tracksMap) {
+    extrapOKMap.push_back(TrackExtrap::extrapToZCov(track, zEnd));
+  }
+  BOOST_REQUIRE(TrackExtrap::setFieldGrid(makeGrid()));
+  std::vector<bool> extrapOKGrid{};
+  for (auto& track : tracksGrid) {
+    extrapOKGrid.push_back(TrackExtrap::extrapToZCov(track, zEnd));
+  }
+  std::vector<TrackParam*> params{};
+  for (auto& track : tracksGridBatch) {
+    params.push_back(&track);
+  }
+  std::vector<bool> extrapOKGridBatch{};
+  auto nOK = TrackExtrap::extrapToZCov(params, zEnd, false, extrapOKGridBatch);
+  TrackExtrap::setFieldGrid(nullptr);
+
+  BOOST_CHECK_EQUAL(nOK, static_cast<std::size_t>(std::count(extrapOKGrid.begin(), extrapOKGrid.end(), true)));
+  BOOST_CHECK(extrapOKGridBatch == extrapOKGrid);
+  for (int i = 0; i < nTracks; ++i) {
+    BOOST_TEST_CONTEXT("track " << i)
+    {
+      BOOST_REQUIRE(extrapOKGrid[i] == extrapOKMap[i]);
+      if (!extrapOKGrid[i]) {
+        continue;
+      }
+      // the interpolated field only differs from the field map by the rounding to single precision
+      BOOST_CHECK_SMALL(tracksGrid[i].getNonBendingCoor() - tracksMap[i].getNonBendingCoor(), 1.e-4);
+      BOOST_CHECK_SMALL(tracksGrid[i].getBendingCoor() - tracksMap[i].getBendingCoor(), 1.e-4);
+      BOOST_CHECK_SMALL(tracksGrid[i].getNonBendingSlope() - tracksMap[i].getNonBendingSlope(), 1.e-7);
+      BOOST_CHECK_SMALL(tracksGrid[i].getBendingSlope() - tracksMap[i].getBendingSlope(), 1.e-7);
+      BOOST_CHECK_CLOSE(tracksGrid[i].getInverseBendingMomentum(), tracksMap[i].getInverseBendingMomentum(), 1.e-4);
+      // the tracks extrapolated all at once give exactly the same results as one by one
+      for (int j = 0; j < 5; ++j) {
+        BOOST_CHECK_EQUAL(tracksGridBatch[i].getParameters()(j, 0), tracksGrid[i].getParameters()(j, 0));
+        for (int k = 0; k < 5; ++k) {
+          BOOST_CHECK_EQUAL(tracksGridBatch[i].getCovariances()(j, k), tracksGrid[i].getCovariances()(j, k));
+        }
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SharedOwnership)
+{
+  initField();
+
+  // the grid is kept as long as it is used by the track extrapolation
+  std::weak_ptr<const MagFieldGrid> usedGrid{};
+  {
+    auto grid = makeGrid();
+    usedGrid = grid;
+    BOOST_REQUIRE(TrackExtrap::setFieldGrid(grid));
+  }
+  BOOST_REQUIRE(!usedGrid.expired());
+  BOOST_CHECK_EQUAL(TrackExtrap::getFieldGrid(), usedGrid.lock().get());
+  double x[3] = {10., 20., -1000.};
+  double b[3] = {0., 0., 0.};
+  BOOST_CHECK(TrackExtrap::getFieldGrid()->field(x, b));
+
+  // an invalid grid is rejected and the current one is kept
+  BOOST_CHECK(!TrackExtrap::setFieldGrid(std::make_shared<MagFieldGrid>()));
+  BOOST_CHECK_EQUAL(TrackExtrap::getFieldGrid(), usedGrid.lock().get());
+
+  // the grid is released when the field changes
+  TrackExtrap::setField();
+  BOOST_CHECK(TrackExtrap::getFieldGrid() == nullptr);
+  BOOST_CHECK(usedGrid.expired());
+}
+
+BOOST_AUTO_TEST_CASE(TrackFinderGrid)
+{
+  initField();
+  o2::conf::ConfigurableParam::setValue("MCHTracking.useFieldGrid", "true");
+
+  // the grid built by the track finder outlives it, and is reused by the next one
+  {
+    TrackFinder finder{};
+    finder.init(0., 0.);
+  }
+  const MagFieldGrid* grid = TrackExtrap::getFieldGrid();
+  BOOST_REQUIRE(grid != nullptr);
+  BOOST_CHECK(grid->isValid());
+  {
+    TrackFinder finder{};
+    finder.init(0., 0.);
+    BOOST_CHECK_EQUAL(TrackExtrap::getFieldGrid(), grid);
+  }
+  BOOST_CHECK_EQUAL(TrackExtrap::getFieldGrid(), grid);
+
+  TrackExtrap::setFieldGrid(nullptr);
+  o2::conf::ConfigurableParam::setValue("MCHTracking.useFieldGrid", "false");
+}
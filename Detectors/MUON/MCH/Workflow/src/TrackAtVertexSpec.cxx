@@ -19,6 +19,7 @@
 #include <chrono>
 #include <stdexcept>
 #include <list>
+#include <memory>
 
 #include <gsl/span>
 #include <filesystem>
@@ -46,6 +47,7 @@
 #include "MCHBase/TrackBlock.h"
 #include "MCHTracking/TrackParam.h"
 #include "MCHTracking/TrackExtrap.h"
+#include "MCHTracking/AbsorberMaterialMap.h"
 #include "TrackAtVtxStruct.h"
 
 namespace o2
@@ -64,12 +66,14 @@ class TrackAtVertexTask
     const auto grp = o2::parameters::GRPObject::loadFrom(grpFile);
     base::Propagator::initFieldFromGRP(grp);
     TrackExtrap::setField();
-    base::GeometryManager::loadGeometry();
+    if (!mAbsorberMap) {
+      base::GeometryManager::loadGeometry();
+    }
   }
 
   void initCustom(framework::InitContext& ic)
   {
-    if (!gGeoManager) {
+    if (!gGeoManager && !mAbsorberMap) {
       o2::base::GeometryManager::loadGeometry("O2geometry.root");
       if (!gGeoManager) {
         throw std::runtime_error("cannot load the geometry");
@@ -94,6 +98,15 @@ class TrackAtVertexTask
 
     LOG(info) << "initializing track extrapolation to vertex";
 
+    // the geometry is not needed if the absorber material map is provided
+    auto absorberMapFile = ic.options().get<std::string>("absorber-map");
+    if (!absorberMapFile.empty()) {
+      mAbsorberMap.reset(AbsorberMaterialMap::loadFrom(absorberMapFile));
+      if (!mAbsorberMap || !TrackExtrap::setAbsorberMaterialMap(mAbsorberMap.get())) {
+        throw std::runtime_error("cannot use the absorber material map");
+      }
+    }
+
     auto grpFile = ic.options().get<std::string>("grp-file");
     if (std::filesystem::exists(grpFile)) {
       initFromGRP(grpFile);
@@ -214,6 +227,7 @@ class TrackAtVertexTask
     }
   }
 
+  std::unique_ptr<AbsorberMaterialMap> mAbsorberMap{};       ///< material map of the absorber, if used
   std::vector<std::vector<TrackAtVtxStruct>> mTracksAtVtx{}; ///< list of tracks extrapolated to vertex for each event
   std::chrono::duration<double> mElapsedTime{};              ///< timer
 };
@@ -231,6 +245,7 @@ o2::framework::DataProcessorSpec getTrackAtVertexSpec(const char* specName)
     AlgorithmSpec{adaptFromTask<TrackAtVertexTask>()},
     Options{
       {"grp-file", VariantType::String, o2::base::NameConf::getGRPFileName(), {"Name of the grp file"}},
+      {"absorber-map", VariantType::String, "", {"File with the absorber material map to use instead of the geometry"}},
       {"l3Current", VariantType::Float, -30000.0f, {"L3 current"}},
       {"dipoleCurrent", VariantType::Float, -6000.0f, {"Dipole current"}}}};
 }
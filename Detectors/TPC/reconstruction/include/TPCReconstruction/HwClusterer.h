@@ -111,7 +111,18 @@ class HwClusterer : public Clusterer
   ///               2 for minimum contributes only to left/older peak
   void setSplittingMode(short mode);
 
+  /// Sets the number of threads used to process the row sets of a sector in parallel
+  /// \param nThreads Number of threads, only used if compiled with OpenMP
+  void setNThreads(int nThreads);
+
  private:
+  /// Clusters found in one row set, collected separately so that the row sets can be processed in parallel
+  struct RowSetClusters {
+    std::vector<unsigned short> regions;                                 ///< Region of each cluster
+    std::vector<ClusterHardware> clusters;                               ///< Found clusters
+    std::vector<std::vector<std::pair<MCCompLabel, unsigned>>> mcLabels; ///< MC labels of each cluster
+  };
+
   /*
    * Helper functions
    */
@@ -122,14 +133,19 @@ class HwClusterer : public Clusterer
   /// \param centerPad     Pad number to be checked for cluster
   /// \param centerTime    Time to be checked for cluster
   /// \param row            Row number for cluster properties
-  void hwClusterProcessor(Vc::uint_m peakMask, unsigned qMaxIndex, short centerPad, int centerTime, unsigned short row);
+  /// \param output         Storage for the found clusters of this row set
+  void hwClusterProcessor(Vc::uint_m peakMask, unsigned qMaxIndex, short centerPad, int centerTime, unsigned short row, RowSetClusters& output);
 
-  /// HW Peak Finder
-  /// \param qMaxIndex        Buffer index of central pad
-  /// \param centerPad        Pad number to be checked for cluster
-  /// \param mappedCenterTime Time to be checked for cluster, mapped in available time space
-  /// \param row              Row number for cluster properties
-  void hwPeakFinder(unsigned qMaxIndex, short centerPad, int mappedCenterTime, unsigned short row);
+  /// HW Peak Finder, computes the peak and minimum relations of all pads of a row set in one time bin
+  /// \param mappedTime         Time to be checked for peaks, mapped in available time space
+  /// \param mappedPreviousTime Previous time bin, mapped in available time space
+  /// \param row                Row set number
+  void hwPeakFinder(unsigned mappedTime, unsigned mappedPreviousTime, unsigned short row);
+
+  /// Finds the clusters of a row set in given timebin
+  /// \param timebin  Timebin to cluster peaks
+  /// \param row      Row set number
+  void computeClusterForRowSet(int timebin, unsigned short row);
 
   /// Helper function to update cluster properties and MC labels
   /// \param selectionMask  VC-mask with slected pads enabled
@@ -200,6 +216,7 @@ class HwClusterer : public Clusterer
   bool mRejectSinglePadClusters;         ///< Switch to reject single pad clusters, sigmaPad2Pre == 0
   bool mRejectSingleTimeClusters;        ///< Switch to reject single time clusters, sigmaTime2Pre == 0
   bool mRejectLaterTimebin;              ///< Switch to reject peaks in later timebins of the same pad
+  int mNThreads;                         ///< Number of threads to process the row sets in parallel
 
   std::vector<unsigned short> mPadsPerRow;                       ///< Number of pads for given row (offset of 2 pads on both sides is already added)
   std::vector<unsigned short> mPadsPerRowSet;                    ///< Number of pads for given row set (offset of 2 pads on both sides is already added), a row set combines rows for parallel SIMD processing
@@ -214,6 +231,8 @@ class HwClusterer : public Clusterer
   std::vector<std::unique_ptr<std::vector<ClusterHardware>>> mTmpClusterArray;                             ///< Temporary cluster storage for each region to accumulate cluster before filling output container
   std::vector<std::unique_ptr<std::vector<std::vector<std::pair<MCCompLabel, unsigned>>>>> mTmpLabelArray; ///< Temporary cluster storage for each region to accumulate cluster before filling output container
 
+  std::vector<RowSetClusters> mRowSetClusters; ///< Clusters of each row set found in the current timebin
+
   std::vector<ClusterHardwareContainer8kb>* mClusterArray; ///< Pointer to output cluster container
   MCLabelContainer* mClusterMcLabelArray;                  ///< Pointer to MC Label container
 };
@@ -263,6 +282,11 @@ inline void HwClusterer::setSplittingMode(short mode)
   mSplittingMode = mode;
 }
 
+inline void HwClusterer::setNThreads(int nThreads)
+{
+  mNThreads = nThreads < 1 ? 1 : nThreads;
+}
+
 inline int HwClusterer::mapTimeInRange(int time)
 {
   return (mTimebinsInBuffer + (time % mTimebinsInBuffer)) % mTimebinsInBuffer;
@@ -34,6 +34,7 @@ struct HwClustererParam : public o2::conf::ConfigurableParamHelper<HwClustererPa
   bool rejectSinglePadClusters = false;     ///< Switch to reject single pad clusters, sigmaPad2Pre == 0
   bool rejectSingleTimeClusters = false;    ///< Switch to reject single time clusters, sigmaTime2Pre == 0
   bool rejectLaterTimebin = false;          ///< Switch to reject peaks in later timebins of the same pad
+  int nThreads = 1;                         ///< Number of threads to process the row sets of a sector in parallel
 
   O2ParamDef(HwClustererParam, "TPCHwClusterer");
 };
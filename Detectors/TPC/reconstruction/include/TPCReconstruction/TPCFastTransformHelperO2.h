@@ -24,6 +24,7 @@
 #include "TPCFastTransform.h"
 #include "Rtypes.h"
 #include <functional>
+#include <vector>
 
 namespace o2
 {
@@ -67,6 +68,25 @@ class TPCFastTransformHelperO2
   /// Updates the transformation with the new time stamp
   int updateCalibration(TPCFastTransform& transform, Long_t TimeStamp);
 
+  /// set the number of threads used to fit the correction splines.
+  /// With more than one thread the space charge correction must be thread-safe.
+  void setNThreads(int n) { mNThreads = n > 0 ? n : 1; }
+  int getNThreads() const { return mNThreads; }
+
+  /// enable the incremental update: when updating the same transformation again, only the
+  /// (slice,row) splines where the input correction changed by more than the tolerance [cm] are refitted
+  void setIncrementalUpdate(bool on, double tolerance = 1.e-3)
+  {
+    mIncrementalUpdate = on;
+    mIncrementalTolerance = tolerance;
+    mCachedCorrection = nullptr;
+    mCachedDataPoints.clear();
+  }
+  bool isIncrementalUpdate() const { return mIncrementalUpdate; }
+
+  /// number of (slice,row) splines refitted by the last update of the correction
+  int getNumberOfRefittedRows() const { return mNumberOfRefittedRows; }
+
   /// _______________  Utilities   ________________________
 
   void testGeometry(const TPCFastTransformGeo& fastTransform) const;
@@ -81,8 +101,14 @@ class TPCFastTransformHelperO2
   bool mIsInitialized = 0;                                                                     ///< initialization flag
   std::function<void(int roc, const double XYZ[3], double dXdYdZ[3])> mSpaceChargeCorrection = nullptr; ///< pointer to an external correction method
   TPCFastTransformGeo mGeo;                                                                    ///< geometry parameters
-
-  ClassDefNV(TPCFastTransformHelperO2, 2);
+  int mNThreads = 1;                                                                           ///< number of threads for the spline fits
+  bool mIncrementalUpdate = false;                                                             ///< refit only the changed rows
+  double mIncrementalTolerance = 1.e-3;                                                        ///< tolerance [cm] for the incremental update
+  int mNumberOfRefittedRows = 0;                                                               ///< splines refitted by the last update
+  const TPCFastSpaceChargeCorrection* mCachedCorrection = nullptr;                             //! correction the cached data points belong to
+  std::vector<std::vector<double>> mCachedDataPoints;                                          //! input data points of the last fit per (slice,row)
+
+  ClassDefNV(TPCFastTransformHelperO2, 3);
 };
 } // namespace tpc
 } // namespace o2
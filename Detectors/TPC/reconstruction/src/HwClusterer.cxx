@@ -24,6 +24,10 @@
 #include <cassert>
 #include <limits>
 
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
 using namespace o2::tpc;
 
 //______________________________________________________________________________
@@ -47,6 +51,7 @@ HwClusterer::HwClusterer(
     mRejectSinglePadClusters(false),
     mRejectSingleTimeClusters(false),
     mRejectLaterTimebin(false),
+    mNThreads(1),
     mPadsPerRowSet(),
     mGlobalRowToRegion(),
     mGlobalRowToLocalRow(),
@@ -57,6 +62,7 @@ HwClusterer::HwClusterer(
     mMCtruth(),
     mTmpClusterArray(),
     mTmpLabelArray(),
+    mRowSetClusters(),
     mClusterMcLabelArray(labelOutput),
     mClusterArray(clusterOutputContainer)
 {
@@ -111,6 +117,7 @@ HwClusterer::HwClusterer(
     }
   }
   mMCtruth.resize(mTimebinsInBuffer, nullptr);
+  mRowSetClusters.resize(mNumRowSets);
 }
 
 //______________________________________________________________________________
@@ -127,6 +134,7 @@ void HwClusterer::init()
   mRejectSinglePadClusters = param.rejectSinglePadClusters;
   mRejectSingleTimeClusters = param.rejectSingleTimeClusters;
   mRejectLaterTimebin = param.rejectLaterTimebin;
+  setNThreads(param.nThreads);
 }
 
 //______________________________________________________________________________
@@ -287,7 +295,7 @@ void HwClusterer::finishProcess(gsl::span<o2::tpc::Digit const> const& digits, C
 }
 
 //______________________________________________________________________________
-void HwClusterer::hwClusterProcessor(const Vc::uint_m peakMask, unsigned qMaxIndex, short centerPad, int centerTime, unsigned short row)
+void HwClusterer::hwClusterProcessor(const Vc::uint_m peakMask, unsigned qMaxIndex, short centerPad, int centerTime, unsigned short row, RowSetClusters& output)
 {
   Vc::uint_v qTot = 0;
   Vc::int_v pad = 0;
@@ -599,8 +607,9 @@ void HwClusterer::hwClusterProcessor(const Vc::uint_m peakMask, unsigned qMaxInd
   for (int i = 0; i < Vc::uint_v::Size; ++i) {
     if (selectionMask[i]) {
 
-      mTmpClusterArray[mGlobalRowToRegion[row * Vc::uint_v::Size + i]]->emplace_back();
-      mTmpClusterArray[mGlobalRowToRegion[row * Vc::uint_v::Size + i]]->back().setCluster(
+      output.regions.emplace_back(mGlobalRowToRegion[row * Vc::uint_v::Size + i]);
+      output.clusters.emplace_back();
+      output.clusters.back().setCluster(
         centerPad - 2,    // we have two artificial empty pads "on the left" which needs to be subtracted
         centerTime % 447, // the time within a HB
         pad[i], time[i],
@@ -611,13 +620,13 @@ void HwClusterer::hwClusterProcessor(const Vc::uint_m peakMask, unsigned qMaxInd
         flags[i]);
 
       std::sort(mcLabels[i]->begin(), mcLabels[i]->end(), [](const labelPair& a, const labelPair& b) { return a.second > b.second; });
-      mTmpLabelArray[mGlobalRowToRegion[row * Vc::uint_v::Size + i]]->push_back(std::move(*mcLabels[i]));
+      output.mcLabels.push_back(std::move(*mcLabels[i]));
     }
   }
 }
 
 //______________________________________________________________________________
-void HwClusterer::hwPeakFinder(unsigned qMaxIndex, short centerPad, int mappedCenterTime, unsigned short row)
+void HwClusterer::hwPeakFinder(unsigned mappedTime, unsigned mappedPreviousTime, unsigned short row)
 {
 
   // Always the center pad is compared with a fixed other pad. The first
@@ -649,75 +658,80 @@ void HwClusterer::hwPeakFinder(unsigned qMaxIndex, short centerPad, int mappedCe
   //  25 | minimum in time direction
   //  24 | minimum in 1. diagonal direction
   //  23 | minimum in 2. diagonal direction
+  //
+  // The comparisons only read the ADC part of the buffer, hence the final state
+  // of every bin can be computed directly instead of iterating over the centers
+  // (1 <= p <= nPads - 2): a bin gets its bits set when it is the center and
+  // cleared afterwards by the center to its right (pad direction, time bin t)
+  // or by the centers of the next time bin (time and diagonal directions, time
+  // bin t-1). Without any dependency between the pads, the whole time bin
+  // plane of the row set (pads x Vc::uint_v::Size rows) is processed in one
+  // pass.
+
+  const int nPads = mPadsPerRowSet[row];
+  Vc::uint_v* current = &mDataBuffer[row][mappedTime * nPads];
+  Vc::uint_v* previous = &mDataBuffer[row][mappedPreviousTime * nPads];
+  const Vc::uint_v peakThreshold = mPeakChargeThreshold << 4;
+
+  for (int pad = 0; pad < nPads; ++pad) {
+    const auto q = getFpOfADC(current[pad]);
+    const auto qPrevious = getFpOfADC(previous[pad]);
+    Vc::uint_v value = current[pad];
+    Vc::uint_v previousValue = previous[pad];
+
+    if (pad >= 1 && pad < nPads - 1) {
+      // this pad is a center
+
+      // pad direction, if true current center could be peak, otherwise minimum
+      auto tmpMask = q >= getFpOfADC(current[pad - 1]);
+      Vc::where(tmpMask) | value |= (0x1 << 31);
+      Vc::where(!tmpMask) | value |= (0x1 << 26);
+
+      // time direction, the other one can be no peak (minimum) anymore
+      tmpMask = q >= qPrevious;
+      Vc::where(tmpMask) | value |= (0x1 << 30);
+      Vc::where(!tmpMask) | value |= (0x1 << 25);
+      Vc::where(tmpMask) | previousValue &= ~(0x1 << 30);
+      Vc::where(!tmpMask) | previousValue &= ~(0x1 << 25);
+
+      // 1. diagonal direction
+      tmpMask = q >= getFpOfADC(previous[pad - 1]);
+      Vc::where(tmpMask) | value |= (0x1 << 29);
+      Vc::where(!tmpMask) | value |= (0x1 << 24);
+
+      // 2. diagonal direction
+      tmpMask = q >= getFpOfADC(previous[pad + 1]);
+      Vc::where(tmpMask) | value |= (0x1 << 28);
+      Vc::where(!tmpMask) | value |= (0x1 << 23);
+
+      // peak threshold
+      Vc::where(q > peakThreshold) | value |= (0x1 << 27);
+    }
 
-  const int compareIndex0 = mappedCenterTime * mPadsPerRowSet[row] + centerPad - 1;
-  const int compareIndex1 = mapTimeInRange(mappedCenterTime - 1) * mPadsPerRowSet[row] + centerPad;
-  const int compareIndex2 = compareIndex1 - 1;
-  const int compareIndex3 = compareIndex1 + 1;
-  const auto adcMask = (getFpOfADC(mDataBuffer[row][qMaxIndex]) == 0) &
-                       (getFpOfADC(mDataBuffer[row][compareIndex0]) == 0) &
-                       (getFpOfADC(mDataBuffer[row][compareIndex1]) == 0) &
-                       (getFpOfADC(mDataBuffer[row][compareIndex2]) == 0) &
-                       (getFpOfADC(mDataBuffer[row][compareIndex3]) == 0);
-  if (adcMask.isFull()) {
-    // if all 0, we can skip the following part and directly set the bits where
-    // the comparisons were true, TODO: still possible if difference is applied?
-    mDataBuffer[row][qMaxIndex] |= (0x1 << 31);
-    mDataBuffer[row][compareIndex0] &= ~(0x1 << 31);
-    mDataBuffer[row][qMaxIndex] |= (0x1 << 30);
-    mDataBuffer[row][compareIndex1] &= ~(0x1 << 30);
-    mDataBuffer[row][qMaxIndex] |= (0x1 << 29);
-    mDataBuffer[row][compareIndex2] &= ~(0x1 << 29);
-    mDataBuffer[row][qMaxIndex] |= (0x1 << 28);
-    mDataBuffer[row][compareIndex3] &= ~(0x1 << 28);
-    return;
-  }
+    if (pad + 1 < nPads - 1) {
+      // right neighbour is a center, it compares to this pad in pad direction
+      // and to this pad of the previous time bin in 1. diagonal direction
+      const auto qRight = getFpOfADC(current[pad + 1]);
+      auto tmpMask = qRight >= q;
+      Vc::where(tmpMask) | value &= ~(0x1 << 31);
+      Vc::where(!tmpMask) | value &= ~(0x1 << 26);
+
+      tmpMask = qRight >= qPrevious;
+      Vc::where(tmpMask) | previousValue &= ~(0x1 << 29);
+      Vc::where(!tmpMask) | previousValue &= ~(0x1 << 24);
+    }
+
+    if (pad >= 2) {
+      // left neighbour is a center, it compares to this pad of the previous
+      // time bin in 2. diagonal direction
+      const auto tmpMask = getFpOfADC(current[pad - 1]) >= qPrevious;
+      Vc::where(tmpMask) | previousValue &= ~(0x1 << 28);
+      Vc::where(!tmpMask) | previousValue &= ~(0x1 << 23);
+    }
 
-  //////////////////////////////////////
-  // Comparison in pad direction
-  // TODO: define needed difference
-  auto tmpMask = getFpOfADC(mDataBuffer[row][qMaxIndex]) >= getFpOfADC(mDataBuffer[row][compareIndex0]);
-  // if true:
-  //  - current center could be peak
-  //  - cleare possible maxBit of other
-  //  - other is minimum if minBit was already set before
-  Vc::where(tmpMask) | mDataBuffer[row][qMaxIndex] |= (0x1 << 31);
-  Vc::where(tmpMask) | mDataBuffer[row][compareIndex0] &= ~(0x1 << 31);
-
-  // if false:
-  //  - current center could be minimum
-  //  - cleare possible minBit of other
-  //  - other is peak if maxBit was already set before
-  Vc::where(!tmpMask) | mDataBuffer[row][qMaxIndex] |= (0x1 << 26);
-  Vc::where(!tmpMask) | mDataBuffer[row][compareIndex0] &= ~(0x1 << 26);
-
-  //////////////////////////////////////
-  // Comparison in time direction
-  tmpMask = getFpOfADC(mDataBuffer[row][qMaxIndex]) >= getFpOfADC(mDataBuffer[row][compareIndex1]);
-  Vc::where(tmpMask) | mDataBuffer[row][qMaxIndex] |= (0x1 << 30);
-  Vc::where(tmpMask) | mDataBuffer[row][compareIndex1] &= ~(0x1 << 30);
-  Vc::where(!tmpMask) | mDataBuffer[row][qMaxIndex] |= (0x1 << 25);
-  Vc::where(!tmpMask) | mDataBuffer[row][compareIndex1] &= ~(0x1 << 25);
-
-  //////////////////////////////////////
-  // Comparison in 1. diagonal direction
-  tmpMask = getFpOfADC(mDataBuffer[row][qMaxIndex]) >= getFpOfADC(mDataBuffer[row][compareIndex2]);
-  Vc::where(tmpMask) | mDataBuffer[row][qMaxIndex] |= (0x1 << 29);
-  Vc::where(tmpMask) | mDataBuffer[row][compareIndex2] &= ~(0x1 << 29);
-  Vc::where(!tmpMask) | mDataBuffer[row][qMaxIndex] |= (0x1 << 24);
-  Vc::where(!tmpMask) | mDataBuffer[row][compareIndex2] &= ~(0x1 << 24);
-
-  //////////////////////////////////////
-  // Comparison in 2. diagonal direction
-  tmpMask = getFpOfADC(mDataBuffer[row][qMaxIndex]) >= getFpOfADC(mDataBuffer[row][compareIndex3]);
-  Vc::where(tmpMask) | mDataBuffer[row][qMaxIndex] |= (0x1 << 28);
-  Vc::where(tmpMask) | mDataBuffer[row][compareIndex3] &= ~(0x1 << 28);
-  Vc::where(!tmpMask) | mDataBuffer[row][qMaxIndex] |= (0x1 << 23);
-  Vc::where(!tmpMask) | mDataBuffer[row][compareIndex3] &= ~(0x1 << 23);
-
-  //////////////////////////////////////
-  // Comparison peak threshold
-  Vc::where(getFpOfADC(mDataBuffer[row][qMaxIndex]) > (mPeakChargeThreshold << 4)) | mDataBuffer[row][qMaxIndex] |= (0x1 << 27);
+    current[pad] = value;
+    previous[pad] = previousValue;
+  }
 }
 
 //______________________________________________________________________________
@@ -773,14 +787,13 @@ void HwClusterer::findPeaksForTime(int timebin)
   }
 
   const unsigned timeBinWrapped = mapTimeInRange(timebin);
-  for (unsigned short row = 0; row < mNumRowSets; ++row) {
-    const unsigned padOffset = timeBinWrapped * mPadsPerRowSet[row];
-    // two empty pads on the left and right without a cluster peak, check one
-    // beyond rightmost pad for remaining relations
-    for (short pad = 1; pad < mPadsPerRowSet[row] - 1; ++pad) {
-      const unsigned qMaxIndex = padOffset + pad;
-      hwPeakFinder(qMaxIndex, pad, timeBinWrapped, row);
-    }
+  const unsigned previousTimeBinWrapped = mapTimeInRange(timebin - 1);
+  // row sets have separate buffers and can be processed independently
+#ifdef WITH_OPENMP
+#pragma omp parallel for num_threads(mNThreads) schedule(dynamic) if (mNThreads > 1)
+#endif
+  for (int row = 0; row < mNumRowSets; ++row) {
+    hwPeakFinder(timeBinWrapped, previousTimeBinWrapped, row);
   }
 }
 
@@ -791,42 +804,59 @@ void HwClusterer::computeClusterForTime(int timebin)
     return;
   }
 
+#ifdef WITH_OPENMP
+#pragma omp parallel for num_threads(mNThreads) schedule(dynamic) if (mNThreads > 1)
+#endif
+  for (int row = 0; row < mNumRowSets; ++row) {
+    computeClusterForRowSet(timebin, row);
+  }
+
+  // collect the clusters in row set order, so that the output does not depend on the number of threads
+  for (auto& rowSetClusters : mRowSetClusters) {
+    for (size_t c = 0; c < rowSetClusters.clusters.size(); ++c) {
+      mTmpClusterArray[rowSetClusters.regions[c]]->emplace_back(rowSetClusters.clusters[c]);
+      mTmpLabelArray[rowSetClusters.regions[c]]->push_back(std::move(rowSetClusters.mcLabels[c]));
+    }
+    rowSetClusters.regions.clear();
+    rowSetClusters.clusters.clear();
+    rowSetClusters.mcLabels.clear();
+  }
+}
+
+//______________________________________________________________________________
+void HwClusterer::computeClusterForRowSet(int timebin, unsigned short row)
+{
   const unsigned timeBinWrapped = mapTimeInRange(timebin);
+  const unsigned padOffset = timeBinWrapped * mPadsPerRowSet[row];
+  auto& output = mRowSetClusters[row];
   if (mRejectLaterTimebin) {
-    const unsigned previousTimeBinWrapped = mapTimeInRange(timebin - 2);
-    for (unsigned short row = 0; row < mNumRowSets; ++row) {
-      const unsigned padOffset = timeBinWrapped * mPadsPerRowSet[row];
-      const unsigned previousPadOffset = previousTimeBinWrapped * mPadsPerRowSet[row];
-      // two empty pads on the left and right without a cluster peak
-      for (short pad = 2; pad < mPadsPerRowSet[row] - 2; ++pad) {
-        const unsigned qMaxIndex = padOffset + pad;
-        const unsigned qMaxPreviousIndex = previousPadOffset + pad;
-
-        // TODO: define needed difference
-        const auto peakMask = ((mDataBuffer[row][qMaxIndex] >> 27) == 0x1F) &                                              //  True if current pad is peak AND
-                              (getFpOfADC(mDataBuffer[row][qMaxIndex]) > getFpOfADC(mDataBuffer[row][qMaxPreviousIndex]) | // previous has smaller charge
-                               !((mDataBuffer[row][qMaxPreviousIndex] >> 27) == 0x1F));                                    //  or previous one was not a peak
-        if (peakMask.isEmpty()) {
-          continue;
-        }
-
-        hwClusterProcessor(peakMask, qMaxIndex, pad, timebin, row);
+    const unsigned previousPadOffset = mapTimeInRange(timebin - 2) * mPadsPerRowSet[row];
+    // two empty pads on the left and right without a cluster peak
+    for (short pad = 2; pad < mPadsPerRowSet[row] - 2; ++pad) {
+      const unsigned qMaxIndex = padOffset + pad;
+      const unsigned qMaxPreviousIndex = previousPadOffset + pad;
+
+      // TODO: define needed difference
+      const auto peakMask = ((mDataBuffer[row][qMaxIndex] >> 27) == 0x1F) &                                              //  True if current pad is peak AND
+                            (getFpOfADC(mDataBuffer[row][qMaxIndex]) > getFpOfADC(mDataBuffer[row][qMaxPreviousIndex]) | // previous has smaller charge
+                             !((mDataBuffer[row][qMaxPreviousIndex] >> 27) == 0x1F));                                    //  or previous one was not a peak
+      if (peakMask.isEmpty()) {
+        continue;
       }
+
+      hwClusterProcessor(peakMask, qMaxIndex, pad, timebin, row, output);
     }
   } else {
-    for (unsigned short row = 0; row < mNumRowSets; ++row) {
-      const unsigned padOffset = timeBinWrapped * mPadsPerRowSet[row];
-      // two empty pads on the left and right without a cluster peak
-      for (short pad = 2; pad < mPadsPerRowSet[row] - 2; ++pad) {
-        const unsigned qMaxIndex = padOffset + pad;
-
-        const auto peakMask = ((mDataBuffer[row][qMaxIndex] >> 27) == 0x1F);
-        if (peakMask.isEmpty()) {
-          continue;
-        }
+    // two empty pads on the left and right without a cluster peak
+    for (short pad = 2; pad < mPadsPerRowSet[row] - 2; ++pad) {
+      const unsigned qMaxIndex = padOffset + pad;
 
-        hwClusterProcessor(peakMask, qMaxIndex, pad, timebin, row);
+      const auto peakMask = ((mDataBuffer[row][qMaxIndex] >> 27) == 0x1F);
+      if (peakMask.isEmpty()) {
+        continue;
       }
+
+      hwClusterProcessor(peakMask, qMaxIndex, pad, timebin, row, output);
     }
   }
 }
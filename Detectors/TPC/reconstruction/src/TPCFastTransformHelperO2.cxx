@@ -25,6 +25,8 @@
 #include "Spline2DHelper.h"
 #include "Riostream.h"
 #include "FairLogger.h"
+#include <cmath>
+#include <memory>
 
 using namespace o2::gpu;
 
@@ -170,6 +172,9 @@ std::unique_ptr<TPCFastTransform> TPCFastTransformHelperO2::create(Long_t TimeSt
 
   std::unique_ptr<TPCFastTransform> fastTransformPtr(new TPCFastTransform);
 
+  // a new transformation always needs the full fit
+  mCachedCorrection = nullptr;
+
   TPCFastTransform& fastTransform = *fastTransformPtr;
 
   { // create the fast transform object
@@ -263,20 +268,91 @@ int TPCFastTransformHelperO2::updateCalibration(TPCFastTransform& fastTransform,
   // for the future: switch TOF correction off for a while
 
   if (mSpaceChargeCorrection) {
-    for (int slice = 0; slice < correction.getGeometry().getNumberOfSlices(); slice++) {
-      for (int row = 0; row < correction.getGeometry().getNumberOfRows(); row++) {
-        const TPCFastSpaceChargeCorrection::SplineType& spline = correction.getSpline(slice, row);
-        float* data = correction.getSplineData(slice, row);
-        Spline2DHelper<float> helper;
-        helper.setSpline(spline, 3, 3);
-        auto F = [&](double su, double sv, double dxuv[3]) {
+    const int nSlices = correction.getGeometry().getNumberOfSlices();
+    const int nRows = correction.getGeometry().getNumberOfRows();
+
+    // rows sharing a spline scenario have the same spline grid, so the fit matrices
+    // are computed once per scenario and shared (read-only) between all the fits
+
+    std::vector<std::unique_ptr<Spline2DHelper<float>>> helpers;
+    for (int row = 0; row < nRows; row++) {
+      const size_t scenario = correction.getRowInfo(row).splineScenarioID;
+      if (scenario >= helpers.size()) {
+        helpers.resize(scenario + 1);
+      }
+      if (!helpers[scenario]) {
+        helpers[scenario] = std::make_unique<Spline2DHelper<float>>();
+        helpers[scenario]->setSpline(correction.getSpline(0, row), 3, 3);
+      }
+    }
+
+    // the cached data points are only valid for the correction they were fitted to
+
+    const bool incremental = mIncrementalUpdate && mCachedCorrection == &correction && mCachedDataPoints.size() == size_t(nSlices * nRows);
+    if (!incremental) {
+      mCachedDataPoints.clear();
+      if (mIncrementalUpdate) {
+        mCachedDataPoints.resize(nSlices * nRows);
+      }
+    }
+    mCachedCorrection = mIncrementalUpdate ? &correction : nullptr;
+
+    int nRefitted = 0;
+
+#ifdef WITH_OPENMP
+#pragma omp parallel for num_threads(mNThreads) schedule(dynamic) reduction(+ \
+                                                                           : nRefitted)
+#endif
+    for (int iSliceRow = 0; iSliceRow < nSlices * nRows; iSliceRow++) {
+      const int slice = iSliceRow / nRows;
+      const int row = iSliceRow % nRows;
+      const Spline2DHelper<float>& helper = *helpers[correction.getRowInfo(row).splineScenarioID];
+
+      // evaluate the input correction at the data points of the fit
+
+      const int nPointsU = helper.getNumberOfDataPointsU1();
+      const int nPointsV = helper.getNumberOfDataPointsU2();
+      const double scaleU = 1. / helper.getHelperU1().getSpline().getUmax();
+      const double scaleV = 1. / helper.getHelperU2().getSpline().getUmax();
+      std::vector<double> dataPointF(3 * helper.getNumberOfDataPoints());
+      for (int iv = 0; iv < nPointsV; iv++) {
+        double sv = helper.getHelperU2().getDataPoint(iv).u * scaleV;
+        for (int iu = 0; iu < nPointsU; iu++) {
+          double su = helper.getHelperU1().getDataPoint(iu).u * scaleU;
+          double* dxuv = &dataPointF[3 * (iv * nPointsU + iu)];
           getSpaceChargeCorrection(slice, row, su, sv, dxuv[0], dxuv[1], dxuv[2]);
-        };
-        helper.approximateFunction(data, 0., 1., 0., 1., F);
-      } // row
-    }   // slice
-    correction.initInverse();
+        }
+      }
+
+      if (incremental) {
+        const auto& cached = mCachedDataPoints[iSliceRow];
+        bool changed = false;
+        for (size_t i = 0; i < dataPointF.size() && !changed; i++) {
+          changed = std::abs(dataPointF[i] - cached[i]) > mIncrementalTolerance;
+        }
+        if (!changed) {
+          continue;
+        }
+      }
+
+      helper.approximateFunction(correction.getSplineData(slice, row), dataPointF.data());
+      nRefitted++;
+
+      if (mIncrementalUpdate) {
+        mCachedDataPoints[iSliceRow] = std::move(dataPointF);
+      }
+    } // slice, row
+
+    mNumberOfRefittedRows = nRefitted;
+    LOG(debug) << "TPCFastTransformHelperO2: refitted " << nRefitted << " of " << nSlices * nRows << " correction splines";
+
+    if (nRefitted > 0) {
+      correction.initInverse();
+    }
   } else {
+    mNumberOfRefittedRows = 0;
+    mCachedCorrection = nullptr;
+    mCachedDataPoints.clear();
     correction.setNoCorrection();
   }
 
@@ -0,0 +1,104 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file benchmarkTPCHwClusterer.cxx
+/// \brief Benchmark of the TPC HwClusterer on zero suppressed digits of one sector
+
+#include "benchmark/benchmark.h"
+#include "DataFormatsTPC/Digit.h"
+#include "DataFormatsTPC/Helpers.h"
+#include "TPCBase/Mapper.h"
+#include "TPCReconstruction/HwClusterer.h"
+#include "SimulationDataFormat/ConstMCTruthContainer.h"
+#include "SimulationDataFormat/MCCompLabel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace o2::tpc;
+
+/// Generates zero suppressed digits of one sector, with nClustersPerTimeBin
+/// gaussian shaped clusters (sigma of about 0.8 pad / time bin) per time bin
+std::vector<Digit> generateZSDigits(int nTimeBins, int nClustersPerTimeBin, float zsThreshold = 2.f)
+{
+  Mapper& mapper = Mapper::instance();
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> rowDist(0, mapper.getNumberOfRows() - 1);
+  std::uniform_real_distribution<float> flat(0.f, 1.f);
+  std::exponential_distribution<float> qMaxDist(1.f / 60.f);
+
+  std::vector<Digit> digits;
+  for (int time = 2; time < nTimeBins - 2; ++time) {
+    for (int c = 0; c < nClustersPerTimeBin; ++c) {
+      const int row = rowDist(gen);
+      const int nPads = mapper.getNumberOfPadsInRowSector(row);
+      const float centerPad = 2 + flat(gen) * (nPads - 5);
+      const float centerTime = time + flat(gen);
+      const float qMax = 5.f + qMaxDist(gen);
+      for (int dt = -2; dt <= 2; ++dt) {
+        for (int dp = -2; dp <= 2; ++dp) {
+          const int pad = int(centerPad) + dp;
+          const int t = int(centerTime) + dt;
+          const float distPad = pad - centerPad;
+          const float distTime = t - centerTime;
+          const float charge = qMax * std::exp(-(distPad * distPad + distTime * distTime) / (2 * 0.8f * 0.8f));
+          if (charge > zsThreshold) {
+            digits.emplace_back(Mapper::REGION[row], charge, row, pad, t);
+          }
+        }
+      }
+    }
+  }
+  std::stable_sort(digits.begin(), digits.end(), [](const Digit& a, const Digit& b) { return a.getTimeStamp() < b.getTimeStamp(); });
+  return digits;
+}
+
+/// Arguments: number of clusters per time bin in the sector, number of threads
+static void BM_HwClustererSector(benchmark::State& state)
+{
+  const int nTimeBins = 2000;
+  const auto digits = generateZSDigits(nTimeBins, state.range(0));
+  o2::dataformats::ConstMCTruthContainerView<o2::MCCompLabel> noLabels;
+
+  std::vector<ClusterHardwareContainer8kb> clusterArray;
+  size_t nClusters = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    clusterArray.clear();
+    HwClusterer clusterer(&clusterArray, 0, nullptr);
+    clusterer.setNThreads(state.range(1));
+    state.ResumeTiming();
+    clusterer.finishProcess(digits, noLabels, true);
+    nClusters = 0;
+    for (auto& container : clusterArray) {
+      nClusters += container.getContainer()->numberOfClusters;
+    }
+  }
+  state.counters["digits"] = digits.size();
+  state.counters["clusters"] = nClusters;
+  state.counters["timeBins/s"] = benchmark::Counter(nTimeBins * state.iterations(), benchmark::Counter::kIsRate);
+  state.SetItemsProcessed(digits.size() * state.iterations());
+}
+
+static void CustomArguments(benchmark::internal::Benchmark* bench)
+{
+  for (int nClusters : {10, 50, 200}) {
+    for (int nThreads : {1, 2, 4, 8}) {
+      bench->Args({nClusters, nThreads});
+    }
+  }
+}
+
+BENCHMARK(BM_HwClustererSector)->Apply(CustomArguments)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -28,6 +28,8 @@
 #include "DataFormatsTPC/CalibdEdxContainer.h"
 #include "GPUO2Interface.h"
 #include "GPUO2InterfaceConfiguration.h"
+#include "GPUReconstruction.h"
+#include "GPUChainTracking.h"
 #include "TPCPadGainCalib.h"
 
 using namespace o2::gpu;
@@ -35,6 +37,8 @@ using namespace o2::gpu;
 #include <vector>
 #include <iostream>
 #include <iomanip>
+#include <future>
+#include <thread>
 
 using namespace o2::dataformats;
 
@@ -105,5 +109,97 @@ BOOST_AUTO_TEST_CASE(CATracking_test1)
   BOOST_CHECK_EQUAL(retVal, 0);
   BOOST_CHECK_EQUAL((int)ptrs.nMergedTracks, 1);
 }
+
+/// @brief Test 2 double pipeline mode on the CPU, two TFs in flight
+BOOST_AUTO_TEST_CASE(CATracking_test2)
+{
+  GPUO2InterfaceConfiguration config;
+  config.configDeviceBackend.deviceType = GPUDataTypes::DeviceType::CPU;
+  config.configDeviceBackend.forceDeviceType = true;
+
+  config.configProcessing.ompThreads = 4;
+  config.configProcessing.runQA = false;
+  config.configProcessing.eventDisplay = nullptr;
+  config.configProcessing.doublePipeline = true;
+  config.configProcessing.memoryAllocationStrategy = GPUMemoryResource::ALLOCATION_GLOBAL;
+
+  config.configGRP.solenoidBz = -5.00668;
+  config.configGRP.continuousMaxTimeBin = 0;
+
+  config.configReconstruction.tpc.nWays = 3;
+  config.configReconstruction.tpc.nWaysOuter = true;
+  config.configReconstruction.tpc.searchWindowDZDR = 2.5f;
+  config.configReconstruction.tpc.trackReferenceX = 1000.;
+
+  config.configWorkflow.steps.set(GPUDataTypes::RecoStep::TPCConversion, GPUDataTypes::RecoStep::TPCSliceTracking,
+                                  GPUDataTypes::RecoStep::TPCMerging, GPUDataTypes::RecoStep::TPCdEdx);
+  config.configWorkflow.inputs.set(GPUDataTypes::InOutType::TPCClusters);
+  config.configWorkflow.outputs.set(GPUDataTypes::InOutType::TPCMergedTracks);
+
+  std::unique_ptr<TPCFastTransform> fastTransform(TPCFastTransformHelperO2::instance()->create(0));
+  config.configCalib.fastTransform = fastTransform.get();
+  auto dEdxCalibContainer = std::make_unique<o2::tpc::CalibdEdxContainer>();
+  config.configCalib.dEdxCalibContainer = dEdxCalibContainer.get();
+  std::unique_ptr<TPCPadGainCalib> gainCalib = GPUO2Interface::getPadGainCalibDefault();
+  config.configCalib.tpcPadGain = gainCalib.get();
+
+  // The master runs the pipeline worker, the second instance processes the TF in flight
+  std::unique_ptr<GPUReconstruction> rec(GPUReconstruction::CreateInstance(GPUDataTypes::DeviceType::CPU, true));
+  std::unique_ptr<GPUReconstruction> recPipeline(GPUReconstruction::CreateInstance(GPUDataTypes::DeviceType::CPU, true, rec.get()));
+  GPUReconstruction* recs[2] = {rec.get(), recPipeline.get()};
+  GPUChainTracking* chains[2];
+  GPUTrackingOutputs outputs[2];
+  std::vector<char> outputMemory[2];
+  for (int i = 0; i < 2; i++) {
+    chains[i] = recs[i]->AddChain<GPUChainTracking>();
+    recs[i]->SetSettings(&config.configGRP, &config.configReconstruction, &config.configProcessing, &config.configWorkflow);
+    chains[i]->SetCalibObjects(config.configCalib);
+    outputMemory[i].resize(10 * 1024 * 1024);
+    outputs[i].tpcTracks.set(outputMemory[i].data(), outputMemory[i].size());
+    chains[i]->SetSubOutputControl(GPUTrackingOutputs::getIndex(&GPUTrackingOutputs::tpcTracks), &outputs[i].tpcTracks);
+  }
+  BOOST_REQUIRE_EQUAL(rec->Init(), 0);
+  std::thread pipelineThread([&rec]() { rec->RunPipelineWorker(); });
+
+  // One straight track in sector 0 in the first TF, in sector 1 in the second one
+  std::vector<ClusterNativeContainer> cont[2];
+  std::unique_ptr<ClusterNative[]> clusterBuffer[2];
+  std::unique_ptr<ClusterNativeAccess> clusters[2];
+  for (int i = 0; i < 2; i++) {
+    cont[i].resize(constants::MAXGLOBALPADROW);
+    for (int j = 0; j < constants::MAXGLOBALPADROW; j++) {
+      cont[i][j].sector = i;
+      cont[i][j].globalPadRow = j;
+      cont[i][j].clusters.resize(1);
+      cont[i][j].clusters[0].setTimeFlags(2, 0);
+      cont[i][j].clusters[0].setPad(0);
+      cont[i][j].clusters[0].setSigmaTime(1);
+      cont[i][j].clusters[0].setSigmaPad(1);
+      cont[i][j].clusters[0].qMax = 10;
+      cont[i][j].clusters[0].qTot = 50;
+    }
+    clusters[i] = ClusterNativeHelper::createClusterNativeIndex(clusterBuffer[i], cont[i], nullptr, nullptr);
+  }
+
+  // Each instance processes its TF from its own thread, the chains of both TFs are run by the pipeline worker
+  std::future<int> retVals[2];
+  for (int i = 0; i < 2; i++) {
+    chains[i]->mIOPtrs = GPUTrackingInOutPointers();
+    chains[i]->mIOPtrs.clustersNative = clusters[i].get();
+    retVals[i] = std::async(std::launch::async, [r = recs[i]]() { return r->RunChains(); });
+  }
+  for (int i = 0; i < 2; i++) {
+    BOOST_CHECK_EQUAL(retVals[i].get(), 0);
+    BOOST_CHECK_EQUAL((int)chains[i]->mIOPtrs.nMergedTracks, 1);
+    BOOST_CHECK_GT(outputs[i].tpcTracks.size, 1);
+  }
+  for (int i = 0; i < 2; i++) {
+    recs[i]->ClearAllocatedMemory();
+  }
+
+  rec->TerminatePipelineWorker();
+  pipelineThread.join();
+  rec->Finalize();
+}
 } // namespace tpc
 } // namespace o2
@@ -30,6 +30,7 @@
 #include "FairLogger.h"
 
 #include <vector>
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 
@@ -197,5 +198,58 @@ BOOST_AUTO_TEST_CASE(FastTransform_test_setSpaceChargeCorrection)
   BOOST_CHECK_MESSAGE(fabs(maxDeviation) < 1.e-2, "test of inverse correction map failed, max difference " << maxDeviation << " cm is too large");
 }
 
+BOOST_AUTO_TEST_CASE(FastTransform_test_parallelAndIncrementalUpdate)
+{
+  TPCFastTransformHelperO2* helper = TPCFastTransformHelperO2::instance();
+
+  float shift = 0.1;
+  int shiftedRoc = -1;
+  auto correctionGlobal = [&](int roc, const double XYZ[3], double dXdYdZ[3]) {
+    dXdYdZ[0] = 0.01 * XYZ[0];
+    dXdYdZ[1] = 0.01 * XYZ[1];
+    dXdYdZ[2] = (roc == shiftedRoc) ? shift : 0.;
+  };
+  helper->setSpaceChargeCorrection(correctionGlobal);
+
+  // the parallel fit must give the same result as the serial one
+
+  helper->setNThreads(1);
+  std::unique_ptr<TPCFastTransform> serial(helper->create(0));
+  helper->setNThreads(4);
+  std::unique_ptr<TPCFastTransform> parallel(helper->create(0));
+
+  const TPCFastSpaceChargeCorrection& corrSerial = serial->getCorrection();
+  const TPCFastSpaceChargeCorrection& corrParallel = parallel->getCorrection();
+  const TPCFastTransformGeo& geo = serial->getGeometry();
+  const int nSplines = geo.getNumberOfSlices() * geo.getNumberOfRows();
+  int nDifferent = 0;
+  for (int slice = 0; slice < geo.getNumberOfSlices(); slice++) {
+    for (int row = 0; row < geo.getNumberOfRows(); row++) {
+      const int nPar = corrSerial.getSpline(slice, row).getNumberOfParameters();
+      const float* dataSerial = corrSerial.getSplineData(slice, row);
+      const float* dataParallel = corrParallel.getSplineData(slice, row);
+      nDifferent += !std::equal(dataSerial, dataSerial + nPar, dataParallel);
+    }
+  }
+  BOOST_CHECK_EQUAL(nDifferent, 0);
+
+  // the incremental update refits only the rows where the correction has changed
+
+  helper->setIncrementalUpdate(true, 1.e-4);
+  std::unique_ptr<TPCFastTransform> transform(helper->create(0));
+  BOOST_CHECK_EQUAL(helper->getNumberOfRefittedRows(), nSplines);
+
+  helper->updateCalibration(*transform, 100);
+  BOOST_CHECK_EQUAL(helper->getNumberOfRefittedRows(), 0);
+
+  shiftedRoc = 3;
+  helper->updateCalibration(*transform, 200);
+  BOOST_CHECK_EQUAL(helper->getNumberOfRefittedRows(), geo.getNumberOfRows());
+
+  helper->setIncrementalUpdate(false);
+  helper->setNThreads(1);
+  helper->setSpaceChargeCorrection(nullptr);
+}
+
 } // namespace tpc
 } // namespace o2
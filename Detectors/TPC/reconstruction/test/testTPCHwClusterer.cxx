@@ -28,6 +28,10 @@
 #include <vector>
 #include <memory>
 #include <iostream>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <cmath>
 
 using MCLabelContainer = o2::dataformats::MCLabelContainer;
 
@@ -1003,5 +1007,101 @@ BOOST_AUTO_TEST_CASE(HwClusterer_test6)
   std::cout << "##" << std::endl
             << std::endl;
 }
+
+/// @brief Test 7 Multi-threaded processing of the row sets gives the same output as single-threaded
+BOOST_AUTO_TEST_CASE(HwClusterer_test7)
+{
+  std::cout << "##" << std::endl;
+  std::cout << "## Starting test 7, multi-threaded vs single-threaded processing." << std::endl;
+
+  // gaussian clusters randomly spread over all rows of the sector, each digit labeled with its cluster
+  Mapper& mapper = Mapper::instance();
+  std::mt19937 gen(1234);
+  std::uniform_int_distribution<int> rowDist(0, mapper.getNumberOfRows() - 1);
+  std::uniform_real_distribution<float> flat(0.f, 1.f);
+  std::vector<Digit> digitVec;
+  MCLabelContainer labelContainer;
+  int clusterId = 0;
+  for (int time = 2; time < 200; ++time) {
+    for (int c = 0; c < 40; ++c, ++clusterId) {
+      const int row = rowDist(gen);
+      const float centerPad = 2 + flat(gen) * (mapper.getNumberOfPadsInRowSector(row) - 5);
+      const float centerTime = time + flat(gen);
+      const float qMax = 10.f + 200.f * flat(gen);
+      for (int dt = -2; dt <= 2; ++dt) {
+        for (int dp = -2; dp <= 2; ++dp) {
+          const int pad = int(centerPad) + dp;
+          const int t = int(centerTime) + dt;
+          const float charge = qMax * std::exp(-((pad - centerPad) * (pad - centerPad) + (t - centerTime) * (t - centerTime)) / 1.28f);
+          if (charge > 2.f) {
+            labelContainer.addElement(digitVec.size(), {clusterId, 0, 0, false});
+            digitVec.emplace_back(Mapper::REGION[row], charge, row, pad, t);
+          }
+        }
+      }
+    }
+  }
+  // sort digits and labels together by time
+  std::vector<size_t> order(digitVec.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&digitVec](size_t a, size_t b) { return digitVec[a].getTimeStamp() < digitVec[b].getTimeStamp(); });
+  std::vector<Digit> digits;
+  MCLabelContainer sortedLabels;
+  for (size_t i = 0; i < order.size(); ++i) {
+    digits.emplace_back(digitVec[order[i]]);
+    for (auto& label : labelContainer.getLabels(order[i])) {
+      sortedLabels.addElement(i, label);
+    }
+  }
+  o2::dataformats::ConstMCTruthContainer<o2::MCCompLabel> flatLabels;
+  sortedLabels.flatten_to(flatLabels);
+
+  auto runClusterer = [&digits, &flatLabels](int nThreads, std::vector<ClusterHardwareContainer8kb>& clusterArray, MCLabelContainer& labelArray) {
+    HwClusterer clusterer(&clusterArray, 0, &labelArray);
+    clusterer.setContinuousReadout(false);
+    clusterer.setNThreads(nThreads);
+    clusterer.process(digits, flatLabels);
+  };
+
+  std::vector<ClusterHardwareContainer8kb> clustersSingle;
+  MCLabelContainer labelsSingle;
+  runClusterer(1, clustersSingle, labelsSingle);
+
+  for (int nThreads : {2, 4, 7}) {
+    std::cout << "testing with " << nThreads << " threads..." << std::endl;
+    std::vector<ClusterHardwareContainer8kb> clustersMulti;
+    MCLabelContainer labelsMulti;
+    runClusterer(nThreads, clustersMulti, labelsMulti);
+
+    BOOST_REQUIRE_EQUAL(clustersMulti.size(), clustersSingle.size());
+    int clusterIndex = 0;
+    for (size_t i = 0; i < clustersSingle.size(); ++i) {
+      auto single = clustersSingle[i].getContainer();
+      auto multi = clustersMulti[i].getContainer();
+      BOOST_CHECK_EQUAL(multi->CRU, single->CRU);
+      BOOST_CHECK_EQUAL(multi->timeBinOffset, single->timeBinOffset);
+      BOOST_REQUIRE_EQUAL(multi->numberOfClusters, single->numberOfClusters);
+      for (int cl = 0; cl < single->numberOfClusters; ++cl, ++clusterIndex) {
+        BOOST_CHECK_EQUAL(multi->clusters[cl].word0, single->clusters[cl].word0);
+        BOOST_CHECK_EQUAL(multi->clusters[cl].word1, single->clusters[cl].word1);
+        BOOST_CHECK_EQUAL(multi->clusters[cl].word2, single->clusters[cl].word2);
+        BOOST_CHECK_EQUAL(multi->clusters[cl].word3, single->clusters[cl].word3);
+        BOOST_CHECK_EQUAL(multi->clusters[cl].word4, single->clusters[cl].word4);
+        auto singleLabels = labelsSingle.getLabels(clusterIndex);
+        auto multiLabels = labelsMulti.getLabels(clusterIndex);
+        BOOST_REQUIRE_EQUAL(multiLabels.size(), singleLabels.size());
+        for (size_t l = 0; l < singleLabels.size(); ++l) {
+          BOOST_CHECK(multiLabels[l] == singleLabels[l]);
+        }
+      }
+    }
+    BOOST_CHECK_EQUAL(labelsMulti.getIndexedSize(), labelsSingle.getIndexedSize());
+  }
+  BOOST_CHECK(labelsSingle.getIndexedSize() > 1000);
+
+  std::cout << "## Test 7 done." << std::endl;
+  std::cout << "##" << std::endl
+            << std::endl;
+}
 } // namespace tpc
 } // namespace o2
@@ -135,7 +135,10 @@ class TrapSimulator
 
   // tracklet calculation
   void addHitToFitreg(int adc, unsigned short timebin, unsigned short qtot, short ypos);
-  void calcFitreg();
+  // total charge of the hit candidates, 0 if there is no hit, for one cluster or all clusters of a timebin
+  unsigned short calcHitCharge(int adcch, int timebin, unsigned int adcMask);
+  void calcHitCharges(int timebin, unsigned int adcMask, std::array<unsigned short, 20>& qTotal);
+  void calcFitreg(bool hitChargeByChannel = false); // find the hit candidates channel by channel if requested (reference for tests)
   void trackletSelection();
   void fitTracklet();
 
@@ -200,6 +203,7 @@ class TrapSimulator
   static const int mgkNHitsMC = 150; // maximum number of hits for which MC information is kept
 
   static const std::array<unsigned short, 4> mgkFPshifts; // shifts for pedestal filter
+  static constexpr int mgkNLanes = 24;                     // ADC channels processed together by the filters, NADCMCM padded to a multiple of the SIMD width
   // hit detection
   // individual hits can be stored as MC info
   class Hit
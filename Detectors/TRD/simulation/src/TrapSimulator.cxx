@@ -50,6 +50,7 @@
 #include <ostream>
 #include <fstream>
 #include <numeric>
+#include <algorithm>
 
 using namespace o2::trd;
 using namespace std;
@@ -1180,16 +1181,45 @@ void TrapSimulator::filterPedestal()
   // It has only an effect if previous samples have been fed to
   // find the pedestal. Currently, the simulation assumes that
   // the input has been stable for a sufficiently long time.
-  // LOG(debug) << "BEGIN: " << __FILE__ << ":" << __func__ << ":" << __LINE__ ;
+  //
+  // The arithmetic is the one of filterPedestalNextSample(), but the
+  // configuration is read once and the ADC channels of a timebin are
+  // processed together without branches, so that the compiler can
+  // vectorize the loops over the channels.
+
+  const unsigned int fpnp = (unsigned short)mTrapConfig->getTrapReg(TrapConfig::kFPNP, mDetector, mRobPos, mMcmPos); // 0..511 -> 0..127.75, pedestal at the output
+  const unsigned int fptc = (unsigned short)mTrapConfig->getTrapReg(TrapConfig::kFPTC, mDetector, mRobPos, mMcmPos); // 0..3, 0 - fastest, 3 - slowest
+  const bool bypass = (unsigned short)mTrapConfig->getTrapReg(TrapConfig::kFPBY, mDetector, mRobPos, mMcmPos) == 0;  // 0..1 bypass, active low
+  const unsigned int shift = mgkFPshifts[fptc];
+
+  std::array<unsigned int, mgkNLanes> accumulator{};
+  std::array<unsigned int, mgkNLanes> values{};
+  for (int iAdc = 0; iAdc < NADCMCM; iAdc++) {
+    accumulator[iAdc] = mInternalFilterRegisters[iAdc].mPedAcc;
+  }
 
   for (int iTimeBin = 0; iTimeBin < mNTimeBin; iTimeBin++) {
+    const bool updateAccumulator = (iTimeBin == 0); // the accumulator is disabled in the drift time
     for (int iAdc = 0; iAdc < NADCMCM; iAdc++) {
-      int oldadc = mADCF[iAdc * mNTimeBin + iTimeBin];
-      mADCF[iAdc * mNTimeBin + iTimeBin] = filterPedestalNextSample(iAdc, iTimeBin, mADCR[iAdc * mNTimeBin + iTimeBin]);
-      //    LOG(debug) << "mADCF : time : " << iTimeBin << " adc : " << iAdc << " change : " << oldadc << " -> " << mADCF[iAdc * mNTimeBin + iTimeBin];
+      values[iAdc] = mADCR[iAdc * mNTimeBin + iTimeBin] & 0xFFFF;
     }
+    for (int iAdc = 0; iAdc < mgkNLanes; iAdc++) {
+      unsigned int value = values[iAdc];
+      unsigned int inpAdd = (value + fpnp) & 0xFFFF;
+      unsigned int accumulatorShifted = (accumulator[iAdc] >> shift) & 0x3FF; // 10 bits
+      unsigned int corrected = (inpAdd > accumulatorShifted) ? std::min(inpAdd - accumulatorShifted, 0xFFFu) : 0u;
+      unsigned int updated = (accumulator[iAdc] + (value & 0x3FF) - accumulatorShifted) & 0x7FFFFFFF; // 31 bits
+      accumulator[iAdc] = updateAccumulator ? updated : accumulator[iAdc];
+      values[iAdc] = bypass ? value : corrected;
+    }
+    for (int iAdc = 0; iAdc < NADCMCM; iAdc++) {
+      mADCF[iAdc * mNTimeBin + iTimeBin] = values[iAdc];
+    }
+  }
+
+  for (int iAdc = 0; iAdc < NADCMCM; iAdc++) {
+    mInternalFilterRegisters[iAdc].mPedAcc = accumulator[iAdc];
   }
-  // LOG(debug) << "BEGIN: " << __FILE__ << ":" << __func__ << ":" << __LINE__ ;
 }
 
 void TrapSimulator::filterGainInit()
@@ -1260,12 +1290,41 @@ unsigned short TrapSimulator::filterGainNextSample(int adc, unsigned short value
 void TrapSimulator::filterGain()
 {
   // Read data from mADCF and apply gain filter.
+  // Same arithmetic as filterGainNextSample(), with the configuration
+  // read once and all ADC channels processed together for each timebin.
 
-  for (int adc = 0; adc < NADCMCM; adc++) {
-    for (int iTimeBin = 0; iTimeBin < mNTimeBin; iTimeBin++) {
-      mADCF[adc * mNTimeBin + iTimeBin] = filterGainNextSample(adc, mADCF[adc * mNTimeBin + iTimeBin]);
+  const unsigned int mgta = (unsigned short)mTrapConfig->getTrapReg(TrapConfig::kFGTA, mDetector, mRobPos, mMcmPos);
+  const unsigned int mgtb = (unsigned short)mTrapConfig->getTrapReg(TrapConfig::kFGTB, mDetector, mRobPos, mMcmPos);
+
+  std::array<unsigned int, mgkNLanes> mgfExtended{}, mga{}, counterA{}, counterB{}, values{};
+  for (int iAdc = 0; iAdc < NADCMCM; iAdc++) {
+    mgfExtended[iAdc] = 0x700 + (unsigned short)mTrapConfig->getTrapReg(TrapConfig::TrapReg_t(TrapConfig::kFGF0 + iAdc), mDetector, mRobPos, mMcmPos);
+    mga[iAdc] = (unsigned short)mTrapConfig->getTrapReg(TrapConfig::TrapReg_t(TrapConfig::kFGA0 + iAdc), mDetector, mRobPos, mMcmPos);
+    counterA[iAdc] = mInternalFilterRegisters[iAdc].mGainCounterA;
+    counterB[iAdc] = mInternalFilterRegisters[iAdc].mGainCounterB;
+  }
+
+  for (int iTimeBin = 0; iTimeBin < mNTimeBin; iTimeBin++) {
+    for (int iAdc = 0; iAdc < NADCMCM; iAdc++) {
+      values[iAdc] = mADCF[iAdc * mNTimeBin + iTimeBin] & 0xFFF;
+    }
+    for (int iAdc = 0; iAdc < mgkNLanes; iAdc++) {
+      unsigned int corr = std::min((values[iAdc] * mgfExtended[iAdc]) >> 11, 0xFFFu);
+      corr = std::min(corr + mga[iAdc], 0xFFFu);
+      // the threshold counters stop when full
+      unsigned int notFull = (counterA[iAdc] != 0x3FFFFFF) & (counterB[iAdc] != 0x3FFFFFF);
+      counterB[iAdc] += notFull & (corr >= mgtb);
+      counterA[iAdc] += notFull & (corr < mgtb) & (corr >= mgta);
+    }
+    for (int iAdc = 0; iAdc < NADCMCM; iAdc++) {
+      mADCF[iAdc * mNTimeBin + iTimeBin] = values[iAdc]; // the gain correction is not applied, see filterGainNextSample()
     }
   }
+
+  for (int iAdc = 0; iAdc < NADCMCM; iAdc++) {
+    mInternalFilterRegisters[iAdc].mGainCounterA = counterA[iAdc];
+    mInternalFilterRegisters[iAdc].mGainCounterB = counterB[iAdc];
+  }
 }
 
 void TrapSimulator::filterTailInit(int baseline)
@@ -1363,12 +1422,45 @@ unsigned short TrapSimulator::filterTailNextSample(int adc, unsigned short value
 void TrapSimulator::filterTail()
 {
   // Apply tail cancellation filter to all data.
+  // Same arithmetic as filterTailNextSample(), with the configuration
+  // read once and all ADC channels processed together for each timebin.
+
+  // exponents and weight calculated from configuration
+  const unsigned int alphaLong = 0x3ff & mTrapConfig->getTrapReg(TrapConfig::kFTAL, mDetector, mRobPos, mMcmPos);                            // the weight of the long component
+  const unsigned int lambdaLong = (1 << 10) | (1 << 9) | (mTrapConfig->getTrapReg(TrapConfig::kFTLL, mDetector, mRobPos, mMcmPos) & 0x1FF);  // the multiplier of the long component
+  const unsigned int lambdaShort = (0 << 10) | (1 << 9) | (mTrapConfig->getTrapReg(TrapConfig::kFTLS, mDetector, mRobPos, mMcmPos) & 0x1FF); // the multiplier of the short component
+  const bool bypass = mTrapConfig->getTrapReg(TrapConfig::kFTBY, mDetector, mRobPos, mMcmPos) == 0;                                          // bypass mode, active low
+
+  std::array<unsigned int, mgkNLanes> amplLong{}, amplShort{}, values{};
+  for (int iAdc = 0; iAdc < NADCMCM; iAdc++) {
+    amplLong[iAdc] = mInternalFilterRegisters[iAdc].mTailAmplLong;
+    amplShort[iAdc] = mInternalFilterRegisters[iAdc].mTailAmplShort;
+  }
 
   for (int iTimeBin = 0; iTimeBin < mNTimeBin; iTimeBin++) {
     for (int iAdc = 0; iAdc < NADCMCM; iAdc++) {
-      mADCF[iAdc * mNTimeBin + iTimeBin] = filterTailNextSample(iAdc, mADCF[iAdc * mNTimeBin + iTimeBin]);
+      values[iAdc] = mADCF[iAdc * mNTimeBin + iTimeBin] & 0xFFFF;
+    }
+    for (int iAdc = 0; iAdc < mgkNLanes; iAdc++) {
+      unsigned int inpVolt = values[iAdc] & 0xFFF; // 12 bits
+      // the difference between the input and the present generator outputs
+      unsigned int aQ = std::min(amplLong[iAdc] + amplShort[iAdc], 0xFFFu);
+      unsigned int aDiff = (inpVolt > aQ) ? inpVolt - aQ : 0u;
+      // the inputs to the two generators, weighted, give their new values
+      unsigned int alInpv = (aDiff * alphaLong) >> 11;
+      amplLong[iAdc] = ((std::min(amplLong[iAdc] + alInpv, 0xFFFu) * lambdaLong) >> 11) & 0xFFF;
+      amplShort[iAdc] = ((std::min(amplShort[iAdc] + aDiff - alInpv, 0xFFFu) * lambdaShort) >> 11) & 0xFFF;
+      values[iAdc] = bypass ? values[iAdc] : aDiff;
+    }
+    for (int iAdc = 0; iAdc < NADCMCM; iAdc++) {
+      mADCF[iAdc * mNTimeBin + iTimeBin] = values[iAdc];
     }
   }
+
+  for (int iAdc = 0; iAdc < NADCMCM; iAdc++) {
+    mInternalFilterRegisters[iAdc].mTailAmplLong = amplLong[iAdc];
+    mInternalFilterRegisters[iAdc].mTailAmplShort = amplShort[iAdc];
+  }
 }
 
 void TrapSimulator::zeroSupressionMapping()
@@ -1513,7 +1605,73 @@ void TrapSimulator::addHitToFitreg(int adc, unsigned short timebin, unsigned sho
   // LOG(debug) << "added hit of : "<<  adc<<":"<< qtot<<":"<< ypos<<":"<< timebin; // TODO add label indexes into the labels container for all those labels pertaining to this hit.
 }
 
-void TrapSimulator::calcFitreg()
+unsigned short TrapSimulator::calcHitCharge(int adcch, int timebin, unsigned int adcMask)
+{
+  // Total charge of the cluster of the ADC channels adcch to adcch + 2 in the timebin
+  // if it is a hit candidate centred on adcch + 1, 0 otherwise.
+  // One channel at a time, it is the reference for calcHitCharges().
+
+  if (((adcMask >> adcch) & 7) != 7) { //??? all 3 channels are present in case of ZS
+    return 0;
+  }
+  int adcLeft = mADCF[adcch * mNTimeBin + timebin];
+  int adcCentral = mADCF[(adcch + 1) * mNTimeBin + timebin];
+  int adcRight = mADCF[(adcch + 2) * mNTimeBin + timebin];
+
+  bool hitQual;
+  if (mTrapConfig->getTrapReg(TrapConfig::kTPVBY, mDetector, mRobPos, mMcmPos) == 0) {
+    // bypass the cluster verification
+    hitQual = true;
+  } else {
+    hitQual = ((adcLeft * adcRight) <
+               ((mTrapConfig->getTrapReg(TrapConfig::kTPVT, mDetector, mRobPos, mMcmPos) * adcCentral * adcCentral) >> 10));
+  }
+
+  // The accumulated charge is with the pedestal!!!
+  unsigned short qtotTemp = adcLeft + adcCentral + adcRight;
+  if ((hitQual) &&
+      (qtotTemp >= mTrapConfig->getTrapReg(TrapConfig::kTPHT, mDetector, mRobPos, mMcmPos)) &&
+      (adcLeft <= adcCentral) &&
+      (adcCentral > adcRight)) {
+    return qtotTemp;
+  }
+  return 0;
+}
+
+void TrapSimulator::calcHitCharges(int timebin, unsigned int adcMask, std::array<unsigned short, 20>& qTotal)
+{
+  // Same as calcHitCharge() for all the clusters of the timebin, which are stored in qTotal.
+  // The configuration is read once for the timebin and all the channels are tested together
+  // without branches, so that the loop can be vectorized.
+
+  const int regTPVBY = mTrapConfig->getTrapReg(TrapConfig::kTPVBY, mDetector, mRobPos, mMcmPos);
+  const int regTPVT = mTrapConfig->getTrapReg(TrapConfig::kTPVT, mDetector, mRobPos, mMcmPos);
+  const int regTPHT = mTrapConfig->getTrapReg(TrapConfig::kTPHT, mDetector, mRobPos, mMcmPos);
+  std::array<int, mgkNLanes + 2> adcValues{}; // padded with zeros like in the filters
+  std::array<unsigned short, mgkNLanes> hitCharge{};
+  std::array<int, mgkNLanes> channelsPresent{};
+  for (int iAdc = 0; iAdc < mgkNLanes; iAdc++) {
+    channelsPresent[iAdc] = ((adcMask >> iAdc) & 7) == 7; //??? all 3 channels are present in case of ZS
+  }
+  for (int iAdc = 0; iAdc < NADCMCM; iAdc++) {
+    adcValues[iAdc] = mADCF[iAdc * mNTimeBin + timebin];
+  }
+
+  for (int iAdc = 0; iAdc < mgkNLanes; iAdc++) {
+    int left = adcValues[iAdc];
+    int central = adcValues[iAdc + 1];
+    int right = adcValues[iAdc + 2];
+    // the cluster verification is bypassed if TPVBY = 0
+    bool quality = (regTPVBY == 0) | ((left * right) < ((regTPVT * central * central) >> 10));
+    // The accumulated charge is with the pedestal!!!
+    unsigned short qtot = left + central + right;
+    bool hit = channelsPresent[iAdc] & quality & (qtot >= regTPHT) & (left <= central) & (central > right);
+    hitCharge[iAdc] = hit ? qtot : 0;
+  }
+  std::copy(hitCharge.begin(), hitCharge.begin() + NADCMCM - 2, qTotal.begin());
+}
+
+void TrapSimulator::calcFitreg(bool hitChargeByChannel)
 {
   // Preprocessing.
   // Detect the hits and fill the fit registers.
@@ -1523,9 +1681,8 @@ void TrapSimulator::calcFitreg()
   LOG(debug) << "ENTERING : " << __FILE__ << ":" << __func__ << ":" << __LINE__ << " :: " << getDetector() << ":" << getRobPos() << ":" << getMcmPos() << " -------------------- mNHits : " << mNHits;
   unsigned int adcMask = 0xffffffff;
 
-  bool hitQual;
   int adcLeft, adcCentral, adcRight;
-  unsigned short timebin, adcch, timebin1, timebin2, qtotTemp;
+  unsigned short timebin, adcch, timebin1, timebin2;
   short ypos, fromLeft, fromRight, found;
   std::array<unsigned short, 20> qTotal{}; //[19 + 1]; // the last is dummy
   std::array<unsigned short, 6> marked{}, qMarked{};
@@ -1564,53 +1721,17 @@ void TrapSimulator::calcFitreg()
   }
   mNHits = 0;
 
+  const int regTPFP = mTrapConfig->getTrapReg(TrapConfig::kTPFP, mDetector, mRobPos, mMcmPos);
+
   for (timebin = timebin1; timebin < timebin2; timebin++) {
     // first find the hit candidates and store the total cluster charge in qTotal array
     // in case of not hit store 0 there.
-    for (adcch = 0; adcch < NADCMCM - 2; adcch++) {
-      if (((adcMask >> adcch) & 7) == 7) //??? all 3 channels are present in case of ZS
-      {
-        adcLeft = mADCF[adcch * mNTimeBin + timebin];
-        adcCentral = mADCF[(adcch + 1) * mNTimeBin + timebin];
-        adcRight = mADCF[(adcch + 2) * mNTimeBin + timebin];
-
-        if (mTrapConfig->getTrapReg(TrapConfig::kTPVBY, mDetector, mRobPos, mMcmPos) == 0) {
-          // bypass the cluster verification
-          hitQual = true;
-        } else {
-          hitQual = ((adcLeft * adcRight) <
-                     ((mTrapConfig->getTrapReg(TrapConfig::kTPVT, mDetector, mRobPos, mMcmPos) * adcCentral * adcCentral) >> 10));
-          if (hitQual) {
-            LOG(debug) << "cluster quality cut passed with " << adcLeft << ", " << adcCentral << ", "
-                       << adcRight << " - threshold " << mTrapConfig->getTrapReg(TrapConfig::kTPVT, mDetector, mRobPos, mMcmPos)
-                       << " -> " << mTrapConfig->getTrapReg(TrapConfig::kTPVT, mDetector, mRobPos, mMcmPos) * adcCentral * adcCentral;
-          }
-        }
-
-        // The accumulated charge is with the pedestal!!!
-        qtotTemp = adcLeft + adcCentral + adcRight;
-        if ((qtotTemp > 130)) {
-          LOG(debug) << "qtotTemp>130 "
-                     << "qtot=" << qtotTemp
-                     << " qleft=" << adcLeft
-                     << " qcent=" << adcCentral
-                     << " qright=" << adcRight
-                     << " for " << mDetector << ":" << mRobPos << ":" << mMcmPos << ":adcleft:" << adcch << ":t" << timebin;
-        }
-
-        if ((hitQual) &&
-            (qtotTemp >= mTrapConfig->getTrapReg(TrapConfig::kTPHT, mDetector, mRobPos, mMcmPos)) &&
-            (adcLeft <= adcCentral) &&
-            (adcCentral > adcRight)) {
-          qTotal[adcch] = qtotTemp;
-        } else {
-          qTotal[adcch] = 0;
-        }
-      } else {
-        qTotal[adcch] = 0; //jkl
+    if (hitChargeByChannel) {
+      for (adcch = 0; adcch < NADCMCM - 2; adcch++) {
+        qTotal[adcch] = calcHitCharge(adcch, timebin, adcMask);
       }
-      //     if (qTotal[adcch] != 0)
-      //     LOG(debug) << "ch " << setw(2) << adcch << "   qTotal " << qTotal[adcch];
+    } else {
+      calcHitCharges(timebin, adcMask, qTotal);
     }
 
     fromLeft = -1;
@@ -1693,7 +1814,6 @@ void TrapSimulator::calcFitreg()
         // hit detected, in TRAP we have 4 units and a hit-selection, here we proceed all channels!
         // subtract the pedestal TPFP, clipping instead of wrapping
 
-        int regTPFP = mTrapConfig->getTrapReg(TrapConfig::kTPFP, mDetector, mRobPos, mMcmPos); //TODO put this together with the others as members of trapsim, which is initiliased by det,rob,mcm.
         LOG(debug) << "Hit found, time=" << timebin << ", adcch=" << adcch << "/" << adcch + 1 << "/"
                    << adcch + 2 << ", adc values=" << adcLeft << "/" << adcCentral << "/"
                    << adcRight << ", regTPFP=" << regTPFP << ", TPHT=" << mTrapConfig->getTrapReg(TrapConfig::kTPHT, mDetector, mRobPos, mMcmPos);
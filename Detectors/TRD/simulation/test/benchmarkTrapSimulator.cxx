@@ -0,0 +1,84 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file benchmarkTrapSimulator.cxx
+/// \brief Benchmark of the digital filters of the TRAP simulation, in MCM per second
+
+#include "benchmark/benchmark.h"
+
+#include "DataFormatsTRD/Constants.h"
+#include "TRDSimulation/TrapConfig.h"
+#include "TRDSimulation/TrapSimulator.h"
+
+#include <array>
+#include <random>
+
+using namespace o2::trd;
+using namespace o2::trd::constants;
+
+constexpr int NTIMEBINS = 30;
+
+/// Set up a simulator with one MCM of random ADC values, mostly around the baseline with a few pulses
+void setupSimulator(TrapConfig& config, TrapSimulator& sim)
+{
+  config.setTrapReg(TrapConfig::kC13CPUA, NTIMEBINS, 0);
+  config.setTrapReg(TrapConfig::kFPBY, 1, 0);
+  config.setTrapReg(TrapConfig::kFTBY, 1, 0);
+  sim.init(&config, 0, 0, 0);
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> baseline(8, 12), signal(0, 1023), select(0, 9);
+  for (int adc = 0; adc < NADCMCM; adc++) {
+    for (int tb = 0; tb < NTIMEBINS; tb++) {
+      sim.setData(adc, tb, select(gen) == 0 ? signal(gen) : baseline(gen));
+    }
+  }
+}
+
+/// Pedestal and tail filters applied sample by sample, as done before the ADC channels were processed together
+static void BM_TrapFiltersSampleBySample(benchmark::State& state)
+{
+  TrapConfig config;
+  TrapSimulator sim;
+  setupSimulator(config, sim);
+  std::array<unsigned short, NADCMCM * NTIMEBINS> values;
+  for (auto _ : state) {
+    for (int tb = 0; tb < NTIMEBINS; tb++) {
+      for (int adc = 0; adc < NADCMCM; adc++) {
+        values[adc * NTIMEBINS + tb] = sim.filterPedestalNextSample(adc, tb, sim.getDataRaw(adc, tb));
+      }
+    }
+    for (int tb = 0; tb < NTIMEBINS; tb++) {
+      for (int adc = 0; adc < NADCMCM; adc++) {
+        values[adc * NTIMEBINS + tb] = sim.filterTailNextSample(adc, values[adc * NTIMEBINS + tb]);
+      }
+    }
+    benchmark::DoNotOptimize(values);
+  }
+  state.counters["MCM/s"] = benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+
+/// Filter chain as run in the digitization, all the ADC channels of the MCM being processed together
+static void BM_TrapFilters(benchmark::State& state)
+{
+  TrapConfig config;
+  TrapSimulator sim;
+  setupSimulator(config, sim);
+  for (auto _ : state) {
+    sim.filter();
+    benchmark::DoNotOptimize(sim.getDataFiltered(0, 0));
+  }
+  state.counters["MCM/s"] = benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_TrapFiltersSampleBySample)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TrapFilters)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
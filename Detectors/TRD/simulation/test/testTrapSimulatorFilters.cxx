@@ -0,0 +1,178 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test TRD TrapSimulator filters
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "DataFormatsTRD/Constants.h"
+#include "TRDSimulation/TrapConfig.h"
+#include "TRDSimulation/TrapSimulator.h"
+
+#include <array>
+#include <random>
+
+namespace o2
+{
+namespace trd
+{
+
+using namespace o2::trd::constants;
+
+constexpr int NTIMEBINS = 30;
+
+// fill both simulators with the same random ADC values, mostly around the baseline with a few pulses
+void fillData(TrapSimulator& sim1, TrapSimulator& sim2, std::mt19937& gen)
+{
+  std::uniform_int_distribution<int> baseline(8, 12), signal(0, 1023), select(0, 9);
+  for (int adc = 0; adc < NADCMCM; adc++) {
+    for (int tb = 0; tb < NTIMEBINS; tb++) {
+      int value = select(gen) == 0 ? signal(gen) : baseline(gen);
+      sim1.setData(adc, tb, value);
+      sim2.setData(adc, tb, value);
+    }
+  }
+}
+
+// apply the filter chain sample by sample with the scalar functions, which are the reference
+void filterSampleBySample(TrapSimulator& sim, std::array<unsigned short, NADCMCM * NTIMEBINS>& values)
+{
+  for (int tb = 0; tb < NTIMEBINS; tb++) {
+    for (int adc = 0; adc < NADCMCM; adc++) {
+      values[adc * NTIMEBINS + tb] = sim.filterPedestalNextSample(adc, tb, sim.getDataRaw(adc, tb));
+    }
+  }
+  for (int adc = 0; adc < NADCMCM; adc++) {
+    for (int tb = 0; tb < NTIMEBINS; tb++) {
+      values[adc * NTIMEBINS + tb] = sim.filterGainNextSample(adc, values[adc * NTIMEBINS + tb]);
+    }
+  }
+  for (int tb = 0; tb < NTIMEBINS; tb++) {
+    for (int adc = 0; adc < NADCMCM; adc++) {
+      values[adc * NTIMEBINS + tb] = sim.filterTailNextSample(adc, values[adc * NTIMEBINS + tb]);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TrapFilters_test)
+{
+  std::mt19937 gen(12345);
+  std::uniform_int_distribution<int> fptc(0, 3), ftal(0, 0x3ff), ftl(0, 0x1ff), fg(0, 0x1ff), fga(0, 63), bypass(0, 1);
+
+  for (int iConfig = 0; iConfig < 20; iConfig++) {
+    TrapConfig config;
+    config.setTrapReg(TrapConfig::kC13CPUA, NTIMEBINS, 0);
+    config.setTrapReg(TrapConfig::kFPTC, fptc(gen), 0);
+    config.setTrapReg(TrapConfig::kFPBY, bypass(gen), 0);
+    config.setTrapReg(TrapConfig::kFTAL, ftal(gen), 0);
+    config.setTrapReg(TrapConfig::kFTLL, ftl(gen), 0);
+    config.setTrapReg(TrapConfig::kFTLS, ftl(gen), 0);
+    config.setTrapReg(TrapConfig::kFTBY, bypass(gen), 0);
+    for (int adc = 0; adc < NADCMCM; adc++) {
+      config.setTrapReg(TrapConfig::TrapReg_t(TrapConfig::kFGF0 + adc), fg(gen), 0);
+      config.setTrapReg(TrapConfig::TrapReg_t(TrapConfig::kFGA0 + adc), fga(gen), 0);
+    }
+
+    TrapSimulator reference, simulator;
+    reference.init(&config, 0, 0, 0);
+    simulator.init(&config, 0, 0, 0);
+
+    // several events in a row, to check that the internal filter registers evolve identically
+    for (int iEvent = 0; iEvent < 5; iEvent++) {
+      fillData(reference, simulator, gen);
+      std::array<unsigned short, NADCMCM * NTIMEBINS> expected;
+      filterSampleBySample(reference, expected);
+
+      simulator.filterPedestal();
+      simulator.filterGain();
+      simulator.filterTail();
+
+      for (int adc = 0; adc < NADCMCM; adc++) {
+        for (int tb = 0; tb < NTIMEBINS; tb++) {
+          BOOST_REQUIRE_EQUAL(simulator.getDataFiltered(adc, tb), expected[adc * NTIMEBINS + tb]);
+        }
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TrapHitCandidates_test)
+{
+  std::mt19937 gen(54321);
+  std::uniform_int_distribution<int> tpvt(0, 63), tpht(0, 400), tpfp(0, 100), bypass(0, 1);
+  std::uniform_int_distribution<unsigned int> mask(0, 0x1fffff);
+  int nCandidates = 0, nHits = 0;
+
+  for (int iConfig = 0; iConfig < 20; iConfig++) {
+    TrapConfig config;
+    config.setTrapReg(TrapConfig::kC13CPUA, NTIMEBINS, 0);
+    config.setTrapReg(TrapConfig::kTPVBY, bypass(gen), 0);
+    config.setTrapReg(TrapConfig::kTPVT, tpvt(gen), 0);
+    config.setTrapReg(TrapConfig::kTPHT, tpht(gen), 0);
+    config.setTrapReg(TrapConfig::kTPFP, tpfp(gen), 0);
+
+    TrapSimulator reference, simulator;
+    reference.init(&config, 0, 0, 0);
+    simulator.init(&config, 0, 0, 0);
+
+    for (int iEvent = 0; iEvent < 5; iEvent++) {
+      fillData(reference, simulator, gen);
+      for (auto sim : {&reference, &simulator}) {
+        sim->filterPedestal();
+        sim->filterGain();
+        sim->filterTail();
+      }
+
+      // the charge of the hit candidates, all channels together or channel by channel
+      for (int tb = 0; tb < NTIMEBINS; tb++) {
+        for (unsigned int adcMask : {0xffffffffu, mask(gen)}) {
+          std::array<unsigned short, 20> qTotal{};
+          simulator.calcHitCharges(tb, adcMask, qTotal);
+          for (int adcch = 0; adcch < NADCMCM - 2; adcch++) {
+            BOOST_REQUIRE_EQUAL(qTotal[adcch], reference.calcHitCharge(adcch, tb, adcMask));
+            nCandidates += qTotal[adcch] > 0;
+          }
+        }
+      }
+
+      // the fit registers and the hits, with the hit candidates found either way
+      reference.calcFitreg(true);
+      simulator.calcFitreg();
+      for (int adc = 0; adc < NADCMCM; adc++) {
+        const auto& fitReg = simulator.mFitReg[adc];
+        const auto& expected = reference.mFitReg[adc];
+        BOOST_REQUIRE_EQUAL(fitReg.mNhits, expected.mNhits);
+        BOOST_REQUIRE_EQUAL(fitReg.mQ0, expected.mQ0);
+        BOOST_REQUIRE_EQUAL(fitReg.mQ1, expected.mQ1);
+        BOOST_REQUIRE_EQUAL(fitReg.mQ2, expected.mQ2);
+        BOOST_REQUIRE_EQUAL(fitReg.mSumX, expected.mSumX);
+        BOOST_REQUIRE_EQUAL(fitReg.mSumY, expected.mSumY);
+        BOOST_REQUIRE_EQUAL(fitReg.mSumX2, expected.mSumX2);
+        BOOST_REQUIRE_EQUAL(fitReg.mSumY2, expected.mSumY2);
+        BOOST_REQUIRE_EQUAL(fitReg.mSumXY, expected.mSumXY);
+        nHits += fitReg.mNhits;
+      }
+      for (size_t iHit = 0; iHit < simulator.mHits.size(); iHit++) {
+        BOOST_REQUIRE_EQUAL(simulator.mHits[iHit].mChannel, reference.mHits[iHit].mChannel);
+        BOOST_REQUIRE_EQUAL(simulator.mHits[iHit].mTimebin, reference.mHits[iHit].mTimebin);
+        BOOST_REQUIRE_EQUAL(simulator.mHits[iHit].mQtot, reference.mHits[iHit].mQtot);
+        BOOST_REQUIRE_EQUAL(simulator.mHits[iHit].mYpos, reference.mHits[iHit].mYpos);
+      }
+    }
+  }
+  // the random data do produce hits
+  BOOST_CHECK_GT(nCandidates, 0);
+  BOOST_CHECK_GT(nHits, 0);
+}
+
+} // namespace trd
+} // namespace o2
@@ -31,7 +31,9 @@
 #endif
 #include <TGrid.h>
 #include <TFile.h>
+#include <TROOT.h>
 #include <TTreeCache.h>
+#include <TTreeCacheUnzip.h>
 
 #include <arrow/ipc/reader.h>
 #include <arrow/ipc/writer.h>
@@ -39,6 +41,7 @@
 #include <arrow/table.h>
 #include <arrow/util/key_value_metadata.h>
 
+#include <future>
 #include <thread>
 
 using namespace o2;
@@ -87,19 +90,61 @@ struct RuntimeWatchdog {
   }
 };
 
-template <typename... C>
-static constexpr auto columnNamesTrait(framework::pack<C...>)
-{
-  return std::vector<std::string>{C::columnLabel()...};
-}
+/// The tables of one dataframe, read from the input files
+struct DataFrameTables {
+  bool endOfFile = false; // the requested dataframe is not in the current file
+  uint64_t timeFrameNumber = 0;
+  size_t sizeCompressed = 0;
+  size_t sizeUncompressed = 0;
+  std::vector<std::pair<o2::header::DataHeader, std::unique_ptr<o2::framework::TreeToTable>>> tables;
+};
 
-std::vector<std::string> getColumnNames(header::DataHeader dh)
+/// Reads the requested tables of dataframe numTF in file fileCounter.
+/// Only the DataInputDirector is used, such that this can run in a separate thread.
+DataFrameTables readDataFrame(o2::framework::DataInputDirector& didir, std::vector<o2::header::DataHeader> const& headers,
+                              int fileCounter, int numTF, int64_t treeCacheSize)
 {
-  auto description = std::string(dh.dataDescription.str);
-  auto origin = std::string(dh.dataOrigin.str);
+  using namespace o2::framework;
+  DataFrameTables df;
+  for (auto& dh : headers) {
+    TTree* tr = didir.getDataTree(dh, fileCounter, numTF);
+    if (!tr) {
+      if (df.tables.empty()) {
+        df.endOfFile = true;
+        return df;
+      }
+      LOGP(fatal, "Can not retrieve tree for table {}: fileCounter {}, timeFrame {}", dh.dataOrigin.as<std::string>(), fileCounter, numTF);
+      throw std::runtime_error("Processing is stopped!");
+    }
+    if (df.tables.empty()) {
+      df.timeFrameNumber = didir.getTimeFrameNumber(dh, fileCounter, numTF);
+    }
 
-  // default: column names = {}
-  return std::vector<std::string>({});
+    // add branches to read
+    // fill the table
+    auto t2t = std::make_unique<TreeToTable>();
+    auto colnames = didir.getColumnNames(dh);
+    t2t->setLabel(tr->GetName());
+    t2t->setTreeCacheSize(treeCacheSize);
+    if (colnames.size() == 0) {
+      df.sizeCompressed += tr->GetZipBytes();
+      df.sizeUncompressed += tr->GetTotBytes();
+      t2t->addAllColumns(tr);
+    } else {
+      for (auto& colname : colnames) {
+        TBranch* branch = tr->GetBranch(colname.c_str());
+        if (branch) {
+          df.sizeCompressed += branch->GetZipBytes("*");
+          df.sizeUncompressed += branch->GetTotBytes("*");
+        }
+      }
+      t2t->addAllColumns(tr, std::move(colnames));
+    }
+    t2t->fill(tr);
+    delete tr;
+    df.tables.emplace_back(dh, std::move(t2t));
+  }
+  return df;
 }
 
 using o2::monitoring::Metric;
@@ -195,18 +240,39 @@ AlgorithmSpec AODJAlienReaderHelpers::rootFileReaderCallback()
       }
     }
 
+    // decompression of the baskets on the ROOT IMT thread pool
+    int64_t treeCacheSize = 0;
+    auto nThreads = options.get<int>("aod-reader-threads");
+    if (nThreads > 0) {
+#ifdef R__USE_IMT
+      ROOT::EnableImplicitMT(nThreads);
+      TTreeCacheUnzip::SetParallelUnzip(TTreeCacheUnzip::kEnable);
+      treeCacheSize = 50 * 1024 * 1024;
+#else
+      LOGP(warn, "ROOT is built without IMT support, baskets are decompressed sequentially");
+#endif
+    }
+    // the next dataframe is read by a separate thread while the current one is processed
+    auto prefetch = options.get<bool>("aod-reader-prefetch");
+    if (prefetch) {
+      ROOT::EnableThreadSafety();
+    }
+
     auto fileCounter = std::make_shared<int>(0);
     auto numTF = std::make_shared<int>(-1);
+    auto prefetched = std::make_shared<std::future<DataFrameTables>>();
     return adaptStateless([TFNumberHeader,
                            requestedTables,
                            fileCounter,
                            numTF,
                            watchdog,
-                           didir](Monitoring& monitoring, DataAllocator& outputs, ControlService& control, DeviceSpec const& device) {
+                           didir,
+                           treeCacheSize,
+                           prefetch,
+                           prefetched](Monitoring& monitoring, DataAllocator& outputs, ControlService& control, DeviceSpec const& device) {
       // Each parallel reader device.inputTimesliceId reads the files fileCounter*device.maxInputTimeslices+device.inputTimesliceId
       // the TF to read is numTF
       assert(device.inputTimesliceId < device.maxInputTimeslices);
-      uint64_t timeFrameNumber = 0;
       int fcnt = (*fileCounter * device.maxInputTimeslices) + device.inputTimesliceId;
       int ntf = *numTF + 1;
       static int currentFileCounter = -1;
@@ -216,8 +282,6 @@ AlgorithmSpec AODJAlienReaderHelpers::rootFileReaderCallback()
         monitoring.send(Metric{(uint64_t)++filesProcessed, "files-opened"}.addTag(Key::Subsystem, monitoring::tags::Value::DPL));
       }
 
-      // loop over requested tables
-      bool first = true;
       static size_t totalSizeUncompressed = 0;
       static size_t totalSizeCompressed = 0;
       static TFile* currentFile = nullptr;
@@ -226,98 +290,79 @@ AlgorithmSpec AODJAlienReaderHelpers::rootFileReaderCallback()
       static uint64_t currentFileIOTime = 0;
       static uint64_t totalDFSent = 0;
 
+      // must not be called while a dataframe is being prefetched
+      auto finish = [&]() {
+        didir->closeInputFiles();
+        control.endOfStream();
+        control.readyToQuit(QuitRequest::Me);
+      };
+
       // check if RuntimeLimit is reached
       if (!watchdog->update()) {
         LOGP(info, "Run time exceeds run time limit of {} seconds. Exiting gracefully...", watchdog->runTimeLimit);
         LOGP(info, "Stopping reader {} after time frame {}.", device.inputTimesliceId, watchdog->numberTimeFrames - 1);
+        // the prefetching thread reads from currentFile, wait for it before
+        // the read statistics of the file are taken
+        if (prefetched->valid()) {
+          prefetched->wait();
+        }
         dumpFileMetrics(monitoring, currentFile, currentFileStartedAt, currentFileIOTime, tfCurrentFile, ntf);
         monitoring.flushBuffer();
-        didir->closeInputFiles();
-        control.endOfStream();
-        control.readyToQuit(QuitRequest::Me);
+        finish();
         return;
       }
 
       auto ioStart = uv_hrtime();
 
+      std::vector<header::DataHeader> headers;
       for (auto& route : requestedTables) {
         if ((device.inputTimesliceId % route.maxTimeslices) != route.timeslice) {
           continue;
         }
-
-        // create header
         auto concrete = DataSpecUtils::asConcreteDataMatcher(route.matcher);
-        auto dh = header::DataHeader(concrete.description, concrete.origin, concrete.subSpec);
-
-        // create a TreeToTable object
-        TTree* tr = didir->getDataTree(dh, fcnt, ntf);
-        if (!tr) {
-          if (first) {
-            // dump metrics of file which is done for reading
-            dumpFileMetrics(monitoring, currentFile, currentFileStartedAt, currentFileIOTime, tfCurrentFile, ntf);
-            currentFile = nullptr;
-            currentFileStartedAt = uv_hrtime();
-            currentFileIOTime = 0;
-
-            // check if there is a next file to read
-            fcnt += device.maxInputTimeslices;
-            if (didir->atEnd(fcnt)) {
-              LOGP(info, "No input files left to read for reader {}!", device.inputTimesliceId);
-              didir->closeInputFiles();
-              control.endOfStream();
-              control.readyToQuit(QuitRequest::Me);
-              return;
-            }
-            // get first folder of next file
-            ntf = 0;
-            tr = didir->getDataTree(dh, fcnt, ntf);
-            if (!tr) {
-              LOGP(fatal, "Can not retrieve tree for table {}: fileCounter {}, timeFrame {}", concrete.origin, fcnt, ntf);
-              throw std::runtime_error("Processing is stopped!");
-            }
-          } else {
-            LOGP(fatal, "Can not retrieve tree for table {}: fileCounter {}, timeFrame {}", concrete.origin, fcnt, ntf);
-            throw std::runtime_error("Processing is stopped!");
-          }
-        }
+        headers.emplace_back(concrete.description, concrete.origin, concrete.subSpec);
+      }
 
-        if (first) {
-          timeFrameNumber = didir->getTimeFrameNumber(dh, fcnt, ntf);
-          auto o = Output(TFNumberHeader);
-          outputs.make<uint64_t>(o) = timeFrameNumber;
+      // the prefetched dataframe is always the one following the previous call
+      auto df = prefetched->valid() ? prefetched->get() : readDataFrame(*didir, headers, fcnt, ntf, treeCacheSize);
+      if (df.endOfFile) {
+        // dump metrics of file which is done for reading
+        dumpFileMetrics(monitoring, currentFile, currentFileStartedAt, currentFileIOTime, tfCurrentFile, ntf);
+        currentFile = nullptr;
+        currentFileStartedAt = uv_hrtime();
+        currentFileIOTime = 0;
+
+        // check if there is a next file to read
+        fcnt += device.maxInputTimeslices;
+        if (didir->atEnd(fcnt)) {
+          LOGP(info, "No input files left to read for reader {}!", device.inputTimesliceId);
+          finish();
+          return;
         }
-
-        // create table output
-        auto o = Output(dh);
-        auto& t2t = outputs.make<TreeToTable>(o);
-
-        // add branches to read
-        // fill the table
-        auto colnames = getColumnNames(dh);
-        t2t.setLabel(tr->GetName());
-        if (colnames.size() == 0) {
-          totalSizeCompressed += tr->GetZipBytes();
-          totalSizeUncompressed += tr->GetTotBytes();
-          t2t.addAllColumns(tr);
-        } else {
-          for (auto& colname : colnames) {
-            TBranch* branch = tr->GetBranch(colname.c_str());
-            totalSizeCompressed += branch->GetZipBytes("*");
-            totalSizeUncompressed += branch->GetTotBytes("*");
-          }
-          t2t.addAllColumns(tr, std::move(colnames));
+        // get first folder of next file
+        ntf = 0;
+        df = readDataFrame(*didir, headers, fcnt, ntf, treeCacheSize);
+        if (df.endOfFile) {
+          LOGP(fatal, "Can not retrieve tree for table {}: fileCounter {}, timeFrame {}", headers.front().dataOrigin.as<std::string>(), fcnt, ntf);
+          throw std::runtime_error("Processing is stopped!");
         }
-        t2t.fill(tr);
-        delete tr;
+      }
+
+      if (!df.tables.empty()) {
+        outputs.make<uint64_t>(Output(TFNumberHeader)) = df.timeFrameNumber;
 
         // needed for metrics dumping (upon next file read, or terminate due to watchdog)
         if (currentFile == nullptr) {
-          currentFile = didir->getFileFolder(dh, fcnt, ntf).file;
-          tfCurrentFile = didir->getTimeFramesInFile(dh, fcnt);
+          currentFile = didir->getFileFolder(df.tables.front().first, fcnt, ntf).file;
+          tfCurrentFile = didir->getTimeFramesInFile(df.tables.front().first, fcnt);
         }
-
-        first = false;
       }
+      for (auto& [dh, t2t] : df.tables) {
+        outputs.adopt(Output(dh), t2t.release());
+      }
+      totalSizeCompressed += df.sizeCompressed;
+      totalSizeUncompressed += df.sizeUncompressed;
+
       totalDFSent++;
       monitoring.send(Metric{(uint64_t)totalDFSent, "df-sent"}.addTag(Key::Subsystem, monitoring::tags::Value::DPL));
       monitoring.send(Metric{(uint64_t)totalSizeUncompressed / 1000, "aod-bytes-read-uncompressed"}.addTag(Key::Subsystem, monitoring::tags::Value::DPL));
@@ -327,6 +372,12 @@ AlgorithmSpec AODJAlienReaderHelpers::rootFileReaderCallback()
       *fileCounter = (fcnt - device.inputTimesliceId) / device.maxInputTimeslices;
       *numTF = ntf;
       currentFileIOTime += (uv_hrtime() - ioStart);
+
+      // start reading the next dataframe of the same file. If it is not in
+      // this file the next call switches file as without prefetching.
+      if (prefetch && !headers.empty()) {
+        *prefetched = std::async(std::launch::async, readDataFrame, std::ref(*didir), headers, fcnt, ntf + 1, treeCacheSize);
+      }
     });
   })};
 
@@ -17,7 +17,11 @@
 #include "Framework/RuntimeError.h"
 #include <arrow/table.h>
 
+#include <atomic>
+#include <exception>
 #include <iterator>
+#include <mutex>
+#include <thread>
 #include <tuple>
 #include <utility>
 
@@ -197,6 +201,19 @@ void syncCategories(std::array<std::vector<std::pair<uint64_t, uint64_t>>, K>& g
   }
 }
 
+// Split grouped indices into the [begin, end) ranges of their categories
+inline std::vector<std::pair<uint64_t, uint64_t>> groupedCategoryBlocks(std::vector<std::pair<uint64_t, uint64_t>> const& groupedIndices)
+{
+  std::vector<std::pair<uint64_t, uint64_t>> blocks;
+  auto catBegin = groupedIndices.begin();
+  while (catBegin != groupedIndices.end()) {
+    auto catEnd = std::upper_bound(catBegin, groupedIndices.end(), *catBegin, sameCategory);
+    blocks.emplace_back(std::distance(groupedIndices.begin(), catBegin), std::distance(groupedIndices.begin(), catEnd));
+    catBegin = catEnd;
+  }
+  return blocks;
+}
+
 template <typename... Ts>
 struct CombinationsIndexPolicyBase {
   using CombinationType = std::tuple<typename Ts::iterator...>;
@@ -499,6 +516,37 @@ struct CombinationsBlockIndexPolicyBase : public CombinationsIndexPolicyBase<Ts.
     });
   }
 
+  /// @return the [begin, end) ranges of the categories in the grouped indices
+  /// of the first table, in iteration order
+  std::vector<std::pair<uint64_t, uint64_t>> getCategoryBlocks() const
+  {
+    return groupedCategoryBlocks(this->mGroupedIndices[0]);
+  }
+
+  /// Restrict the combinations to the categories found in [begin, end) of
+  /// the grouped indices of the first table. The policy is rewound to the
+  /// first of these categories, the derived policy has to set its ranges again.
+  /// Positions in the grouped indices are kept, as the upper policy compares
+  /// them across tables.
+  void restrictToCategories(uint64_t begin, uint64_t end)
+  {
+    constexpr auto k = sizeof...(Ts);
+    if (begin >= end) {
+      this->mIsEnd = true;
+      return;
+    }
+    std::pair<uint64_t, uint64_t> firstCategory{this->mGroupedIndices[0][begin].first, 0};
+    std::pair<uint64_t, uint64_t> lastCategory{this->mGroupedIndices[0][end - 1].first, 0};
+    for_<k>([&, this](auto i) {
+      auto& indices = this->mGroupedIndices[i.value];
+      auto first = std::lower_bound(indices.begin(), indices.end(), firstCategory, sameCategory);
+      auto last = std::upper_bound(first, indices.end(), lastCategory, sameCategory);
+      std::get<i.value>(this->mCurrentIndices) = std::distance(indices.begin(), first);
+      indices.erase(last, indices.end());
+    });
+    this->mIsEnd = false;
+  }
+
   std::array<std::vector<std::pair<uint64_t, uint64_t>>, sizeof...(Ts)> mGroupedIndices;
   IndicesType mCurrentIndices;
   IndicesType mBeginIndices;
@@ -823,6 +871,26 @@ struct CombinationsBlockSameIndexPolicyBase : public CombinationsIndexPolicyBase
     std::get<0>(this->mCurrentIndices) = 0;
   }
 
+  /// @return the [begin, end) ranges of the categories in the grouped indices, in iteration order
+  std::vector<std::pair<uint64_t, uint64_t>> getCategoryBlocks() const
+  {
+    return groupedCategoryBlocks(this->mGroupedIndices);
+  }
+
+  /// Restrict the combinations to the categories found in [begin, end) of
+  /// the grouped indices. The policy is rewound to the first of these
+  /// categories, the derived policy has to set its ranges again.
+  void restrictToCategories(uint64_t begin, uint64_t end)
+  {
+    if (begin >= end) {
+      this->mIsEnd = true;
+      return;
+    }
+    this->mGroupedIndices.resize(end);
+    std::get<0>(this->mCurrentIndices) = begin;
+    this->mIsEnd = false;
+  }
+
   std::vector<std::pair<uint64_t, uint64_t>> mGroupedIndices;
   IndicesType mCurrentIndices;
   const uint64_t mSlidingWindowSize;
@@ -1241,6 +1309,108 @@ struct CombinationsGenerator {
   iterator mEnd;
 };
 
+/// Split the combinations of a block policy into at most @a nParts
+/// independent generators, each covering a contiguous range of categories.
+/// Combinations never span categories, so the parts together yield exactly
+/// the combinations of @a policy, in the same order, and can be iterated
+/// concurrently. Categories are distributed so that the parts have a
+/// similar estimated number of combinations. @a policy must not have been
+/// advanced.
+template <typename P>
+std::vector<CombinationsGenerator<P>> partitionCombinations(P const& policy, int nParts)
+{
+  std::vector<CombinationsGenerator<P>> parts;
+  if (policy.mIsEnd || nParts <= 1) {
+    parts.emplace_back(policy);
+    return parts;
+  }
+
+  constexpr auto k = std::tuple_size_v<typename P::CombinationType>;
+  auto blocks = policy.getCategoryBlocks();
+  std::vector<double> costs;
+  costs.reserve(blocks.size());
+  double totalCost = 0;
+  for (auto& [begin, end] : blocks) {
+    double size = end - begin;
+    double window = std::min<double>(size, policy.mSlidingWindowSize);
+    double cost = size;
+    for (size_t i = 1; i < k; i++) {
+      cost *= window;
+    }
+    costs.push_back(cost);
+    totalCost += cost;
+  }
+
+  double target = totalCost / nParts;
+  double accumulated = 0;
+  size_t first = 0;
+  for (size_t bi = 0; bi < blocks.size(); bi++) {
+    accumulated += costs[bi];
+    bool lastBlock = bi + 1 == blocks.size();
+    if (lastBlock || (accumulated >= target && static_cast<int>(parts.size()) + 1 < nParts)) {
+      P part(policy);
+      part.restrictToCategories(blocks[first].first, blocks[bi].second);
+      part.setRanges();
+      parts.emplace_back(part);
+      accumulated = 0;
+      first = bi + 1;
+    }
+  }
+  return parts;
+}
+
+/// Invoke @a f on all the combinations of a block policy, using @a nThreads
+/// threads. @a f is called as f(slot, combination), where slot in [0, nThreads)
+/// identifies the calling thread, so that per-thread outputs can be filled
+/// without locking. The combinations are split in more parts than threads
+/// and the parts are picked up dynamically, to cope with uneven categories.
+/// The first exception thrown by @a f is rethrown once all threads are done.
+template <typename P, typename F>
+void parallelCombinations(P const& policy, int nThreads, F&& f)
+{
+  if (nThreads <= 1) {
+    for (auto& comb : CombinationsGenerator<P>(policy)) {
+      f(0, comb);
+    }
+    return;
+  }
+
+  constexpr int partsPerThread = 4;
+  auto parts = partitionCombinations(policy, nThreads * partsPerThread);
+  std::atomic<size_t> nextPart{0};
+  std::exception_ptr error;
+  std::mutex errorMutex;
+
+  auto worker = [&](int slot) {
+    try {
+      for (auto pi = nextPart++; pi < parts.size(); pi = nextPart++) {
+        for (auto& comb : parts[pi]) {
+          f(slot, comb);
+        }
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(errorMutex);
+      if (!error) {
+        error = std::current_exception();
+      }
+      nextPart = parts.size();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(nThreads - 1);
+  for (int slot = 1; slot < nThreads; slot++) {
+    threads.emplace_back(worker, slot);
+  }
+  worker(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
 template <typename T2, typename... T2s>
 constexpr bool isSameType()
 {
@@ -217,6 +217,7 @@ struct OutputManager<HistogramRegistry> {
 
   static bool postRun(EndOfStreamContext& context, HistogramRegistry& what)
   {
+    what.mergeShards();
     context.outputs().snapshot(what.ref(), *(*what));
     return true;
   }
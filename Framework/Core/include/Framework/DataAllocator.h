@@ -34,11 +34,15 @@
 
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <string>
 #include <utility>
 #include <type_traits>
 #include <utility>
 #include <cstddef>
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
 
 // Do not change this for a full inclusion of FairMQDevice.
 #include <fairmq/FwdDecls.h>
@@ -88,6 +92,10 @@ class DataAllocator
 
   DataAllocator(ServiceRegistry* contextes,
                 const AllowedOutputRoutes& routes);
+  /// An allocator for the same routes as @a other, creating its messages in
+  /// the contexts of @a contextes. The route lookup and the allocation
+  /// counters are shared with @a other.
+  DataAllocator(ServiceRegistry* contextes, DataAllocator const& other);
 
   DataChunk& newChunk(const Output&, size_t);
 
@@ -379,6 +387,12 @@ class DataAllocator
   void snapshot(const Output& spec, const char* payload, size_t payloadSize,
                 o2::header::SerializationMethod serializationMethod = o2::header::gSerializationMethodNone);
 
+  /// Forward the payload of an input to the output specified by \p spec. When the input
+  /// still references the message it was received in, the new message shares its buffer
+  /// (e.g. the same shared memory region) and no copy of the payload is made. Otherwise
+  /// this falls back to a snapshot.
+  void forward(const Output& spec, const DataRef& ref);
+
   /// make an object of type T and route to output specified by OutputRef
   /// The object is owned by the framework, returned reference can be used to fill the object.
   ///
@@ -405,7 +419,7 @@ class DataAllocator
   o2::pmr::FairMQMemoryResource* getMemoryResource(const Output& spec)
   {
     auto& timingInfo = mRegistry->get<TimingInfo>();
-    std::string const& channel = matchDataHeader(spec, timingInfo.timeslice);
+    std::string const& channel = mRouting->routes[matchRoute(spec, timingInfo.timeslice)].channel;
     auto& context = mRegistry->get<MessageContext>();
     return *context.proxy().getTransport(channel);
   }
@@ -454,6 +468,15 @@ class DataAllocator
   /// check if a certain output is allowed
   bool isAllowed(Output const& query);
 
+  /// Bindings of the OutputSpecs of this device, in the same order as
+  /// outputAllocations().
+  std::vector<std::string> const& outputBindings() const { return mRouting->outputBindings; }
+  /// Number of messages created so far for the output @a index of outputBindings(),
+  /// including the ones created by the allocators sharing the routes with this one.
+  uint64_t outputAllocations(size_t index) const { return mRouting->outputAllocations[index].load(std::memory_order_relaxed); }
+  /// Number of data types whose matching routes are memoised.
+  size_t cachedRoutes() const;
+
   o2::header::DataHeader* findMessageHeader(const Output& spec)
   {
     return mRegistry->get<MessageContext>().findMessageHeader(spec);
@@ -475,9 +498,47 @@ class DataAllocator
   }
 
  private:
-  AllowedOutputRoutes mAllowedOutputRoutes;
+  struct ConcreteDataMatcherHash {
+    size_t operator()(ConcreteDataMatcher const& matcher) const
+    {
+      size_t h = std::hash<uint64_t>{}((uint64_t)matcher.origin.itg[0] << 32 | matcher.subSpec);
+      h ^= std::hash<uint64_t>{}(matcher.description.itg[0]) + 0x9e3779b9 + (h << 6) + (h >> 2);
+      h ^= std::hash<uint64_t>{}(matcher.description.itg[1]) + 0x9e3779b9 + (h << 6) + (h >> 2);
+      return h;
+    }
+  };
+
+  /// Everything needed to route an output which does not depend on the
+  /// contexts, so that it can be shared by the allocators of the timeslices
+  /// which are processed concurrently.
+  struct Routing {
+    AllowedOutputRoutes routes;
+    /// Indices of the routes matching a given data type, in the same order as
+    /// routes. Concrete routes are filled at construction, wildcard ones the
+    /// first time a given data type is created. Only data types which do
+    /// match are cached, up to MaxCachedRoutes entries, so that probing
+    /// arbitrary subSpecs does not make it grow unbounded.
+    std::unordered_map<ConcreteDataMatcher, std::vector<size_t>, ConcreteDataMatcherHash> cache;
+    /// Protects the insertions in the cache. Entries are never removed, so
+    /// they can be used once the lock is released.
+    mutable std::shared_mutex mutex;
+    /// Index in outputBindings / outputAllocations for each of the routes.
+    std::vector<size_t> routeOutputIndex;
+    std::vector<std::string> outputBindings;
+    std::vector<std::atomic<uint64_t>> outputAllocations;
+  };
+  static constexpr size_t MaxCachedRoutes = 1024;
+
+  std::shared_ptr<Routing> mRouting;
   ServiceRegistry* mRegistry;
 
+  /// @return the indices of all the routes matching @a matcher, or nullptr
+  /// if they are not cached, in which case the routes need to be scanned.
+  std::vector<size_t> const* matchingRoutes(ConcreteDataMatcher const& matcher);
+  /// @return the index of the route to be used for @a spec at the given @a timeslice
+  size_t matchRoute(const Output& spec, size_t timeslice);
+  /// Same as matchRoute, but also accounts for the allocation.
+  /// @return the channel to be used for @a spec at the given @a timeslice
   std::string const& matchDataHeader(const Output& spec, size_t timeframeId);
   FairMQMessagePtr headerMessageFromOutput(Output const& spec,                                  //
                                            std::string const& channel,                          //
@@ -206,6 +206,9 @@ class StartTimeValueMatcher : public ValueHolder<uint64_t>
   /// actual values found.
   bool match(header::DataHeader const& dh, DataProcessingHeader const& dph, VariableContext& context) const;
 
+  /// The scale applied to the start time before matching it
+  uint64_t getScale() const { return mScale; }
+
  private:
   uint64_t mScale;
 };
@@ -42,6 +42,7 @@ struct DataInputDescriptor {
 
   std::string tablename = "";
   std::string treename = "";
+  std::vector<std::string> columnnames; // columns to read, all if empty
   std::unique_ptr<data_matcher::DataDescriptorMatcher> matcher;
 
   DataInputDescriptor() = default;
@@ -114,6 +115,7 @@ struct DataInputDirector {
 
   std::unique_ptr<TTreeReader> getTreeReader(header::DataHeader dh, int counter, int numTF, std::string treeName);
   TTree* getDataTree(header::DataHeader dh, int counter, int numTF);
+  std::vector<std::string> getColumnNames(header::DataHeader dh);
   uint64_t getTimeFrameNumber(header::DataHeader dh, int counter, int numTF);
   FileAndFolder getFileFolder(header::DataHeader dh, int counter, int numTF);
   int getTimeFramesInFile(header::DataHeader dh, int counter);
@@ -23,6 +23,7 @@
 #include "Framework/InputRoute.h"
 #include "Framework/ForwardRoute.h"
 #include "Framework/TimingInfo.h"
+#include "Framework/TimesliceExecutor.h"
 #include "Framework/ProcessingPolicies.h"
 #include "Framework/Tracing.h"
 #include "Framework/RunningWorkflowInfo.h"
@@ -86,6 +87,9 @@ struct DataProcessorContext {
   AlgorithmSpec::ProcessCallback* statefulProcess = nullptr;
   AlgorithmSpec::ProcessCallback* statelessProcess = nullptr;
   AlgorithmSpec::ErrorCallback* error = nullptr;
+  /// The threads processing consecutive timeslices concurrently,
+  /// nullptr if they are processed one after the other.
+  TimesliceExecutor* executor = nullptr;
 
   /// Wether or not the associated DataProcessor can forward things early
   bool canForwardEarly = true;
@@ -171,6 +175,7 @@ class DataProcessingDevice : public FairMQDevice
   std::vector<uv_work_t> mHandles;                               /// Handles to use to schedule work.
   std::vector<TaskStreamInfo> mStreams;                          /// Information about the task running in the associated mHandle.
   ComputingQuotaEvaluator& mQuotaEvaluator;                      /// The component which evaluates if the offer can be used to run a task
+  std::unique_ptr<TimesliceExecutor> mTimesliceExecutor;         /// The threads processing timeslices concurrently, if requested.
   /// Handle to wake up the main loop from other threads
   /// e.g. when FairMQ notifies some callback in an asynchronous way
   uv_async_t* mAwakeHandle = nullptr;
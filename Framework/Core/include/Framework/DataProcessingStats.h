@@ -43,6 +43,7 @@ struct DataProcessingStats {
   std::atomic<uint64_t> lastSlowMetricSentTimestamp = 0; /// The timestamp of the last time we sent slow metrics
   std::atomic<uint64_t> lastVerySlowMetricSentTimestamp = 0; /// The timestamp of the last time we sent very slow metrics
   std::atomic<uint64_t> lastMetricFlushedTimestamp = 0;  /// The timestamp of the last time we actually flushed metrics
+  std::atomic<uint64_t> lastOutputMetricSentTimestamp = 0; /// The timestamp of the last time we sent the per output allocation counters
   std::atomic<uint64_t> beginIterationTimestamp = 0;     /// The timestamp of when the current ConditionalRun was started
 
   std::atomic<uint64_t> performedComputations = 0;             // The number of computations which have completed so far
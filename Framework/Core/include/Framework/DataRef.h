@@ -12,6 +12,7 @@
 #define FRAMEWORK_DATAREF_H
 
 #include <cstddef> // for size_t
+#include <fairmq/FwdDecls.h>
 
 namespace o2
 {
@@ -27,6 +28,9 @@ struct DataRef {
   const char* header = nullptr;
   const char* payload = nullptr;
   size_t payloadSize = 0;
+  // the message owning the payload, if any. Allows forwarding the
+  // payload without copying it, see DataAllocator::forward
+  const FairMQMessage* payloadMessage = nullptr;
 };
 
 } // namespace framework
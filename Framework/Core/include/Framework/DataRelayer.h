@@ -40,6 +40,7 @@ struct DataRelayerStats {
   uint64_t droppedComputations = 0;     /// How many computations have been dropped because one of the inputs was late
   uint64_t droppedIncomingMessages = 0; /// How many messages have been dropped (not relayed) because they were late
   uint64_t relayedMessages = 0;         /// How many messages have been successfully relayed
+  uint64_t backpressuredMessages = 0;   /// How many times a message could not be relayed because all the slots of its lane were in use
 };
 
 enum struct CacheEntryStatus : int {
@@ -162,6 +163,12 @@ class DataRelayer
   std::vector<data_matcher::VariableContext> mVariableContextes;
   std::vector<CacheEntryStatus> mCachedStateMetrics;
   size_t mMaxLanes;
+  /// Whether all the input matchers bind the timeslice to the start time of
+  /// the data, so that only the slots of that timeslice need to be matched.
+  bool mLookupByTimeslice = false;
+  /// The slots to look at in relay() and processDanglingInputs(), kept to
+  /// avoid reallocating it every time.
+  std::vector<TimesliceSlot> mCandidateSlots;
 
   static std::vector<std::string> sMetricsNames;
   static std::vector<std::string> sVariablesMetricsNames;
@@ -26,6 +26,8 @@
 namespace o2::framework
 {
 
+struct DeviceMetricsRing;
+
 struct DeviceInfo {
   /// The pid of the device associated to this device
   pid_t pid;
@@ -68,6 +70,11 @@ struct DeviceInfo {
   Metric2DViewIndex queriesViewIndex;
   /// Index for the queries of each input route.
   Metric2DViewIndex outputsViewIndex;
+  /// The binary metrics ring of the device, if it has one and the driver
+  /// already attached to it.
+  DeviceMetricsRing* metricsRing = nullptr;
+  /// How many metrics did not fit in the ring and were sent as text.
+  size_t metricsRingOverflows = 0;
   /// Current configuration for the device
   boost::property_tree::ptree currentConfig;
   /// Current provenance for the configuration keys
@@ -25,6 +25,7 @@
 namespace o2::framework
 {
 struct DriverInfo;
+struct BinaryMetricRecord;
 
 struct DeviceMetricsHelper {
   /// Type of the callback which can be provided to be invoked every time a new
@@ -42,6 +43,15 @@ struct DeviceMetricsHelper {
   static bool processMetric(ParsedMetricMatch& results,
                             DeviceMetricsInfo& info,
                             NewMetricCallback newMetricCallback = nullptr);
+
+  /// Processes a metric received in binary form, without any string parsing.
+  ///
+  /// @record is the binary record, as found in the device DeviceMetricsRing
+  /// @info is the DeviceInfo associated to the device posting the metric
+  /// @newMetricsCallback is a callback that will be invoked every time a new metric is added to the list.
+  static bool processMetric(BinaryMetricRecord const& record,
+                            DeviceMetricsInfo& info,
+                            NewMetricCallback newMetricCallback = nullptr);
   /// @return the index in metrics for the information of given metric
   static size_t metricIdxByName(const std::string& name,
                                 const DeviceMetricsInfo& info);
@@ -0,0 +1,110 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef O2_FRAMEWORK_DEVICEMETRICSRING_H_
+#define O2_FRAMEWORK_DEVICEMETRICSRING_H_
+
+#include "Framework/DeviceMetricsInfo.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+// For pid_t
+#include <unistd.h>
+
+namespace o2::framework
+{
+
+/// A numeric metric in binary form, as it is exchanged between a device
+/// and the driver. No string parsing is needed on the receiving side.
+/// String metrics and metrics whose label does not fit are still sent
+/// using the text protocol.
+struct BinaryMetricRecord {
+  static constexpr size_t MAX_LABEL_SIZE = 103;
+  uint64_t timestamp = 0;
+  union {
+    int intValue;
+    float floatValue;
+    uint64_t uint64Value = 0;
+  };
+  MetricType type = MetricType::Unknown;
+  unsigned char labelSize = 0;
+  char label[MAX_LABEL_SIZE];
+};
+
+static_assert(sizeof(BinaryMetricRecord) == 128, "BinaryMetricRecord is expected to fill exactly two cache lines");
+
+/// Lock-free single producer / single consumer ring of binary metrics.
+/// The ring is meant to be placed in a shared memory segment, with the
+/// device as the producer and the driver as the consumer.
+struct DeviceMetricsRing {
+  static constexpr size_t CAPACITY = 8192;
+  static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+  static_assert(std::atomic<uint64_t>::is_always_lock_free, "Ring indices must be lock free to be shared between processes");
+
+  /// Next slot to be written. Only modified by the producer.
+  alignas(64) std::atomic<uint64_t> head{0};
+  /// Next slot to be read. Only modified by the consumer.
+  alignas(64) std::atomic<uint64_t> tail{0};
+  /// Number of records which did not fit. Only modified by the producer.
+  alignas(64) std::atomic<uint64_t> overflows{0};
+  BinaryMetricRecord records[CAPACITY];
+
+  /// Append @a record to the ring.
+  /// @return false if the ring is full, in which case the caller
+  /// is expected to fall back to the text protocol.
+  bool push(BinaryMetricRecord const& record)
+  {
+    auto h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) >= CAPACITY) {
+      overflows.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    records[h & (CAPACITY - 1)] = record;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Invoke @a callback on all the records currently in the ring and
+  /// release them to the producer.
+  /// @return the number of records processed.
+  template <typename F>
+  size_t drain(F&& callback)
+  {
+    auto t = tail.load(std::memory_order_relaxed);
+    auto h = head.load(std::memory_order_acquire);
+    for (auto i = t; i != h; ++i) {
+      callback(records[i & (CAPACITY - 1)]);
+    }
+    tail.store(h, std::memory_order_release);
+    return h - t;
+  }
+};
+
+struct DeviceMetricsRingHelpers {
+  /// @return the name of the shared memory segment holding the
+  /// metrics of the device with the given @a pid.
+  static std::string segmentName(pid_t pid);
+  /// Create the metrics ring for the device with the given @a pid.
+  /// @return nullptr if the segment could not be created.
+  static DeviceMetricsRing* create(pid_t pid);
+  /// Map the metrics ring of the device with the given @a pid, if
+  /// the device created one. The segment name is removed once mapped,
+  /// so that nothing is left behind if the device crashes.
+  /// @return nullptr if the device did not create a ring (yet).
+  static DeviceMetricsRing* attach(pid_t pid);
+  /// Unmap a ring returned by create() or attach().
+  static void release(DeviceMetricsRing* ring);
+};
+
+} // namespace o2::framework
+
+#endif // O2_FRAMEWORK_DEVICEMETRICSRING_H_
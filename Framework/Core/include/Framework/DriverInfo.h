@@ -13,6 +13,8 @@
 #define O2_FRAMEWORK_DRIVERINFO_H_
 
 #include <cstddef>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include <csignal>
@@ -159,10 +161,18 @@ struct DriverInfo {
   /// The minimum level after which the device will exit with 1
   LogParsingHelpers::LogLevel minFailureLevel = LogParsingHelpers::LogLevel::Fatal;
 
+  /// Time spent in each of the startup phases, in ms, in the order they happened.
+  std::vector<std::pair<std::string, float>> startupPhases;
+  /// Timestamp of the end of the last startup phase, as from uv_hrtime.
+  uint64_t lastStartupPhaseTimestamp = 0;
+
   /// Aggregate metrics calculated in the driver itself
   DeviceMetricsInfo metrics;
   /// Skip shared memory cleanup if set
   bool noSHMCleanup;
+  /// Whether devices pass numeric metrics in binary form via shared memory
+  /// (--monitoring-backend dpl-shm://), in addition to the text ones.
+  bool binaryMetrics = false;
   /// Default value for the --driver-client-backend. Notice that if we start from
   /// the driver, the default backend will be the websocket one.  On the other hand,
   /// if the device is started standalone, the default becomes the old stdout:// so
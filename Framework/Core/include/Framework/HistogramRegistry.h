@@ -27,6 +27,10 @@
 #include <TDataType.h>
 
 #include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 class TList;
 
@@ -71,6 +75,11 @@ struct HistFiller {
 //**************************************************************************************************
 class HistogramRegistry
 {
+  // the maximum number of histograms in buffer is currently set to 512
+  // which seems to be both reasonably large and allowing for very fast lookup
+  static constexpr uint32_t REGISTRY_BITMASK{0x1FF};
+  static constexpr uint32_t MAX_REGISTRY_SIZE{REGISTRY_BITMASK + 1};
+
   // HistogramName class providing the associated hash and a first guess for the index in the registry
   struct HistName {
     // ctor for histogram names that are already hashed at compile time via HIST("myHistName")
@@ -137,10 +146,108 @@ class HistogramRegistry
   // print summary of the histograms stored in registry
   void print(bool showAxisDetails = false);
 
+  // enable lock-free concurrent filling: each thread fills its own lazily created shard of the histograms,
+  // which is merged into the registry histograms by mergeShards() (done automatically at end-of-stream)
+  void setConcurrentFill(bool enable = true);
+  bool isConcurrentFill() const { return mConcurrentFill; }
+
+  // merge the contents of all per-thread shards into the registry histograms and reset the shards
+  // this must not be called while other threads are still filling
+  void mergeShards();
+
   // lookup distance counter for benchmarking
   mutable uint32_t lookup = 0;
 
  private:
+  // flat bin-content buffer for TH1 / TH2 with fixed binning, filled without going through the virtual TH1::Fill
+  struct RawFillBuffer {
+    // returns nullptr if the histogram binning does not allow for the raw fill path
+    static std::unique_ptr<RawFillBuffer> create(TH1* hist);
+
+    // same bin finding as TAxis::FindFixBin for non-extendable axes
+    int findBin(int dim, double x) const
+    {
+      if (x < min[dim]) {
+        return 0;
+      } else if (!(x < max[dim])) {
+        return nBins[dim] + 1;
+      }
+      return 1 + static_cast<int>(nBins[dim] * (x - min[dim]) / (max[dim] - min[dim]));
+    }
+
+    void fill1D(double x, double w = 1.)
+    {
+      int bin = findBin(0, x);
+      add(bin, w);
+      if (bin > 0 && bin <= nBins[0]) {
+        stats[0] += w;
+        stats[1] += w * w;
+        stats[2] += w * x;
+        stats[3] += w * x * x;
+      }
+    }
+
+    void fill2D(double x, double y, double w = 1.)
+    {
+      int binX = findBin(0, x);
+      int binY = findBin(1, y);
+      add(binX + (nBins[0] + 2) * binY, w);
+      if (binX > 0 && binX <= nBins[0] && binY > 0 && binY <= nBins[1]) {
+        stats[0] += w;
+        stats[1] += w * w;
+        stats[2] += w * x;
+        stats[3] += w * x * x;
+        stats[4] += w * y;
+        stats[5] += w * y * y;
+        stats[6] += w * x * y;
+      }
+    }
+
+    // add the buffered content to the histogram and reset the buffer
+    void mergeInto(TH1* hist);
+
+    int nBins[2]{0, 0};
+    double min[2]{0., 0.};
+    double max[2]{0., 0.};
+    std::vector<double> content{};
+    std::vector<double> sumw2{};
+    std::array<double, 7> stats{}; // sumw, sumw2, sumwx, sumwx2, sumwy, sumwy2, sumwxy (same layout as TH1::GetStats)
+    double entries{};
+    bool weighted{};
+
+   private:
+    void add(int bin, double w)
+    {
+      content[bin] += w;
+      sumw2[bin] += w * w;
+      entries += 1.;
+      weighted |= (w != 1.);
+    }
+  };
+
+  // per-thread copy of the registry histograms used in concurrent fill mode, created lazily on first fill
+  struct FillShard {
+    std::array<HistPtr, MAX_REGISTRY_SIZE> values{};
+    std::array<std::unique_ptr<RawFillBuffer>, MAX_REGISTRY_SIZE> rawBuffers{};
+    std::array<bool, MAX_REGISTRY_SIZE> initialized{};
+  };
+
+  struct ShardStore {
+    uint64_t id{};
+    std::mutex mutex{};
+    std::unordered_map<std::thread::id, std::unique_ptr<FillShard>> shards{};
+  };
+
+  // find (or create) the shard of the calling thread
+  FillShard& getLocalShard();
+
+  // create the shard histogram with index idx (same binning as the registry histogram, but empty)
+  void initShardHist(FillShard& shard, uint32_t idx);
+
+  // fill the shard of the calling thread
+  template <typename... Ts>
+  void fillConcurrent(uint32_t idx, Ts&&... positionAndWeight);
+
   // create histogram from specification and insert it into the registry
   HistPtr insert(const HistogramSpec& histSpec);
 
@@ -175,11 +282,9 @@ class HistogramRegistry
   bool mSortHistos{};
   uint32_t mTaskHash{};
   std::vector<std::string> mRegisteredNames{};
+  bool mConcurrentFill{};
+  std::unique_ptr<ShardStore> mShardStore{};
 
-  // the maximum number of histograms in buffer is currently set to 512
-  // which seems to be both reasonably large and allowing for very fast lookup
-  static constexpr uint32_t REGISTRY_BITMASK{0x1FF};
-  static constexpr uint32_t MAX_REGISTRY_SIZE{REGISTRY_BITMASK + 1};
   std::array<uint32_t, MAX_REGISTRY_SIZE> mRegistryKey{};
   std::array<HistPtr, MAX_REGISTRY_SIZE> mRegistryValue{};
 };
@@ -408,13 +513,51 @@ uint32_t HistogramRegistry::getHistIndex(const T& histName)
 template <typename... Ts>
 void HistogramRegistry::fill(const HistName& histName, Ts&&... positionAndWeight)
 {
+  if (mConcurrentFill) {
+    fillConcurrent(getHistIndex(histName), std::forward<Ts>(positionAndWeight)...);
+    return;
+  }
   std::visit([&positionAndWeight...](auto&& hist) { HistFiller::fillHistAny(hist, std::forward<Ts>(positionAndWeight)...); }, mRegistryValue[getHistIndex(histName)]);
 }
 
 template <typename... Cs, typename T>
 void HistogramRegistry::fill(const HistName& histName, const T& table, const o2::framework::expressions::Filter& filter)
 {
-  std::visit([&table, &filter](auto&& hist) { HistFiller::fillHistAny<Cs...>(hist, table, filter); }, mRegistryValue[getHistIndex(histName)]);
+  auto idx = getHistIndex(histName);
+  if (mConcurrentFill) {
+    auto s = o2::framework::expressions::createSelection(table.asArrowTable(), filter);
+    auto filtered = o2::soa::Filtered<T>{{table.asArrowTable()}, s};
+    for (auto& t : filtered) {
+      fillConcurrent(idx, (*(static_cast<Cs>(t).getIterator()))...);
+    }
+    return;
+  }
+  std::visit([&table, &filter](auto&& hist) { HistFiller::fillHistAny<Cs...>(hist, table, filter); }, mRegistryValue[idx]);
+}
+
+template <typename... Ts>
+void HistogramRegistry::fillConcurrent(uint32_t idx, Ts&&... positionAndWeight)
+{
+  auto& shard = getLocalShard();
+  if (O2_BUILTIN_UNLIKELY(!shard.initialized[idx])) {
+    initShardHist(shard, idx);
+  }
+  constexpr int nArgs = sizeof...(Ts);
+  if (auto* buffer = shard.rawBuffers[idx].get()) {
+    // raw fast path, only available for fixed-binning TH1 and TH2
+    if (std::holds_alternative<std::shared_ptr<TH1>>(mRegistryValue[idx])) {
+      if constexpr (nArgs == 1 || nArgs == 2) {
+        buffer->fill1D(static_cast<double>(positionAndWeight)...);
+        return;
+      }
+    } else {
+      if constexpr (nArgs == 2 || nArgs == 3) {
+        buffer->fill2D(static_cast<double>(positionAndWeight)...);
+        return;
+      }
+    }
+  }
+  std::visit([&positionAndWeight...](auto&& hist) { HistFiller::fillHistAny(hist, std::forward<Ts>(positionAndWeight)...); }, shard.values[idx]);
 }
 
 } // namespace o2::framework
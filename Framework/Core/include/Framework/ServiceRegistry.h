@@ -169,6 +169,20 @@ struct ServiceRegistry {
   /// This method is supposed to be thread safe
   void registerService(hash_type typeHash, void* service, ServiceKind kind, uint64_t threadId, char const* name = nullptr) const;
 
+  /// Make all the threads using this registry get @a service for the
+  /// already registered @a typeHash. This is meant to be used on a copy of
+  /// the registry, so that a timeslice processed concurrently to others can
+  /// have its own instance of the services holding per timeslice state
+  /// (e.g. the message contexts), while sharing all the others.
+  /// This method is not thread safe.
+  void overrideService(hash_type typeHash, void* service);
+
+  template <typename T>
+  void overrideService(T* service)
+  {
+    overrideService(TypeIdHelpers::uniqueId<T>(), reinterpret_cast<void*>(service));
+  }
+
   // Lookup a given @a typeHash for a given @a threadId at
   // a unique (per typeHash) location. There might
   // be other typeHash which sit in the same place, but
@@ -799,6 +799,17 @@ class TableBuilder
     };
   }
 
+  /// Same as cursor(), but returns a writer which appends whole columns at
+  /// once, one pointer per persistent column of T, into builders which are
+  /// preallocated for nRows rows.
+  template <typename T>
+  auto bulkCursor(size_t nRows)
+  {
+    using persistent_columns_pack = typename T::table_t::persistent_columns_t;
+    constexpr auto persistent_size = pack_size(persistent_columns_pack{});
+    return bulkCursorHelper<typename soa::PackToTable<persistent_columns_pack>::table>(nRows, std::make_index_sequence<persistent_size>());
+  }
+
   /// Reserve method to expand the columns as needed.
   template <typename... ARGS>
   auto reserve(o2::framework::pack<ARGS...> pack, int s)
@@ -837,6 +848,13 @@ class TableBuilder
     return this->template persist<E>(columnNames);
   }
 
+  template <typename T, size_t... Is>
+  auto bulkCursorHelper(size_t nRows, std::index_sequence<Is...>)
+  {
+    std::vector<std::string> columnNames{pack_element_t<Is, typename T::columns>::columnLabel()...};
+    return this->template bulkPersist<typename pack_element_t<Is, typename T::columns>::type...>(columnNames, nRows);
+  }
+
   bool (*mFinalizer)(std::shared_ptr<arrow::Schema> schema, std::vector<std::shared_ptr<arrow::Array>>& arrays, void* holders);
   void* mHolders;
   arrow::MemoryPool* mMemoryPool;
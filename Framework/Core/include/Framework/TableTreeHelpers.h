@@ -123,6 +123,9 @@ class TreeToTable
  public:
   TreeToTable(arrow::MemoryPool* pool = arrow::default_memory_pool());
   void setLabel(const char* label);
+  /// Read the branches through a TTreeCache of the given size (0: no cache).
+  /// Needed for the baskets to be decompressed in parallel when ROOT IMT is on.
+  void setTreeCacheSize(int64_t size) { mTreeCacheSize = size; }
   void addAllColumns(TTree* tree, std::vector<std::string>&& names = {});
   void fill(TTree*);
   std::shared_ptr<arrow::Table> finalize();
@@ -132,6 +135,7 @@ class TreeToTable
   std::vector<std::unique_ptr<BranchToColumn>> mBranchReaders;
   std::string mTableLabel;
   std::shared_ptr<arrow::Table> mTable;
+  int64_t mTreeCacheSize = 0;
 
   void addReader(TBranch* branch, std::string const& name, bool VLA);
 };
@@ -0,0 +1,131 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef O2_FRAMEWORK_TIMESLICEEXECUTOR_H_
+#define O2_FRAMEWORK_TIMESLICEEXECUTOR_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace o2::framework
+{
+
+/// Processes consecutive timeslices concurrently on a pool of threads owned
+/// by a single device, so that they can share the same services (e.g. CCDB
+/// objects, geometry, field) rather than having one copy per pipelined device.
+///
+/// Each thread has its own queue, which is fed in a round robin manner.
+/// Threads which run out of work steal the oldest pending work of the
+/// others, i.e. the one dispatched first, so that a slow timeslice does
+/// not hold back the ones queued behind it.
+///
+/// The results are committed in the order in which the work was dispatched,
+/// regardless of the order in which it completes: the commit callbacks are
+/// only invoked by complete() and drain(), i.e. by the thread owning the
+/// executor.
+class TimesliceExecutor
+{
+ public:
+  /// The processing of one timeslice, invoked on one of the worker threads.
+  using Work = std::function<void()>;
+  /// Invoked on the owner thread once the associated work is done, with the
+  /// exception thrown by the work, if any.
+  using Commit = std::function<void(std::exception_ptr)>;
+
+  /// @a threads the number of worker threads, at least one.
+  /// @a notify invoked by a worker thread every time it completes some work,
+  /// e.g. to wake up the event loop of the owner thread.
+  TimesliceExecutor(size_t threads, std::function<void()> notify = nullptr);
+  /// Stops the worker threads, once they are done with the work they are
+  /// processing. Work which was not started yet and pending commits are
+  /// discarded, and reported as an error: call drain() before.
+  ~TimesliceExecutor();
+
+  TimesliceExecutor(TimesliceExecutor const&) = delete;
+  TimesliceExecutor& operator=(TimesliceExecutor const&) = delete;
+
+  /// Schedule @a work on one of the threads. @a commit will be invoked once
+  /// the work is done and all the work dispatched before has been committed.
+  void dispatch(Work work, Commit commit);
+  /// Invoke, in dispatch order, the commit callbacks of the work which is
+  /// done, stopping at the first one which is still running.
+  /// If @a wait is true, block until at least one commit can be done,
+  /// unless nothing is in flight.
+  /// @return the number of commits done.
+  size_t complete(bool wait = false);
+  /// Wait for all the dispatched work to be done and commit it.
+  void drain();
+
+  /// Number of dispatched work items which were not committed yet.
+  size_t inFlight() const;
+  /// Number of worker threads
+  size_t threads() const { return mWorkers.size(); }
+  /// Number of work items which were run by a different thread than the one
+  /// they were queued to.
+  size_t stolen() const { return mStolen.load(); }
+
+ private:
+  struct Task {
+    uint64_t sequence;
+    Work work;
+  };
+
+  struct Worker {
+    std::mutex mutex;
+    std::deque<Task> queue;
+    std::thread thread;
+  };
+
+  struct Pending {
+    Commit commit;
+    std::exception_ptr error;
+    bool done = false;
+  };
+
+  void run(size_t index);
+  /// Take the oldest task of the worker @a index, or steal the oldest
+  /// task of all the other workers.
+  bool take(size_t index, Task& task);
+  /// Pop the first task of @a worker, if any.
+  bool popFront(Worker& worker, Task& task);
+
+  std::vector<std::unique_ptr<Worker>> mWorkers;
+  std::function<void()> mNotify;
+
+  /// Protects mQueued and mStop, to put idle threads to sleep.
+  std::mutex mWakeMutex;
+  std::condition_variable mWakeCondition;
+  size_t mQueued = 0;
+  bool mStop = false;
+
+  /// Protects the list of work in flight, in dispatch order.
+  mutable std::mutex mPendingMutex;
+  std::condition_variable mPendingCondition;
+  std::deque<Pending> mPending;
+  /// Sequence number of the first entry of mPending
+  uint64_t mFirstSequence = 0;
+  uint64_t mNextSequence = 0;
+
+  std::atomic<size_t> mStolen{0};
+};
+
+} // namespace o2::framework
+
+#endif // O2_FRAMEWORK_TIMESLICEEXECUTOR_H_
@@ -16,8 +16,13 @@
 #include "Framework/CompilerBuiltins.h"
 #include "Framework/ServiceHandle.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <functional>
+#include <set>
 #include <tuple>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace o2::framework
@@ -98,10 +103,28 @@ class TimesliceIndex
   ///         of the messages.
   inline std::tuple<ActionTaken, TimesliceSlot> replaceLRUWith(data_matcher::VariableContext& newContext, TimesliceId timestamp);
 
+  /// Fill @a slots with the valid slots associated to @a timestamp, lowest
+  /// slot first, without having to look at all the slots of the index.
+  inline void getSlotsForTimeslice(TimesliceId timestamp, std::vector<TimesliceSlot>& slots) const;
+
+  /// @return the lowest invalid slot in the lane of @a timestamp, or an invalid
+  /// slot if all the slots of this lane are in use.
+  inline TimesliceSlot findInvalidSlot(TimesliceId timestamp) const;
+
+  /// Fill @a slots with all the valid slots, lowest first.
+  inline void getValidSlots(std::vector<TimesliceSlot>& slots) const;
+
+  /// @return the number of valid slots, i.e. of timeslices in flight.
+  inline size_t validSlots() const;
+
+  /// Update the lookup tables after the variable 0 of the VariableContext of
+  /// @a slot was modified via getVariablesForSlot().
+  inline void refresh(TimesliceSlot slot);
+
  private:
   /// @return the oldest slot possible so that we can eventually override it.
   /// This is the timeslices for all the in flight parts.
-  inline TimesliceSlot findOldestSlot(TimesliceId) const;
+  inline TimesliceSlot findOldestSlot(TimesliceId);
 
   /// The variables for each cacheline.
   std::vector<data_matcher::VariableContext> mVariables;
@@ -117,6 +140,20 @@ class TimesliceIndex
   BackpressureOp mBackpressurePolicy = BackpressureOp::Wait;
   /// The maximum number of lanes for this timeslice index
   size_t mMaxLanes;
+
+  /// The timeslice held by each slot, i.e. its variable 0, or
+  /// TimesliceId::INVALID if the slot is not in use.
+  std::vector<uint64_t> mTimeslices;
+  /// The slots holding a given timeslice.
+  std::unordered_multimap<uint64_t, size_t> mSlotsByTimeslice;
+  /// The invalid slots of each lane, lowest first.
+  std::vector<std::set<size_t>> mInvalidSlots;
+  /// A min-heap of (timeslice, slot) per lane, to find the oldest slot when
+  /// one needs to be replaced. Entries of slots which have been invalidated or
+  /// reassigned since are discarded when they reach the top.
+  std::vector<std::vector<std::pair<uint64_t, size_t>>> mOldestSlots;
+  /// The number of valid slots
+  size_t mValidSlots = 0;
 };
 
 } // namespace o2::framework
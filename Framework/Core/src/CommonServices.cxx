@@ -23,8 +23,10 @@
 #include "Framework/DataRelayer.h"
 #include "Framework/Signpost.h"
 #include "Framework/DataProcessingStats.h"
+#include "Framework/DataAllocator.h"
 #include "Framework/CommonMessageBackends.h"
 #include "Framework/DanglingContext.h"
+#include "Framework/DeviceMetricsRing.h"
 #include "InputRouteHelpers.h"
 #include "Framework/EndOfStreamContext.h"
 #include "Framework/RawDeviceService.h"
@@ -83,11 +85,14 @@ o2::framework::ServiceSpec CommonServices::monitoringSpec()
       void* service = nullptr;
       bool isWebsocket = strncmp(options.GetPropertyAsString("driver-client-backend").c_str(), "ws://", 4) == 0;
       bool isDefault = options.GetPropertyAsString("monitoring-backend") == "default";
-      bool useDPL = (isWebsocket && isDefault) || options.GetPropertyAsString("monitoring-backend") == "dpl://";
+      // dpl-shm:// is the same as dpl://, but numeric metrics are passed to the
+      // driver in binary form via a shared memory ring.
+      bool useShm = options.GetPropertyAsString("monitoring-backend") == "dpl-shm://";
+      bool useDPL = (isWebsocket && isDefault) || options.GetPropertyAsString("monitoring-backend") == "dpl://" || useShm;
       o2::monitoring::Monitoring* monitoring;
       if (useDPL) {
         monitoring = new Monitoring();
-        auto dplBackend = std::make_unique<DPLMonitoringBackend>(registry);
+        auto dplBackend = std::make_unique<DPLMonitoringBackend>(registry, useShm ? DeviceMetricsRingHelpers::create(getpid()) : nullptr);
         (dynamic_cast<o2::monitoring::Backend*>(dplBackend.get()))->setVerbosity(o2::monitoring::Verbosity::Debug);
         monitoring->addBackend(std::move(dplBackend));
       } else {
@@ -503,6 +508,10 @@ auto sendRelayerMetrics(ServiceRegistry& registry, DataProcessingStats& stats) -
   monitoring.send(Metric{(int)relayerStats.droppedComputations, "dropped_computations"}.addTag(Key::Subsystem, Value::DPL));
   monitoring.send(Metric{(int)relayerStats.droppedIncomingMessages, "dropped_incoming_messages"}.addTag(Key::Subsystem, Value::DPL));
   monitoring.send(Metric{(int)relayerStats.relayedMessages, "relayed_messages"}.addTag(Key::Subsystem, Value::DPL));
+  monitoring.send(Metric{(int)relayerStats.backpressuredMessages, "backpressured_messages"}.addTag(Key::Subsystem, Value::DPL));
+  auto& timesliceIndex = registry.get<TimesliceIndex>();
+  monitoring.send(Metric{(int)timesliceIndex.validSlots(), "timeslice_slots/in_use"}.addTag(Key::Subsystem, Value::DPL));
+  monitoring.send(Metric{(int)timesliceIndex.size(), "timeslice_slots/total"}.addTag(Key::Subsystem, Value::DPL));
 
   monitoring.send(Metric{(int)stats.errorCount, "errors"}.addTag(Key::Subsystem, Value::DPL));
   monitoring.send(Metric{(int)stats.exceptionCount, "exceptions"}.addTag(Key::Subsystem, Value::DPL));
@@ -564,6 +573,21 @@ auto sendRelayerMetrics(ServiceRegistry& registry, DataProcessingStats& stats) -
   stats.lastVerySlowMetricSentTimestamp.store(stats.beginIterationTimestamp.load());
 };
 
+/// This will send the number of messages created for each output at
+/// regular intervals of 5 seconds.
+auto sendOutputMetrics(ServiceRegistry& registry, DataAllocator const& allocator, DataProcessingStats& stats) -> void
+{
+  if (stats.beginIterationTimestamp - stats.lastOutputMetricSentTimestamp < 5000) {
+    return;
+  }
+  auto& monitoring = registry.get<Monitoring>();
+  auto& bindings = allocator.outputBindings();
+  for (size_t oi = 0; oi < bindings.size(); ++oi) {
+    monitoring.send(Metric{allocator.outputAllocations(oi), fmt::format("output_allocations/{}", bindings[oi])}.addTag(Key::Subsystem, Value::DPL));
+  }
+  stats.lastOutputMetricSentTimestamp.store(stats.beginIterationTimestamp.load());
+}
+
 /// This will flush metrics only once every second.
 auto flushMetrics(ServiceRegistry& registry, DataProcessingStats& stats) -> void
 {
@@ -608,7 +632,8 @@ o2::framework::ServiceSpec CommonServices::dataProcessingStats()
     .configure = noConfiguration(),
     .postProcessing = [](ProcessingContext& context, void* service) {
       DataProcessingStats* stats = (DataProcessingStats*)service;
-      stats->performedComputations++; },
+      stats->performedComputations++;
+      sendOutputMetrics(context.services(), context.outputs(), *stats); },
     .preDangling = [](DanglingContext& context, void* service) {
       DataProcessingStats* stats = (DataProcessingStats*)service;
       sendRelayerMetrics(context.services(), *stats);
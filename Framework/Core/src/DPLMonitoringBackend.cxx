@@ -10,10 +10,14 @@
 // or submit itself to any jurisdiction.
 
 #include "DPLMonitoringBackend.h"
+#include "Framework/DeviceMetricsRing.h"
 #include "Framework/DriverClient.h"
 #include "Framework/ServiceRegistry.h"
 #include <fmt/format.h>
+#include <cstring>
 #include <sstream>
+#include <sys/mman.h>
+#include <unistd.h>
 
 namespace o2::framework
 {
@@ -26,11 +30,21 @@ template <class... Ts>
 overloaded(Ts...) -> overloaded<Ts...>;
 
 
-DPLMonitoringBackend::DPLMonitoringBackend(ServiceRegistry& registry)
-  : mRegistry{registry}
+DPLMonitoringBackend::DPLMonitoringBackend(ServiceRegistry& registry, DeviceMetricsRing* ring)
+  : mRegistry{registry},
+    mRing{ring}
 {
 }
 
+DPLMonitoringBackend::~DPLMonitoringBackend()
+{
+  if (mRing) {
+    // In case the driver never attached to it.
+    shm_unlink(DeviceMetricsRingHelpers::segmentName(getpid()).c_str());
+    DeviceMetricsRingHelpers::release(mRing);
+  }
+}
+
 void DPLMonitoringBackend::addGlobalTag(std::string_view name, std::string_view value)
 {
   // FIXME: tags are ignored by DPL in any case...
@@ -51,8 +65,47 @@ inline unsigned long convertTimestamp(const std::chrono::time_point<std::chrono:
     .count();
 }
 
+bool DPLMonitoringBackend::sendBinary(o2::monitoring::Metric const& metric)
+{
+  auto const& name = metric.getName();
+  if (metric.getValuesSize() != 1 || name.size() > BinaryMetricRecord::MAX_LABEL_SIZE) {
+    return false;
+  }
+  BinaryMetricRecord record;
+  bool isNumeric = std::visit(overloaded{
+                                [&record](int value) {
+                                  record.type = MetricType::Int;
+                                  record.intValue = value;
+                                  return true;
+                                },
+                                [&record](double value) {
+                                  record.type = MetricType::Float;
+                                  record.floatValue = value;
+                                  return true;
+                                },
+                                [&record](uint64_t value) {
+                                  record.type = MetricType::Uint64;
+                                  record.uint64Value = value;
+                                  return true;
+                                },
+                                [](auto const&) { return false; }},
+                              metric.getValues().front().second);
+  if (!isNumeric) {
+    return false;
+  }
+  record.timestamp = convertTimestamp(metric.getTimestamp());
+  record.labelSize = name.size();
+  memcpy(record.label, name.data(), name.size());
+  std::lock_guard<std::mutex> lock(mRingMutex);
+  return mRing->push(record);
+}
+
 void DPLMonitoringBackend::send(o2::monitoring::Metric const& metric)
 {
+  // Tags are ignored by the driver, so nothing is lost by not sending them.
+  if (mRing && sendBinary(metric)) {
+    return;
+  }
   std::array<char, 4096> buffer;
   auto mStream = fmt::format_to(buffer.begin(), "[METRIC] {}", metric.getName());
   for (auto& value : metric.getValues()) {
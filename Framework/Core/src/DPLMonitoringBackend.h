@@ -12,22 +12,27 @@
 #define O2_FRAMEWORK_DPLMONITORINGBACKEND_H_
 
 #include "Monitoring/Backend.h"
+#include <mutex>
 #include <string>
 
 namespace o2::framework
 {
 
 struct ServiceRegistry;
+struct DeviceMetricsRing;
 
 /// \brief Prints metrics to standard output via std::cout
 class DPLMonitoringBackend final : public o2::monitoring::Backend
 {
  public:
   /// Default constructor
-  DPLMonitoringBackend(ServiceRegistry& registry);
+  /// \param ring        if not null, numeric metrics are pushed in binary
+  ///                    form to this ring, rather than sent as text. The
+  ///                    backend takes ownership of the mapping.
+  DPLMonitoringBackend(ServiceRegistry& registry, DeviceMetricsRing* ring = nullptr);
 
   /// Default destructor
-  ~DPLMonitoringBackend() override = default;
+  ~DPLMonitoringBackend() override;
 
   /// Prints metric
   /// \param metric           reference to metric object
@@ -46,6 +51,14 @@ class DPLMonitoringBackend final : public o2::monitoring::Backend
   std::string mTagString;    ///< Global tagset (common for each metric)
   const std::string mPrefix; ///< Metric prefix
   ServiceRegistry& mRegistry;
+  DeviceMetricsRing* mRing = nullptr; ///< Binary metrics channel to the driver, if any
+  /// The ring has a single producer, while metrics can be sent from other
+  /// threads than the main one (e.g. the process monitoring).
+  std::mutex mRingMutex;
+
+  /// Push the metric to the binary ring.
+  /// \return false if the metric cannot be represented in binary form or the ring is full.
+  bool sendBinary(const o2::monitoring::Metric& metric);
 };
 
 } // namespace o2::framework
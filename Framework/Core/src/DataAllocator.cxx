@@ -16,6 +16,7 @@
 #include "Framework/ArrowContext.h"
 #include "Framework/DataSpecUtils.h"
 #include "Framework/DataProcessingHeader.h"
+#include "Framework/DataRefUtils.h"
 #include "Headers/Stack.h"
 #include "FairMQResizableBuffer.h"
 
@@ -28,6 +29,8 @@
 
 #include <TClonesArray.h>
 
+#include <algorithm>
+
 namespace o2::framework
 {
 
@@ -35,19 +38,96 @@ using DataHeader = o2::header::DataHeader;
 using DataDescription = o2::header::DataDescription;
 using DataProcessingHeader = o2::framework::DataProcessingHeader;
 
+namespace
+{
+std::vector<size_t> findMatchingRoutes(DataAllocator::AllowedOutputRoutes const& routes, ConcreteDataMatcher const& matcher)
+{
+  std::vector<size_t> result;
+  for (size_t ri = 0; ri < routes.size(); ++ri) {
+    if (DataSpecUtils::match(routes[ri].matcher, matcher.origin, matcher.description, matcher.subSpec)) {
+      result.push_back(ri);
+    }
+  }
+  return result;
+}
+} // namespace
+
 DataAllocator::DataAllocator(ServiceRegistry* contextRegistry,
                              const AllowedOutputRoutes& routes)
-  : mAllowedOutputRoutes{routes},
+  : mRouting{std::make_shared<Routing>()},
     mRegistry{contextRegistry}
 {
+  mRouting->routes = routes;
+  for (auto& route : mRouting->routes) {
+    // The same OutputSpec has one route per pipelined consumer.
+    auto& bindings = mRouting->outputBindings;
+    auto binding = std::find(bindings.begin(), bindings.end(), route.matcher.binding.value);
+    mRouting->routeOutputIndex.push_back(std::distance(bindings.begin(), binding));
+    if (binding == bindings.end()) {
+      bindings.push_back(route.matcher.binding.value);
+    }
+    auto concrete = std::get_if<ConcreteDataMatcher>(&route.matcher.matcher);
+    if (concrete && mRouting->cache.find(*concrete) == mRouting->cache.end()) {
+      mRouting->cache.emplace(*concrete, findMatchingRoutes(mRouting->routes, *concrete));
+    }
+  }
+  mRouting->outputAllocations = std::vector<std::atomic<uint64_t>>(mRouting->outputBindings.size());
 }
 
-std::string const& DataAllocator::matchDataHeader(const Output& spec, size_t timeslice)
+DataAllocator::DataAllocator(ServiceRegistry* contextRegistry, DataAllocator const& other)
+  : mRouting{other.mRouting},
+    mRegistry{contextRegistry}
+{
+}
+
+std::vector<size_t> const* DataAllocator::matchingRoutes(ConcreteDataMatcher const& matcher)
+{
+  {
+    std::shared_lock<std::shared_mutex> lock(mRouting->mutex);
+    auto candidates = mRouting->cache.find(matcher);
+    if (candidates != mRouting->cache.end()) {
+      return &candidates->second;
+    }
+    if (mRouting->cache.size() >= MaxCachedRoutes) {
+      return nullptr;
+    }
+  }
+  auto routes = findMatchingRoutes(mRouting->routes, matcher);
+  if (routes.empty()) {
+    return nullptr;
+  }
+  std::unique_lock<std::shared_mutex> lock(mRouting->mutex);
+  if (mRouting->cache.size() >= MaxCachedRoutes && mRouting->cache.find(matcher) == mRouting->cache.end()) {
+    return nullptr;
+  }
+  // Someone else might have inserted it in the meanwhile, which is fine.
+  return &mRouting->cache.emplace(matcher, std::move(routes)).first->second;
+}
+
+size_t DataAllocator::cachedRoutes() const
+{
+  std::shared_lock<std::shared_mutex> lock(mRouting->mutex);
+  return mRouting->cache.size();
+}
+
+size_t DataAllocator::matchRoute(const Output& spec, size_t timeslice)
 {
   // FIXME: we should take timeframeId into account as well.
-  for (auto& output : mAllowedOutputRoutes) {
-    if (DataSpecUtils::match(output.matcher, spec.origin, spec.description, spec.subSpec) && ((timeslice % output.maxTimeslices) == output.timeslice)) {
-      return output.channel;
+  ConcreteDataMatcher matcher{spec.origin, spec.description, spec.subSpec};
+  if (auto candidates = matchingRoutes(matcher)) {
+    for (auto ri : *candidates) {
+      auto& output = mRouting->routes[ri];
+      if ((timeslice % output.maxTimeslices) == output.timeslice) {
+        return ri;
+      }
+    }
+  } else {
+    for (size_t ri = 0; ri < mRouting->routes.size(); ++ri) {
+      auto& output = mRouting->routes[ri];
+      if (DataSpecUtils::match(output.matcher, matcher.origin, matcher.description, matcher.subSpec) &&
+          (timeslice % output.maxTimeslices) == output.timeslice) {
+        return ri;
+      }
     }
   }
   throw runtime_error_f(
@@ -58,6 +138,13 @@ std::string const& DataAllocator::matchDataHeader(const Output& spec, size_t tim
     spec.subSpec);
 }
 
+std::string const& DataAllocator::matchDataHeader(const Output& spec, size_t timeslice)
+{
+  auto ri = matchRoute(spec, timeslice);
+  mRouting->outputAllocations[mRouting->routeOutputIndex[ri]].fetch_add(1, std::memory_order_relaxed);
+  return mRouting->routes[ri].channel;
+}
+
 DataChunk& DataAllocator::newChunk(const Output& spec, size_t size)
 {
   auto& timingInfo = mRegistry->get<TimingInfo>();
@@ -265,14 +352,41 @@ void DataAllocator::snapshot(const Output& spec, const char* payload, size_t pay
   addPartToContext(std::move(payloadMessage), spec, serializationMethod);
 }
 
+void DataAllocator::forward(const Output& spec, const DataRef& ref)
+{
+  const auto* inputHeader = DataRefUtils::getHeader<DataHeader*>(ref);
+  if (inputHeader == nullptr) {
+    throw runtime_error("Unable to forward an input without DataHeader");
+  }
+  auto serializationMethod = inputHeader->payloadSerializationMethod;
+  auto* inputMessage = const_cast<FairMQMessage*>(ref.payloadMessage);
+  if (inputMessage == nullptr) {
+    snapshot(spec, ref.payload, DataRefUtils::getPayloadSize(ref), serializationMethod);
+    return;
+  }
+  auto& timingInfo = mRegistry->get<TimingInfo>();
+  // Accounted for when the part is actually added to the context.
+  std::string const& channel = mRouting->routes[matchRoute(spec, timingInfo.timeslice)].channel;
+  auto* transport = mRegistry->get<MessageContext>().proxy().getTransport(channel, 0);
+  // Copy only adds a reference to the underlying buffer when both messages
+  // live on the same transport, otherwise we have to do a real copy.
+  if (transport->GetType() != inputMessage->GetType()) {
+    snapshot(spec, ref.payload, DataRefUtils::getPayloadSize(ref), serializationMethod);
+    return;
+  }
+  FairMQMessagePtr payloadMessage(transport->CreateMessage());
+  payloadMessage->Copy(*inputMessage);
+  addPartToContext(std::move(payloadMessage), spec, serializationMethod);
+}
+
 Output DataAllocator::getOutputByBind(OutputRef&& ref)
 {
   if (ref.label.empty()) {
     throw runtime_error("Invalid (empty) OutputRef provided.");
   }
-  for (auto ri = 0ul, re = mAllowedOutputRoutes.size(); ri != re; ++ri) {
-    if (mAllowedOutputRoutes[ri].matcher.binding.value == ref.label) {
-      auto spec = mAllowedOutputRoutes[ri].matcher;
+  for (auto ri = 0ul, re = mRouting->routes.size(); ri != re; ++ri) {
+    if (mRouting->routes[ri].matcher.binding.value == ref.label) {
+      auto spec = mRouting->routes[ri].matcher;
       auto dataType = DataSpecUtils::asConcreteDataTypeMatcher(spec);
       return Output{dataType.origin, dataType.description, ref.subSpec, spec.lifetime, std::move(ref.headerStack)};
     }
@@ -283,12 +397,13 @@ Output DataAllocator::getOutputByBind(OutputRef&& ref)
 
 bool DataAllocator::isAllowed(Output const& query)
 {
-  for (auto const& route : mAllowedOutputRoutes) {
-    if (DataSpecUtils::match(route.matcher, query.origin, query.description, query.subSpec)) {
-      return true;
-    }
+  ConcreteDataMatcher matcher{query.origin, query.description, query.subSpec};
+  if (matchingRoutes(matcher) != nullptr) {
+    return true;
   }
-  return false;
+  return std::any_of(mRouting->routes.begin(), mRouting->routes.end(), [&matcher](OutputRoute const& route) {
+    return DataSpecUtils::match(route.matcher, matcher.origin, matcher.description, matcher.subSpec);
+  });
 }
 
 } // namespace o2::framework
@@ -44,6 +44,7 @@ void DataInputDescriptor::printOut()
   LOGP(info, "DataInputDescriptor");
   LOGP(info, "  Table name        : {}", tablename);
   LOGP(info, "  Tree name         : {}", treename);
+  LOGP(info, "  Columns           : {}", columnnames.empty() ? std::string("all") : fmt::format("{}", fmt::join(columnnames, ", ")));
   LOGP(info, "  Input files file  : {}", getInputfilesFilename());
   LOGP(info, "  File name regex   : {}", getFilenamesRegexString());
   LOGP(info, "  Input files       : {}", mfilenames.size());
@@ -411,6 +412,22 @@ bool DataInputDirector::readJsonDocument(Document* jsonDoc)
         didesc->treename = m[2];
       }
 
+      itemName = "columns";
+      if (didescItem.HasMember(itemName)) {
+        if (didescItem[itemName].IsArray()) {
+          for (auto& cn : didescItem[itemName].GetArray()) {
+            if (!cn.IsString()) {
+              LOGP(error, "Check the JSON document! Item \"{}\" must be an array of strings!", itemName);
+              return false;
+            }
+            didesc->columnnames.emplace_back(cn.GetString());
+          }
+        } else {
+          LOGP(error, "Check the JSON document! Item \"{}\" must be an array!", itemName);
+          return false;
+        }
+      }
+
       itemName = "fileregex";
       if (didescItem.HasMember(itemName)) {
         if (didescItem[itemName].IsString()) {
@@ -583,6 +600,17 @@ TTree* DataInputDirector::getDataTree(header::DataHeader dh, int counter, int nu
   return tree;
 }
 
+std::vector<std::string> DataInputDirector::getColumnNames(header::DataHeader dh)
+{
+  // only DataInputDescriptors from the json file can restrict the columns
+  auto didesc = getDataInputDescriptor(dh);
+  if (!didesc) {
+    return {};
+  }
+
+  return didesc->columnnames;
+}
+
 void DataInputDirector::closeInputFiles()
 {
   mdefaultDataInputDescriptor->closeInputFile();
@@ -18,6 +18,7 @@
 #include "Framework/ComputingQuotaEvaluator.h"
 #include "Framework/DataProcessingHeader.h"
 #include "Framework/DataProcessor.h"
+#include "Framework/DataSender.h"
 #include "Framework/DataSpecUtils.h"
 #include "Framework/DeviceState.h"
 #include "Framework/DispatchPolicy.h"
@@ -32,6 +33,10 @@
 #include "Framework/TMessageSerializer.h"
 #include "Framework/InputRecord.h"
 #include "Framework/InputSpan.h"
+#include "Framework/MessageContext.h"
+#include "Framework/StringContext.h"
+#include "Framework/ArrowContext.h"
+#include "Framework/RawBufferContext.h"
 #include "Framework/Signpost.h"
 #include "Framework/SourceInfoHeader.h"
 #include "Framework/Logger.h"
@@ -54,10 +59,13 @@
 #include <options/FairMQProgOptions.h>
 #include <Configuration/ConfigurationInterface.h>
 #include <Configuration/ConfigurationFactory.h>
+#include <Monitoring/Backend.h>
 #include <TMessage.h>
 #include <TClonesArray.h>
+#include <TROOT.h>
 
 #include <algorithm>
+#include <exception>
 #include <vector>
 #include <memory>
 #include <unordered_map>
@@ -575,6 +583,25 @@ void DataProcessingDevice::fillContext(DataProcessorContext& context, DeviceCont
       break;
     }
   }
+
+  // Timeslices can be processed concurrently only if their inputs do not
+  // have to be forwarded after the processing, as that would require the
+  // processing to be done.
+  auto timesliceThreads = std::stoi(fConfig->GetValue<std::string>("timeslice-threads"));
+  if (timesliceThreads > 0 && mSpec.forwards.empty() == false && context.canForwardEarly == false) {
+    LOGP(warning, "Inputs of {} are forwarded after processing. Timeslices will be processed one after the other.", mSpec.name);
+    timesliceThreads = 0;
+  }
+  mTimesliceExecutor.reset();
+  if (timesliceThreads > 0) {
+    LOGP(info, "Processing timeslices concurrently with {} threads", timesliceThreads);
+    // User code might use ROOT from the worker threads.
+    ROOT::EnableThreadSafety();
+    mTimesliceExecutor = std::make_unique<TimesliceExecutor>(timesliceThreads, [awakeMainThread = mState.awakeMainThread]() {
+      uv_async_send(awakeMainThread);
+    });
+  }
+  context.executor = mTimesliceExecutor.get();
 }
 
 void DataProcessingDevice::PreRun()
@@ -689,6 +716,11 @@ void DataProcessingDevice::Run()
     }
     FrameMark;
   }
+  // Whatever is still processed concurrently is committed before leaving
+  // the running state, i.e. before the Stop callbacks in PostRun.
+  if (mTimesliceExecutor) {
+    mTimesliceExecutor->drain();
+  }
 }
 
 /// We drive the state loop ourself so that we will be able to support
@@ -834,6 +866,10 @@ void DataProcessingDevice::doRun(DataProcessorContext& context)
     while (DataProcessingDevice::tryDispatchComputation(context, *context.completed) && hasOnlyGenerated == false) {
       context.relayer->processDanglingInputs(*context.expirationHandlers, *context.registry, false);
     }
+    // The outputs of all the timeslices must be sent before the end of stream.
+    if (context.executor != nullptr) {
+      context.executor->drain();
+    }
     EndOfStreamContext eosContext{*context.registry, *context.allocator};
 
     context.registry->preEOSCallbacks(eosContext);
@@ -1126,6 +1162,122 @@ void update_maximum(std::atomic<T>& maximum_value, T const& value) noexcept
          !maximum_value.compare_exchange_weak(prev_value, value)) {
   }
 }
+
+/// An InputSpan on top of the messages in @a inputs, which must outlive it.
+InputSpan makeInputSpan(std::vector<MessageSet>& inputs)
+{
+  auto getter = [&inputs](size_t i, size_t partindex) -> DataRef {
+    if (inputs[i].getNumberOfPairs() > partindex) {
+      const char* headerptr = nullptr;
+      const char* payloadptr = nullptr;
+      size_t payloadSize = 0;
+      // - each input can have multiple parts
+      // - "part" denotes a sequence of messages belonging together, the first message of the
+      //   sequence is the header message
+      // - each part has one or more payload messages
+      // - InputRecord provides all payloads as header-payload pairs
+      auto const& headerMsg = inputs[i].associatedHeader(partindex);
+      auto const& payloadMsg = inputs[i].associatedPayload(partindex);
+      headerptr = static_cast<char const*>(headerMsg->GetData());
+      payloadptr = payloadMsg ? static_cast<char const*>(payloadMsg->GetData()) : nullptr;
+      payloadSize = payloadMsg ? payloadMsg->GetSize() : 0;
+      return DataRef{nullptr, headerptr, payloadptr, payloadSize, payloadMsg.get()};
+    }
+    return DataRef{};
+  };
+  auto nofPartsGetter = [&inputs](size_t i) -> size_t {
+    return inputs[i].getNumberOfPairs();
+  };
+  return InputSpan{getter, nofPartsGetter, inputs.size()};
+}
+
+/// Keeps the metrics sent while a timeslice is processed concurrently, so
+/// that they can be passed on to the Monitoring of the device, which is not
+/// thread safe, from the main thread.
+class MetricsRecorder final : public o2::monitoring::Backend
+{
+ public:
+  MetricsRecorder(std::vector<o2::monitoring::Metric>& metrics) : mMetrics{metrics}
+  {
+    setVerbosity(o2::monitoring::Verbosity::Debug);
+  }
+
+  void send(o2::monitoring::Metric const& metric) override { mMetrics.push_back(metric); }
+
+  void send(std::vector<o2::monitoring::Metric>&& metrics) override
+  {
+    for (auto& metric : metrics) {
+      mMetrics.push_back(std::move(metric));
+    }
+  }
+
+  // Global tags are added by the Monitoring of the device.
+  void addGlobalTag(std::string_view, std::string_view) override {}
+
+ private:
+  std::vector<o2::monitoring::Metric>& mMetrics;
+};
+
+/// A timeslice being processed by one of the threads of the TimesliceExecutor.
+/// It owns its inputs and has its own copy of the services which hold per
+/// timeslice state, i.e. the contexts where the outputs are created, the
+/// TimingInfo and the Monitoring, so that the outputs and the metrics can be
+/// sent in order once the processing is done. All the other services are
+/// shared with the device, and so is the routing of the DataAllocator.
+struct ConcurrentTimeslice {
+  ConcurrentTimeslice(DataProcessorContext& context, std::vector<MessageSet>&& currentSetOfInputs)
+    : inputs{std::move(currentSetOfInputs)},
+      span{makeInputSpan(inputs)},
+      record{context.deviceContext->spec->inputs, span},
+      timingInfo{*context.timingInfo},
+      messageContext{FairMQDeviceProxy{context.deviceContext->device}},
+      stringContext{FairMQDeviceProxy{context.deviceContext->device}},
+      arrowContext{FairMQDeviceProxy{context.deviceContext->device}},
+      rawBufferContext{FairMQDeviceProxy{context.deviceContext->device}},
+      registry{*context.registry},
+      allocator{&registry, *context.allocator}
+  {
+    monitoring.addBackend(std::make_unique<MetricsRecorder>(metrics));
+    registry.overrideService(&monitoring);
+    registry.overrideService(&timingInfo);
+    registry.overrideService(&messageContext);
+    registry.overrideService(&stringContext);
+    registry.overrideService(&arrowContext);
+    registry.overrideService(&rawBufferContext);
+  }
+
+  /// Send what was created while processing, in the same order
+  /// as the postProcessing callbacks of the backends would.
+  void send(DataSender& sender, ServiceRegistry& services)
+  {
+    DataProcessor::doSend(sender, messageContext, services);
+    DataProcessor::doSend(sender, arrowContext, services);
+    DataProcessor::doSend(sender, stringContext, services);
+    DataProcessor::doSend(sender, rawBufferContext, services);
+  }
+
+  /// Pass what was recorded while processing on to the Monitoring of the device.
+  void flushMetrics(o2::monitoring::Monitoring& deviceMonitoring)
+  {
+    for (auto& metric : metrics) {
+      deviceMonitoring.send(std::move(metric));
+    }
+    metrics.clear();
+  }
+
+  std::vector<MessageSet> inputs;
+  InputSpan span;
+  InputRecord record;
+  TimingInfo timingInfo;
+  MessageContext messageContext;
+  StringContext stringContext;
+  ArrowContext arrowContext;
+  RawBufferContext rawBufferContext;
+  std::vector<o2::monitoring::Metric> metrics;
+  o2::monitoring::Monitoring monitoring;
+  ServiceRegistry registry;
+  DataAllocator allocator;
+};
 } // namespace
 
 bool DataProcessingDevice::tryDispatchComputation(DataProcessorContext& context, std::vector<DataRelayer::RecordAction>& completed)
@@ -1171,29 +1323,7 @@ bool DataProcessingDevice::tryDispatchComputation(DataProcessorContext& context,
     } else {
       currentSetOfInputs = relayer->consumeExistingInputsForTimeslice(slot);
     }
-    auto getter = [&currentSetOfInputs](size_t i, size_t partindex) -> DataRef {
-      if (currentSetOfInputs[i].getNumberOfPairs() > partindex) {
-        const char* headerptr = nullptr;
-        const char* payloadptr = nullptr;
-        size_t payloadSize = 0;
-        // - each input can have multiple parts
-        // - "part" denotes a sequence of messages belonging together, the first message of the
-        //   sequence is the header message
-        // - each part has one or more payload messages
-        // - InputRecord provides all payloads as header-payload pairs
-        auto const& headerMsg = currentSetOfInputs[i].associatedHeader(partindex);
-        auto const& payloadMsg = currentSetOfInputs[i].associatedPayload(partindex);
-        headerptr = static_cast<char const*>(headerMsg->GetData());
-        payloadptr = payloadMsg ? static_cast<char const*>(payloadMsg->GetData()) : nullptr;
-        payloadSize = payloadMsg ? payloadMsg->GetSize() : 0;
-        return DataRef{nullptr, headerptr, payloadptr, payloadSize};
-      }
-      return DataRef{};
-    };
-    auto nofPartsGetter = [&currentSetOfInputs](size_t i) -> size_t {
-      return currentSetOfInputs[i].getNumberOfPairs();
-    };
-    return InputSpan{getter, nofPartsGetter, currentSetOfInputs.size()};
+    return makeInputSpan(currentSetOfInputs);
   };
 
   auto markInputsAsDone = [&relayer = context.relayer](TimesliceSlot slot) -> void {
@@ -1391,8 +1521,15 @@ bool DataProcessingDevice::tryDispatchComputation(DataProcessorContext& context,
     control.notifyStreamingState(state->streaming);
   };
 
+  // Whatever was processed concurrently in the meanwhile is committed
+  // before dispatching anything else, so that the order is preserved.
+  bool committed = false;
+  if (context.executor != nullptr) {
+    committed = context.executor->complete() > 0;
+  }
+
   if (canDispatchSomeComputation() == false) {
-    return false;
+    return committed;
   }
 
   auto postUpdateStats = [&stats = context.registry->get<DataProcessingStats>()](DataRelayer::RecordAction const& action, InputRecord const& record, uint64_t tStart) {
@@ -1428,6 +1565,19 @@ bool DataProcessingDevice::tryDispatchComputation(DataProcessorContext& context,
       continue;
     }
 
+    // Only consumed timeslices are processed concurrently. Anything else is
+    // done right away on the main thread, so what is still in flight has to
+    // be committed first, not to be overtaken.
+    bool concurrent = context.executor != nullptr && action.op == CompletionPolicy::CompletionOp::Consume && context.deviceContext->state->quitRequested == false;
+    if (concurrent) {
+      // Do not let inputs pile up when the threads cannot keep up.
+      while (context.executor->inFlight() >= 2 * context.executor->threads()) {
+        context.executor->complete(true);
+      }
+    } else if (context.executor != nullptr) {
+      context.executor->drain();
+    }
+
     prepareAllocatorForCurrentTimeSlice(TimesliceSlot{action.slot});
     bool shouldConsume = action.op == CompletionPolicy::CompletionOp::Consume ||
                          action.op == CompletionPolicy::CompletionOp::Discard;
@@ -1462,6 +1612,74 @@ bool DataProcessingDevice::tryDispatchComputation(DataProcessorContext& context,
 
     static bool noCatch = getenv("O2_NO_CATCHALL_EXCEPTIONS") && strcmp(getenv("O2_NO_CATCHALL_EXCEPTIONS"), "0");
 
+    // When requested, consumed timeslices are processed by the TimesliceExecutor
+    // threads, while the main thread goes on receiving and dispatching the
+    // following ones. What needs to happen after the processing (sending the
+    // outputs, updating the stats, ...) is done on the main thread, in the
+    // same order as if they were processed one after the other.
+    if (concurrent) {
+      auto job = std::make_shared<ConcurrentTimeslice>(context, std::move(currentSetOfInputs));
+      {
+        ZoneScopedN("service pre processing");
+        // Callbacks from users, which are always invoked on the main thread
+        context.registry->get<CallbackService>()(CallbackService::Id::PreProcessing, job->registry, (int)action.op);
+      }
+
+      auto process = [&context, job]() {
+        ZoneScopedN("concurrent process");
+        ProcessingContext processContext{job->record, job->registry, job->allocator};
+        if (*context.statefulProcess) {
+          ZoneScopedN("statefull process");
+          (*context.statefulProcess)(processContext);
+        }
+        if (*context.statelessProcess) {
+          ZoneScopedN("stateless process");
+          (*context.statelessProcess)(processContext);
+        }
+        // Notify the sink we just consumed some timeframe data
+        if (context.isSink) {
+          job->allocator.make<int>(OutputRef{"dpl-summary", compile_time_hash(context.deviceContext->spec->name.c_str())}, 1);
+        }
+      };
+
+      auto commit = [&context, job, action, tStart, postUpdateStats, cleanupRecord](std::exception_ptr error) {
+        // The services of the device see this timeslice, not the last dispatched one.
+        *context.timingInfo = job->timingInfo;
+        job->flushMetrics(context.registry->get<o2::monitoring::Monitoring>());
+        ProcessingContext processContext{job->record, *context.registry, *context.allocator};
+        if (error) {
+          try {
+            std::rethrow_exception(error);
+          } catch (std::exception& ex) {
+            if (noCatch) {
+              throw;
+            }
+            ZoneScopedN("error handling");
+            auto e = runtime_error(ex.what());
+            (*context.errorHandling)(e, job->record);
+          } catch (o2::framework::RuntimeErrorRef e) {
+            if (noCatch) {
+              throw;
+            }
+            ZoneScopedN("error handling");
+            (*context.errorHandling)(e, job->record);
+          }
+        } else {
+          ZoneScopedN("service post processing");
+          job->send(context.registry->get<DataSender>(), *context.registry);
+          context.registry->postProcessingCallbacks(processContext);
+        }
+        postUpdateStats(action, job->record, tStart);
+        context.registry->postDispatchingCallbacks(processContext);
+        context.registry->get<CallbackService>()(CallbackService::Id::DataConsumed, *(context.registry));
+#ifdef TRACY_ENABLE
+        cleanupRecord(job->record);
+#endif
+      };
+      context.executor->dispatch(std::move(process), std::move(commit));
+      continue;
+    }
+
     auto runNoCatch = [&context, &processContext](DataRelayer::RecordAction& action) {
       if (context.deviceContext->state->quitRequested == false) {
         {
@@ -1530,6 +1748,9 @@ bool DataProcessingDevice::tryDispatchComputation(DataProcessorContext& context,
   }
   // We now broadcast the end of stream if it was requested
   if (context.deviceContext->state->streaming == StreamingState::EndOfStreaming) {
+    if (context.executor != nullptr) {
+      context.executor->drain();
+    }
     for (auto& channel : context.deviceContext->spec->outputChannels) {
       DataProcessingHelpers::sendEndOfStream(*context.deviceContext->device, channel);
     }
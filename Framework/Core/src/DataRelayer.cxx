@@ -38,6 +38,7 @@
 #include <fmt/format.h>
 #include <fmt/ostream.h>
 #include <gsl/span>
+#include <algorithm>
 #include <numeric>
 #include <string>
 
@@ -68,6 +69,8 @@ DataRelayer::DataRelayer(const CompletionPolicy& policy,
 {
   std::scoped_lock<LockableBase(std::recursive_mutex)> lock(mMutex);
 
+  mLookupByTimeslice = std::all_of(mInputMatchers.begin(), mInputMatchers.end(), &DataRelayerHelpers::bindsTimesliceToStartTime);
+
   if (policy.configureRelayer == nullptr) {
     setPipelineLength(DEFAULT_PIPELINE_LENGTH);
   } else {
@@ -107,59 +110,64 @@ DataRelayer::ActivityStats DataRelayer::processDanglingInputs(std::vector<Expira
   if (expirationHandlers.empty()) {
     return activity;
   }
-  // Create any slot for the time based fields
+  // Create any slot for the time based fields. If we are not allowed to
+  // create new slots, the handlers apply to any slot which is in use.
   std::vector<TimesliceSlot> slotsCreatedByHandlers;
   if (createNew) {
     for (auto& handler : expirationHandlers) {
       slotsCreatedByHandlers.push_back(handler.creator(mTimesliceIndex));
     }
-  }
-  if (slotsCreatedByHandlers.empty() == false) {
     activity.newSlots++;
+  } else {
+    slotsCreatedByHandlers.resize(expirationHandlers.size(), TimesliceSlot{TimesliceSlot::ANY});
   }
-  // Outer loop, we process all the records because the fact that the record
-  // expires is independent from having received data for it.
-  for (size_t ti = 0; ti < mTimesliceIndex.size(); ++ti) {
-    TimesliceSlot slot{ti};
-    if (mTimesliceIndex.isValid(slot) == false) {
-      continue;
+  assert(mDistinctRoutesIndex.empty() == false);
+  auto expireSlot = [&](ExpirationHandler const& expirator, TimesliceSlot slot) {
+    auto ti = slot.index;
+    // We check that no data is already there for the given cell
+    // it is enough to check the first element
+    auto& part = mCache[ti * mDistinctRoutesIndex.size() + expirator.routeIndex.value];
+    if (part.size() > 0 && part.header(0) != nullptr) {
+      return;
+    }
+    if (part.size() > 0 && part.payload(0) != nullptr) {
+      return;
     }
-    assert(mDistinctRoutesIndex.empty() == false);
     auto& variables = mTimesliceIndex.getVariablesForSlot(slot);
     auto timestamp = VariableContextHelpers::getTimeslice(variables);
-    // We iterate on all the hanlders checking if they need to be expired.
-    for (size_t ei = 0; ei < expirationHandlers.size(); ++ei) {
-      auto& expirator = expirationHandlers[ei];
-      // We check that no data is already there for the given cell
-      // it is enough to check the first element
-      auto& part = mCache[ti * mDistinctRoutesIndex.size() + expirator.routeIndex.value];
-      if (part.size() > 0 && part.header(0) != nullptr) {
-        continue;
-      }
-      if (part.size() > 0 && part.payload(0) != nullptr) {
-        continue;
-      }
-      // We check that the cell can actually be expired.
-      if (!expirator.checker) {
-        continue;
-      }
-      if (slotsCreatedByHandlers[ei] != slot) {
-        continue;
-      }
-      if (expirator.checker(services, timestamp.value) == false) {
-        continue;
-      }
+    if (expirator.checker(services, timestamp.value) == false) {
+      return;
+    }
 
-      assert(ti * mDistinctRoutesIndex.size() + expirator.routeIndex.value < mCache.size());
-      assert(expirator.handler);
-      PartRef newRef;
-      expirator.handler(services, newRef, variables);
-      part.reset(std::move(newRef));
-      activity.expiredSlots++;
+    assert(ti * mDistinctRoutesIndex.size() + expirator.routeIndex.value < mCache.size());
+    assert(expirator.handler);
+    PartRef newRef;
+    expirator.handler(services, newRef, variables);
+    part.reset(std::move(newRef));
+    activity.expiredSlots++;
 
-      mTimesliceIndex.markAsDirty(slot, true);
-      assert(part.header(0) != nullptr);
-      assert(part.payload(0) != nullptr);
+    mTimesliceIndex.markAsDirty(slot, true);
+    assert(part.header(0) != nullptr);
+    assert(part.payload(0) != nullptr);
+  };
+  // The fact that the record expires is independent from having received data
+  // for it. A handler only applies to the slot it created, if any, so we only
+  // need to look at all the slots in use for the handlers which apply to any.
+  auto& validSlots = mCandidateSlots;
+  mTimesliceIndex.getValidSlots(validSlots);
+  for (size_t ei = 0; ei < expirationHandlers.size(); ++ei) {
+    auto& expirator = expirationHandlers[ei];
+    // We check that the cell can actually be expired.
+    if (!expirator.checker) {
+      continue;
+    }
+    auto created = slotsCreatedByHandlers[ei];
+    if (created.index == TimesliceSlot::ANY) {
+      for (auto slot : validSlots) {
+        expireSlot(expirator, slot);
+      }
+    } else if (TimesliceSlot::isValid(created) && mTimesliceIndex.isValid(created)) {
+      expireSlot(expirator, created);
     }
   }
   return activity;
@@ -322,6 +330,7 @@ DataRelayer::RelayChoice
         stats.relayedMessages++;
         break;
       case TimesliceIndex::ActionTaken::Wait:
+        stats.backpressuredMessages++;
         break;
     }
   };
@@ -336,38 +345,55 @@ DataRelayer::RelayChoice
 
   bool needsCleaning = false;
   // First look for matching slots which already have some
-  // partial match.
-  for (size_t ci = 0; ci < index.size(); ++ci) {
-    slot = TimesliceSlot{ci};
-    if (!isSlotInLane(slot)) {
-      continue;
-    }
-    if (index.isValid(slot) == false) {
+  // partial match. If the timeslice is always bound to the start time
+  // only the slots already holding it can match.
+  auto& candidates = mCandidateSlots;
+  if (mLookupByTimeslice) {
+    index.getSlotsForTimeslice(TimesliceId{dph->startTime}, candidates);
+  } else {
+    index.getValidSlots(candidates);
+  }
+  for (auto candidate : candidates) {
+    if (!isSlotInLane(candidate)) {
       continue;
     }
-    std::tie(input, timeslice) = getInputTimeslice(index.getVariablesForSlot(slot));
+    std::tie(input, timeslice) = getInputTimeslice(index.getVariablesForSlot(candidate));
     if (input != INVALID_INPUT) {
+      slot = candidate;
       break;
     }
   }
 
   // If we did not find anything, look for slots which
-  // are invalid.
+  // are invalid. Their variables are all reset, so either the lowest one in
+  // the lane matches or none does, unless some matcher does not bind the
+  // timeslice, in which case a failed match might leave other variables set.
   if (input == INVALID_INPUT) {
-    for (size_t ci = 0; ci < index.size(); ++ci) {
-      slot = TimesliceSlot{ci};
-      if (index.isValid(slot) == true) {
-        continue;
-      }
-      if (!isSlotInLane(slot)) {
-        continue;
+    if (mLookupByTimeslice) {
+      slot = index.findInvalidSlot(TimesliceId{dph->startTime});
+      if (TimesliceSlot::isValid(slot)) {
+        std::tie(input, timeslice) = getInputTimeslice(index.getVariablesForSlot(slot));
       }
-      std::tie(input, timeslice) = getInputTimeslice(index.getVariablesForSlot(slot));
-      if (input != INVALID_INPUT) {
-        needsCleaning = true;
-        break;
+    } else {
+      for (size_t ci = 0; ci < index.size(); ++ci) {
+        slot = TimesliceSlot{ci};
+        if (index.isValid(slot) == true) {
+          continue;
+        }
+        if (!isSlotInLane(slot)) {
+          continue;
+        }
+        std::tie(input, timeslice) = getInputTimeslice(index.getVariablesForSlot(slot));
+        if (input != INVALID_INPUT) {
+          break;
+        }
       }
     }
+    if (input != INVALID_INPUT) {
+      needsCleaning = true;
+      // The variables of the slot were modified in place.
+      index.refresh(slot);
+    }
   }
 
   /// If we get a valid result, we can store the message in cache.
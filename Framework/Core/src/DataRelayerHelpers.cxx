@@ -13,6 +13,7 @@
 #include "Framework/DataDescriptorMatcher.h"
 #include "Framework/InputRoute.h"
 #include <stdexcept>
+#include <type_traits>
 
 using namespace o2::framework::data_matcher;
 
@@ -70,4 +71,32 @@ std::vector<DataDescriptorMatcher>
   return result;
 }
 
+bool DataRelayerHelpers::bindsTimesliceToStartTime(DataDescriptorMatcher const& matcher)
+{
+  auto bindsNode = [](Node const& node) -> bool {
+    if (auto startTime = std::get_if<StartTimeValueMatcher>(&node)) {
+      bool isTimeslice = startTime->visit([](auto const& value) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(value)>, ContextRef>) {
+          return value.index == 0;
+        } else {
+          return false;
+        }
+      });
+      return isTimeslice && startTime->getScale() == 1;
+    } else if (auto submatcher = std::get_if<std::unique_ptr<DataDescriptorMatcher>>(&node)) {
+      return bindsTimesliceToStartTime(**submatcher);
+    }
+    return false;
+  };
+  // Only the nodes which must all match are guaranteed to be evaluated.
+  switch (matcher.getOp()) {
+    case DataDescriptorMatcher::Op::Just:
+      return bindsNode(matcher.getLeft());
+    case DataDescriptorMatcher::Op::And:
+      return bindsNode(matcher.getLeft()) || bindsNode(matcher.getRight());
+    default:
+      return false;
+  }
+}
+
 } // namespace o2::framework
@@ -23,6 +23,10 @@ struct DataRelayerHelpers {
   static std::vector<size_t> createDistinctRouteIndex(std::vector<InputRoute> const&);
   /// This converts from InputRoute to the associated DataDescriptorMatcher.
   static std::vector<data_matcher::DataDescriptorMatcher> createInputMatchers(std::vector<InputRoute> const&);
+  /// @return true if a successful match of @a matcher always binds the
+  /// variable 0 to the start time of the data, so that data can only be
+  /// relayed to the slots which already hold its start time or to unused ones.
+  static bool bindsTimesliceToStartTime(data_matcher::DataDescriptorMatcher const& matcher);
 };
 
 } // namespace o2::framework
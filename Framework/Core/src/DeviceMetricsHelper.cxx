@@ -10,6 +10,7 @@
 // or submit itself to any jurisdiction.
 
 #include "Framework/DeviceMetricsHelper.h"
+#include "Framework/DeviceMetricsRing.h"
 #include "Framework/DriverInfo.h"
 #include "Framework/RuntimeError.h"
 #include <cassert>
@@ -351,4 +352,33 @@ void DeviceMetricsHelper::updateMetricsNames(DriverInfo& driverInfo, std::vector
   driverInfo.availableMetrics.swap(result);
 }
 
+bool DeviceMetricsHelper::processMetric(BinaryMetricRecord const& record,
+                                        DeviceMetricsInfo& info,
+                                        DeviceMetricsHelper::NewMetricCallback newMetricsCallback)
+{
+  ParsedMetricMatch match{};
+  match.beginKey = record.label;
+  match.endKey = record.label + record.labelSize;
+  match.timestamp = record.timestamp;
+  match.type = record.type;
+  // As for the text protocol, floatValue always holds the float
+  // equivalent of the metric.
+  switch (record.type) {
+    case MetricType::Int:
+      match.intValue = record.intValue;
+      match.floatValue = (float)record.intValue;
+      break;
+    case MetricType::Float:
+      match.floatValue = record.floatValue;
+      break;
+    case MetricType::Uint64:
+      match.uint64Value = record.uint64Value;
+      match.floatValue = (float)record.uint64Value;
+      break;
+    default:
+      return false;
+  }
+  return processMetric(match, info, newMetricsCallback);
+}
+
 } // namespace o2::framework
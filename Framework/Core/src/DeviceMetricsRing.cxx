@@ -0,0 +1,87 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "Framework/DeviceMetricsRing.h"
+#include "Framework/Logger.h"
+
+#include <fmt/format.h>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace o2::framework
+{
+
+std::string DeviceMetricsRingHelpers::segmentName(pid_t pid)
+{
+  return fmt::format("/dpl-metrics-{}", pid);
+}
+
+DeviceMetricsRing* DeviceMetricsRingHelpers::create(pid_t pid)
+{
+  auto name = segmentName(pid);
+  // A stale segment from a previous process with the same pid.
+  shm_unlink(name.c_str());
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    LOGP(warning, "Unable to create metrics segment {}: {}. Using text metrics.", name, strerror(errno));
+    return nullptr;
+  }
+  if (ftruncate(fd, sizeof(DeviceMetricsRing)) != 0) {
+    LOGP(warning, "Unable to size metrics segment {}: {}. Using text metrics.", name, strerror(errno));
+    close(fd);
+    shm_unlink(name.c_str());
+    return nullptr;
+  }
+  void* addr = mmap(nullptr, sizeof(DeviceMetricsRing), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    LOGP(warning, "Unable to map metrics segment {}: {}. Using text metrics.", name, strerror(errno));
+    shm_unlink(name.c_str());
+    return nullptr;
+  }
+  return new (addr) DeviceMetricsRing;
+}
+
+DeviceMetricsRing* DeviceMetricsRingHelpers::attach(pid_t pid)
+{
+  auto name = segmentName(pid);
+  int fd = shm_open(name.c_str(), O_RDWR, 0600);
+  if (fd < 0) {
+    return nullptr;
+  }
+  struct stat st;
+  // The device might still be sizing the segment.
+  if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(DeviceMetricsRing)) {
+    close(fd);
+    return nullptr;
+  }
+  void* addr = mmap(nullptr, sizeof(DeviceMetricsRing), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    return nullptr;
+  }
+  shm_unlink(name.c_str());
+  return reinterpret_cast<DeviceMetricsRing*>(addr);
+}
+
+void DeviceMetricsRingHelpers::release(DeviceMetricsRing* ring)
+{
+  if (ring == nullptr) {
+    return;
+  }
+  munmap(ring, sizeof(DeviceMetricsRing));
+}
+
+} // namespace o2::framework
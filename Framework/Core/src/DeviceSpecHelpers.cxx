@@ -842,7 +842,11 @@ void DeviceSpecHelpers::dataProcessorSpecs2DeviceSpecs(const WorkflowSpec& workf
   // them before assigning to a device.
   std::vector<OutputSpec> outputs;
 
-  WorkflowHelpers::constructGraph(workflow, logicalEdges, outputs, availableForwardsInfo);
+  // The cache is shared between the driver and all the devices, which
+  // would otherwise all recompute the same graph.
+  auto& options = configContext.options();
+  auto topologyCache = options.isSet("topology-cache") ? options.get<std::string>("topology-cache") : std::string{};
+  WorkflowHelpers::constructGraphCached(workflow, logicalEdges, outputs, availableForwardsInfo, topologyCache);
 
   // We need to instanciate one device per (me, timeIndex) in the
   // DeviceConnectionEdge. For each device we need one new binding
@@ -1204,6 +1208,7 @@ void DeviceSpecHelpers::prepareArguments(bool defaultQuiet, bool defaultStopped,
         realOdesc.add_options()("rate", bpo::value<std::string>());
         realOdesc.add_options()("expected-region-callbacks", bpo::value<std::string>());
         realOdesc.add_options()("timeframes-rate-limit", bpo::value<std::string>());
+        realOdesc.add_options()("timeslice-threads", bpo::value<std::string>());
         realOdesc.add_options()("environment", bpo::value<std::string>());
         realOdesc.add_options()("stacktrace-on-signal", bpo::value<std::string>());
         realOdesc.add_options()("post-fork-command", bpo::value<std::string>());
@@ -1361,6 +1366,7 @@ boost::program_options::options_description DeviceSpecHelpers::getForwardedDevic
     ("rate", bpo::value<std::string>(), "rate for a data source device (Hz)")                                                                                        //
     ("expected-region-callbacks", bpo::value<std::string>(), "region callbacks to expect before starting")                                                           //
     ("timeframes-rate-limit", bpo::value<std::string>()->default_value("0"), "how many timeframes can be in fly")                                                    //
+    ("timeslice-threads", bpo::value<std::string>(), "threads processing consecutive timeslices concurrently")                                                       //
     ("shm-monitor", bpo::value<std::string>(), "whether to use the shared memory monitor")                                                                           //
     ("channel-prefix", bpo::value<std::string>()->default_value(""), "prefix to use for multiplexing multiple workflows in the same session")                        //
     ("shm-segment-size", bpo::value<std::string>(), "size of the shared memory segment in bytes")                                                                    //
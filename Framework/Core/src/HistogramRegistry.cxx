@@ -10,6 +10,7 @@
 // or submit itself to any jurisdiction.
 
 #include "Framework/HistogramRegistry.h"
+#include <atomic>
 #include <regex>
 #include <TList.h>
 
@@ -260,6 +261,168 @@ void HistogramRegistry::print(bool showAxisDetails)
   LOGF(info, "");
 }
 
+void HistogramRegistry::setConcurrentFill(bool enable)
+{
+  if (!enable && mConcurrentFill) {
+    mergeShards();
+  }
+  if (enable && !mShardStore) {
+    // ids are never reused, so that the per-thread shard caches cannot refer to a registry that no longer exists
+    static std::atomic<uint64_t> nextId{1};
+    mShardStore = std::make_unique<ShardStore>();
+    mShardStore->id = nextId++;
+  }
+  mConcurrentFill = enable;
+}
+
+HistogramRegistry::FillShard& HistogramRegistry::getLocalShard()
+{
+  // small per-thread cache of the shards last used by this thread, so that filling
+  // several registries from the same thread does not need to take the lock
+  static constexpr int nCached = 8;
+  thread_local std::array<std::pair<uint64_t, FillShard*>, nCached> cache{};
+  thread_local int nextCacheSlot = 0;
+
+  const uint64_t id = mShardStore->id;
+  for (auto& [cachedId, cachedShard] : cache) {
+    if (cachedId == id) {
+      return *cachedShard;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mShardStore->mutex);
+  auto& shard = mShardStore->shards[std::this_thread::get_id()];
+  if (!shard) {
+    shard = std::make_unique<FillShard>();
+  }
+  cache[nextCacheSlot] = {id, shard.get()};
+  nextCacheSlot = (nextCacheSlot + 1) % nCached;
+  return *shard;
+}
+
+// helper function to bring a cloned histogram back to its empty state
+template <typename T>
+static void resetHist(T* hist)
+{
+  if constexpr (std::is_base_of_v<StepTHn, T>) {
+    for (int step = 0; step < hist->getNSteps(); ++step) {
+      for (auto array : {hist->getValues(step), hist->getSumw2(step)}) {
+        for (int i = 0; array && i < array->GetSize(); ++i) {
+          array->SetAt(0., i);
+        }
+      }
+    }
+  } else {
+    hist->Reset();
+  }
+}
+
+void HistogramRegistry::initShardHist(FillShard& shard, uint32_t idx)
+{
+  // ROOT object creation is not thread-safe, so the shards are created under the lock
+  std::lock_guard<std::mutex> lock(mShardStore->mutex);
+  std::visit([&](const auto& sharedPtr) {
+    using T = std::decay_t<decltype(*sharedPtr)>;
+    auto clone = static_cast<T*>(sharedPtr->Clone());
+    if constexpr (std::is_base_of_v<TH1, T>) {
+      clone->SetDirectory(nullptr);
+    }
+    resetHist(clone);
+    shard.values[idx] = std::shared_ptr<T>(clone);
+    if constexpr (std::is_same_v<TH1, T> || std::is_same_v<TH2, T>) {
+      shard.rawBuffers[idx] = RawFillBuffer::create(sharedPtr.get());
+    }
+  },
+             mRegistryValue[idx]);
+  shard.initialized[idx] = true;
+}
+
+void HistogramRegistry::mergeShards()
+{
+  if (!mShardStore) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mShardStore->mutex);
+  for (auto& [threadId, shard] : mShardStore->shards) {
+    for (auto idx = 0u; idx < MAX_REGISTRY_SIZE; ++idx) {
+      if (!shard->initialized[idx]) {
+        continue;
+      }
+      std::visit([&](const auto& shardHist) {
+        using T = std::decay_t<decltype(*shardHist)>;
+        auto& target = std::get<std::shared_ptr<T>>(mRegistryValue[idx]);
+        if constexpr (std::is_same_v<TH1, T> || std::is_same_v<TH2, T>) {
+          if (shard->rawBuffers[idx]) {
+            shard->rawBuffers[idx]->mergeInto(target.get());
+          }
+        }
+        TList list;
+        list.Add(shardHist.get());
+        target->Merge(&list);
+        resetHist(shardHist.get());
+      },
+                 shard->values[idx]);
+    }
+  }
+}
+
+std::unique_ptr<HistogramRegistry::RawFillBuffer> HistogramRegistry::RawFillBuffer::create(TH1* hist)
+{
+  const int nDim = hist->GetDimension();
+  if (nDim > 2 || hist->CanExtendAllAxes()) {
+    return nullptr;
+  }
+  auto buffer = std::make_unique<RawFillBuffer>();
+  for (int d = 0; d < nDim; ++d) {
+    TAxis* axis = (d == 0) ? hist->GetXaxis() : hist->GetYaxis();
+    if (axis->IsVariableBinSize() || axis->GetLabels()) {
+      return nullptr;
+    }
+    buffer->nBins[d] = axis->GetNbins();
+    buffer->min[d] = axis->GetXmin();
+    buffer->max[d] = axis->GetXmax();
+  }
+  buffer->content.resize(hist->GetNcells(), 0.);
+  buffer->sumw2.resize(hist->GetNcells(), 0.);
+  return buffer;
+}
+
+void HistogramRegistry::RawFillBuffer::mergeInto(TH1* hist)
+{
+  if (entries == 0.) {
+    return;
+  }
+  // same behaviour as TH1::Fill: the first weighted fill enables the error structure
+  if (weighted && hist->GetSumw2N() == 0) {
+    hist->Sumw2();
+  }
+  // the statistics have to be retrieved before modifying the bin content, otherwise they would be recomputed from it
+  double histStats[TH1::kNstat]{};
+  hist->GetStats(histStats);
+  for (std::size_t i = 0; i < stats.size(); ++i) {
+    histStats[i] += stats[i];
+  }
+  const double histEntries = hist->GetEntries();
+
+  double* histSumw2 = hist->GetSumw2N() ? hist->GetSumw2()->GetArray() : nullptr;
+  for (std::size_t bin = 0; bin < content.size(); ++bin) {
+    if (content[bin] != 0.) {
+      hist->AddBinContent(bin, content[bin]);
+    }
+    if (histSumw2) {
+      histSumw2[bin] += sumw2[bin];
+    }
+  }
+  hist->PutStats(histStats);
+  hist->SetEntries(histEntries + entries);
+
+  std::fill(content.begin(), content.end(), 0.);
+  std::fill(sumw2.begin(), sumw2.end(), 0.);
+  stats.fill(0.);
+  entries = 0.;
+  weighted = false;
+}
+
 // create output structure will be propagated to file-sink
 TList* HistogramRegistry::operator*()
 {
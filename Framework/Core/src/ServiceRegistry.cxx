@@ -64,6 +64,17 @@ void ServiceRegistry::registerService(hash_type typeHash, void* service, Service
                            ". Make sure you use const / non-const correctly.");
 }
 
+void ServiceRegistry::overrideService(hash_type typeHash, void* service)
+{
+  // Every thread which looked up the service has its own entry,
+  // all of them need to point to the new instance.
+  for (size_t i = 0; i < mServicesKey.size(); ++i) {
+    if (mServicesKey[i].load() == typeHash) {
+      mServicesValue[i] = service;
+    }
+  }
+}
+
 void ServiceRegistry::declareService(ServiceSpec const& spec, DeviceState& state, fair::mq::ProgOptions& options)
 {
   mSpecs.push_back(spec);
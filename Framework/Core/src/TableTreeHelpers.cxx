@@ -517,14 +517,21 @@ void TreeToTable::addAllColumns(TTree* tree, std::vector<std::string>&& names)
   if (mBranchReaders.empty()) {
     throw runtime_error("No columns will be read");
   }
-  //tree->SetCacheSize(50000000);
   // FIXME: see https://github.com/root-project/root/issues/8962 and enable
   // again once fixed.
   //tree->SetClusterPrefetch(true);
-  //for (auto& reader : mBranchReaders) {
-  //  tree->AddBranchToCache(reader->branch());
-  //}
-  //tree->StopCacheLearningPhase();
+  // The branch cache is therefore off by default. It is only set up when
+  // explicitly requested, as the parallel unzipping of the baskets with ROOT
+  // IMT needs it, and without cluster prefetching. Only the selected branches
+  // go to the cache, so the projected-out columns are neither read nor
+  // decompressed.
+  if (mTreeCacheSize > 0) {
+    tree->SetCacheSize(mTreeCacheSize);
+    for (auto& reader : mBranchReaders) {
+      tree->AddBranchToCache(reader->branch());
+    }
+    tree->StopCacheLearningPhase();
+  }
 }
 
 void TreeToTable::setLabel(const char* label)
@@ -536,7 +543,8 @@ void TreeToTable::fill(TTree*)
 {
   std::vector<std::shared_ptr<arrow::ChunkedArray>> columns;
   std::vector<std::shared_ptr<arrow::Field>> fields;
-  static TBufferFile buffer{TBuffer::EMode::kWrite, 4 * 1024 * 1024};
+  // thread local, tables can be filled by a prefetching thread of the reader
+  static thread_local TBufferFile buffer{TBuffer::EMode::kWrite, 4 * 1024 * 1024};
   for (auto& reader : mBranchReaders) {
     buffer.Reset();
     auto arrayAndField = reader->read(&buffer);
@@ -0,0 +1,194 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "Framework/TimesliceExecutor.h"
+#include "Framework/Logger.h"
+
+#include <cassert>
+#include <limits>
+#include <utility>
+
+namespace o2::framework
+{
+
+TimesliceExecutor::TimesliceExecutor(size_t threads, std::function<void()> notify)
+  : mNotify{std::move(notify)}
+{
+  assert(threads > 0);
+  for (size_t i = 0; i < threads; ++i) {
+    mWorkers.emplace_back(std::make_unique<Worker>());
+  }
+  // Threads are started only once all the queues exist, as they
+  // might try to steal from any of them.
+  for (size_t i = 0; i < threads; ++i) {
+    mWorkers[i]->thread = std::thread([this, i]() { run(i); });
+  }
+}
+
+TimesliceExecutor::~TimesliceExecutor()
+{
+  {
+    std::lock_guard<std::mutex> lock(mWakeMutex);
+    mStop = true;
+  }
+  mWakeCondition.notify_all();
+  // The work being processed is finished, the one still queued is not
+  // started anymore.
+  size_t notStarted = 0;
+  for (auto& worker : mWorkers) {
+    worker->thread.join();
+    notStarted += worker->queue.size();
+  }
+  if (mPending.empty() == false) {
+    LOGP(error, "TimesliceExecutor stopped with {} timeslices not committed ({} not even started). Their results are discarded, drain() should have been called before.",
+         mPending.size(), notStarted);
+  }
+}
+
+void TimesliceExecutor::dispatch(Work work, Commit commit)
+{
+  uint64_t sequence;
+  {
+    std::lock_guard<std::mutex> lock(mPendingMutex);
+    sequence = mNextSequence++;
+    mPending.push_back(Pending{std::move(commit)});
+  }
+  auto& worker = *mWorkers[sequence % mWorkers.size()];
+  {
+    // The counter is updated together with the queue, so that it never
+    // underflows when the task is taken right away.
+    std::lock_guard<std::mutex> wakeLock(mWakeMutex);
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.queue.push_back(Task{sequence, std::move(work)});
+    mQueued++;
+  }
+  mWakeCondition.notify_one();
+}
+
+bool TimesliceExecutor::popFront(Worker& worker, Task& task)
+{
+  {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.queue.empty()) {
+      return false;
+    }
+    task = std::move(worker.queue.front());
+    worker.queue.pop_front();
+  }
+  std::lock_guard<std::mutex> wakeLock(mWakeMutex);
+  mQueued--;
+  return true;
+}
+
+bool TimesliceExecutor::take(size_t index, Task& task)
+{
+  // Our own work first.
+  if (popFront(*mWorkers[index], task)) {
+    return true;
+  }
+  // Then the oldest work of the others, i.e. the queue front with the
+  // smallest sequence number, as it is the next one to be committed.
+  // The victim might be emptied in the meanwhile, in which case we look
+  // again.
+  while (true) {
+    Worker* victim = nullptr;
+    uint64_t oldest = std::numeric_limits<uint64_t>::max();
+    for (size_t i = 0; i < mWorkers.size(); ++i) {
+      if (i == index) {
+        continue;
+      }
+      auto& worker = *mWorkers[i];
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      if (worker.queue.empty() == false && worker.queue.front().sequence < oldest) {
+        oldest = worker.queue.front().sequence;
+        victim = &worker;
+      }
+    }
+    if (victim == nullptr) {
+      return false;
+    }
+    if (popFront(*victim, task)) {
+      mStolen++;
+      return true;
+    }
+  }
+}
+
+void TimesliceExecutor::run(size_t index)
+{
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mWakeMutex);
+      mWakeCondition.wait(lock, [this]() { return mStop || mQueued > 0; });
+      if (mStop) {
+        return;
+      }
+    }
+    Task task;
+    if (take(index, task) == false) {
+      continue;
+    }
+    std::exception_ptr error;
+    try {
+      task.work();
+    } catch (...) {
+      error = std::current_exception();
+    }
+    // Whatever the work holds on to is released here, so that the commit
+    // is the last one to use it.
+    task.work = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(mPendingMutex);
+      auto& pending = mPending[task.sequence - mFirstSequence];
+      pending.error = error;
+      pending.done = true;
+    }
+    mPendingCondition.notify_all();
+    if (mNotify) {
+      mNotify();
+    }
+  }
+}
+
+size_t TimesliceExecutor::complete(bool wait)
+{
+  std::unique_lock<std::mutex> lock(mPendingMutex);
+  if (wait) {
+    mPendingCondition.wait(lock, [this]() { return mPending.empty() || mPending.front().done; });
+  }
+  size_t committed = 0;
+  while (mPending.empty() == false && mPending.front().done) {
+    Pending pending = std::move(mPending.front());
+    mPending.pop_front();
+    mFirstSequence++;
+    // Commits can take a while (e.g. sending the outputs), do not
+    // block the workers in the meanwhile.
+    lock.unlock();
+    pending.commit(pending.error);
+    committed++;
+    lock.lock();
+  }
+  return committed;
+}
+
+void TimesliceExecutor::drain()
+{
+  while (complete(true) > 0) {
+  }
+}
+
+size_t TimesliceExecutor::inFlight() const
+{
+  std::lock_guard<std::mutex> lock(mPendingMutex);
+  return mPending.size();
+}
+
+} // namespace o2::framework
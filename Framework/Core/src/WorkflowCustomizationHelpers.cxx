@@ -42,6 +42,7 @@ std::vector<ConfigParamSpec> WorkflowCustomizationHelpers::requiredWorkflowOptio
                                        ConfigParamSpec{"clone", VariantType::String, "", {"clone processors from a template"}},
                                        ConfigParamSpec{"labels", VariantType::String, "", {"add labels to dataprocessors"}},
                                        ConfigParamSpec{"workflow-suffix", VariantType::String, "", {"suffix to add to all dataprocessors"}},
+                                       ConfigParamSpec{"topology-cache", VariantType::String, "", {"directory where to cache the computed topology, empty to disable"}},
 
                                        // options for TF rate limiting
                                        ConfigParamSpec{"timeframes-rate-limit-ipcid", VariantType::String, "-1", {"Suffix for IPC channel for metrix-feedback, -1 = disable"}},
@@ -27,13 +27,18 @@
 #include "ArrowSupport.h"
 
 #include "Headers/DataHeader.h"
+#include <fmt/format.h>
 #include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <list>
+#include <sstream>
 #include <set>
 #include <utility>
 #include <vector>
 #include <climits>
 #include <thread>
+#include <unistd.h>
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpedantic"
@@ -262,6 +267,8 @@ void WorkflowHelpers::injectServiceDevices(WorkflowSpec& workflow, ConfigContext
     {ConfigParamSpec{"aod-file", VariantType::String, {"Input AOD file"}},
      ConfigParamSpec{"aod-reader-json", VariantType::String, {"json configuration file"}},
      ConfigParamSpec{"time-limit", VariantType::Int64, 0ll, {"Maximum run time limit in seconds"}},
+     ConfigParamSpec{"aod-reader-threads", VariantType::Int, 0, {"Number of threads decompressing the input baskets (0: no parallel decompression)"}},
+     ConfigParamSpec{"aod-reader-prefetch", VariantType::Bool, false, {"Read the next dataframe while the current one is processed"}},
      ConfigParamSpec{"orbit-offset-enumeration", VariantType::Int64, 0ll, {"initial value for the orbit"}},
      ConfigParamSpec{"orbit-multiplier-enumeration", VariantType::Int64, 0ll, {"multiplier to get the orbit from the counter"}},
      ConfigParamSpec{"start-value-enumeration", VariantType::Int64, 0ll, {"initial value for the enumeration"}},
@@ -803,6 +810,161 @@ void WorkflowHelpers::constructGraph(const WorkflowSpec& workflow,
   }
 }
 
+namespace
+{
+// Bump whenever the layout of the cached edges changes.
+constexpr uint64_t gTopologyCacheVersion = 1;
+
+// Only indices which are valid for @a workflow are accepted, so that a
+// corrupted or colliding cache file cannot be used to build the devices.
+bool readTopologyCache(std::istream& in,
+                       WorkflowSpec const& workflow,
+                       std::vector<DeviceConnectionEdge>& logicalEdges,
+                       std::vector<LogicalForwardInfo>& forwardedInputsInfo)
+{
+  size_t nOutputs = 0;
+  for (auto& producer : workflow) {
+    nOutputs += producer.outputs.size();
+  }
+  auto validInput = [&workflow, nOutputs](size_t consumer, size_t input, size_t output) {
+    return consumer < workflow.size() && input < workflow[consumer].inputs.size() && output < nOutputs;
+  };
+
+  auto read = [&in]() {
+    uint64_t value = 0;
+    in.read(reinterpret_cast<char*>(&value), sizeof(value));
+    return value;
+  };
+  if (read() != gTopologyCacheVersion) {
+    return false;
+  }
+  auto nEdges = read();
+  for (size_t ei = 0; ei < nEdges && in.good(); ++ei) {
+    DeviceConnectionEdge edge{};
+    edge.producer = read();
+    edge.consumer = read();
+    edge.timeIndex = read();
+    edge.producerTimeIndex = read();
+    edge.outputGlobalIndex = read();
+    edge.consumerInputIndex = read();
+    edge.isForward = read() != 0;
+    auto kind = read();
+    if (!validInput(edge.consumer, edge.consumerInputIndex, edge.outputGlobalIndex) ||
+        edge.producer >= workflow.size() ||
+        edge.timeIndex >= workflow[edge.consumer].maxInputTimeslices ||
+        edge.producerTimeIndex >= workflow[edge.producer].maxInputTimeslices ||
+        kind > (uint64_t)ConnectionKind::Unknown) {
+      return false;
+    }
+    edge.kind = (ConnectionKind)kind;
+    logicalEdges.push_back(edge);
+  }
+  auto nForwards = read();
+  for (size_t fi = 0; fi < nForwards && in.good(); ++fi) {
+    LogicalForwardInfo forward{};
+    forward.consumer = read();
+    forward.inputLocalIndex = read();
+    forward.outputGlobalIndex = read();
+    if (!validInput(forward.consumer, forward.inputLocalIndex, forward.outputGlobalIndex)) {
+      return false;
+    }
+    forwardedInputsInfo.push_back(forward);
+  }
+  return in.good();
+}
+
+void writeTopologyCache(std::ostream& out,
+                        std::vector<DeviceConnectionEdge> const& logicalEdges,
+                        std::vector<LogicalForwardInfo> const& forwardedInputsInfo)
+{
+  auto write = [&out](uint64_t value) {
+    out.write(reinterpret_cast<char const*>(&value), sizeof(value));
+  };
+  write(gTopologyCacheVersion);
+  write(logicalEdges.size());
+  for (auto& edge : logicalEdges) {
+    write(edge.producer);
+    write(edge.consumer);
+    write(edge.timeIndex);
+    write(edge.producerTimeIndex);
+    write(edge.outputGlobalIndex);
+    write(edge.consumerInputIndex);
+    write(edge.isForward);
+    write((uint64_t)edge.kind);
+  }
+  write(forwardedInputsInfo.size());
+  for (auto& forward : forwardedInputsInfo) {
+    write(forward.consumer);
+    write(forward.inputLocalIndex);
+    write(forward.outputGlobalIndex);
+  }
+}
+} // namespace
+
+size_t WorkflowHelpers::topologyHash(const WorkflowSpec& workflow)
+{
+  // Only what constructGraph looks at goes in, i.e. the order of the
+  // dataprocessors, their timeslices and the matchers of their inputs and
+  // outputs, so this is a single pass over the specs.
+  size_t hash = workflow.size();
+  auto combine = [&hash](size_t value) {
+    hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+  };
+  std::hash<std::string> hashString;
+  for (auto& processor : workflow) {
+    combine(hashString(processor.name));
+    combine(processor.maxInputTimeslices);
+    combine(processor.inputs.size());
+    for (auto& input : processor.inputs) {
+      combine(hashString(DataSpecUtils::describe(input)));
+    }
+    combine(processor.outputs.size());
+    for (auto& output : processor.outputs) {
+      combine(hashString(DataSpecUtils::describe(output)));
+    }
+  }
+  return hash;
+}
+
+void WorkflowHelpers::constructGraphCached(const WorkflowSpec& workflow,
+                                           std::vector<DeviceConnectionEdge>& logicalEdges,
+                                           std::vector<OutputSpec>& outputs,
+                                           std::vector<LogicalForwardInfo>& forwardedInputsInfo,
+                                           std::string const& cacheDir)
+{
+  if (cacheDir.empty()) {
+    constructGraph(workflow, logicalEdges, outputs, forwardedInputsInfo);
+    return;
+  }
+  auto filename = fmt::format("{}/dpl-topology-{:016x}.bin", cacheDir, topologyHash(workflow));
+  std::ifstream in(filename, std::ios::binary);
+  if (in.good()) {
+    if (readTopologyCache(in, workflow, logicalEdges, forwardedInputsInfo)) {
+      LOGP(debug, "Reusing topology from {}", filename);
+      // The outputs are simply the ones of all the dataprocessors, in order.
+      for (auto& producer : workflow) {
+        outputs.insert(outputs.end(), producer.outputs.begin(), producer.outputs.end());
+      }
+      return;
+    }
+    LOGP(warning, "Ignoring invalid topology cache {}", filename);
+  }
+  logicalEdges.clear();
+  forwardedInputsInfo.clear();
+  constructGraph(workflow, logicalEdges, outputs, forwardedInputsInfo);
+
+  // The driver and all the devices might be doing this at the same time,
+  // so we only expose complete files.
+  auto tmpFilename = fmt::format("{}.{}", filename, getpid());
+  std::ofstream out(tmpFilename, std::ios::binary);
+  writeTopologyCache(out, logicalEdges, forwardedInputsInfo);
+  out.close();
+  if (!out || std::rename(tmpFilename.c_str(), filename.c_str()) != 0) {
+    LOGP(warning, "Unable to write topology cache {}", filename);
+    std::remove(tmpFilename.c_str());
+  }
+}
+
 std::vector<EdgeAction>
   WorkflowHelpers::computeOutEdgeActions(
     const std::vector<DeviceConnectionEdge>& edges,
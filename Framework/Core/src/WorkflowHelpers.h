@@ -19,6 +19,7 @@
 #include "Framework/DataProcessorInfo.h"
 
 #include <cstddef>
+#include <string>
 #include <vector>
 #include <iosfwd>
 
@@ -199,6 +200,19 @@ struct WorkflowHelpers {
                              std::vector<OutputSpec>& outputs,
                              std::vector<LogicalForwardInfo>& availableForwardsInfo);
 
+  /// Same as constructGraph, but reuses the edges computed by a previous
+  /// invocation for an identical workflow, if they are found in @a cacheDir.
+  /// The cache is keyed by topologyHash, so that any change to the
+  /// topology invalidates it. An empty @a cacheDir disables the cache.
+  static void constructGraphCached(const WorkflowSpec& workflow,
+                                   std::vector<DeviceConnectionEdge>& logicalEdges,
+                                   std::vector<OutputSpec>& outputs,
+                                   std::vector<LogicalForwardInfo>& availableForwardsInfo,
+                                   std::string const& cacheDir);
+
+  /// @return a hash of everything in @a workflow which affects the result of constructGraph.
+  static size_t topologyHash(const WorkflowSpec& workflow);
+
   // FIXME: this is an implementation detail for compute edge action,
   //        actually. It should be moved to the cxx. Comes handy for testing things though..
   static void sortEdges(std::vector<size_t>& inEdgeIndex,
@@ -26,6 +26,7 @@
 #include "Framework/DeviceInfo.h"
 #include "Framework/DeviceMetricsInfo.h"
 #include "Framework/DeviceMetricsHelper.h"
+#include "Framework/DeviceMetricsRing.h"
 #include "Framework/DeviceConfigInfo.h"
 #include "Framework/DeviceSpec.h"
 #include "Framework/DeviceState.h"
@@ -836,17 +837,6 @@ LogProcessingState processChildrenOutput(DriverInfo& driverInfo,
     assert(specs.size() == infos.size());
     DeviceSpec const& spec = specs[di];
 
-    if (info.unprinted.empty()) {
-      continue;
-    }
-
-    O2_SIGNPOST_START(DriverStatus::ID, DriverStatus::BYTES_PROCESSED, info.pid, 0, 0);
-
-    std::string_view s = info.unprinted;
-    size_t pos = 0;
-    info.history.resize(info.historySize);
-    info.historyLevel.resize(info.historySize);
-
     auto updateMetricsViews =
       Metric2DViewIndex::getUpdater({&info.dataRelayerViewIndex,
                                      &info.variablesViewIndex,
@@ -858,6 +848,42 @@ LogProcessingState processChildrenOutput(DriverInfo& driverInfo,
       hasNewMetric = true;
     };
 
+    // Numeric metrics passed in binary form do not need any parsing.
+    if (driverInfo.binaryMetrics) {
+      if (info.metricsRing == nullptr && info.active) {
+        info.metricsRing = DeviceMetricsRingHelpers::attach(info.pid);
+      }
+      if (info.metricsRing) {
+        auto processed = info.metricsRing->drain([&metrics, &newMetricCallback](BinaryMetricRecord const& record) {
+          DeviceMetricsHelper::processMetric(record, metrics, newMetricCallback);
+        });
+        result.didProcessMetric |= processed != 0;
+        auto overflows = info.metricsRing->overflows.load(std::memory_order_relaxed);
+        if (overflows != info.metricsRingOverflows) {
+          if (info.metricsRingOverflows == 0) {
+            LOGP(warning, "Binary metrics ring of {} is full, its metrics are sent as text until it is drained.", spec.id);
+          }
+          info.metricsRingOverflows = overflows;
+        }
+        // Nothing else will come from a device which is gone.
+        if (!info.active) {
+          DeviceMetricsRingHelpers::release(info.metricsRing);
+          info.metricsRing = nullptr;
+        }
+      }
+    }
+
+    if (info.unprinted.empty()) {
+      continue;
+    }
+
+    O2_SIGNPOST_START(DriverStatus::ID, DriverStatus::BYTES_PROCESSED, info.pid, 0, 0);
+
+    std::string_view s = info.unprinted;
+    size_t pos = 0;
+    info.history.resize(info.historySize);
+    info.historyLevel.resize(info.historySize);
+
     while ((pos = s.find(delimiter)) != std::string::npos) {
       std::string token{s.substr(0, pos)};
       auto logLevel = LogParsingHelpers::parseTokenLevel(token);
@@ -1021,6 +1047,7 @@ int doChild(int argc, char** argv, ServiceRegistry& serviceRegistry,
       ("infologger-severity", bpo::value<std::string>()->default_value(""), "minimum FairLogger severity to send to InfoLogger")                                                           //
       ("expected-region-callbacks", bpo::value<std::string>()->default_value("0"), "how many region callbacks we are expecting")                                                           //
       ("timeframes-rate-limit", bpo::value<std::string>()->default_value("0"), "how many timeframe can be in fly at the same moment (0 disables)")                                         //
+      ("timeslice-threads", bpo::value<std::string>()->default_value("0"), "how many threads process consecutive timeslices concurrently (0 disables)")                                    //
       ("configuration,cfg", bpo::value<std::string>()->default_value("command-line"), "configuration backend")                                                                             //
       ("infologger-mode", bpo::value<std::string>()->default_value(""), "O2_INFOLOGGER_MODE override");
     r.fConfig.AddToCmdLineOptions(optsDesc, true);
@@ -1139,6 +1166,35 @@ void dumpMetricsCallback(uv_timer_t* handle)
                                                context->driver->metrics, *(context->specs), performanceMetrics);
 }
 
+/// Account for the time spent since the previous startup phase.
+/// A @a last timestamp of 0 means the startup is over.
+void markStartupPhase(std::vector<std::pair<std::string, float>>& phases, uint64_t& last, char const* phase)
+{
+  if (last == 0) {
+    return;
+  }
+  auto now = uv_hrtime();
+  phases.emplace_back(phase, (now - last) / 1000000.f);
+  last = now;
+}
+
+/// Print how long each of the startup phases took. Devices only
+/// do so in debug mode, not to flood the driver.
+void reportStartupPhases(DriverInfo const& driverInfo, bool isDevice)
+{
+  std::string summary;
+  float total = 0;
+  for (auto& [phase, elapsed] : driverInfo.startupPhases) {
+    summary += fmt::format("{}{}: {:.1f} ms", summary.empty() ? "" : ", ", phase, elapsed);
+    total += elapsed;
+  }
+  if (isDevice) {
+    LOGP(debug, "Startup took {:.1f} ms ({})", total, summary);
+  } else {
+    LOGP(info, "Startup took {:.1f} ms ({})", total, summary);
+  }
+}
+
 // This is the handler for the parent inner loop.
 int runStateMachine(DataProcessorSpecs const& workflow,
                     WorkflowInfo const& workflowInfo,
@@ -1306,6 +1362,17 @@ int runStateMachine(DataProcessorSpecs const& workflow,
   uv_timer_t force_step_timer;
   uv_timer_init(loop, &force_step_timer);
 
+  // Devices do not notify the driver when they push binary metrics, so
+  // without something else waking up the loop (e.g. the GUI timer) their
+  // rings would only be drained on the next output on their stdout. We
+  // wake up regularly, so that processChildrenOutput drains them long
+  // before they are full.
+  uv_timer_t metricsRingTimer;
+  if (driverInfo.binaryMetrics) {
+    uv_timer_init(loop, &metricsRingTimer);
+    uv_timer_start(&metricsRingTimer, [](uv_timer_t*) {}, 10, 10);
+  }
+
   bool guiDeployedOnce = false;
   bool once = false;
 
@@ -1565,6 +1632,7 @@ int runStateMachine(DataProcessorSpecs const& workflow,
               }
             }
           }
+          markStartupPhase(driverInfo.startupPhases, driverInfo.lastStartupPhaseTimestamp, "materialise");
 
           // This should expand nodes so that we can build a consistent DAG.
         } catch (std::runtime_error& e) {
@@ -1590,6 +1658,7 @@ int runStateMachine(DataProcessorSpecs const& workflow,
         for (size_t di = 0; di < runningWorkflow.devices.size(); di++) {
           RunningDeviceRef ref{di};
           if (runningWorkflow.devices[di].id == frameworkId) {
+            reportStartupPhases(driverInfo, true);
             return doChild(driverInfo.argc, driverInfo.argv,
                            serviceRegistry,
                            runningWorkflow, ref,
@@ -1665,6 +1734,7 @@ int runStateMachine(DataProcessorSpecs const& workflow,
                                               deviceExecutions,
                                               controls,
                                               driverInfo.uniqueWorkflowId);
+          markStartupPhase(driverInfo.startupPhases, driverInfo.lastStartupPhaseTimestamp, "merge-configs");
         } catch (o2::framework::RuntimeErrorRef& ref) {
           auto& err = o2::framework::error_from_ref(ref);
           LOGP(error, "unable to merge configurations in {}: {}", driverInfo.argv[0], err.what);
@@ -1733,6 +1803,11 @@ int runStateMachine(DataProcessorSpecs const& workflow,
                          driverInfo.resourcesMonitoringDumpInterval * 1000);
         }
         LOG(info) << "Redeployment of configuration done.";
+        if (driverInfo.lastStartupPhaseTimestamp) {
+          markStartupPhase(driverInfo.startupPhases, driverInfo.lastStartupPhaseTimestamp, "schedule");
+          reportStartupPhases(driverInfo, false);
+          driverInfo.lastStartupPhaseTimestamp = 0;
+        }
       } break;
       case DriverState::RUNNING:
         // Run any pending libUV event loop, block if
@@ -2303,6 +2378,8 @@ int doMain(int argc, char** argv, o2::framework::WorkflowSpec const& workflow,
            o2::framework::ConfigContext& configContext)
 {
   O2_SIGNPOST_INIT();
+  std::vector<std::pair<std::string, float>> startupPhases;
+  uint64_t lastStartupPhase = uv_hrtime();
   std::vector<std::string> currentArgs;
   std::vector<PluginInfo> plugins;
 
@@ -2408,6 +2485,8 @@ int doMain(int argc, char** argv, o2::framework::WorkflowSpec const& workflow,
     }
   }
 
+  markStartupPhase(startupPhases, lastStartupPhase, "import");
+
   /// This is the earlies the services are actually needed
   std::vector<ServiceSpec> driverServices = CommonDriverServices::defaultServices();
   // We insert the hash for the internal devices.
@@ -2442,6 +2521,8 @@ int doMain(int argc, char** argv, o2::framework::WorkflowSpec const& workflow,
                      [](OutputSpec const& a, OutputSpec const& b) { return DataSpecUtils::describe(a) < DataSpecUtils::describe(b); });
   }
 
+  markStartupPhase(startupPhases, lastStartupPhase, "inject");
+
   std::vector<TopologyPolicy> topologyPolicies = TopologyPolicy::createDefaultPolicies();
   std::vector<TopologyPolicy::DependencyChecker> dependencyCheckers;
   dependencyCheckers.reserve(physicalWorkflow.size());
@@ -2521,6 +2602,7 @@ int doMain(int argc, char** argv, o2::framework::WorkflowSpec const& workflow,
     }
     apply_permutation(physicalWorkflow, newLocations);
   }
+  markStartupPhase(startupPhases, lastStartupPhase, "sort");
 
   // Use the hidden options as veto, all config specs matching a definition
   // in the hidden options are skipped in order to avoid duplicate definitions
@@ -2580,6 +2662,7 @@ int doMain(int argc, char** argv, o2::framework::WorkflowSpec const& workflow,
   driverInfo.argv = argv;
   driverInfo.batch = varmap["no-batch"].defaulted() ? varmap["batch"].as<bool>() : false;
   driverInfo.noSHMCleanup = varmap["no-cleanup"].as<bool>();
+  driverInfo.binaryMetrics = varmap.count("monitoring-backend") && varmap["monitoring-backend"].as<std::string>() == "dpl-shm://";
   driverInfo.processingPolicies.termination = varmap["completion-policy"].as<TerminationPolicy>();
   driverInfo.processingPolicies.earlyForward = varmap["early-forward-policy"].as<EarlyForwardPolicy>();
   if (varmap["error-policy"].defaulted() && driverInfo.batch == false) {
@@ -2598,6 +2681,9 @@ int doMain(int argc, char** argv, o2::framework::WorkflowSpec const& workflow,
   // FIXME: should use the whole dataProcessorInfos, actually...
   driverInfo.processorInfo = dataProcessorInfos;
   driverInfo.configContext = &configContext;
+  markStartupPhase(startupPhases, lastStartupPhase, "options");
+  driverInfo.startupPhases = std::move(startupPhases);
+  driverInfo.lastStartupPhaseTimestamp = lastStartupPhase;
 
   commandInfo.merge(CommandInfo(argc, argv));
 
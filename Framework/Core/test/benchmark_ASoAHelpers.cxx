@@ -13,6 +13,7 @@
 #include "Framework/TableBuilder.h"
 #include "Framework/AnalysisDataModel.h"
 #include <benchmark/benchmark.h>
+#include <numeric>
 #include <random>
 #include <vector>
 
@@ -28,6 +29,7 @@ DECLARE_SOA_COLUMN_FULL(X, x, float, "x");
 DECLARE_SOA_COLUMN_FULL(Y, y, float, "y");
 DECLARE_SOA_COLUMN_FULL(Z, z, float, "z");
 DECLARE_SOA_DYNAMIC_COLUMN(Sum, sum, [](float x, float y) { return x + y; });
+DECLARE_SOA_COLUMN_FULL(MixingBin, mixingBin, int32_t, "mixingBin");
 } // namespace test
 
 #ifdef __APPLE__
@@ -714,4 +716,58 @@ static void BM_ASoAHelpersCombGenCollisionsFivesCategories(benchmark::State& sta
 
 BENCHMARK(BM_ASoAHelpersCombGenCollisionsFivesCategories)->RangeMultiplier(2)->Range(8, 8 << (maxFivesRange + 1));
 
+// Event mixing of collisions binned in z vertex and multiplicity,
+// with the combinations split over state.range(1) threads
+static void BM_ASoAHelpersCombGenCollisionsMixingParallel(benchmark::State& state)
+{
+  std::default_random_engine e1(1234567891);
+  std::uniform_real_distribution<float> uniform_dist(0, 1);
+  std::normal_distribution<float> vertex_dist(0.f, 6.f);
+  std::exponential_distribution<float> mult_dist(1.f / 15.f);
+  std::vector<float> zBins{-10.f, -8.f, -6.f, -4.f, -2.f, 0.f, 2.f, 4.f, 6.f, 8.f, 10.f};
+  std::vector<int> multBins{0, 5, 10, 15, 20, 30, 40, 50, 70, 100, 1000};
+
+  TableBuilder builder;
+  auto rowWriter = builder.cursor<o2::aod::Collisions>();
+  for (auto i = 0; i < state.range(0); ++i) {
+    rowWriter(0, i,
+              uniform_dist(e1), uniform_dist(e1), vertex_dist(e1),
+              uniform_dist(e1), uniform_dist(e1), uniform_dist(e1),
+              uniform_dist(e1), uniform_dist(e1), uniform_dist(e1),
+              0, uniform_dist(e1),
+              static_cast<int>(mult_dist(e1)),
+              uniform_dist(e1), uniform_dist(e1));
+  }
+  o2::aod::Collisions collisions{builder.finalize()};
+
+  // Mixing bin of each collision, -1 outside of the binning
+  TableBuilder builderBins;
+  auto rowWriterBins = builderBins.persist<float, int32_t>({"z", "mixingBin"});
+  for (auto& collision : collisions) {
+    int zBin = std::upper_bound(zBins.begin(), zBins.end(), collision.posZ()) - zBins.begin() - 1;
+    int multBin = std::upper_bound(multBins.begin(), multBins.end(), static_cast<int>(collision.numContrib())) - multBins.begin() - 1;
+    bool inside = zBin >= 0 && zBin < static_cast<int>(zBins.size()) - 1 && multBin >= 0 && multBin < static_cast<int>(multBins.size()) - 1;
+    rowWriterBins(0, collision.posZ(), inside ? zBin * static_cast<int>(multBins.size()) + multBin : -1);
+  }
+  using MixingBins = o2::soa::Table<o2::soa::Index<>, test::Z, test::MixingBin>;
+  MixingBins bins{builderBins.finalize()};
+
+  int nThreads = state.range(1);
+  int64_t count = 0;
+  for (auto _ : state) {
+    std::vector<int64_t> perThreadCount(nThreads, 0);
+    std::vector<float> perThreadSum(nThreads, 0.f);
+    parallelCombinations(CombinationsBlockStrictlyUpperSameIndexPolicy("mixingBin", 5, -1, bins, bins), nThreads, [&](int slot, auto& comb) {
+      perThreadCount[slot]++;
+      perThreadSum[slot] += std::get<0>(comb).z() - std::get<1>(comb).z();
+    });
+    count = std::accumulate(perThreadCount.begin(), perThreadCount.end(), int64_t{0});
+    benchmark::DoNotOptimize(perThreadSum);
+  }
+  state.counters["Combinations"] = count;
+  state.SetBytesProcessed(state.iterations() * sizeof(float) * count);
+}
+
+BENCHMARK(BM_ASoAHelpersCombGenCollisionsMixingParallel)->RangeMultiplier(2)->Ranges({{8 << maxPairsRange, 8 << maxPairsRange}, {1, 8}})->UseRealTime();
+
 BENCHMARK_MAIN();
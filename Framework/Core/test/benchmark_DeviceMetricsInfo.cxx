@@ -10,8 +10,11 @@
 // or submit itself to any jurisdiction.
 #include "Framework/DeviceMetricsInfo.h"
 #include "Framework/DeviceMetricsHelper.h"
+#include "Framework/DeviceMetricsRing.h"
 
 #include <benchmark/benchmark.h>
+#include <cstring>
+#include <memory>
 #include <regex>
 
 // This is the fastest we could ever get.
@@ -92,10 +95,39 @@ static void BM_ProcessIntMetric(benchmark::State& state)
     }
   }
   state.SetBytesProcessed(state.iterations() * metrics.size() * metric.size());
+  state.SetItemsProcessed(state.iterations() * metrics.size());
 }
 
 BENCHMARK(BM_ProcessIntMetric);
 
+// Same as BM_ProcessIntMetric, but going through the binary ring
+// rather than the text protocol.
+static void BM_ProcessBinaryIntMetric(benchmark::State& state)
+{
+  using namespace o2::framework;
+  DeviceMetricsInfo info;
+  auto ring = std::make_unique<DeviceMetricsRing>();
+
+  BinaryMetricRecord record;
+  record.type = MetricType::Int;
+  record.intValue = 12;
+  record.timestamp = 1789372894;
+  record.labelSize = 4;
+  memcpy(record.label, "bkey", 4);
+  for (auto _ : state) {
+    for (size_t i = 0; i < 1000; ++i) {
+      ring->push(record);
+    }
+    ring->drain([&info](BinaryMetricRecord const& r) {
+      DeviceMetricsHelper::processMetric(r, info);
+    });
+  }
+  state.SetBytesProcessed(state.iterations() * 1000 * sizeof(BinaryMetricRecord));
+  state.SetItemsProcessed(state.iterations() * 1000);
+}
+
+BENCHMARK(BM_ProcessBinaryIntMetric);
+
 static void BM_ParseFloatMetric(benchmark::State& state)
 {
   using namespace o2::framework;
@@ -16,6 +16,7 @@
 
 #include <benchmark/benchmark.h>
 #include <boost/format.hpp>
+#include <random>
 
 using namespace o2::framework;
 using namespace arrow;
@@ -62,6 +63,66 @@ static void BM_StandardNameLookup(benchmark::State& state)
     }
   }
 }
+/// Number of fills per thread and iteration, about the number of tracks of a few Pb-Pb collisions
+const int nFills = 100000;
+
+/// Fill a TH1F and a TH2F of a HistogramRegistry, either directly or via the per-thread shards
+static void BM_RegistryFill(benchmark::State& state)
+{
+  HistogramRegistry registry{
+    "registry", {
+                  {"pt", "p_{T}", {HistType::kTH1F, {{200, 0., 10.}}}},                        //
+                  {"etaPhi", "#eta vs #varphi", {HistType::kTH2F, {{100, -1., 1.}, {100, 0., 6.3}}}} //
+                }                                                                                      //
+  };
+  if (state.range(0)) {
+    registry.setConcurrentFill();
+  }
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<double> flat(0., 1.);
+  std::vector<std::array<double, 3>> values(nFills);
+  for (auto& v : values) {
+    v = {10. * flat(gen), 2. * flat(gen) - 1., 6.3 * flat(gen)};
+  }
+  for (auto _ : state) {
+    for (auto& v : values) {
+      registry.fill(HIST("pt"), v[0]);
+      registry.fill(HIST("etaPhi"), v[1], v[2]);
+    }
+  }
+  registry.mergeShards();
+  state.SetItemsProcessed(state.iterations() * nFills * 2);
+}
+
+/// Fill from several threads: each benchmark thread uses its own shard of the shared registry
+static HistogramRegistry sharedRegistry{
+  "shared", {
+              {"pt", "p_{T}", {HistType::kTH1F, {{200, 0., 10.}}}},                        //
+              {"etaPhi", "#eta vs #varphi", {HistType::kTH2F, {{100, -1., 1.}, {100, 0., 6.3}}}} //
+            }                                                                                    //
+};
+
+static void BM_RegistryConcurrentFillThreads(benchmark::State& state)
+{
+  if (state.thread_index == 0) {
+    sharedRegistry.setConcurrentFill();
+  }
+  std::mt19937 gen(state.thread_index);
+  std::uniform_real_distribution<double> flat(0., 1.);
+  for (auto _ : state) {
+    for (int i = 0; i < nFills; ++i) {
+      sharedRegistry.fill(HIST("pt"), 10. * flat(gen));
+      sharedRegistry.fill(HIST("etaPhi"), 2. * flat(gen) - 1., 6.3 * flat(gen));
+    }
+  }
+  if (state.thread_index == 0) {
+    sharedRegistry.mergeShards();
+  }
+  state.SetItemsProcessed(state.iterations() * nFills * 2);
+}
+
+BENCHMARK(BM_RegistryFill)->Arg(0)->Arg(1);
+BENCHMARK(BM_RegistryConcurrentFillThreads)->ThreadRange(1, 8)->UseRealTime();
 BENCHMARK(BM_HashedNameLookup)->Arg(4)->Arg(8)->Arg(16)->Arg(64)->Arg(128)->Arg(256)->Arg(512);
 BENCHMARK(BM_StandardNameLookup)->Arg(4)->Arg(8)->Arg(16)->Arg(64)->Arg(128)->Arg(256)->Arg(512);
 
@@ -1232,6 +1232,62 @@ BOOST_AUTO_TEST_CASE(BlockCombinations)
   BOOST_CHECK_EQUAL(count, 0);
 }
 
+BOOST_AUTO_TEST_CASE(PartitionedBlockCombinations)
+{
+  TableBuilder builderAux;
+  auto rowWriterAux = builderAux.persist<int32_t, int32_t>({"x", "y"});
+  for (int i = 0; i < 60; i++) {
+    // Categories of uneven size, with some outsiders
+    rowWriterAux(0, i, (i * i + 3 * i) % 11 - 1);
+  }
+  auto tableAux = builderAux.finalize();
+  using TestsAux = o2::soa::Table<o2::soa::Index<>, test::X, test::Y>;
+  TestsAux testAux{tableAux};
+  BOOST_REQUIRE_EQUAL(60, testAux.size());
+
+  auto checkPartitions = [](auto const& policy) {
+    std::vector<std::tuple<int32_t, int32_t>> expected;
+    for (auto& [c0, c1] : combinations(policy)) {
+      expected.emplace_back(c0.x(), c1.x());
+    }
+    BOOST_REQUIRE_GT(expected.size(), 0);
+
+    for (int nParts : {1, 2, 3, 7, 100}) {
+      auto parts = partitionCombinations(policy, nParts);
+      BOOST_CHECK_LE(parts.size(), static_cast<size_t>(nParts));
+      std::vector<std::tuple<int32_t, int32_t>> joined;
+      for (auto& part : parts) {
+        for (auto& [c0, c1] : part) {
+          joined.emplace_back(c0.x(), c1.x());
+        }
+      }
+      BOOST_CHECK(joined == expected);
+    }
+
+    constexpr int nThreads = 4;
+    std::array<std::vector<std::tuple<int32_t, int32_t>>, nThreads> perThread;
+    parallelCombinations(policy, nThreads, [&perThread](int slot, auto& comb) {
+      perThread[slot].emplace_back(std::get<0>(comb).x(), std::get<1>(comb).x());
+    });
+    std::vector<std::tuple<int32_t, int32_t>> merged;
+    for (auto& combs : perThread) {
+      merged.insert(merged.end(), combs.begin(), combs.end());
+    }
+    std::sort(merged.begin(), merged.end());
+    std::sort(expected.begin(), expected.end());
+    BOOST_CHECK(merged == expected);
+  };
+
+  checkPartitions(CombinationsBlockUpperIndexPolicy("y", 2, -1, testAux, testAux));
+  checkPartitions(CombinationsBlockFullIndexPolicy("y", 2, -1, testAux, testAux));
+  checkPartitions(CombinationsBlockUpperSameIndexPolicy("y", 3, -1, testAux, testAux));
+  checkPartitions(CombinationsBlockStrictlyUpperSameIndexPolicy("y", 3, -1, testAux, testAux));
+  checkPartitions(CombinationsBlockFullSameIndexPolicy("y", 2, -1, testAux, testAux));
+
+  // Exceptions thrown by the callback are propagated to the caller
+  BOOST_CHECK_THROW(parallelCombinations(CombinationsBlockFullSameIndexPolicy("y", 2, -1, testAux, testAux), 4, [](int, auto&) { throw std::runtime_error("failed"); }), std::runtime_error);
+}
+
 BOOST_AUTO_TEST_CASE(CombinationsHelpers)
 {
   TableBuilder builderA;
@@ -0,0 +1,113 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#include "Framework/CommonServices.h"
+#include "Framework/ControlService.h"
+#include "Framework/CustomWorkflowTerminationHook.h"
+#include "Framework/DeviceInfo.h"
+#include "Framework/DeviceMetricsHelper.h"
+#include "Framework/DeviceMetricsInfo.h"
+#include "Framework/DeviceSpec.h"
+#include "Framework/Monitoring.h"
+#include "Framework/Logger.h"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+namespace
+{
+// More metrics than fit in the ring of the producer, which therefore has
+// to be drained while the workflow runs.
+int const nTimeslices = 100;
+int const nMetricsPerTimeslice = 200;
+char const* const metricName = "binary-metrics-test";
+
+// Only meaningful in the driver, where the metrics are received.
+size_t receivedMetrics = 0;
+size_t lastValue = 0;
+size_t ringOverflows = 0;
+
+struct BinaryMetricsCheck {
+};
+} // namespace
+
+void customize(o2::framework::OnWorkflowTerminationHook& hook)
+{
+  hook = [](char const* idstring) {
+    // The devices are started with an --id, the driver is not.
+    if (idstring != nullptr) {
+      return;
+    }
+    if (receivedMetrics != nTimeslices * nMetricsPerTimeslice || lastValue != receivedMetrics - 1) {
+      LOGP(fatal, "The driver received {} metrics, up to {}, expecting {}", receivedMetrics, lastValue, nTimeslices * nMetricsPerTimeslice);
+    }
+    if (ringOverflows != 0) {
+      LOGP(fatal, "{} metrics did not fit in the binary ring", ringOverflows);
+    }
+  };
+}
+
+#include "Framework/runDataProcessing.h"
+
+using namespace o2::framework;
+
+// The workflow runs without GUI, with --monitoring-backend dpl-shm://, see
+// CMakeLists.txt. All the metrics of the producer must reach the driver
+// via the binary ring, i.e. the driver drains it before it is full.
+WorkflowSpec defineDataProcessing(ConfigContext const&)
+{
+  DataProcessorSpec producer{
+    "producer",
+    Inputs{},
+    {OutputSpec{"TST", "COUNTER", 0, Lifetime::Timeframe}},
+    AlgorithmSpec{[counter = std::make_shared<int>(0)](ProcessingContext& ctx) {
+      auto& monitoring = ctx.services().get<o2::monitoring::Monitoring>();
+      for (int i = 0; i < nMetricsPerTimeslice; ++i) {
+        monitoring.send(o2::monitoring::Metric{*counter * nMetricsPerTimeslice + i, metricName});
+      }
+      monitoring.flushBuffer();
+      ctx.outputs().make<int>(Output{"TST", "COUNTER", 0}) = (*counter)++;
+      if (*counter == nTimeslices) {
+        ctx.services().get<ControlService>().endOfStream();
+        ctx.services().get<ControlService>().readyToQuit(QuitRequest::Me);
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }}};
+  // The metric handling callbacks of the services of the devices are
+  // invoked by the driver.
+  producer.requiredServices.push_back(ServiceSpec{
+    .name = "binary-metrics-check",
+    .init = CommonServices::simpleServiceInit<BinaryMetricsCheck, BinaryMetricsCheck>(),
+    .configure = CommonServices::noConfiguration(),
+    .metricHandling = [](ServiceRegistry&, std::vector<DeviceMetricsInfo>& metrics, std::vector<DeviceSpec>& specs, std::vector<DeviceInfo>& infos, DeviceMetricsInfo&, size_t) {
+      for (size_t di = 0; di < specs.size(); ++di) {
+        if (specs[di].name != "producer") {
+          continue;
+        }
+        ringOverflows = infos[di].metricsRingOverflows;
+        auto mi = DeviceMetricsHelper::metricIdxByName(metricName, metrics[di]);
+        if (mi == metrics[di].metrics.size()) {
+          continue;
+        }
+        auto const& info = metrics[di].metrics[mi];
+        receivedMetrics = info.filledMetrics;
+        lastValue = metrics[di].intMetrics[info.storeIdx][(info.pos + 1023) % 1024];
+      }
+    },
+    .kind = ServiceKind::Serial});
+
+  return WorkflowSpec{
+    producer,
+    {"sink",
+     {InputSpec{"counter", "TST", "COUNTER", 0, Lifetime::Timeframe}},
+     Outputs{},
+     AlgorithmSpec{[](ProcessingContext&) {}}}};
+}
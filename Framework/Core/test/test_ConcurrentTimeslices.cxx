@@ -0,0 +1,89 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#include "Framework/CallbackService.h"
+#include "Framework/ControlService.h"
+#include "Framework/DataProcessingHeader.h"
+#include "Framework/DataRefUtils.h"
+#include "Framework/EndOfStreamContext.h"
+#include "Framework/Monitoring.h"
+#include "Framework/TimingInfo.h"
+#include "Framework/Logger.h"
+#include "Framework/runDataProcessing.h"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#define ASSERT_ERROR(condition)                                   \
+  if ((condition) == false) {                                     \
+    LOG(fatal) << R"(Test condition ")" #condition R"(" failed)"; \
+  }
+
+using namespace o2::framework;
+
+namespace
+{
+int const nTimeslices = 64;
+}
+
+// The processor is started with --timeslice-threads, see CMakeLists.txt.
+// Its timeslices complete out of order, but the sink must receive them in
+// the order in which they were produced.
+WorkflowSpec defineDataProcessing(ConfigContext const&)
+{
+  return WorkflowSpec{
+    {"producer",
+     Inputs{},
+     {OutputSpec{"TST", "COUNTER", 0, Lifetime::Timeframe}},
+     AlgorithmSpec{[counter = std::make_shared<int>(0)](ProcessingContext& ctx) {
+       ctx.outputs().make<int>(Output{"TST", "COUNTER", 0}) = (*counter)++;
+       if (*counter == nTimeslices) {
+         ctx.services().get<ControlService>().endOfStream();
+         ctx.services().get<ControlService>().readyToQuit(QuitRequest::Me);
+       }
+     }}},
+    {"processor",
+     {InputSpec{"counter", "TST", "COUNTER", 0, Lifetime::Timeframe}},
+     {OutputSpec{"TST", "PROCESSED", 0, Lifetime::Timeframe},
+      OutputSpec{"TST", "TIMESLICE", 0, Lifetime::Timeframe}},
+     AlgorithmSpec{[](ProcessingContext& ctx) {
+       auto value = ctx.inputs().get<int>("counter");
+       // Each timeslice sees its own TimingInfo, whatever the main thread
+       // is dispatching in the meanwhile.
+       auto const* dph = DataRefUtils::getHeader<DataProcessingHeader*>(ctx.inputs().get("counter"));
+       auto const& timingInfo = ctx.services().get<TimingInfo>();
+       ASSERT_ERROR(dph->startTime == timingInfo.timeslice);
+       // Within each group of four, the first timeslices take the longest.
+       std::this_thread::sleep_for(std::chrono::milliseconds(3 - value % 4));
+       ctx.services().get<o2::monitoring::Monitoring>().send(o2::monitoring::Metric{value, "concurrent-timeslice"});
+       ctx.outputs().make<int>(Output{"TST", "PROCESSED", 0}) = value;
+       ctx.outputs().make<size_t>(Output{"TST", "TIMESLICE", 0}) = timingInfo.timeslice;
+     }}},
+    {"sink",
+     {InputSpec{"processed", "TST", "PROCESSED", 0, Lifetime::Timeframe},
+      InputSpec{"timeslice", "TST", "TIMESLICE", 0, Lifetime::Timeframe}},
+     Outputs{},
+     AlgorithmSpec{adaptStateful([](CallbackService& callbacks) {
+       auto expected = std::make_shared<int>(0);
+       callbacks.set(CallbackService::Id::EndOfStream, [expected](EndOfStreamContext&) {
+         ASSERT_ERROR(*expected == nTimeslices);
+       });
+       return adaptStateless([expected](InputRecord& inputs) {
+         auto value = inputs.get<int>("processed");
+         if (value != *expected) {
+           LOG(fatal) << "Expecting " << *expected << " found " << value;
+         }
+         (*expected)++;
+         auto const* dph = DataRefUtils::getHeader<DataProcessingHeader*>(inputs.get("processed"));
+         ASSERT_ERROR(dph->startTime == inputs.get<size_t>("timeslice"));
+       });
+     })}}};
+}
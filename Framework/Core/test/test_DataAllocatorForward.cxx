@@ -0,0 +1,130 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test Framework DataAllocatorForward
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include "Framework/DataAllocator.h"
+#include "Framework/DataProcessingHeader.h"
+#include "Framework/DataRef.h"
+#include "Framework/FairMQDeviceProxy.h"
+#include "Framework/MessageContext.h"
+#include "Framework/OutputRoute.h"
+#include "Framework/OutputSpec.h"
+#include "Framework/ServiceRegistry.h"
+#include "Framework/ServiceRegistryHelpers.h"
+#include "Framework/TimingInfo.h"
+#include "Headers/DataHeader.h"
+#include "Headers/Stack.h"
+#include "MemoryResources/MemoryResources.h"
+#include <fairmq/FairMQDevice.h>
+#include <fairmq/FairMQTransportFactory.h>
+
+#include <cstring>
+#include <vector>
+
+using namespace o2::framework;
+using DataHeader = o2::header::DataHeader;
+using Stack = o2::header::Stack;
+
+namespace
+{
+// A device with the output channel of the route, without running its state machine
+class TestDevice : public FairMQDevice
+{
+ public:
+  TestDevice(std::shared_ptr<FairMQTransportFactory> transport)
+  {
+    fTransportFactory = transport;
+    fChannels["from_a_to_b"].emplace_back("from_a_to_b", "push", transport);
+  }
+};
+
+struct ForwardFixture {
+  std::shared_ptr<FairMQTransportFactory> transport = FairMQTransportFactory::CreateTransportFactory("zeromq");
+  TestDevice device{transport};
+  MessageContext context{FairMQDeviceProxy{&device}};
+  TimingInfo timingInfo{};
+  ServiceRegistry registry;
+  DataAllocator allocator;
+  FairMQMessagePtr header;
+  FairMQMessagePtr payload;
+
+  ForwardFixture()
+    : allocator{&registry, std::vector<OutputRoute>{OutputRoute{0, 1, OutputSpec{{"forwarded"}, "TST", "FORWARD", 0, Lifetime::Timeframe}, "from_a_to_b"}}}
+  {
+    registry.registerService(ServiceRegistryHelpers::handleForService<MessageContext>(&context));
+    registry.registerService(ServiceRegistryHelpers::handleForService<TimingInfo>(&timingInfo));
+
+    // the input, as received by the device
+    DataHeader dh{o2::header::DataDescription{"INPUT"}, o2::header::DataOrigin{"TST"}, 0, 1024};
+    dh.payloadSerializationMethod = o2::header::gSerializationMethodNone;
+    auto channelAlloc = o2::pmr::getTransportAllocator(transport.get());
+    header = o2::pmr::getMessage(Stack{channelAlloc, dh, DataProcessingHeader{0, 1}});
+    payload = transport->CreateMessage(1024);
+    for (size_t i = 0; i < payload->GetSize(); ++i) {
+      static_cast<char*>(payload->GetData())[i] = static_cast<char>(i);
+    }
+  }
+
+  // the parts which would be sent for the output
+  FairMQParts sent()
+  {
+    auto messages = context.getMessagesForSending();
+    BOOST_REQUIRE_EQUAL(messages.size(), 1);
+    BOOST_CHECK_EQUAL(messages[0]->channel(), "from_a_to_b");
+    return messages[0]->finalize();
+  }
+
+  void checkForwarded(FairMQParts& parts)
+  {
+    BOOST_REQUIRE_EQUAL(parts.Size(), 2);
+    auto* dh = o2::header::get<DataHeader*>(parts.At(0)->GetData());
+    BOOST_REQUIRE(dh != nullptr);
+    BOOST_CHECK(dh->dataOrigin == o2::header::DataOrigin("TST"));
+    BOOST_CHECK(dh->dataDescription == o2::header::DataDescription("FORWARD"));
+    BOOST_CHECK_EQUAL(dh->payloadSize, 1024);
+    BOOST_REQUIRE_EQUAL(parts.At(1)->GetSize(), payload->GetSize());
+    BOOST_CHECK(memcmp(parts.At(1)->GetData(), payload->GetData(), payload->GetSize()) == 0);
+  }
+};
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestForwardSharesPayload)
+{
+  ForwardFixture f;
+  DataRef ref{nullptr, static_cast<char const*>(f.header->GetData()), static_cast<char const*>(f.payload->GetData()), f.payload->GetSize(), f.payload.get()};
+  f.allocator.forward(Output{"TST", "FORWARD", 0}, ref);
+  auto parts = f.sent();
+  f.checkForwarded(parts);
+  // The output message references the buffer of the input message.
+  BOOST_CHECK_EQUAL(parts.At(1)->GetData(), f.payload->GetData());
+}
+
+BOOST_AUTO_TEST_CASE(TestForwardWithoutMessage)
+{
+  ForwardFixture f;
+  // The message owning the payload is not known, the payload is copied.
+  DataRef ref{nullptr, static_cast<char const*>(f.header->GetData()), static_cast<char const*>(f.payload->GetData()), f.payload->GetSize()};
+  f.allocator.forward(Output{"TST", "FORWARD", 0}, ref);
+  auto parts = f.sent();
+  f.checkForwarded(parts);
+  BOOST_CHECK(parts.At(1)->GetData() != f.payload->GetData());
+}
+
+BOOST_AUTO_TEST_CASE(TestForwardWithoutHeader)
+{
+  ForwardFixture f;
+  DataRef ref{nullptr, nullptr, static_cast<char const*>(f.payload->GetData()), f.payload->GetSize(), f.payload.get()};
+  BOOST_CHECK_THROW(f.allocator.forward(Output{"TST", "FORWARD", 0}, ref), o2::framework::RuntimeErrorRef);
+}
@@ -0,0 +1,90 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test Framework DataAllocatorRoutes
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include "Framework/DataAllocator.h"
+#include "Framework/OutputRoute.h"
+#include "Framework/OutputSpec.h"
+
+#include <vector>
+
+using namespace o2::framework;
+
+namespace
+{
+std::vector<OutputRoute> makeRoutes()
+{
+  return {
+    OutputRoute{0, 1, OutputSpec{{"clusters"}, "TST", "CLUSTERS", 0, Lifetime::Timeframe}, "from_a_to_b"},
+    OutputRoute{0, 1, OutputSpec{{"digits"}, ConcreteDataTypeMatcher{"TST", "DIGITS"}, Lifetime::Timeframe}, "from_a_to_b"},
+  };
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestConcreteRoutes)
+{
+  DataAllocator allocator(nullptr, makeRoutes());
+  // Concrete routes are known upfront.
+  BOOST_CHECK_EQUAL(allocator.cachedRoutes(), 1);
+  BOOST_CHECK(allocator.isAllowed(Output{"TST", "CLUSTERS", 0}));
+  BOOST_CHECK(allocator.isAllowed(Output{"TST", "CLUSTERS", 1}) == false);
+  BOOST_CHECK_EQUAL(allocator.cachedRoutes(), 1);
+  BOOST_REQUIRE_EQUAL(allocator.outputBindings().size(), 2);
+  BOOST_CHECK_EQUAL(allocator.outputBindings()[0], "clusters");
+  BOOST_CHECK_EQUAL(allocator.outputBindings()[1], "digits");
+}
+
+BOOST_AUTO_TEST_CASE(TestWildcardMemoisation)
+{
+  DataAllocator allocator(nullptr, makeRoutes());
+  // A wildcard route is memoised the first time a subSpec matches it.
+  BOOST_CHECK(allocator.isAllowed(Output{"TST", "DIGITS", 7}));
+  BOOST_CHECK_EQUAL(allocator.cachedRoutes(), 2);
+  BOOST_CHECK(allocator.isAllowed(Output{"TST", "DIGITS", 7}));
+  BOOST_CHECK_EQUAL(allocator.cachedRoutes(), 2);
+  BOOST_CHECK(allocator.isAllowed(Output{"TST", "DIGITS", 8}));
+  BOOST_CHECK_EQUAL(allocator.cachedRoutes(), 3);
+
+  // Lookups which do not match are never cached.
+  for (uint32_t subSpec = 0; subSpec < 100; ++subSpec) {
+    BOOST_CHECK(allocator.isAllowed(Output{"TST", "RAW", subSpec}) == false);
+  }
+  BOOST_CHECK_EQUAL(allocator.cachedRoutes(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(TestBoundedMemoisation)
+{
+  DataAllocator allocator(nullptr, makeRoutes());
+  // Once the cache is full, the routes are still found by scanning them.
+  for (uint32_t subSpec = 0; subSpec < 4096; ++subSpec) {
+    BOOST_CHECK(allocator.isAllowed(Output{"TST", "DIGITS", subSpec}));
+  }
+  BOOST_CHECK_LE(allocator.cachedRoutes(), 1024);
+  BOOST_CHECK(allocator.isAllowed(Output{"TST", "DIGITS", 5000}));
+  BOOST_CHECK(allocator.isAllowed(Output{"TST", "CLUSTERS", 0}));
+  BOOST_CHECK(allocator.isAllowed(Output{"TST", "CLUSTERS", 5000}) == false);
+}
+
+BOOST_AUTO_TEST_CASE(TestSharedRoutes)
+{
+  DataAllocator allocator(nullptr, makeRoutes());
+  // An allocator for a timeslice processed concurrently shares the routes.
+  DataAllocator concurrent(nullptr, allocator);
+  BOOST_CHECK(concurrent.isAllowed(Output{"TST", "DIGITS", 7}));
+  BOOST_CHECK_EQUAL(allocator.cachedRoutes(), 2);
+  BOOST_CHECK_EQUAL(&allocator.outputBindings(), &concurrent.outputBindings());
+  BOOST_CHECK_EQUAL(concurrent.outputAllocations(0), 0);
+  BOOST_CHECK_EQUAL(concurrent.outputAllocations(1), 0);
+}
@@ -43,6 +43,7 @@ BOOST_AUTO_TEST_CASE(TestDatainputDirector)
   jf << R"(      {)" << std::endl;
   jf << R"(        "table": "AOD/DUE/0",)" << std::endl;
   jf << R"(        "treename": "due",)" << std::endl;
+  jf << R"(        "columns": ["fX", "fY"],)" << std::endl;
   jf << R"delimiter(        "fileregex": "(Bres)(.*)")delimiter" << std::endl;
   jf << R"(      })" << std::endl;
   jf << R"(    ])" << std::endl;
@@ -67,6 +68,15 @@ BOOST_AUTO_TEST_CASE(TestDatainputDirector)
   BOOST_CHECK(didesc);
   BOOST_CHECK_EQUAL(didesc->getNumberInputfiles(), 2);
 
+  auto columns = didir1.getColumnNames(dh);
+  BOOST_REQUIRE_EQUAL(columns.size(), 2);
+  BOOST_CHECK_EQUAL(columns[0], "fX");
+  BOOST_CHECK_EQUAL(columns[1], "fY");
+  auto dhUno = DataHeader(DataDescription{"UNO"},
+                          DataOrigin{"AOD"},
+                          DataHeader::SubSpecificationType{0});
+  BOOST_CHECK(didir1.getColumnNames(dhUno).empty());
+
   // test initialization with "std::vector<std::string> inputFiles"
   // in this case "resfile" of the InputDataDirector in the json file must be
   // empty, otherwise files specified in the json file will be added to the
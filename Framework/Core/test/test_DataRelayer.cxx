@@ -553,6 +553,38 @@ BOOST_AUTO_TEST_CASE(TestTooMany)
   BOOST_CHECK_EQUAL(action, DataRelayer::Backpressured);
   BOOST_CHECK_NE(header2.get(), nullptr);
   BOOST_CHECK_NE(payload2.get(), nullptr);
+  BOOST_CHECK_EQUAL(relayer.getStats().backpressuredMessages, 1);
+  BOOST_CHECK_EQUAL(index.validSlots(), 1);
+}
+
+/// Test which matchers allow looking up the slots by timeslice.
+BOOST_AUTO_TEST_CASE(TestTimesliceBinding)
+{
+  using namespace o2::framework::data_matcher;
+  std::vector<InputRoute> inputs = {
+    InputRoute{InputSpec{"clusters", "TPC", "CLUSTERS"}, 0, "Fake1", 0},
+    InputRoute{o2::framework::select("tracks:TPC/TRACKS")[0], 1, "Fake2", 0},
+  };
+  for (auto& matcher : DataRelayerHelpers::createInputMatchers(inputs)) {
+    BOOST_CHECK(DataRelayerHelpers::bindsTimesliceToStartTime(matcher));
+  }
+
+  DataDescriptorMatcher noTime{
+    DataDescriptorMatcher::Op::Just,
+    OriginValueMatcher{"TPC"}};
+  BOOST_CHECK(DataRelayerHelpers::bindsTimesliceToStartTime(noTime) == false);
+
+  DataDescriptorMatcher scaledTime{
+    DataDescriptorMatcher::Op::And,
+    OriginValueMatcher{"TPC"},
+    StartTimeValueMatcher{ContextRef{0}, 10}};
+  BOOST_CHECK(DataRelayerHelpers::bindsTimesliceToStartTime(scaledTime) == false);
+
+  DataDescriptorMatcher eitherTime{
+    DataDescriptorMatcher::Op::Or,
+    OriginValueMatcher{"TPC"},
+    StartTimeValueMatcher{ContextRef{0}}};
+  BOOST_CHECK(DataRelayerHelpers::bindsTimesliceToStartTime(eitherTime) == false);
 }
 
 BOOST_AUTO_TEST_CASE(SplitParts)
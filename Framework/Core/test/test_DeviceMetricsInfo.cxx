@@ -14,8 +14,11 @@
 
 #include "Framework/DeviceMetricsInfo.h"
 #include "Framework/DeviceMetricsHelper.h"
+#include "Framework/DeviceMetricsRing.h"
 #include <boost/test/unit_test.hpp>
+#include <cstring>
 #include <iostream>
+#include <memory>
 #include <regex>
 #include <string_view>
 
@@ -223,3 +226,61 @@ BOOST_AUTO_TEST_CASE(TestHelpers)
   BOOST_CHECK_EQUAL(metric2, 0);
   BOOST_CHECK_EQUAL(metric3, 1);
 }
+
+BOOST_AUTO_TEST_CASE(TestBinaryMetrics)
+{
+  using namespace o2::framework;
+  auto ring = std::make_unique<DeviceMetricsRing>();
+  DeviceMetricsInfo info;
+
+  auto makeRecord = [](char const* label, MetricType type, uint64_t timestamp) {
+    BinaryMetricRecord record;
+    record.type = type;
+    record.timestamp = timestamp;
+    record.labelSize = strlen(label);
+    memcpy(record.label, label, record.labelSize);
+    return record;
+  };
+  auto intRecord = makeRecord("bkey", MetricType::Int, 1789372894);
+  intRecord.intValue = 12;
+  auto floatRecord = makeRecord("akey", MetricType::Float, 1789372895);
+  floatRecord.floatValue = 16.5f;
+  auto uint64Record = makeRecord("ckey", MetricType::Uint64, 1789372896);
+  uint64Record.uint64Value = 1ull << 40;
+
+  BOOST_REQUIRE(ring->push(intRecord));
+  BOOST_REQUIRE(ring->push(floatRecord));
+  BOOST_REQUIRE(ring->push(uint64Record));
+  intRecord.intValue = 13;
+  BOOST_REQUIRE(ring->push(intRecord));
+
+  auto processed = ring->drain([&info](BinaryMetricRecord const& record) {
+    BOOST_CHECK(DeviceMetricsHelper::processMetric(record, info));
+  });
+  BOOST_CHECK_EQUAL(processed, 4);
+  BOOST_CHECK_EQUAL(ring->drain([](BinaryMetricRecord const&) {}), 0);
+
+  BOOST_REQUIRE_EQUAL(info.metrics.size(), 3);
+  BOOST_CHECK_EQUAL(info.metricLabels[0].label, std::string("bkey"));
+  BOOST_CHECK_EQUAL(info.metricLabels[1].label, std::string("akey"));
+  BOOST_CHECK_EQUAL(info.metricLabels[2].label, std::string("ckey"));
+  BOOST_CHECK_EQUAL(info.intMetrics[0][0], 12);
+  BOOST_CHECK_EQUAL(info.intMetrics[0][1], 13);
+  BOOST_CHECK_EQUAL(info.metrics[0].filledMetrics, 2);
+  BOOST_CHECK_EQUAL(info.floatMetrics[0][0], 16.5f);
+  BOOST_CHECK_EQUAL(info.uint64Metrics[0][0], 1ull << 40);
+  BOOST_CHECK_EQUAL(info.timestamps[1][0], 1789372895);
+  BOOST_CHECK_EQUAL(info.max[0], 13);
+  BOOST_CHECK_EQUAL(info.min[0], 12);
+
+  // The producer must not overrun the consumer.
+  for (size_t i = 0; i < DeviceMetricsRing::CAPACITY; ++i) {
+    BOOST_REQUIRE(ring->push(intRecord));
+  }
+  BOOST_CHECK_EQUAL(ring->overflows.load(), 0);
+  BOOST_CHECK(ring->push(intRecord) == false);
+  BOOST_CHECK_EQUAL(ring->overflows.load(), 1);
+  BOOST_CHECK_EQUAL(ring->drain([](BinaryMetricRecord const&) {}), DeviceMetricsRing::CAPACITY);
+  BOOST_CHECK(ring->push(intRecord));
+  BOOST_CHECK_EQUAL(ring->overflows.load(), 1);
+}
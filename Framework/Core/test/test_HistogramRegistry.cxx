@@ -15,6 +15,7 @@
 #include "Framework/HistogramRegistry.h"
 #include <boost/test/unit_test.hpp>
 #include <iostream>
+#include <thread>
 
 using namespace o2;
 using namespace o2::framework;
@@ -129,3 +130,64 @@ BOOST_AUTO_TEST_CASE(HistogramRegistryStepTHn)
 
   registry.print();
 }
+
+BOOST_AUTO_TEST_CASE(HistogramRegistryConcurrentFill)
+{
+  std::vector<HistogramSpec> specs{
+    {"x", "x", {HistType::kTH1F, {{100, -1.0f, 1.0f}}}},                        //
+    {"xy", "xy", {HistType::kTH2D, {{20, -1.0f, 1.0f}, {20, -1.0f, 1.0f}}}},    //
+    {"xVar", "xVar", {HistType::kTH1D, {std::vector<double>{-1.0, -0.5, 0., 0.5, 1.0}}}}, //
+    {"prof", "prof", {HistType::kTProfile, {{10, -1.0f, 1.0f}}}},               //
+    {"xyz", "xyz", {HistType::kTHnF, {{10, -1., 1.}, {10, -1., 1.}, {10, -1., 1.}}}} //
+  };
+  HistogramRegistry reference{"reference", specs};
+  HistogramRegistry concurrent{"concurrent", specs};
+  concurrent.setConcurrentFill();
+  BOOST_REQUIRE(concurrent.isConcurrentFill());
+
+  const int nThreads = 4;
+  const int nFills = 10000;
+  auto value = [](int i) { return std::sin(0.37 * i) * 1.1; };
+  auto fillAll = [&value](HistogramRegistry& registry, int first, int last) {
+    for (int i = first; i < last; ++i) {
+      double x = value(i);
+      double y = value(3 * i + 1);
+      registry.fill(HIST("x"), x);
+      registry.fill(HIST("xy"), x, y, 0.5);
+      registry.fill(HIST("xVar"), x);
+      registry.fill(HIST("prof"), x, y);
+      registry.fill(HIST("xyz"), x, y, x * y);
+    }
+  };
+
+  fillAll(reference, 0, nThreads * nFills);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < nThreads; ++t) {
+    threads.emplace_back(fillAll, std::ref(concurrent), t * nFills, (t + 1) * nFills);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // nothing reaches the registry histograms before merging
+  BOOST_CHECK_EQUAL(concurrent.get<TH1>(HIST("x"))->GetEntries(), 0);
+  concurrent.mergeShards();
+
+  auto checkTH1 = [](auto ref, auto conc) {
+    BOOST_CHECK_EQUAL(ref->GetEntries(), conc->GetEntries());
+    BOOST_CHECK_CLOSE(ref->GetMean(), conc->GetMean(), 1e-6);
+    BOOST_CHECK_CLOSE(ref->GetStdDev(), conc->GetStdDev(), 1e-6);
+    for (int bin = 0; bin < ref->GetNcells(); ++bin) {
+      BOOST_CHECK_CLOSE(ref->GetBinContent(bin), conc->GetBinContent(bin), 1e-4);
+      BOOST_CHECK_CLOSE(ref->GetBinError(bin), conc->GetBinError(bin), 1e-4);
+    }
+  };
+  checkTH1(reference.get<TH1>(HIST("x")), concurrent.get<TH1>(HIST("x")));
+  checkTH1(reference.get<TH2>(HIST("xy")), concurrent.get<TH2>(HIST("xy")));
+  checkTH1(reference.get<TH1>(HIST("xVar")), concurrent.get<TH1>(HIST("xVar")));
+  checkTH1(reference.get<TProfile>(HIST("prof")), concurrent.get<TProfile>(HIST("prof")));
+  BOOST_CHECK_EQUAL(reference.get<THn>(HIST("xyz"))->GetEntries(), concurrent.get<THn>(HIST("xyz"))->GetEntries());
+
+  // merging again must not add the same content twice
+  concurrent.mergeShards();
+  BOOST_CHECK_EQUAL(reference.get<TH1>(HIST("x"))->GetEntries(), concurrent.get<TH1>(HIST("x"))->GetEntries());
+}
@@ -162,6 +162,29 @@ BOOST_AUTO_TEST_CASE(TestStreamServices)
   BOOST_CHECK_EQUAL(tt2->threadId, 2);
 }
 
+BOOST_AUTO_TEST_CASE(TestOverrideServices)
+{
+  using namespace o2::framework;
+  ServiceRegistry registry;
+
+  DummyService t0{0};
+  DummyService other{1};
+  /// We register it pretending to be on thread 0
+  registry.registerService(TypeIdHelpers::uniqueId<DummyService>(), &t0, ServiceKind::Serial, 0);
+  /// Thread 1 looked it up already, so it has its own entry
+  registry.get(TypeIdHelpers::uniqueId<DummyService>(), 1, ServiceKind::Serial);
+
+  ServiceRegistry copy{registry};
+  copy.overrideService(&other);
+  for (uint64_t tid = 0; tid < 3; ++tid) {
+    auto tt = reinterpret_cast<DummyService*>(copy.get(TypeIdHelpers::uniqueId<DummyService>(), tid, ServiceKind::Serial));
+    BOOST_CHECK_EQUAL(tt->threadId, 1);
+    // The original registry is untouched
+    auto to = reinterpret_cast<DummyService*>(registry.get(TypeIdHelpers::uniqueId<DummyService>(), tid, ServiceKind::Serial));
+    BOOST_CHECK_EQUAL(to->threadId, 0);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(TestServiceRegistryCtor)
 {
   using namespace o2::framework;
@@ -185,6 +185,34 @@ BOOST_AUTO_TEST_CASE(TestTableBuilderBulk)
   }
 }
 
+BOOST_AUTO_TEST_CASE(TestTableBuilderBulkCursor)
+{
+  using namespace o2::framework;
+  TableBuilder builder;
+  auto bulkWriter = builder.bulkCursor<TestTable>(8);
+  uint64_t x[] = {0, 10, 20, 30, 40, 50, 60, 70};
+  uint64_t y[] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+  bulkWriter(0, 4, x, y);
+  bulkWriter(0, 4, x + 4, y + 4);
+
+  auto table = builder.finalize();
+  BOOST_REQUIRE_EQUAL(table->num_columns(), 2);
+  BOOST_REQUIRE_EQUAL(table->num_rows(), 8);
+  BOOST_REQUIRE_EQUAL(table->schema()->field(0)->name(), "x");
+  BOOST_REQUIRE_EQUAL(table->schema()->field(1)->name(), "y");
+  BOOST_REQUIRE_EQUAL(table->schema()->field(0)->type()->id(), arrow::uint64()->id());
+
+  auto readBack = TestTable{table};
+  size_t i = 0;
+  for (auto& row : readBack) {
+    BOOST_CHECK_EQUAL(row.x(), i * 10);
+    BOOST_CHECK_EQUAL(row.y(), i);
+    ++i;
+  }
+  BOOST_CHECK_EQUAL(i, 8);
+}
+
 BOOST_AUTO_TEST_CASE(TestTableBuilderMore)
 {
   using namespace o2::framework;
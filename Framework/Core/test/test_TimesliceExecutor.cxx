@@ -0,0 +1,241 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test Framework TimesliceExecutor
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include "Framework/TimesliceExecutor.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace o2::framework;
+
+BOOST_AUTO_TEST_CASE(TestCommitOrder)
+{
+  std::atomic<int> notified = 0;
+  std::vector<int> committed;
+  std::vector<int> results(16, -1);
+  {
+    TimesliceExecutor executor{4, [&notified]() { notified++; }};
+    BOOST_CHECK_EQUAL(executor.threads(), 4);
+    BOOST_CHECK_EQUAL(executor.inFlight(), 0);
+
+    // The first timeslices take longer, so that they complete last.
+    for (int i = 0; i < 16; ++i) {
+      executor.dispatch(
+        [i, &results]() {
+          std::this_thread::sleep_for(std::chrono::milliseconds(16 - i));
+          results[i] = i * i;
+        },
+        [i, &results, &committed](std::exception_ptr error) {
+          BOOST_CHECK(error == nullptr);
+          BOOST_CHECK_EQUAL(results[i], i * i);
+          committed.push_back(i);
+        });
+    }
+    executor.drain();
+    BOOST_CHECK_EQUAL(executor.inFlight(), 0);
+    // Nothing in flight, we do not wait.
+    BOOST_CHECK_EQUAL(executor.complete(true), 0);
+  }
+  BOOST_REQUIRE_EQUAL(committed.size(), 16);
+  for (int i = 0; i < 16; ++i) {
+    BOOST_CHECK_EQUAL(committed[i], i);
+  }
+  // Workers notify after marking the work as done, so all the
+  // notifications are there only once the threads are stopped.
+  BOOST_CHECK_EQUAL(notified.load(), 16);
+}
+
+BOOST_AUTO_TEST_CASE(TestCompleteStopsAtRunning)
+{
+  std::promise<void> release;
+  std::promise<void> secondDone;
+  std::atomic<int> done = 0;
+  // Only the second one can be done before the first one is released.
+  TimesliceExecutor executor{2, [&done, &secondDone]() {
+                               if (++done == 1) {
+                                 secondDone.set_value();
+                               }
+                             }};
+  std::vector<int> committed;
+  executor.dispatch([released = release.get_future().share()]() { released.wait(); },
+                    [&committed](std::exception_ptr) { committed.push_back(0); });
+  executor.dispatch([]() {}, [&committed](std::exception_ptr) { committed.push_back(1); });
+  secondDone.get_future().wait();
+  // The second one cannot be committed before the first one.
+  BOOST_CHECK_EQUAL(executor.complete(), 0);
+  BOOST_CHECK(committed.empty());
+  BOOST_CHECK_EQUAL(executor.inFlight(), 2);
+  release.set_value();
+  BOOST_CHECK_GE(executor.complete(true), 1);
+  executor.drain();
+  BOOST_REQUIRE_EQUAL(committed.size(), 2);
+  BOOST_CHECK_EQUAL(committed[0], 0);
+  BOOST_CHECK_EQUAL(committed[1], 1);
+}
+
+BOOST_AUTO_TEST_CASE(TestWorkStealing)
+{
+  // All the work queued behind a blocked task is taken by the other thread.
+  std::promise<void> release;
+  std::promise<void> othersDone;
+  std::atomic<int> done = 0;
+  TimesliceExecutor executor{2, [&done, &othersDone]() {
+                               if (++done == 10) {
+                                 othersDone.set_value();
+                               }
+                             }};
+  executor.dispatch([released = release.get_future().share()]() { released.wait(); },
+                    [](std::exception_ptr) {});
+  for (int i = 0; i < 10; ++i) {
+    executor.dispatch([]() {}, [](std::exception_ptr) {});
+  }
+  othersDone.get_future().wait();
+  // Half of the work was queued to the blocked thread.
+  BOOST_CHECK_GE(executor.stolen(), 1);
+  BOOST_CHECK_EQUAL(executor.inFlight(), 11);
+  release.set_value();
+  executor.drain();
+  BOOST_CHECK_EQUAL(executor.inFlight(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestStealOldest)
+{
+  // Block the three threads, then queue two tasks to each of them.
+  std::mutex mutex;
+  std::condition_variable condition;
+  int blocked = 0;
+  std::vector<std::promise<void>> release(3);
+  std::vector<int> started;
+  TimesliceExecutor executor{3};
+  for (int i = 0; i < 3; ++i) {
+    executor.dispatch(
+      [&, released = release[i].get_future().share()]() {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          blocked++;
+        }
+        condition.notify_all();
+        released.wait();
+      },
+      [](std::exception_ptr) {});
+  }
+  {
+    // Every thread runs one of them, whichever it was queued to.
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [&blocked]() { return blocked == 3; });
+  }
+  for (int i = 3; i < 9; ++i) {
+    executor.dispatch(
+      [&, i]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        started.push_back(i);
+        condition.notify_all();
+      },
+      [](std::exception_ptr) {});
+  }
+  // The released thread runs its own queue, then steals from the others
+  // in dispatch order, whatever the queue they are in.
+  release[1].set_value();
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [&started]() { return started.size() == 6; });
+  }
+  BOOST_REQUIRE_EQUAL(started.size(), 6);
+  int own = started[0];
+  BOOST_CHECK_EQUAL(started[1], own + 3);
+  std::vector<int> stolen;
+  for (int i = 3; i < 9; ++i) {
+    if (i != own && i != own + 3) {
+      stolen.push_back(i);
+    }
+  }
+  BOOST_CHECK_EQUAL_COLLECTIONS(started.begin() + 2, started.end(), stolen.begin(), stolen.end());
+  BOOST_CHECK_EQUAL(executor.stolen(), 4);
+  release[0].set_value();
+  release[2].set_value();
+  executor.drain();
+  BOOST_CHECK_EQUAL(executor.inFlight(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestDiscardOnDestruction)
+{
+  // Without drain(), the running work is finished, but nothing is
+  // committed and the work which was not started is not run.
+  std::promise<void> release;
+  std::promise<void> running;
+  std::atomic<int> run = 0;
+  int committed = 0;
+  std::thread releaser;
+  {
+    TimesliceExecutor executor{1};
+    executor.dispatch(
+      [&run, &running, released = release.get_future().share()]() {
+        run++;
+        running.set_value();
+        released.wait();
+      },
+      [&committed](std::exception_ptr) { committed++; });
+    for (int i = 0; i < 4; ++i) {
+      executor.dispatch([&run]() { run++; }, [&committed](std::exception_ptr) { committed++; });
+    }
+    running.get_future().wait();
+    // Released only once the destructor is waiting for the thread.
+    releaser = std::thread([&release]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      release.set_value();
+    });
+  }
+  releaser.join();
+  BOOST_CHECK_EQUAL(run.load(), 1);
+  BOOST_CHECK_EQUAL(committed, 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestErrors)
+{
+  TimesliceExecutor executor{3};
+  std::vector<std::string> errors;
+  for (int i = 0; i < 6; ++i) {
+    executor.dispatch(
+      [i]() {
+        if (i % 2) {
+          throw std::runtime_error("timeslice " + std::to_string(i));
+        }
+      },
+      [&errors](std::exception_ptr error) {
+        if (error == nullptr) {
+          errors.emplace_back();
+          return;
+        }
+        try {
+          std::rethrow_exception(error);
+        } catch (std::runtime_error& e) {
+          errors.emplace_back(e.what());
+        }
+      });
+  }
+  executor.drain();
+  BOOST_REQUIRE_EQUAL(errors.size(), 6);
+  BOOST_CHECK_EQUAL(errors[0], "");
+  BOOST_CHECK_EQUAL(errors[1], "timeslice 1");
+  BOOST_CHECK_EQUAL(errors[4], "");
+  BOOST_CHECK_EQUAL(errors[5], "timeslice 5");
+}
@@ -99,3 +99,101 @@ BOOST_AUTO_TEST_CASE(TestLRUReplacement)
     BOOST_CHECK(action == TimesliceIndex::ActionTaken::Wait);
   }
 }
+
+BOOST_AUTO_TEST_CASE(TestLookup)
+{
+  using namespace o2::framework;
+  TimesliceIndex index{2};
+  index.resize(6);
+  std::vector<TimesliceSlot> slots;
+
+  BOOST_CHECK_EQUAL(index.validSlots(), 0);
+  BOOST_CHECK_EQUAL(index.findInvalidSlot({10}).index, 0);
+  BOOST_CHECK_EQUAL(index.findInvalidSlot({11}).index, 1);
+  index.associate(TimesliceId{10}, TimesliceSlot{0});
+  index.associate(TimesliceId{12}, TimesliceSlot{2});
+  index.associate(TimesliceId{10}, TimesliceSlot{4});
+  index.associate(TimesliceId{11}, TimesliceSlot{1});
+  BOOST_CHECK_EQUAL(index.validSlots(), 4);
+  BOOST_CHECK_EQUAL(index.findInvalidSlot({10}).index, TimesliceSlot::INVALID);
+  BOOST_CHECK_EQUAL(index.findInvalidSlot({11}).index, 3);
+
+  index.getSlotsForTimeslice({10}, slots);
+  BOOST_REQUIRE_EQUAL(slots.size(), 2);
+  BOOST_CHECK_EQUAL(slots[0].index, 0);
+  BOOST_CHECK_EQUAL(slots[1].index, 4);
+  index.getSlotsForTimeslice({13}, slots);
+  BOOST_CHECK(slots.empty());
+
+  index.associate(TimesliceId{14}, TimesliceSlot{4});
+  index.getSlotsForTimeslice({10}, slots);
+  BOOST_REQUIRE_EQUAL(slots.size(), 1);
+  BOOST_CHECK_EQUAL(slots[0].index, 0);
+
+  index.markAsInvalid(TimesliceSlot{2});
+  BOOST_CHECK_EQUAL(index.validSlots(), 3);
+  BOOST_CHECK_EQUAL(index.findInvalidSlot({10}).index, 2);
+  index.getSlotsForTimeslice({12}, slots);
+  BOOST_CHECK(slots.empty());
+
+  index.getValidSlots(slots);
+  BOOST_REQUIRE_EQUAL(slots.size(), 3);
+  BOOST_CHECK_EQUAL(slots[0].index, 0);
+  BOOST_CHECK_EQUAL(slots[1].index, 1);
+  BOOST_CHECK_EQUAL(slots[2].index, 4);
+
+  // Modifying the variables in place requires a refresh
+  index.getVariablesForSlot(TimesliceSlot{2}).put({0, uint64_t{16}});
+  index.getVariablesForSlot(TimesliceSlot{2}).commit();
+  index.refresh(TimesliceSlot{2});
+  BOOST_CHECK_EQUAL(index.validSlots(), 4);
+  index.getSlotsForTimeslice({16}, slots);
+  BOOST_REQUIRE_EQUAL(slots.size(), 1);
+  BOOST_CHECK_EQUAL(slots[0].index, 2);
+}
+
+BOOST_AUTO_TEST_CASE(TestLRUReplacementWithLanes)
+{
+  using namespace o2::framework;
+  TimesliceIndex index{2};
+  index.resize(6);
+  data_matcher::VariableContext context;
+
+  // Fill the even lane, leaving the odd one empty
+  for (size_t timeslice : {20, 10, 30}) {
+    context.put({0, uint64_t{timeslice}});
+    context.commit();
+    auto [action, slot] = index.replaceLRUWith(context, {timeslice});
+    BOOST_CHECK(action == TimesliceIndex::ActionTaken::ReplaceUnused);
+    BOOST_CHECK_EQUAL(slot.index % 2, 0);
+  }
+  BOOST_CHECK_EQUAL(index.validSlots(), 3);
+  {
+    context.put({0, uint64_t{40}});
+    context.commit();
+    auto [action, slot] = index.replaceLRUWith(context, {40});
+    BOOST_CHECK(action == TimesliceIndex::ActionTaken::Wait);
+    BOOST_CHECK_EQUAL(slot.index, TimesliceSlot::INVALID);
+  }
+  {
+    context.put({0, uint64_t{41}});
+    context.commit();
+    auto [action, slot] = index.replaceLRUWith(context, {41});
+    BOOST_CHECK(action == TimesliceIndex::ActionTaken::ReplaceUnused);
+    BOOST_CHECK_EQUAL(slot.index, 1);
+  }
+  // Once the oldest slot of the lane is freed, it is the one reused, even
+  // after many reassignments of the others.
+  for (int i = 0; i < 100; ++i) {
+    index.associate(TimesliceId{uint64_t(100 + i)}, TimesliceSlot{0});
+  }
+  index.markAsInvalid(TimesliceSlot{2});
+  {
+    context.put({0, uint64_t{50}});
+    context.commit();
+    auto [action, slot] = index.replaceLRUWith(context, {50});
+    BOOST_CHECK(action == TimesliceIndex::ActionTaken::ReplaceUnused);
+    BOOST_CHECK_EQUAL(slot.index, 2);
+  }
+  BOOST_CHECK_EQUAL(index.validSlots(), 4);
+}
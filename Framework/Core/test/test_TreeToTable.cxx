@@ -22,8 +22,12 @@
 
 #include <TTree.h>
 #include <TRandom.h>
+#include <TROOT.h>
+#include <TTreeCacheUnzip.h>
 #include <arrow/table.h>
 
+#include <thread>
+
 using namespace o2::framework;
 
 BOOST_AUTO_TEST_CASE(TreeToTableConversion)
@@ -158,6 +162,87 @@ BOOST_AUTO_TEST_CASE(TreeToTableConversion)
   f2->Close();
 }
 
+namespace
+{
+std::shared_ptr<arrow::Table> readProjected(char const* filename, int64_t treeCacheSize)
+{
+  std::unique_ptr<TFile> f{TFile::Open(filename, "READ")};
+  auto* tree = static_cast<TTree*>(f->Get("proj"));
+  TreeToTable tr2ta;
+  tr2ta.setTreeCacheSize(treeCacheSize);
+  tr2ta.addAllColumns(tree, {"pz", "ev"});
+  tr2ta.fill(tree);
+  return tr2ta.finalize();
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TreeToTableProjection)
+{
+  Int_t ndp = 10000;
+  {
+    TFile f("tree2table_projection.root", "RECREATE");
+    TTree t("proj", "a tree with more branches than needed");
+    Float_t px, py, pz;
+    Int_t ev;
+    t.Branch("px", &px, "px/F");
+    t.Branch("py", &py, "py/F");
+    t.Branch("pz", &pz, "pz/F");
+    t.Branch("ev", &ev, "ev/I");
+    t.SetAutoFlush(1000); // several clusters and baskets to go through the cache
+    for (int i = 0; i < ndp; i++) {
+      px = i * 0.5f;
+      py = i * 0.25f;
+      pz = px * px + py * py;
+      ev = i;
+      t.Fill();
+    }
+    t.Write();
+  }
+
+  auto check = [ndp](std::shared_ptr<arrow::Table> const& table) {
+    BOOST_REQUIRE_EQUAL(table->Validate().ok(), true);
+    BOOST_REQUIRE_EQUAL(table->num_rows(), ndp);
+    BOOST_REQUIRE_EQUAL(table->num_columns(), 2);
+    BOOST_CHECK_EQUAL(table->schema()->field(0)->name(), "pz");
+    BOOST_CHECK_EQUAL(table->schema()->field(1)->name(), "ev");
+    auto pz = std::static_pointer_cast<arrow::FloatArray>(table->column(0)->chunk(0));
+    auto ev = std::static_pointer_cast<arrow::Int32Array>(table->column(1)->chunk(0));
+    for (int i = 0; i < ndp; i++) {
+      BOOST_REQUIRE_EQUAL(ev->Value(i), i);
+      float px = i * 0.5f;
+      float py = i * 0.25f;
+      BOOST_REQUIRE_EQUAL(pz->Value(i), px * px + py * py);
+    }
+  };
+
+  // without and with the branch cache
+  check(readProjected("tree2table_projection.root", 0));
+  check(readProjected("tree2table_projection.root", 10 * 1024 * 1024));
+
+  // as the AOD reader does with --aod-reader-threads and --aod-reader-prefetch:
+  // the baskets are unzipped on the IMT pool and tables are filled by
+  // several threads at the same time
+  ROOT::EnableThreadSafety();
+#ifdef R__USE_IMT
+  ROOT::EnableImplicitMT(2);
+  TTreeCacheUnzip::SetParallelUnzip(TTreeCacheUnzip::kEnable);
+#endif
+  std::vector<std::shared_ptr<arrow::Table>> tables(4);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < tables.size(); i++) {
+    threads.emplace_back([&tables, i]() { tables[i] = readProjected("tree2table_projection.root", 10 * 1024 * 1024); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto& table : tables) {
+    check(table);
+  }
+#ifdef R__USE_IMT
+  ROOT::DisableImplicitMT();
+#endif
+}
+
 namespace o2::aod
 {
 DECLARE_SOA_STORE();
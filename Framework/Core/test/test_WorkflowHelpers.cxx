@@ -24,7 +24,11 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/test/tools/detail/per_element_manip.hpp>
 #include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <memory>
+#include <fmt/format.h>
+#include <unistd.h>
 
 using namespace o2::framework;
 
@@ -456,6 +460,82 @@ BOOST_AUTO_TEST_CASE(TestGraphConstruction)
   }
 }
 
+BOOST_AUTO_TEST_CASE(TestGraphConstructionCache)
+{
+  WorkflowSpec workflow{
+    {"A",
+     Inputs{},
+     Outputs{
+       OutputSpec{"TST", "A"}}},
+    timePipeline({
+                   "B",
+                   Inputs{InputSpec{"b", "TST", "A"}},
+                   Outputs{OutputSpec{"TST", "B"}},
+                 },
+                 3),
+    timePipeline({"C", Inputs{InputSpec{"c", "TST", "B"}}}, 2)};
+
+  auto context = makeEmptyConfigContext();
+  WorkflowHelpers::injectServiceDevices(workflow, *context);
+
+  std::vector<DeviceConnectionEdge> expectedEdges;
+  std::vector<LogicalForwardInfo> expectedForwards;
+  std::vector<OutputSpec> expectedOutputs;
+  WorkflowHelpers::constructGraph(workflow, expectedEdges, expectedOutputs, expectedForwards);
+
+  char cacheDir[] = "/tmp/dpl-topology-cache-XXXXXX";
+  BOOST_REQUIRE(mkdtemp(cacheDir) != nullptr);
+  auto cacheFile = fmt::format("{}/dpl-topology-{:016x}.bin", cacheDir, WorkflowHelpers::topologyHash(workflow));
+
+  // The first time we compute and store, the second we reuse. The third
+  // time the cache refers to a non existing consumer, so it is recomputed.
+  for (int pass = 0; pass < 3; ++pass) {
+    if (pass == 2) {
+      std::ofstream corrupted(cacheFile, std::ios::binary | std::ios::trunc);
+      uint64_t const content[] = {1, 1, 0, 1000, 0, 0, 0, 0, 0, 0, 0};
+      corrupted.write(reinterpret_cast<char const*>(content), sizeof(content));
+    }
+    BOOST_TEST_CONTEXT("with pass: " << pass)
+    {
+      std::vector<DeviceConnectionEdge> logicalEdges;
+      std::vector<LogicalForwardInfo> availableForwardsInfo;
+      std::vector<OutputSpec> outputs;
+      WorkflowHelpers::constructGraphCached(workflow, logicalEdges, outputs, availableForwardsInfo, cacheDir);
+      BOOST_CHECK(access(cacheFile.c_str(), R_OK) == 0);
+      BOOST_REQUIRE_EQUAL(logicalEdges.size(), expectedEdges.size());
+      for (size_t i = 0; i < logicalEdges.size(); ++i) {
+        BOOST_CHECK_EQUAL(logicalEdges[i].producer, expectedEdges[i].producer);
+        BOOST_CHECK_EQUAL(logicalEdges[i].consumer, expectedEdges[i].consumer);
+        BOOST_CHECK_EQUAL(logicalEdges[i].timeIndex, expectedEdges[i].timeIndex);
+        BOOST_CHECK_EQUAL(logicalEdges[i].producerTimeIndex, expectedEdges[i].producerTimeIndex);
+        BOOST_CHECK_EQUAL(logicalEdges[i].outputGlobalIndex, expectedEdges[i].outputGlobalIndex);
+        BOOST_CHECK_EQUAL(logicalEdges[i].consumerInputIndex, expectedEdges[i].consumerInputIndex);
+        BOOST_CHECK_EQUAL(logicalEdges[i].isForward, expectedEdges[i].isForward);
+      }
+      BOOST_CHECK_EQUAL(availableForwardsInfo.size(), expectedForwards.size());
+      BOOST_REQUIRE_EQUAL(outputs.size(), expectedOutputs.size());
+      for (size_t i = 0; i < outputs.size(); ++i) {
+        BOOST_CHECK_EQUAL(DataSpecUtils::describe(outputs[i]), DataSpecUtils::describe(expectedOutputs[i]));
+      }
+    }
+  }
+
+  // A different topology must not pick up the cached one.
+  auto otherWorkflow = workflow;
+  otherWorkflow[0].outputs.emplace_back(OutputSpec{"TST", "A2"});
+  BOOST_CHECK_NE(WorkflowHelpers::topologyHash(otherWorkflow), WorkflowHelpers::topologyHash(workflow));
+  otherWorkflow = workflow;
+  otherWorkflow[1].outputs.push_back(otherWorkflow[0].outputs.back());
+  otherWorkflow[0].outputs.pop_back();
+  BOOST_CHECK_NE(WorkflowHelpers::topologyHash(otherWorkflow), WorkflowHelpers::topologyHash(workflow));
+  otherWorkflow = workflow;
+  otherWorkflow[2].maxInputTimeslices = 4;
+  BOOST_CHECK_NE(WorkflowHelpers::topologyHash(otherWorkflow), WorkflowHelpers::topologyHash(workflow));
+
+  std::remove(cacheFile.c_str());
+  rmdir(cacheDir);
+}
+
 // This is to test a workflow where the input is not of type Timeframe and
 // therefore requires a dangling channel.
 // The topology is
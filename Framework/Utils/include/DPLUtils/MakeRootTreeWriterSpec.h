@@ -22,6 +22,8 @@
 #include "Framework/DataProcessorSpec.h"
 #include "Framework/CallbackService.h"
 #include "Framework/ControlService.h"
+#include "Framework/Monitoring.h"
+#include <TROOT.h>
 #include <algorithm>
 #include <vector>
 #include <string>
@@ -68,6 +70,8 @@ namespace framework
 ///     --nevents
 ///     --autosave
 ///     --terminate
+///     --async-queue
+///     --imt-threads
 ///
 /// \par
 /// In addition to that, a custom option can be added for every branch to configure the
@@ -81,6 +85,15 @@ namespace framework
 /// coming after (not necessarilly immidiately) the number or events. The process will
 /// signal to the DPL that it is ready for termination.
 ///
+/// \par Asynchronous writing:
+/// With a non-zero \c --async-queue, filling of the tree, including compression of the
+/// baskets, and autosaving are done on a background thread, see RootTreeWriter::setAsync.
+/// At most the given number of input sets are pending, after that the processing blocks.
+/// The number of pending input sets and the accumulated time the processing was blocked
+/// are published as metrics \c <process>/pending_fills and \c <process>/blocked_time_us.
+/// \c --imt-threads enables ROOT implicit multithreading, which allows to compress the
+/// baskets of the branches in parallel.
+///
 /// \par Termination policy:
 /// The configurable termination policy specifies what to signal to the DPL when the event
 /// count is reached. Currently option 'process' terminates only the process and 'workflow'
@@ -353,6 +366,9 @@ class MakeRootTreeWriterSpec
       Preprocessor preprocessor;
       // the total number of served branches on the n inputs
       size_t nofBranches;
+      // metric names for the asynchronous writing
+      std::string pendingMetric;
+      std::string blockedMetric;
     };
     auto processAttributes = std::make_shared<ProcessAttributes>();
     processAttributes->writer = mWriter;
@@ -366,6 +382,8 @@ class MakeRootTreeWriterSpec
       processAttributes->activeInputs.emplace(input.binding);
     }
     processAttributes->nofBranches = mNofBranches;
+    processAttributes->pendingMetric = mProcessName + "/pending_fills";
+    processAttributes->blockedMetric = mProcessName + "/blocked_time_us";
 
     // the init function is returned to the DPL in order to init the process
     auto initFct = [processAttributes, TerminationPolicyMap = TerminationPolicyMap](InitContext& ic) {
@@ -403,7 +421,19 @@ class MakeRootTreeWriterSpec
         }
         filename = outdir + filename;
       }
+      auto imtThreads = ic.options().get<int>("imt-threads");
+      if (imtThreads > 0) {
+#ifdef R__USE_IMT
+        ROOT::EnableImplicitMT(imtThreads);
+#else
+        LOG(warning) << "ROOT is built without IMT support, baskets are compressed sequentially";
+#endif
+      }
       processAttributes->writer->init(filename.c_str(), treename.c_str(), treetitle.c_str());
+      auto asyncQueue = ic.options().get<int>("async-queue");
+      if (asyncQueue > 0) {
+        processAttributes->writer->setAsync(asyncQueue);
+      }
       // the callback to be set as hook at stop of processing for the framework
       auto finishWriting = [processAttributes]() {
         processAttributes->writer->close();
@@ -470,6 +500,13 @@ class MakeRootTreeWriterSpec
         if (checkProcessing(pc.inputs())) {
           (*writer)(pc.inputs());
           counter = counter + 1;
+          if (writer->isAsync()) {
+            using namespace o2::monitoring;
+            auto stats = writer->getAsyncStats();
+            auto& monitoring = pc.services().get<Monitoring>();
+            monitoring.send(Metric{(uint64_t)stats.pending, processAttributes->pendingMetric}.addTag(tags::Key::Subsystem, tags::Value::DPL));
+            monitoring.send(Metric{(uint64_t)stats.blockedTime.count(), processAttributes->blockedMetric}.addTag(tags::Key::Subsystem, tags::Value::DPL));
+          }
         }
 
         if ((nEvents >= 0 && counter == nEvents) || checkReady(pc.inputs())) {
@@ -492,6 +529,8 @@ class MakeRootTreeWriterSpec
       {"nevents", VariantType::Int, mDefaultNofEvents, {"Number of events to execute"}},
       {"autosave", VariantType::Int, mDefaultAutoSave, {"Autosave after number of events"}},
       {"terminate", VariantType::String, mDefaultTerminationPolicy.c_str(), {"Terminate the 'process' or 'workflow'"}},
+      {"async-queue", VariantType::Int, 0, {"Fill the tree on a background thread with at most this many pending events, 0 to fill synchronously"}},
+      {"imt-threads", VariantType::Int, 0, {"Number of threads for ROOT implicit multithreading, 0 to disable"}},
     };
     for (size_t branchIndex = 0; branchIndex < mBranchNameOptions.size(); branchIndex++) {
       // adding option definitions for those ones defined in the branch definition
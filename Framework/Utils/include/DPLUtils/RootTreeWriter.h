@@ -20,10 +20,12 @@
 #include "Framework/InputRecord.h"
 #include "Framework/DataRef.h"
 #include "Framework/Logger.h"
+#include "Headers/Stack.h"
 #include <TFile.h>
 #include <TTree.h>
 #include <TBranch.h>
 #include <TClass.h>
+#include <TROOT.h>
 #include <vector>
 #include <functional>
 #include <string>
@@ -35,6 +37,12 @@
 #include <utility>    // std::forward
 #include <algorithm>  // std::generate
 #include <variant>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <exception>
 
 namespace o2
 {
@@ -117,6 +125,14 @@ struct can_assign<
 /// as a \c std::vector<char>, this ensures separation on event basis as well as having binary
 /// data in parallel to ROOT objects in the same file, e.g. a binary data format from the
 /// reconstruction in parallel to MC labels.
+///
+/// \par Asynchronous filling:
+/// With \ref setAsync, the objects are extracted from the input on the calling thread,
+/// while filling of the branches, including basket compression, and autosaving are
+/// done by a background thread. Extracted objects are owned by the pending fill, so
+/// the input can be released as soon as the functor returns. Custom fill and spectator
+/// callbacks of the branch definitions are invoked on the background thread. The queue
+/// of pending fills is bounded, the calling thread blocks if the queue is full.
 class RootTreeWriter
 {
  public:
@@ -131,6 +147,16 @@ class RootTreeWriter
   // writing of tree and closing of file need to be implemented, but the pointers
   // remain owned by the tool
   using CustomClose = std::function<void(TFile* file, TTree* tree)>;
+  // a deferred fill of a branch, owning the object to be written
+  using FillJob = std::function<void()>;
+
+  /// Statistics of the asynchronous filling
+  struct AsyncStats {
+    /// number of input sets waiting to be filled
+    size_t pending = 0;
+    /// total time the calling thread was blocked because the queue was full
+    std::chrono::microseconds blockedTime{0};
+  };
 
   /// DefaultKeyExtractor maps a data type used as key in the branch definition
   /// to the default internal key type std::string
@@ -338,9 +364,44 @@ class RootTreeWriter
     if (!mTree || !mFile || mFile->IsZombie()) {
       throw std::runtime_error("Writer is invalid state, probably closed previously");
     }
-    // execute tree structure handlers and fill the individual branches
-    mTreeStructure->exec(std::forward<ContextType>(context), mBranchSpecs);
-    // Note: number of entries will be set when closing the writer
+    if (!mAsync) {
+      // execute tree structure handlers and fill the individual branches
+      mTreeStructure->exec(std::forward<ContextType>(context), mBranchSpecs, nullptr);
+      // Note: number of entries will be set when closing the writer
+      return;
+    }
+    mAsync->rethrowError();
+    // extract the objects now, while the input is available, the branches
+    // are filled by the background thread
+    std::vector<FillJob> jobs;
+    mTreeStructure->exec(std::forward<ContextType>(context), mBranchSpecs, &jobs);
+    mAsync->push(std::move(jobs));
+  }
+
+  /// Fill the tree on a background thread.
+  /// @param queueDepth  maximum number of input sets waiting to be filled,
+  ///                    0 switches back to synchronous filling
+  ///
+  /// Pending fills are completed before switching.
+  void setAsync(size_t queueDepth)
+  {
+    mAsync.reset();
+    if (queueDepth > 0) {
+      // the background thread fills and autosaves while the calling thread
+      // extracts and deserializes objects
+      ROOT::EnableThreadSafety();
+      mAsync = std::make_unique<AsyncFiller>(queueDepth);
+    }
+  }
+
+  bool isAsync() const
+  {
+    return mAsync != nullptr;
+  }
+
+  AsyncStats getAsyncStats() const
+  {
+    return mAsync ? mAsync->stats() : AsyncStats{};
   }
 
   /// write the tree and close the file
@@ -348,6 +409,14 @@ class RootTreeWriter
   void close()
   {
     mIsClosed = true;
+    if (mAsync) {
+      // complete all pending fills before writing the tree
+      mAsync->stop();
+      if (mAsync->hasError()) {
+        LOG(error) << "Filling of tree " << (mTree ? mTree->GetName() : "") << " failed, output is incomplete";
+      }
+      mAsync.reset();
+    }
     if (!mFile) {
       return;
     }
@@ -371,11 +440,23 @@ class RootTreeWriter
     if (mIsClosed || !mFile) {
       return;
     }
+    if (mAsync) {
+      // done in sequence with the pending fills
+      mAsync->push({[this]() { doAutoSave(); }});
+      return;
+    }
+    doAutoSave();
+  }
+
+ private:
+  void doAutoSave()
+  {
     mTree->SetEntries();
     LOG(info) << "Autosaving " << mTree->GetName() << " at entry " << mTree->GetEntries();
     mTree->AutoSave("overwrite");
   }
 
+ public:
   bool isClosed() const
   {
     return mIsClosed;
@@ -430,6 +511,118 @@ class RootTreeWriter
 
   using InputContext = InputRecord;
 
+  /// A DataRef which stays valid after the input has been released, for the callbacks of
+  /// deferred fills. Only the header stack is kept, the payload is not available anymore.
+  struct DetachedRef {
+    std::vector<char> headerStack;
+    DataRef ref;
+    DetachedRef(DataRef const& source)
+      : headerStack(source.header, source.header + (source.header ? o2::header::Stack::headerStackSize(reinterpret_cast<std::byte const*>(source.header)) : 0)),
+        ref{source.spec, source.header ? headerStack.data() : nullptr, nullptr, 0, nullptr}
+    {
+    }
+  };
+
+  /// Bounded queue of deferred fills, processed in order by a background thread.
+  /// Each entry holds the fills of one input set.
+  class AsyncFiller
+  {
+   public:
+    AsyncFiller(size_t depth) : mDepth(depth), mWorker([this]() { run(); }) {}
+    ~AsyncFiller() { stop(); }
+
+    /// queue the fills of one input set, blocks while the queue is full
+    void push(std::vector<FillJob>&& jobs)
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      if (mQueue.size() >= mDepth) {
+        auto start = std::chrono::steady_clock::now();
+        mNotFull.wait(lock, [this]() { return mQueue.size() < mDepth; });
+        mBlockedTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+      }
+      mQueue.emplace_back(std::move(jobs));
+      lock.unlock();
+      mNotEmpty.notify_one();
+    }
+
+    /// complete the pending fills and terminate the background thread
+    void stop()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+      }
+      mNotEmpty.notify_one();
+      if (mWorker.joinable()) {
+        mWorker.join();
+      }
+    }
+
+    AsyncStats stats() const
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      return AsyncStats{mQueue.size(), mBlockedTime};
+    }
+
+    bool hasError() const
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      return mError != nullptr;
+    }
+
+    /// rethrow in the calling thread an exception raised by one of the fills
+    void rethrowError()
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      if (mError) {
+        std::rethrow_exception(mError);
+      }
+    }
+
+   private:
+    void run()
+    {
+      while (true) {
+        std::vector<FillJob> jobs;
+        bool failed = false;
+        {
+          std::unique_lock<std::mutex> lock(mMutex);
+          mNotEmpty.wait(lock, [this]() { return mStop || !mQueue.empty(); });
+          if (mQueue.empty()) {
+            return;
+          }
+          jobs = std::move(mQueue.front());
+          mQueue.pop_front();
+          failed = mError != nullptr;
+        }
+        mNotFull.notify_one();
+        if (failed) {
+          // the output is broken anyhow, just release the objects
+          continue;
+        }
+        try {
+          for (auto& job : jobs) {
+            job();
+          }
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(mMutex);
+          mError = std::current_exception();
+        }
+      }
+    }
+
+    size_t mDepth;
+    mutable std::mutex mMutex;
+    std::condition_variable mNotEmpty;
+    std::condition_variable mNotFull;
+    std::deque<std::vector<FillJob>> mQueue;
+    std::chrono::microseconds mBlockedTime{0};
+    std::exception_ptr mError;
+    bool mStop = false;
+    // must come last, the thread uses all other members
+    std::thread mWorker;
+  };
+
   /// polymorphic interface for the mixin stack of branch type descriptions
   /// it implements the entry point for processing through exec method
   class TreeStructureInterface
@@ -446,7 +639,9 @@ class RootTreeWriter
     /// enters at the outermost element and recurses to the base elements
     /// Read the configured inputs from the input context, select the output branch
     /// and write the object
-    virtual void exec(InputContext&, std::vector<BranchSpec>&) {}
+    /// If the list of deferred jobs is provided, the objects are extracted and the filling
+    /// of the branches is added to the list instead of being done immediately
+    virtual void exec(InputContext&, std::vector<BranchSpec>&, std::vector<FillJob>*) {}
     /// get the size of the branch structure, i.e. the number of registered branch
     /// definitions
     virtual size_t size() const { return STAGE; }
@@ -454,7 +649,7 @@ class RootTreeWriter
     // a dummy method called in the recursive processing
     void setupInstance(std::vector<BranchSpec>&, TTree*) {}
     // a dummy method called in the recursive processing
-    void process(InputContext&, std::vector<BranchSpec>&) {}
+    void process(InputContext&, std::vector<BranchSpec>&, std::vector<FillJob>*) {}
   };
 
   template <typename T = char>
@@ -547,9 +742,9 @@ class RootTreeWriter
 
     // this is the polymorphic entry point for processing of branch specs
     // recursive processing starting from the highest instance
-    void exec(InputContext& context, std::vector<BranchSpec>& specs) override
+    void exec(InputContext& context, std::vector<BranchSpec>& specs, std::vector<FillJob>* deferred) override
     {
-      process(context, specs);
+      process(context, specs, deferred);
     }
     size_t size() const override { return STAGE; }
 
@@ -635,16 +830,31 @@ class RootTreeWriter
       return false;
     }
 
+    /// run the fill immediately or, if the list of deferred jobs is provided, add it to the list
+    /// The fill functor must own the object to be written in the latter case.
+    template <typename F>
+    static void dispatch(std::vector<FillJob>* deferred, DataRef const& ref, F&& fill)
+    {
+      if (deferred == nullptr) {
+        fill(ref);
+        return;
+      }
+      auto detached = std::make_shared<DetachedRef>(ref);
+      deferred->emplace_back([detached, fill = std::forward<F>(fill)]() mutable { fill(detached->ref); });
+    }
+
     // specialization for trivial structs or serialized objects without a TClass interface
     // the extracted object is copied to store variable
     template <typename S, typename std::enable_if_t<std::is_same<S, MessageableTypeSpecialization>::value, int> = 0>
-    void fillData(InputContext& context, DataRef const& ref, TBranch* branch, size_t branchIdx)
+    void fillData(InputContext& context, DataRef const& ref, TBranch* branch, size_t branchIdx, std::vector<FillJob>* deferred)
     {
       auto data = context.get<value_type>(ref);
-      if (!runCallback(branch, data, ref)) {
-        mStore[branchIdx] = data;
-        branch->Fill();
-      }
+      dispatch(deferred, ref, [this, data, branch, branchIdx](DataRef const& ref) {
+        if (!runCallback(branch, data, ref)) {
+          mStore[branchIdx] = data;
+          branch->Fill();
+        }
+      });
     }
 
     // specialization for non-messageable types with ROOT dictionary
@@ -652,33 +862,47 @@ class RootTreeWriter
     // in order to directly use the pointer to extracted object
     // store is a pointer to object
     template <typename S, typename std::enable_if_t<std::is_same<S, ROOTTypeSpecialization>::value, int> = 0>
-    void fillData(InputContext& context, DataRef const& ref, TBranch* branch, size_t branchIdx)
+    void fillData(InputContext& context, DataRef const& ref, TBranch* branch, size_t branchIdx, std::vector<FillJob>* deferred)
     {
-      auto data = context.get<typename std::add_pointer<value_type>::type>(ref);
-      if (!runCallback(branch, *data, ref)) {
-        // this is ugly but necessary because of the TTree API does not allow a const
-        // object as input. Have to rely on that ROOT treats the object as const
-        mStore[branchIdx] = const_cast<value_type*>(data.get());
-        branch->Fill();
-      }
+      // the deserialized object is owned by the fill
+      std::shared_ptr<value_type const> data = context.get<typename std::add_pointer<value_type>::type>(ref);
+      dispatch(deferred, ref, [this, data, branch, branchIdx](DataRef const& ref) {
+        if (!runCallback(branch, *data, ref)) {
+          // this is ugly but necessary because of the TTree API does not allow a const
+          // object as input. Have to rely on that ROOT treats the object as const
+          mStore[branchIdx] = const_cast<value_type*>(data.get());
+          branch->Fill();
+        }
+      });
     }
 
     // specialization for binary buffers using const char*
     // this writes both the data branch and a size branch
     template <typename S, typename std::enable_if_t<std::is_same<S, BinaryBranchSpecialization>::value, int> = 0>
-    void fillData(InputContext& context, DataRef const& ref, TBranch* branch, size_t branchIdx)
+    void fillData(InputContext& context, DataRef const& ref, TBranch* branch, size_t branchIdx, std::vector<FillJob>* deferred)
     {
       auto data = context.get<gsl::span<char>>(ref);
-      std::get<2>(mStore.at(branchIdx)) = data.size();
-      std::get<1>(mStore.at(branchIdx))->Fill();
-      std::get<0>(mStore.at(branchIdx)).resize(data.size());
-      memcpy(std::get<0>(mStore.at(branchIdx)).data(), data.data(), data.size());
-      branch->Fill();
+      if (deferred == nullptr) {
+        std::get<2>(mStore.at(branchIdx)) = data.size();
+        std::get<1>(mStore.at(branchIdx))->Fill();
+        std::get<0>(mStore.at(branchIdx)).resize(data.size());
+        memcpy(std::get<0>(mStore.at(branchIdx)).data(), data.data(), data.size());
+        branch->Fill();
+        return;
+      }
+      // the buffer is copied anyhow, do it now so that the input can be released
+      auto buffer = std::make_shared<std::vector<char>>(data.begin(), data.end());
+      dispatch(deferred, ref, [this, buffer, branch, branchIdx](DataRef const&) {
+        std::get<2>(mStore.at(branchIdx)) = buffer->size();
+        std::get<1>(mStore.at(branchIdx))->Fill();
+        std::get<0>(mStore.at(branchIdx)).swap(*buffer);
+        branch->Fill();
+      });
     }
 
     // specialization for vectors of messageable types
     template <typename S, typename std::enable_if_t<std::is_same<S, MessageableVectorSpecialization>::value, int> = 0>
-    void fillData(InputContext& context, DataRef const& ref, TBranch* branch, size_t branchIdx)
+    void fillData(InputContext& context, DataRef const& ref, TBranch* branch, size_t branchIdx, std::vector<FillJob>* deferred)
     {
       using ElementType = typename value_type::value_type;
       static_assert(is_messageable<ElementType>::value, "logical error: should be correctly selected by StructureElementTypeTrait");
@@ -712,6 +936,17 @@ class RootTreeWriter
         // try extracting from message with serialization method NONE, throw runtime error
         // if message is serialized
         auto data = context.get<gsl::span<ElementType>>(ref);
+        if (deferred != nullptr) {
+          // the view would not survive the input, the fill needs its own copy
+          auto copy = std::make_shared<value_type const>(data.begin(), data.end());
+          dispatch(deferred, ref, [this, copy, branch, branchIdx](DataRef const& ref) {
+            if (!runCallback(branch, *copy, ref)) {
+              mStore[branchIdx] = const_cast<value_type*>(copy.get());
+              branch->Fill();
+            }
+          });
+          return;
+        }
         // take an ordinary std::vector "view" on the data
         auto* dataview = new value_type;
         adopt(data, *dataview);
@@ -727,11 +962,13 @@ class RootTreeWriter
       } catch (RuntimeErrorRef e) {
         if constexpr (has_root_dictionary<value_type>::value == true) {
           // try extracting from message with serialization method ROOT
-          auto data = context.get<typename std::add_pointer<value_type>::type>(ref);
-          if (!runCallback(branch, *data, ref)) {
-            mStore[branchIdx] = const_cast<value_type*>(data.get());
-            branch->Fill();
-          }
+          std::shared_ptr<value_type const> data = context.get<typename std::add_pointer<value_type>::type>(ref);
+          dispatch(deferred, ref, [this, data, branch, branchIdx](DataRef const& ref) {
+            if (!runCallback(branch, *data, ref)) {
+              mStore[branchIdx] = const_cast<value_type*>(data.get());
+              branch->Fill();
+            }
+          });
         } else {
           // the type has no ROOT dictionary, re-throw exception
           throw e;
@@ -740,11 +977,11 @@ class RootTreeWriter
     }
 
     // process previous stage and this stage
-    void process(InputContext& context, std::vector<BranchSpec>& specs)
+    void process(InputContext& context, std::vector<BranchSpec>& specs, std::vector<FillJob>* deferred)
     {
       // recursing through the tree structure by simply using method of the previous type,
       // i.e. the base class method.
-      PrevT::process(context, specs);
+      PrevT::process(context, specs, deferred);
       constexpr size_t SpecIndex = STAGE - 1;
       BranchSpec const& spec = specs[SpecIndex];
       if (spec.branches.size() == 0) {
@@ -765,7 +1002,7 @@ class RootTreeWriter
               continue;
             }
           }
-          fillData<specialization_id>(context, dataref, spec.branches.at(branchIdx), branchIdx);
+          fillData<specialization_id>(context, dataref, spec.branches.at(branchIdx), branchIdx, deferred);
         }
       }
     }
@@ -894,6 +1131,8 @@ class RootTreeWriter
   bool mIsClosed = false;
   /// custom close handler, optional
   CustomClose mCustomClose;
+  /// the asynchronous filler, must be destroyed first as it operates on the tree structure
+  std::unique_ptr<AsyncFiller> mAsync;
 };
 
 } // namespace framework
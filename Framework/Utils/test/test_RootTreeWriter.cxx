@@ -94,9 +94,8 @@ bool checkTree(const char* filename, const char* treename, Args&&... args)
   return checkBranch(*tree, std::forward<Args>(args)...);
 }
 
-BOOST_AUTO_TEST_CASE(test_RootTreeWriter)
+void runWriter(std::string const& filename, size_t asyncQueue)
 {
-  std::string filename = "test_RootTreeWriter.root";
   const char* treename = "testtree";
 
   using Container = std::vector<o2::test::Polymorphic>;
@@ -140,6 +139,8 @@ BOOST_AUTO_TEST_CASE(test_RootTreeWriter)
                         RootTreeWriter::BranchDef<std::vector<o2::test::TriviallyCopyable>>{"input8", "srlzdvecbranch"});
 
   BOOST_CHECK(writer.getStoreSize() == 7);
+  writer.setAsync(asyncQueue);
+  BOOST_CHECK(writer.isAsync() == (asyncQueue > 0));
 
   // need to mimic a context to actually call the processing
   auto transport = FairMQTransportFactory::CreateTransportFactory("zeromq");
@@ -226,6 +227,10 @@ BOOST_AUTO_TEST_CASE(test_RootTreeWriter)
     span};
 
   writer(inputs);
+  if (asyncQueue > 0) {
+    // the pending fill must not depend on the input messages
+    store.clear();
+  }
   writer.close();
 
   checkTree(filename.c_str(), treename,
@@ -238,6 +243,16 @@ BOOST_AUTO_TEST_CASE(test_RootTreeWriter)
             BranchContent<decltype(trivvec)>{"srlzdvecbranch", trivvec});
 }
 
+BOOST_AUTO_TEST_CASE(test_RootTreeWriter)
+{
+  runWriter("test_RootTreeWriter.root", 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_RootTreeWriterAsync)
+{
+  runWriter("test_RootTreeWriterAsync.root", 2);
+}
+
 template <typename T>
 using BranchDefinition = MakeRootTreeWriterSpec::BranchDefinition<T>;
 
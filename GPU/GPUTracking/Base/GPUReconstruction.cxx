@@ -156,6 +156,9 @@ int GPUReconstruction::Init()
     mHostMemorySize = std::max(mHostMemorySize, mSlaves[i]->mHostMemorySize);
     mDeviceMemorySize = std::max(mDeviceMemorySize, mSlaves[i]->mDeviceMemorySize);
   }
+  if (!IsGPU() && mProcessingSettings.doublePipeline) {
+    mHostMemorySize *= 1 + mSlaves.size(); // The CPU processes all TFs in flight in host memory, each one needs its own pool, see below
+  }
   if (InitDevice()) {
     return 1;
   }
@@ -182,6 +185,15 @@ int GPUReconstruction::Init()
     mDeviceMemoryPermanent = mSlaves[i]->mDeviceMemoryPermanent;
     mHostMemoryPermanent = mSlaves[i]->mHostMemoryPermanent;
   }
+  char* hostPoolStart = nullptr;
+  size_t hostPoolSize = 0;
+  if (!IsGPU() && mProcessingSettings.doublePipeline) {
+    // Split the non-permanent host memory in one pool per instance, so that the preparation of the next TF does not overwrite the memory of the TF being processed
+    hostPoolStart = (char*)GPUProcessor::alignPointer<GPUCA_MEMALIGN>(mHostMemoryPermanent);
+    hostPoolSize = ((char*)mHostMemoryBase + mHostMemorySize - hostPoolStart) / (1 + mSlaves.size()) / GPUCA_MEMALIGN * GPUCA_MEMALIGN;
+    mHostMemorySize = hostPoolStart + hostPoolSize - (char*)mHostMemoryBase;
+    mHostMemoryPoolEnd = (char*)mHostMemoryBase + mHostMemorySize;
+  }
   retVal = InitPhaseAfterDevice();
   if (retVal) {
     return retVal;
@@ -190,6 +202,11 @@ int GPUReconstruction::Init()
   for (unsigned int i = 0; i < mSlaves.size(); i++) {
     mSlaves[i]->mDeviceMemoryPermanent = mDeviceMemoryPermanent;
     mSlaves[i]->mHostMemoryPermanent = mHostMemoryPermanent;
+    if (hostPoolSize) {
+      mSlaves[i]->mHostMemoryPermanent = hostPoolStart + (i + 1) * hostPoolSize; // Not from mHostMemoryPermanent, which has grown in the pool of the master in the meantime
+      mSlaves[i]->mHostMemorySize = (char*)mSlaves[i]->mHostMemoryPermanent + hostPoolSize - (char*)mSlaves[i]->mHostMemoryBase;
+      mSlaves[i]->mHostMemoryPoolEnd = (char*)mSlaves[i]->mHostMemoryBase + mSlaves[i]->mHostMemorySize;
+    }
     retVal = mSlaves[i]->InitPhaseAfterDevice();
     if (retVal) {
       GPUError("Error initialization slave (after device init)");
@@ -313,7 +330,7 @@ int GPUReconstruction::InitPhaseBeforeDevice()
     mNStreams = std::max<int>(mProcessingSettings.nStreams, 3);
   }
 
-  if (mProcessingSettings.doublePipeline && (mChains.size() != 1 || mChains[0]->SupportsDoublePipeline() == false || !IsGPU() || mProcessingSettings.memoryAllocationStrategy != GPUMemoryResource::ALLOCATION_GLOBAL)) {
+  if (mProcessingSettings.doublePipeline && (mChains.size() != 1 || mChains[0]->SupportsDoublePipeline() == false || mProcessingSettings.memoryAllocationStrategy != GPUMemoryResource::ALLOCATION_GLOBAL)) {
     GPUError("Must use double pipeline mode only with exactly one chain that must support it");
     return 1;
   }
@@ -41,6 +41,10 @@
 #include <unistd.h>
 #endif
 
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
 #if defined(WITH_OPENMP) || defined(_OPENMP)
 #include <omp.h>
 #else
@@ -74,14 +78,28 @@ int GPUReconstructionCPUBackend::runKernelBackend(krnlSetup& _xyz, const Args&..
   unsigned int num = y.num == 0 || y.num == -1 ? 1 : y.num;
   for (unsigned int k = 0; k < num; k++) {
     int ompThreads = mProcessingSettings.ompKernels ? (mProcessingSettings.ompKernels == 2 ? ((mProcessingSettings.ompThreads + mNestedLoopOmpFactor - 1) / mNestedLoopOmpFactor) : mProcessingSettings.ompThreads) : 1;
+    // With the nested parallelization over slices, the inner threads of a slice kernel run on the NUMA node of the slice
+    const int numaNode = NUMAActive() && mNestedLoopOmpFactor > 1 && y.num != -1 ? NUMANodeOfSlice(y.start + k) : -1;
     if (ompThreads > 1) {
       if (mProcessingSettings.debugLevel >= 5) {
         printf("Running %d ompThreads\n", ompThreads);
       }
-      GPUCA_OPENMP(parallel for num_threads(ompThreads))
-      for (unsigned int iB = 0; iB < x.nBlocks; iB++) {
-        typename T::GPUSharedMemory smem;
-        T::template Thread<I>(x.nBlocks, 1, iB, 0, smem, T::Processor(*mHostConstantMem)[y.start + k], args...);
+      if (numaNode >= 0) {
+        GPUCA_OPENMP(parallel num_threads(ompThreads))
+        {
+          NUMAThreadPinning pinning(mNUMATopology, numaNode); // Every thread of the team restores its affinity at the end of the region
+          GPUCA_OPENMP(for)
+          for (unsigned int iB = 0; iB < x.nBlocks; iB++) {
+            typename T::GPUSharedMemory smem;
+            T::template Thread<I>(x.nBlocks, 1, iB, 0, smem, T::Processor(*mHostConstantMem)[y.start + k], args...);
+          }
+        }
+      } else {
+        GPUCA_OPENMP(parallel for num_threads(ompThreads))
+        for (unsigned int iB = 0; iB < x.nBlocks; iB++) {
+          typename T::GPUSharedMemory smem;
+          T::template Thread<I>(x.nBlocks, 1, iB, 0, smem, T::Processor(*mHostConstantMem)[y.start + k], args...);
+        }
       }
     } else {
       for (unsigned int iB = 0; iB < x.nBlocks; iB++) {
@@ -106,6 +124,97 @@ GPUReconstruction::krnlProperties GPUReconstructionCPUBackend::getKernelProperti
   return krnlProperties{1, 1};
 }
 
+int GPUReconstructionCPUBackend::InitNUMA()
+{
+  if (mNUMATopology.Init() < 2) {
+    mNUMATopology.Clear();
+    return 1;
+  }
+  mNUMABoundRanges.clear();
+  mNUMASliceBytes.assign(NSLICES, 0);
+  mNUMASliceTime.assign(NSLICES, 0.);
+  return 0;
+}
+
+size_t GPUReconstructionCPUBackend::BindProcessorMemoryToSliceNUMANode(const GPUProcessor* proc, int iSlice)
+{
+  size_t bytes = 0;
+#if defined(__linux__)
+  if (!NUMAActive()) {
+    return 0;
+  }
+  constexpr int mpolPreferred = 1;     // MPOL_PREFERRED from linux/mempolicy.h, we do not depend on libnuma
+  constexpr unsigned int mpolMove = 2; // MPOL_MF_MOVE
+  constexpr unsigned int maxNodes = 1024;
+  const int nodeId = mNUMATopology.NodeId(NUMANodeOfSlice(iSlice));
+  unsigned long nodeMask[maxNodes / (8 * sizeof(unsigned long))] = {0};
+  nodeMask[nodeId / (8 * sizeof(unsigned long))] = 1ul << (nodeId % (8 * sizeof(unsigned long)));
+  const size_t pageSize = sysconf(_SC_PAGESIZE);
+  for (const auto& res : mMemoryResources) {
+    if (res.mProcessor != proc || res.mPtr == nullptr || res.mSize == 0 || (res.mType & GPUMemoryResource::MEMORY_EXTERNAL)) {
+      continue;
+    }
+    bytes += res.mSize;
+    // Only whole pages, the pages at the borders might be shared with memory of other slices
+    size_t start = ((size_t)res.mPtr + pageSize - 1) / pageSize * pageSize;
+    size_t end = ((size_t)res.mPtr + res.mSize) / pageSize * pageSize;
+    if (end <= start) {
+      continue;
+    }
+    // The pool layout is the same for most TFs, a region is only moved when it was not yet bound to this node
+    {
+      std::lock_guard<std::mutex> lock(mNUMABindMutex);
+      auto bound = mNUMABoundRanges.find({start, end - start});
+      if (bound != mNUMABoundRanges.end() && bound->second == nodeId) {
+        continue;
+      }
+      // Previously bound regions overlapping this one are partially moved to another node now, forget them
+      for (auto it = mNUMABoundRanges.begin(); it != mNUMABoundRanges.end() && it->first.first < end;) {
+        it = it->first.first + it->first.second > start ? mNUMABoundRanges.erase(it) : std::next(it);
+      }
+      mNUMABoundRanges[{start, end - start}] = nodeId;
+    }
+    syscall(SYS_mbind, start, end - start, mpolPreferred, nodeMask, maxNodes, mpolMove);
+  }
+#endif
+  return bytes;
+}
+
+void GPUReconstructionCPUBackend::AddNUMASliceStatistics(int iSlice, size_t bytes, double time)
+{
+  if (NUMAActive()) {
+    mNUMASliceBytes[iSlice] += bytes;
+    mNUMASliceTime[iSlice] += time;
+  }
+}
+
+void GPUReconstructionCPUBackend::PrintNUMAStatistics(unsigned int nEvents)
+{
+  // Without access to the memory controller counters we cannot measure the traffic per node, hence no bandwidth.
+  // The processing time and the slice memory per node show whether the nodes are balanced.
+  for (unsigned int i = 0; i < mNUMATopology.NNodes(); i++) {
+    size_t bytes = 0;
+    double time = 0.;
+    int nSlices = 0;
+    for (unsigned int iSlice = 0; iSlice < NSLICES; iSlice++) {
+      if (NUMANodeOfSlice(iSlice) == (int)i) {
+        bytes += mNUMASliceBytes[iSlice];
+        time += mNUMASliceTime[iSlice];
+        nSlices++;
+      }
+    }
+    printf("Execution Time: NUMA Node %3d (%2d slices, %3d CPUs): %27s Time: %'10d us (slice memory %'14lu bytes)\n", mNUMATopology.NodeId(i), nSlices, (int)mNUMATopology.NodeCPUs(i).size(), "TPC Slice Tracking", (int)(time * 1000000 / nEvents), (unsigned long)(bytes / nEvents));
+    if (mProcessingSettings.resetTimers) {
+      for (unsigned int iSlice = 0; iSlice < NSLICES; iSlice++) {
+        if (NUMANodeOfSlice(iSlice) == (int)i) {
+          mNUMASliceBytes[iSlice] = 0;
+          mNUMASliceTime[iSlice] = 0.;
+        }
+      }
+    }
+  }
+}
+
 size_t GPUReconstructionCPU::TransferMemoryInternal(GPUMemoryResource* res, int stream, deviceEvent* ev, deviceEvent* evList, int nEvents, bool toGPU, const void* src, void* dst) { return 0; }
 size_t GPUReconstructionCPU::GPUMemCpy(void* dst, const void* src, size_t size, int stream, int toGPU, deviceEvent* ev, deviceEvent* evList, int nEvents) { return 0; }
 size_t GPUReconstructionCPU::GPUMemCpyAlways(bool onGpu, void* dst, const void* src, size_t size, int stream, int toGPU, deviceEvent* ev, deviceEvent* evList, int nEvents)
@@ -170,6 +279,13 @@ int GPUReconstructionCPU::InitDevice()
   if (mProcessingSettings.ompKernels) {
     mBlockCount = getOMPMaxThreads();
   }
+  if (mProcessingSettings.numaPinning) {
+    if (InitNUMA()) {
+      GPUInfo("NUMA pinning requested, but not running on multiple NUMA nodes, disabling");
+    } else if (mProcessingSettings.debugLevel >= 1) {
+      GPUInfo("NUMA pinning active, processing TPC slices on %d nodes", (int)mNUMATopology.NNodes());
+    }
+  }
   mThreadId = GetThread();
   mProcShadow.mProcessorsProc = processors();
   return 0;
@@ -278,6 +394,9 @@ int GPUReconstructionCPU::RunChains()
         printf("Execution Time: General Step      : %50s Time: %'10d us\n", GPUDataTypes::GENERAL_STEP_NAMES[i], (int)(mTimersGeneralSteps[i].GetElapsedTime() * 1000000 / mStatNEvents));
       }
     }
+    if (NUMAActive()) {
+      PrintNUMAStatistics(mStatNEvents);
+    }
     mStatKernelTime = kernelTotal * 1000000 / mStatNEvents;
     printf("Execution Time: Total   : %50s Time: %'10d us\n", "Total Kernel", (int)mStatKernelTime);
     printf("Execution Time: Total   : %50s Time: %'10d us\n", "Total Wall", (int)mStatWallTime);
@@ -20,7 +20,10 @@
 #include "GPUConstantMem.h"
 #include <stdexcept>
 #include "utils/timer.h"
+#include "utils/numa.h"
 #include <vector>
+#include <mutex>
+#include <map>
 
 #include "GPUGeneralKernels.h"
 #include "GPUTPCCreateSliceData.h"
@@ -53,6 +56,13 @@ class GPUReconstructionCPUBackend : public GPUReconstruction
  public:
   ~GPUReconstructionCPUBackend() override = default;
 
+  // NUMA-aware processing of the TPC slices, only active with the numaPinning setting on a multi-node host
+  bool NUMAActive() const { return mNUMATopology.NNodes() > 1; }
+  const NUMATopology& GetNUMATopology() const { return mNUMATopology; }
+  int NUMANodeOfSlice(int iSlice) const { return mNUMATopology.NodeOfSlice(iSlice, NSLICES); }
+  size_t BindProcessorMemoryToSliceNUMANode(const GPUProcessor* proc, int iSlice); // Move the host memory of the processor to the node processing iSlice, returns the size of that memory
+  void AddNUMASliceStatistics(int iSlice, size_t bytes, double time);
+
  protected:
   GPUReconstructionCPUBackend(const GPUSettingsDeviceBackend& cfg) : GPUReconstruction(cfg) {}
   template <class T, int I = 0, typename... Args>
@@ -60,6 +70,14 @@ class GPUReconstructionCPUBackend : public GPUReconstruction
   template <class T, int I>
   krnlProperties getKernelPropertiesBackend();
   unsigned int mNestedLoopOmpFactor = 1;
+
+  int InitNUMA();
+  void PrintNUMAStatistics(unsigned int nEvents);
+  NUMATopology mNUMATopology;                                   // NUMA nodes we run on, empty unless NUMA pinning is active
+  std::vector<size_t> mNUMASliceBytes;                          // Slice memory processed per slice since the last statistics reset
+  std::vector<double> mNUMASliceTime;                           // Processing time per slice since the last statistics reset
+  std::map<std::pair<size_t, size_t>, int> mNUMABoundRanges;    // Page ranges already moved, by start address and size: node id
+  std::mutex mNUMABindMutex;                                    // Slices are bound from parallel threads
 };
 
 template <class T>
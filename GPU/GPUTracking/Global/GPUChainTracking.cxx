@@ -296,7 +296,7 @@ bool GPUChainTracking::ValidateSettings()
       GPUError("Double pipeline incompatible to compression mode 1");
       return false;
     }
-    if (!(GetRecoStepsGPU() & GPUDataTypes::RecoStep::TPCCompression) || !(GetRecoStepsGPU() & GPUDataTypes::RecoStep::TPCClusterFinding) || param().rec.fwdTPCDigitsAsClusters) {
+    if ((mRec->IsGPU() && (!(GetRecoStepsGPU() & GPUDataTypes::RecoStep::TPCCompression) || !(GetRecoStepsGPU() & GPUDataTypes::RecoStep::TPCClusterFinding))) || param().rec.fwdTPCDigitsAsClusters) { // The CPU has no transfers to overlap, it can pipeline any steps
       GPUError("Invalid reconstruction settings for double pipeline");
       return false;
     }
@@ -596,7 +596,7 @@ int GPUChainTracking::RunChain()
   }
 
   if (mIOPtrs.clustersNative) {
-    if (GetProcessingSettings().doublePipeline) {
+    if (GetProcessingSettings().doublePipeline && mRec->IsGPU()) { // Overlapping the input transfer of the next TF with the compression is only needed on the GPU
       GPUChainTracking* foreignChain = (GPUChainTracking*)GetNextChainInQueue();
       if (foreignChain && foreignChain->mIOPtrs.tpcZS) {
         if (GetProcessingSettings().debugLevel >= 3) {
@@ -78,7 +78,7 @@ int GPUChainTracking::RunTPCCompression()
   const o2::tpc::CompressedClustersPtrs* P = nullptr;
   HighResTimer* gatherTimer = nullptr;
   int outputStream = 0;
-  if (ProcessingSettings().doublePipeline) {
+  if (ProcessingSettings().doublePipeline && mRec->IsGPU()) {
     SynchronizeStream(mRec->NStreams() - 2); // Synchronize output copies running in parallel from memory that might be released, only the following async copy from stacked memory is safe after the chain finishes.
     outputStream = mRec->NStreams() - 2;
   }
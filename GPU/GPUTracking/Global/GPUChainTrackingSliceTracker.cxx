@@ -152,6 +152,17 @@ int GPUChainTracking::RunTPCTrackingSlices_internal()
     GPUTPCTracker& trkShadow = doGPU ? processorsShadow()->tpcTrackers[iSlice] : trk;
     int useStream = (iSlice % mRec->NStreams());
 
+    const bool doNUMA = !doGPU && mRec->NUMAActive();
+    size_t numaBytes = 0;
+    HighResTimer numaTimer;
+    // Process the slice on the NUMA node its memory is moved to, the slice data is then written from there.
+    // The thread, taken from the OpenMP pool, gets its previous affinity back at the end of the iteration.
+    NUMAThreadPinning numaPinning(mRec->GetNUMATopology(), doNUMA ? mRec->NUMANodeOfSlice(iSlice) : -1);
+    if (doNUMA) {
+      numaBytes = mRec->BindProcessorMemoryToSliceNUMANode(&trk, iSlice);
+      numaTimer.Start();
+    }
+
     if (GetProcessingSettings().debugLevel >= 3) {
       GPUInfo("Creating Slice Data (Slice %d)", iSlice);
     }
@@ -255,6 +266,9 @@ int GPUChainTracking::RunTPCTrackingSlices_internal()
       }
       DoDebugAndDump(RecoStep::TPCSliceTracking, 512, trk, &GPUTPCTracker::DumpTrackHits, *mDebugFile);
     }
+    if (doNUMA) {
+      mRec->AddNUMASliceStatistics(iSlice, numaBytes, numaTimer.GetCurrentElapsedTime());
+    }
   }
   mRec->SetNestedLoopOmpFactor(1);
   if (error) {
@@ -0,0 +1,190 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file testGPUNUMA.cxx
+/// \brief Unit tests of the NUMA topology, of the mapping of the TPC slices to the nodes and of the thread pinning
+
+#define BOOST_TEST_MODULE Test GPU NUMA
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "utils/numa.h"
+
+namespace
+{
+#if defined(__linux__)
+std::vector<int> availableCPUs()
+{
+  cpu_set_t mask;
+  std::vector<int> cpus;
+  if (sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &mask)) {
+        cpus.emplace_back(cpu);
+      }
+    }
+  }
+  return cpus;
+}
+
+std::string cpuList(const std::vector<int>& cpus)
+{
+  std::string list;
+  for (int cpu : cpus) {
+    list += (list.empty() ? "" : ",") + std::to_string(cpu);
+  }
+  return list;
+}
+
+/// Fake sysfs node directory, with the given cpulist per node
+class FakeNodes
+{
+ public:
+  FakeNodes(const std::vector<std::string>& lists)
+  {
+    std::string tmpl = (std::filesystem::temp_directory_path() / "gpunumaXXXXXX").string();
+    BOOST_REQUIRE(mkdtemp(tmpl.data()) != nullptr);
+    mPath = tmpl;
+    for (unsigned int i = 0; i < lists.size(); i++) {
+      std::filesystem::create_directory(mPath / ("node" + std::to_string(i)));
+      std::ofstream(mPath / ("node" + std::to_string(i)) / "cpulist") << lists[i] << "\n";
+    }
+  }
+  ~FakeNodes() { std::filesystem::remove_all(mPath); }
+  std::string path() const { return mPath.string(); }
+
+ private:
+  std::filesystem::path mPath;
+};
+
+bool sameAffinity(const cpu_set_t& a)
+{
+  cpu_set_t b;
+  return sched_getaffinity(0, sizeof(b), &b) == 0 && CPU_EQUAL(&a, &b);
+}
+#endif
+} // namespace
+
+BOOST_AUTO_TEST_CASE(ParseCPUList)
+{
+  BOOST_CHECK(NUMATopology::ParseCPUList("") == std::vector<int>{});
+  BOOST_CHECK(NUMATopology::ParseCPUList("5") == std::vector<int>{5});
+  BOOST_CHECK((NUMATopology::ParseCPUList("0-3,8,10-11") == std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+  BOOST_CHECK((NUMATopology::ParseCPUList("2,,4\n") == std::vector<int>{2, 4}));
+}
+
+BOOST_AUTO_TEST_CASE(SliceToNodeMapping)
+{
+  const int nSlices = 36;
+  for (unsigned int nNodes = 1; nNodes <= 4; nNodes++) {
+    BOOST_TEST_CONTEXT(nNodes << " nodes")
+    {
+      NUMATopology topology;
+#if defined(__linux__)
+      // All nodes may share the same CPUs, only the number of nodes matters for the mapping
+      auto cpus = cpuList(availableCPUs());
+      FakeNodes nodes(std::vector<std::string>(nNodes, cpus));
+      BOOST_REQUIRE_EQUAL(topology.Init(nodes.path()), (int)nNodes);
+#else
+      continue;
+#endif
+      // Consecutive slices on the same node, every node gets the same number of slices up to one
+      std::vector<int> perNode(nNodes, 0);
+      int previous = 0;
+      for (int iSlice = 0; iSlice < nSlices; iSlice++) {
+        int node = topology.NodeOfSlice(iSlice, nSlices);
+        BOOST_REQUIRE(node >= previous && node < (int)nNodes);
+        BOOST_CHECK_LE(node - previous, 1);
+        previous = node;
+        perNode[node]++;
+      }
+      BOOST_CHECK_EQUAL(topology.NodeOfSlice(0, nSlices), 0);
+      BOOST_CHECK_EQUAL(topology.NodeOfSlice(nSlices - 1, nSlices), (int)nNodes - 1);
+      for (int n : perNode) {
+        BOOST_CHECK_LE(std::abs(n - nSlices / (int)nNodes), 1);
+      }
+    }
+  }
+}
+
+#if defined(__linux__)
+BOOST_AUTO_TEST_CASE(InitFromSysfs)
+{
+  auto cpus = availableCPUs();
+  BOOST_REQUIRE(!cpus.empty());
+  // Node 1 has no CPU available to the process and is skipped, node 2 lists an unavailable CPU which is dropped
+  FakeNodes nodes({cpuList({cpus[0]}), std::to_string(CPU_SETSIZE + 1), cpuList(cpus) + "," + std::to_string(CPU_SETSIZE + 2)});
+  NUMATopology topology;
+  BOOST_REQUIRE_EQUAL(topology.Init(nodes.path()), 2);
+  BOOST_CHECK_EQUAL(topology.NodeId(0), 0);
+  BOOST_CHECK_EQUAL(topology.NodeId(1), 2);
+  BOOST_CHECK(topology.NodeCPUs(0) == std::vector<int>{cpus[0]});
+  BOOST_CHECK(topology.NodeCPUs(1) == cpus);
+
+  NUMATopology none;
+  BOOST_CHECK_EQUAL(none.Init(nodes.path() + "/missing"), 0);
+}
+
+BOOST_AUTO_TEST_CASE(PinningRestoresAffinity)
+{
+  auto cpus = availableCPUs();
+  if (cpus.size() < 2) {
+    BOOST_TEST_MESSAGE("Only one CPU available, pinning cannot change the affinity");
+    return;
+  }
+  FakeNodes nodes({cpuList({cpus[0]}), cpuList(std::vector<int>(cpus.begin() + 1, cpus.end()))});
+  NUMATopology topology;
+  BOOST_REQUIRE_EQUAL(topology.Init(nodes.path()), 2);
+
+  // Two jobs in a row on the same thread, as in a thread pool: the second one must not see the pinning of the first one
+  std::thread worker([&topology]() {
+    cpu_set_t original;
+    if (sched_getaffinity(0, sizeof(original), &original)) { // No BOOST_REQUIRE outside of the main thread
+      BOOST_ERROR("sched_getaffinity failed");
+      return;
+    }
+    for (int node = 0; node < 2; node++) {
+      {
+        NUMAThreadPinning pinning(topology, node);
+        BOOST_CHECK(pinning.Changed());
+        cpu_set_t pinned;
+        CPU_ZERO(&pinned);
+        BOOST_CHECK(sched_getaffinity(0, sizeof(pinned), &pinned) == 0);
+        BOOST_CHECK_EQUAL(CPU_COUNT(&pinned), (int)topology.NodeCPUs(node).size());
+        for (int cpu : topology.NodeCPUs(node)) {
+          BOOST_CHECK(CPU_ISSET(cpu, &pinned));
+        }
+        {
+          // Already pinned to the node, e.g. the master thread of a nested team: nothing changed, nothing restored
+          NUMAThreadPinning nested(topology, node);
+          BOOST_CHECK(!nested.Changed());
+        }
+        BOOST_CHECK(sameAffinity(pinned));
+        BOOST_CHECK(!sameAffinity(original));
+      }
+      BOOST_CHECK(sameAffinity(original));
+    }
+    // No node, or a node out of range, leaves the thread untouched
+    NUMAThreadPinning noNode(topology, -1);
+    NUMAThreadPinning badNode(topology, 2);
+    BOOST_CHECK(!noNode.Changed() && !badNode.Changed());
+    BOOST_CHECK(sameAffinity(original));
+  });
+  worker.join();
+}
+#endif
@@ -0,0 +1,98 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file numa.cxx
+
+#include "numa.h"
+#include <fstream>
+#include <sstream>
+
+int NUMATopology::Init(const std::string& sysfsNodes)
+{
+  Clear();
+#if defined(__linux__)
+  cpu_set_t available;
+  if (sched_getaffinity(0, sizeof(available), &available)) {
+    return 0;
+  }
+  for (int node = 0; true; node++) {
+    std::ifstream file(sysfsNodes + "/node" + std::to_string(node) + "/cpulist");
+    if (!file) {
+      break;
+    }
+    std::string list;
+    std::getline(file, list);
+    std::vector<int> cpus;
+    for (int cpu : ParseCPUList(list)) {
+      if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &available)) {
+        cpus.emplace_back(cpu);
+      }
+    }
+    if (cpus.size()) {
+      mNodeIds.emplace_back(node);
+      mNodeCPUs.emplace_back(std::move(cpus));
+    }
+  }
+#endif
+  return NNodes();
+}
+
+void NUMATopology::Clear()
+{
+  mNodeIds.clear();
+  mNodeCPUs.clear();
+}
+
+std::vector<int> NUMATopology::ParseCPUList(const std::string& list)
+{
+  std::vector<int> cpus;
+  std::stringstream ranges(list);
+  std::string range;
+  while (std::getline(ranges, range, ',')) {
+    if (range.empty() || range.find_first_not_of(" \t\n") == std::string::npos) {
+      continue;
+    }
+    size_t dash = range.find('-');
+    int first = std::stoi(range.substr(0, dash));
+    int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+    for (int cpu = first; cpu <= last; cpu++) {
+      cpus.emplace_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+NUMAThreadPinning::NUMAThreadPinning(const NUMATopology& topology, int node)
+{
+#if defined(__linux__)
+  if (node < 0 || node >= (int)topology.NNodes() || sched_getaffinity(0, sizeof(mPrevious), &mPrevious)) {
+    return;
+  }
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  for (int cpu : topology.NodeCPUs(node)) {
+    CPU_SET(cpu, &cpus);
+  }
+  // Nothing to do if the thread is already pinned to the node, e.g. the master of the inner team of a nested parallel region
+  if (CPU_COUNT(&cpus) && !CPU_EQUAL(&cpus, &mPrevious) && sched_setaffinity(0, sizeof(cpus), &cpus) == 0) {
+    mRestore = true;
+  }
+#endif
+}
+
+NUMAThreadPinning::~NUMAThreadPinning()
+{
+#if defined(__linux__)
+  if (mRestore) {
+    sched_setaffinity(0, sizeof(mPrevious), &mPrevious);
+  }
+#endif
+}
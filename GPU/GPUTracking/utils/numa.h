@@ -0,0 +1,59 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file numa.h
+
+#ifndef QONMODULE_NUMA_H
+#define QONMODULE_NUMA_H
+
+#include <string>
+#include <vector>
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+// NUMA nodes of the host with the CPUs of each node the process may run on, read from sysfs without libnuma
+class NUMATopology
+{
+ public:
+  int Init(const std::string& sysfsNodes = "/sys/devices/system/node"); // Returns the number of nodes with available CPUs
+  void Clear();
+  unsigned int NNodes() const { return mNodeCPUs.size(); }
+  int NodeId(unsigned int i) const { return mNodeIds[i]; }                             // System id of the i-th node
+  const std::vector<int>& NodeCPUs(unsigned int i) const { return mNodeCPUs[i]; }      // Available CPUs of the i-th node
+  int NodeOfSlice(int iSlice, int nSlices) const { return iSlice * (int)NNodes() / nSlices; } // Consecutive slices are split evenly between the nodes
+
+  static std::vector<int> ParseCPUList(const std::string& list); // Parse a sysfs cpulist, e.g. "0-3,8,10-11"
+
+ private:
+  std::vector<int> mNodeIds;
+  std::vector<std::vector<int>> mNodeCPUs;
+};
+
+// Pins the calling thread to the CPUs of one node of the topology while it exists, and restores the previous affinity of the thread when destroyed.
+// Used in each thread of an OpenMP team, so that the pooled threads are not left bound to the node in later parallel regions.
+class NUMAThreadPinning
+{
+ public:
+  NUMAThreadPinning(const NUMATopology& topology, int node); // node < 0 does nothing
+  ~NUMAThreadPinning();
+  NUMAThreadPinning(const NUMAThreadPinning&) = delete;
+  NUMAThreadPinning& operator=(const NUMAThreadPinning&) = delete;
+  bool Changed() const { return mRestore; } // Whether the affinity was changed, and is restored on destruction
+
+ private:
+#if defined(__linux__)
+  cpu_set_t mPrevious;
+#endif
+  bool mRestore = false;
+};
+
+#endif
@@ -253,6 +253,8 @@ class ITSDPLDigitizerTask : public ITSMFTDPLDigitizerTask
     digipar.setNoisePerPixel(dopt.noisePerPixel);     // noise level
     digipar.setTimeOffset(dopt.timeOffset);
     digipar.setNSimSteps(dopt.nSimSteps);
+    digipar.setShapeCacheNQuant(dopt.shapeCacheNQuant);
+    mDigitizer.setNThreads(dopt.nThreads);
   }
 };
 
@@ -296,6 +298,8 @@ class MFTDPLDigitizerTask : public ITSMFTDPLDigitizerTask
     digipar.setNoisePerPixel(dopt.noisePerPixel);     // noise level
     digipar.setTimeOffset(dopt.timeOffset);
     digipar.setNSimSteps(dopt.nSimSteps);
+    digipar.setShapeCacheNQuant(dopt.shapeCacheNQuant);
+    mDigitizer.setNThreads(dopt.nThreads);
   }
 };
 
@@ -21,6 +21,7 @@
 #include <vector>
 #include <memory>
 
+#include "Framework/ConcreteDataMatcher.h"
 #include "Framework/DataProcessorSpec.h"
 #include "Framework/DeviceSpec.h"
 #include "Framework/Task.h"
@@ -69,11 +70,22 @@ class Dispatcher : public framework::Task
   void reportStats(monitoring::Monitoring& monitoring) const;
   void send(framework::DataAllocator& dataAllocator, const framework::DataRef& inputData, const framework::Output& output) const;
 
+  /// A policy which matches a given input together with the data type it should be sampled to.
+  struct PolicyMatch {
+    DataSamplingPolicy* policy;
+    framework::ConcreteDataTypeMatcher route;
+  };
+  /// \brief Returns the policies matching the input, evaluating them only the first time the input is seen.
+  const std::vector<PolicyMatch>& matchingPolicies(const framework::ConcreteDataMatcher& input);
+
   std::string mName;
   DataSamplingHeader::DeviceIDType mDeviceID = "invalid";
   std::string mReconfigurationSource;
   // policies should be shared between all pipeline threads
   std::vector<std::shared_ptr<DataSamplingPolicy>> mPolicies;
+  // policy matches of each input seen so far, cleared whenever mPolicies changes.
+  // There are only a few distinct inputs, so a linear search is enough.
+  std::vector<std::pair<framework::ConcreteDataMatcher, std::vector<PolicyMatch>>> mPolicyMatches;
 };
 
 } // namespace o2::utilities
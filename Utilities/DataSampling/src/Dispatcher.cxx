@@ -70,6 +70,9 @@ void Dispatcher::init(InitContext& ctx)
     }
   }
 
+  // the policies might have been reconfigured
+  mPolicyMatches.clear();
+
   auto spec = ctx.services().get<const DeviceSpec>();
   mDeviceID.runtimeInit(spec.id.substr(0, DataSamplingHeader::deviceIDTypeSize).c_str());
 }
@@ -78,7 +81,7 @@ void Dispatcher::run(ProcessingContext& ctx)
 {
   // todo: consider matching (and deciding) in completion policy to save some time
   //  it is not trivial though, we would have to share state with the customize() method,
-  //  which is not possible atm.
+  //  which is not possible atm. For now, the matching is evaluated once per input route and cached.
 
   for (auto inputIt = ctx.inputs().begin(); inputIt != ctx.inputs().end(); inputIt++) {
 
@@ -89,13 +92,12 @@ void Dispatcher::run(ProcessingContext& ctx)
     const auto* firstInputHeader = DataRefUtils::getHeader<header::DataHeader*>(firstPart);
     ConcreteDataMatcher inputMatcher{firstInputHeader->dataOrigin, firstInputHeader->dataDescription, firstInputHeader->subSpecification};
 
-    for (auto& policy : mPolicies) {
-      // fixme: in principle matching could be broken by having query "TST/RAWDATA/0" and having parts with just
-      //  the first subspec == 0, but others could be different. However, we trust that DPL does necessary checks
-      //  during workflow validation and when passing messages (e.g. query "TST/RAWDATA/0" should not match
-      //  a "TST/RAWDATA/*" output.
-      if (auto route = policy->match(inputMatcher); route != nullptr && policy->decide(firstPart)) {
-        auto routeAsConcreteDataType = DataSpecUtils::asConcreteDataTypeMatcher(*route);
+    // fixme: in principle matching could be broken by having query "TST/RAWDATA/0" and having parts with just
+    //  the first subspec == 0, but others could be different. However, we trust that DPL does necessary checks
+    //  during workflow validation and when passing messages (e.g. query "TST/RAWDATA/0" should not match
+    //  a "TST/RAWDATA/*" output.
+    for (const auto& [policy, routeAsConcreteDataType] : matchingPolicies(inputMatcher)) {
+      if (policy->decide(firstPart)) {
         auto dsheader = prepareDataSamplingHeader(*policy);
         for (const auto& part : inputIt) {
           if (part.header != nullptr) {
@@ -165,15 +167,34 @@ header::Stack Dispatcher::extractAdditionalHeaders(const char* inputHeaderStack)
   return headerStack;
 }
 
+const std::vector<Dispatcher::PolicyMatch>& Dispatcher::matchingPolicies(const ConcreteDataMatcher& input)
+{
+  for (const auto& [matcher, matches] : mPolicyMatches) {
+    if (matcher == input) {
+      return matches;
+    }
+  }
+  std::vector<PolicyMatch> matches;
+  for (auto& policy : mPolicies) {
+    if (auto route = policy->match(input); route != nullptr) {
+      matches.push_back({policy.get(), DataSpecUtils::asConcreteDataTypeMatcher(*route)});
+    }
+  }
+  return mPolicyMatches.emplace_back(input, std::move(matches)).second;
+}
+
 void Dispatcher::send(DataAllocator& dataAllocator, const DataRef& inputData, const Output& output) const
 {
-  const auto* inputHeader = DataRefUtils::getHeader<header::DataHeader*>(inputData);
-  dataAllocator.snapshot(output, inputData.payload, inputHeader->payloadSize, inputHeader->payloadSerializationMethod);
+  // the payload is not copied if it still resides in the message we have received it in,
+  // only the header stack is new.
+  dataAllocator.forward(output, inputData);
 }
 
 void Dispatcher::registerPolicy(std::unique_ptr<DataSamplingPolicy>&& policy)
 {
   mPolicies.emplace_back(std::move(policy));
+  // the new policy might match inputs which were already seen
+  mPolicyMatches.clear();
 }
 
 const std::string& Dispatcher::getName()
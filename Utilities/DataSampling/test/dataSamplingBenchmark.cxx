@@ -46,6 +46,7 @@ void customize(std::vector<ConfigParamSpec>& workflowOptions)
 }
 
 #include <memory>
+#include <chrono>
 #include <boost/algorithm/string.hpp>
 #include <boost/interprocess/managed_shared_memory.hpp>
 #include <boost/functional/hash.hpp>
@@ -64,6 +65,7 @@ void sysinfo(sysinfo* info)
 
 #include "Headers/DataHeader.h"
 #include "Framework/ControlService.h"
+#include "Framework/DataRefUtils.h"
 #include "DataSampling/DataSampling.h"
 #include "DataSampling/DataSamplingPolicy.h"
 #include "Framework/RawDeviceService.h"
@@ -232,11 +234,24 @@ WorkflowSpec defineDataProcessing(ConfigContext const& config)
            {"test-timer", "TST", "TIMER", 0, Lifetime::Timer}},
     Outputs{},
     AlgorithmSpec{
-      (AlgorithmSpec::ProcessCallback)[](ProcessingContext & ctx){
-        // todo: maybe add a check
-        if (ctx.inputs().isValid("test-timer")){
-          ctx.services().get<ControlService>().readyToQuit(QuitRequest::All);
-        }
+      (AlgorithmSpec::InitCallback) [](InitContext&) {
+        auto sampledBytes = std::make_shared<size_t>(0);
+        auto sampledMessages = std::make_shared<size_t>(0);
+        auto start = std::make_shared<std::chrono::steady_clock::time_point>(std::chrono::steady_clock::now());
+
+        return (AlgorithmSpec::ProcessCallback) [=](ProcessingContext& ctx) {
+          if (ctx.inputs().isValid("test-data")) {
+            auto data = ctx.inputs().get<DataRef>("test-data");
+            *sampledBytes += DataRefUtils::getPayloadSize(data);
+            *sampledMessages += 1;
+          }
+          if (ctx.inputs().isValid("test-timer")) {
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - *start).count();
+            LOG(info) << "Sampled " << *sampledMessages << " messages, " << *sampledBytes / 1000000.0 << " MB in "
+                      << elapsed << " s: " << *sampledBytes / 1000000.0 / elapsed << " MB/s";
+            ctx.services().get<ControlService>().readyToQuit(QuitRequest::All);
+          }
+        };
       }
     },
     Options{